@@ -19,51 +19,216 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include <ghost.h>
-#include <sstream>
 #include <map>
 #include <string>
+#include <vector>
+#include <string.h>
 #include <ghostuser/utils/logger.hpp>
-#include <stdio.h>
 
 /**
- *
+ * This driver keeps a file system in memory and serves it on "/mount/loopback",
+ * so that the cost of passing requests to a delegate process can be measured.
  */
-struct phys_node_t {
-	g_fs_virt_id virt_id;
-	int phys_id;
-	phys_node_t* parent;
+struct memory_node_t {
+	g_fs_phys_id phys_id;
+	g_fs_node_type type;
 	std::string name;
+	memory_node_t* parent;
+	std::vector<memory_node_t*> children;
+	std::vector<uint8_t> content;
 };
 
-static std::map<int, phys_node_t*> phys_nodes;
+static std::map<g_fs_phys_id, memory_node_t*> memory_nodes;
+static g_fs_phys_id next_phys_id = 1;
 
 /**
  *
  */
-phys_node_t* fake_discovery(phys_node_t* parent, std::string name) {
-	static int fake_phys_id_counter = 1238;
-	phys_node_t* node = new phys_node_t;
-	node->parent = parent;
-	node->phys_id = fake_phys_id_counter++;
+memory_node_t* create_memory_node(memory_node_t* parent, std::string name, g_fs_node_type type) {
+	memory_node_t* node = new memory_node_t;
+	node->phys_id = next_phys_id++;
+	node->type = type;
 	node->name = name;
-	phys_nodes[node->phys_id] = node;
+	node->parent = parent;
+	if (parent) {
+		parent->children.push_back(node);
+	}
+	memory_nodes[node->phys_id] = node;
 	return node;
 }
 
 /**
  *
  */
-void print_phys_tree() {
-
-	g_logger::log(" physical nodes:");
-	for (auto entry : phys_nodes) {
-		phys_node_t* node = entry.second;
-		g_logger::log("    '" + node->name + "', v%i, p%i, parent v%i p%i",
-				node->virt_id, node->phys_id,
-				node->parent ? node->parent->virt_id : 0,
-				node->parent ? node->parent->phys_id : 0);
+memory_node_t* get_memory_node(g_fs_phys_id phys_id) {
+	auto entry = memory_nodes.find(phys_id);
+	return entry == memory_nodes.end() ? 0 : entry->second;
+}
+
+/**
+ *
+ */
+memory_node_t* find_memory_child(memory_node_t* parent, const char* name) {
+	for (memory_node_t* child : parent->children) {
+		if (child->name == name) {
+			return child;
+		}
 	}
+	return 0;
+}
 
+/**
+ *
+ */
+void handle_discover(g_fs_tasked_delegate_request* request, uint8_t* transfer, memory_node_t* parent) {
+	memory_node_t* child = parent ? find_memory_child(parent, (const char*) transfer) : 0;
+	if (child) {
+		request->result_phys_fs_id = child->phys_id;
+		request->result_type = child->type;
+		request->result_status = G_FS_DISCOVERY_SUCCESSFUL;
+	} else {
+		request->result_status = parent ? G_FS_DISCOVERY_NOT_FOUND : G_FS_DISCOVERY_ERROR;
+	}
+}
+
+/**
+ *
+ */
+void handle_read(g_fs_tasked_delegate_request* request, uint8_t* transfer, memory_node_t* node) {
+	if (!node || node->type != G_FS_NODE_TYPE_FILE) {
+		request->result_status = G_FS_READ_ERROR;
+		return;
+	}
+
+	int64_t available = (int64_t) node->content.size() - request->offset;
+	int64_t length = available < request->length ? available : request->length;
+	if (length < 0) {
+		length = 0;
+	}
+	if (length > 0) {
+		memcpy(transfer, node->content.data() + request->offset, length);
+	}
+	request->result = length;
+	request->result_status = G_FS_READ_SUCCESSFUL;
+}
+
+/**
+ *
+ */
+void handle_write(g_fs_tasked_delegate_request* request, uint8_t* transfer, memory_node_t* node) {
+	if (!node || node->type != G_FS_NODE_TYPE_FILE) {
+		request->result_status = G_FS_WRITE_ERROR;
+		return;
+	}
+
+	uint64_t end = request->offset + request->length;
+	if (end > node->content.size()) {
+		node->content.resize(end);
+	}
+	memcpy(node->content.data() + request->offset, transfer, request->length);
+	request->result = request->length;
+	request->result_status = G_FS_WRITE_SUCCESSFUL;
+}
+
+/**
+ * Writes records for the children starting at the index given as offset, as many
+ * as fit the transfer buffer.
+ */
+void handle_read_directory(g_fs_tasked_delegate_request* request, uint8_t* transfer, memory_node_t* folder) {
+	if (!folder) {
+		request->result_status = G_FS_DIRECTORY_REFRESH_ERROR;
+		return;
+	}
+
+	uint32_t position = 0;
+	int64_t count = 0;
+	for (uint64_t index = request->offset; index < folder->children.size(); index++) {
+		memory_node_t* child = folder->children[index];
+
+		uint32_t record_length = sizeof(g_fs_tasked_delegate_directory_record) + child->name.length() + 1;
+		record_length = (record_length + 3) & ~3;
+		if (position + record_length > G_FS_TASKED_DELEGATE_TRANSFER_SIZE) {
+			break;
+		}
+
+		g_fs_tasked_delegate_directory_record* record = (g_fs_tasked_delegate_directory_record*) &transfer[position];
+		record->record_length = record_length;
+		record->phys_fs_id = child->phys_id;
+		record->type = child->type;
+		memcpy(record->name, child->name.c_str(), child->name.length() + 1);
+
+		position += record_length;
+		count++;
+	}
+
+	request->result = count;
+	request->result_status = G_FS_DIRECTORY_REFRESH_SUCCESSFUL;
+}
+
+/**
+ *
+ */
+void handle_create(g_fs_tasked_delegate_request* request, uint8_t* transfer, memory_node_t* parent) {
+	if (!parent || parent->type == G_FS_NODE_TYPE_FILE) {
+		request->result_status = G_FS_OPEN_ERROR;
+		return;
+	}
+
+	const char* name = (const char*) transfer;
+	memory_node_t* file = find_memory_child(parent, name);
+	if (!file) {
+		file = create_memory_node(parent, name, G_FS_NODE_TYPE_FILE);
+	}
+	request->result_phys_fs_id = file->phys_id;
+	request->result_status = G_FS_OPEN_SUCCESSFUL;
+}
+
+/**
+ *
+ */
+void handle_request(g_fs_tasked_delegate_ring* ring, uint32_t slot) {
+	g_fs_tasked_delegate_request* request = &ring->requests[slot];
+	uint8_t* transfer = G_FS_TASKED_DELEGATE_TRANSFER(ring, slot);
+	memory_node_t* node = get_memory_node(request->phys_fs_id);
+
+	switch (request->type) {
+	case G_FS_TASKED_DELEGATE_REQUEST_TYPE_DISCOVER:
+		handle_discover(request, transfer, node);
+		break;
+
+	case G_FS_TASKED_DELEGATE_REQUEST_TYPE_READ:
+		handle_read(request, transfer, node);
+		break;
+
+	case G_FS_TASKED_DELEGATE_REQUEST_TYPE_WRITE:
+		handle_write(request, transfer, node);
+		break;
+
+	case G_FS_TASKED_DELEGATE_REQUEST_TYPE_GET_LENGTH:
+		request->result = node ? node->content.size() : 0;
+		request->result_status = node ? G_FS_LENGTH_SUCCESSFUL : G_FS_LENGTH_NOT_FOUND;
+		break;
+
+	case G_FS_TASKED_DELEGATE_REQUEST_TYPE_READ_DIRECTORY:
+		handle_read_directory(request, transfer, node);
+		break;
+
+	case G_FS_TASKED_DELEGATE_REQUEST_TYPE_CREATE:
+		handle_create(request, transfer, node);
+		break;
+
+	case G_FS_TASKED_DELEGATE_REQUEST_TYPE_TRUNCATE:
+		if (node) {
+			node->content.clear();
+		}
+		request->result_status = node ? G_FS_OPEN_SUCCESSFUL : G_FS_OPEN_NOT_FOUND;
+		break;
+
+	default:
+		g_logger::log("received request of unknown type %i", request->type);
+		request->result_status = -1;
+		break;
+	}
 }
 
 /**
@@ -78,187 +243,46 @@ int main(int argc, char* argv[]) {
 	 * The process must specify a name, and gets a mountpoint &
 	 * a transaction storage back:
 	 */
-	const char* name = "testfs";
+	const char* name = "loopback";
 	g_fs_virt_id mountpoint_id;
 	g_address transaction_storage_addr;
 
-	phys_node_t* mountpoint_node = fake_discovery(0, "root");
+	memory_node_t* root = create_memory_node(0, "root", G_FS_NODE_TYPE_MOUNTPOINT);
+	memory_node_t* readme = create_memory_node(root, "readme.txt", G_FS_NODE_TYPE_FILE);
+	const char* readme_text = "This file is served by the example file system driver.\n";
+	readme->content.assign(readme_text, readme_text + strlen(readme_text));
+
 	g_fs_register_as_delegate_status result = g_fs_register_as_delegate(name,
-			mountpoint_node->phys_id, &mountpoint_id,
-			&transaction_storage_addr);
-	mountpoint_node->virt_id = mountpoint_id;
+			root->phys_id, &mountpoint_id, &transaction_storage_addr);
 
-	/**
-	 * Now the result of the registration must be checked
-	 */
 	if (result == G_FS_REGISTER_AS_DELEGATE_FAILED_EXISTING) {
 		g_logger::log(
 				"failed to register as delegate named '%s', mountpoint already exists",
 				name);
+		return -1;
 
-	} else if (result == G_FS_REGISTER_AS_DELEGATE_FAILED_DELEGATE_CREATION) {
+	} else if (result != G_FS_REGISTER_AS_DELEGATE_SUCCESSFUL) {
 		g_logger::log(
 				"failed to register as delegate named '%s', delegate could not be created",
 				name);
+		return -1;
+	}
 
-	} else if (result == G_FS_REGISTER_AS_DELEGATE_SUCCESSFUL) {
-		/**
-		 * The transaction storage is used in various operations, like discovering nodes,
-		 * to transfer data from the kernel to the process.
-		 */
-		uint8_t* transaction_storage = (uint8_t*) transaction_storage_addr;
-
-		g_tid tid = g_get_tid();
-		g_fs_phys_id dummy_fs_node_id_counter = 0;
-
-		/**
-		 * The driver must now make a message loop, asking for messages that are
-		 * addressed to the **thread** that was registered.
-		 */
-		while (true) {
-			g_message_empty(request);
-			g_recv_msg(tid, &request);
-
-			// Now do what is necessary to perform the requested operation
-			if (request.type == G_FS_TASKED_DELEGATE_REQUEST_TYPE_DISCOVER) {
-				g_fs_tasked_delegate_transaction_storage_discovery* disc =
-						(g_fs_tasked_delegate_transaction_storage_discovery*) transaction_storage;
-
-				phys_node_t* parent = 0;
-				if (phys_nodes.count(disc->parent_phys_fs_id) > 0) {
-					parent = phys_nodes[disc->parent_phys_fs_id];
-
-					phys_node_t* child = fake_discovery(parent, disc->name);
-
-					g_fs_virt_id created_vfs_node_id;
-					g_fs_create_node_status stat = g_fs_create_node(
-							parent->virt_id, disc->name, G_FS_NODE_TYPE_FILE,
-							child->phys_id, &created_vfs_node_id);
-					child->virt_id = created_vfs_node_id;
-					g_logger::log(
-							"discovered child of %i (phys %i) named %s, virt %i, phys %i",
-							parent->virt_id, parent->phys_id, disc->name,
-							child->virt_id, child->phys_id);
-
-					disc->result_status = G_FS_DISCOVERY_SUCCESSFUL;
-				} else {
-					g_logger::log(
-							"tried to find child of non-existing physical node: %i",
-							disc->parent_phys_fs_id);
-					disc->result_status = G_FS_DISCOVERY_ERROR;
-				}
-				g_fs_set_transaction_status(request.parameterA,
-						G_FS_TRANSACTION_FINISHED);
-
-			} else if (request.type == G_FS_TASKED_DELEGATE_REQUEST_TYPE_READ) {
-				g_fs_tasked_delegate_transaction_storage_read* storage =
-						(g_fs_tasked_delegate_transaction_storage_read*) transaction_storage;
-
-				// this is a dummy method, driver has exactly 1024 random files
-				int toread = 1024 - storage->offset;
-				int requested = storage->length;
-				toread = toread < requested ? toread : requested;
-				for (int i = 0; i < toread; i++) {
-					((char*) storage->mapped_buffer)[i] = (char) ('a'
-							+ (i % ('z' - 'a')));
-				}
-				storage->result_read = toread;
-				storage->result_status = G_FS_READ_SUCCESSFUL;
-				g_fs_set_transaction_status(request.parameterA,
-						G_FS_TRANSACTION_FINISHED);
-
-			} else if (request.type
-					== G_FS_TASKED_DELEGATE_REQUEST_TYPE_WRITE) {
-				g_fs_tasked_delegate_transaction_storage_write* storage =
-						(g_fs_tasked_delegate_transaction_storage_write*) transaction_storage;
-
-				std::stringstream content;
-				for (int i = 0; i < storage->length; i++) {
-					content << ((char*) storage->mapped_buffer)[i];
-				}
-				g_logger::log(
-						"wrote %i to node %i: '" + content.str() + "'",
-						storage->length, storage->phys_fs_id);
-				storage->result_write = storage->length;
-				storage->result_status = G_FS_WRITE_SUCCESSFUL;
-				g_fs_set_transaction_status(request.parameterA,
-						G_FS_TRANSACTION_FINISHED);
-
-			} else if (request.type
-					== G_FS_TASKED_DELEGATE_REQUEST_TYPE_GET_LENGTH) {
-				g_fs_tasked_delegate_transaction_storage_get_length* storage =
-						(g_fs_tasked_delegate_transaction_storage_get_length*) transaction_storage;
-
-				storage->result_length = 1024;
-				storage->result_status = G_FS_LENGTH_SUCCESSFUL;
-				g_fs_set_transaction_status(request.parameterA,
-						G_FS_TRANSACTION_FINISHED);
-
-			} else if (request.type
-					== G_FS_TASKED_DELEGATE_REQUEST_TYPE_READ_DIRECTORY) {
-				g_fs_tasked_delegate_transaction_storage_directory_refresh* storage =
-						(g_fs_tasked_delegate_transaction_storage_directory_refresh*) transaction_storage;
-
-				klog("got read directory request");
-
-				for(int position = 0; position < 10; position++) {
-					phys_node_t* parent = phys_nodes[storage->parent_phys_fs_id];
-
-					// prepare name
-					std::stringstream filenames;
-					filenames << "file" << position;
-					std::string filename = filenames.str();
-
-					// find existing node at position
-					phys_node_t* child = 0;
-
-					int index = 0;
-					for (auto entry : phys_nodes) {
-						if (entry.second->parent->phys_id == parent->phys_id) {
-							if (index == position) {
-								child = entry.second;
-								break;
-							}
-							++index;
-						}
-					}
-
-					// otherwise create node
-					if (child == 0) {
-						child = fake_discovery(parent, filename.c_str());
-						klog("- creating fake child: %s", filename.c_str());
-					}
-
-					klog("- fake child: %s", filename.c_str());
-
-					// create/update node
-					g_fs_virt_id vfs_node_id;
-					g_fs_create_node_status stat = g_fs_create_node(
-							parent->virt_id, (char*) filename.c_str(),
-							G_FS_NODE_TYPE_FILE, child->phys_id, &vfs_node_id);
-					child->virt_id = vfs_node_id;
-
-					if (stat == G_FS_CREATE_NODE_STATUS_CREATED) {
-						g_logger::log("created node when reading dir");
-					} else if (stat == G_FS_CREATE_NODE_STATUS_UPDATED) {
-						g_logger::log("updated node when reading dir");
-					} else {
-						g_logger::log("failed on node when reading dir");
-					}
-
-					storage->result_status = G_FS_READ_DIRECTORY_SUCCESSFUL;
-				}
-
-				g_fs_set_transaction_status(request.parameterA,
-						G_FS_TRANSACTION_FINISHED);
-			}
-
+	/**
+	 * The transaction storage is a ring that the kernel puts requests into. Each request
+	 * has its own transfer buffer for names and payloads. All requests that are pending
+	 * are taken at once, and the kernel is only woken once after finishing them.
+	 */
+	g_fs_tasked_delegate_ring* ring = (g_fs_tasked_delegate_ring*) transaction_storage_addr;
+	uint32_t slots[G_FS_TASKED_DELEGATE_SLOTS];
+
+	while (true) {
+		uint32_t count = g_fs_delegate_take(ring, slots, G_FS_TASKED_DELEGATE_SLOTS);
+		for (uint32_t i = 0; i < count; i++) {
+			handle_request(ring, slots[i]);
+			g_fs_delegate_finish(ring, slots[i], G_FS_TRANSACTION_FINISHED);
 		}
-
-	} else {
-		g_logger::log(
-				"failed to register as delegate named '%s', unknown error occured",
-				name);
+		g_fs_delegate_flush(ring);
 	}
 
 	return 0;
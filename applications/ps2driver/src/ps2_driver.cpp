@@ -49,10 +49,8 @@ uint32_t keyboard_receiver_transaction;
  */
 uint64_t packets_count = 0;
 
-g_ps2_shared_area* shared_area;
-
-g_fd keyboard_pipe_w;
-g_fd keyboard_pipe_r;
+g_channel* mouse_channel;
+g_channel* keyboard_channel;
 
 /**
  *
@@ -65,27 +63,14 @@ int main() {
 		return 1;
 	}
 
-	// set up shared memory
-	shared_area = (g_ps2_shared_area*) g_alloc_mem(sizeof(g_ps2_shared_area));
-	if (shared_area == 0) {
-		klog("failed to allocate transfer memory area");
+	// set up input channels
+	mouse_channel = g_create_channel(sizeof(g_ps2_mouse_packet), G_PS2_MOUSE_CHANNEL_CAPACITY);
+	keyboard_channel = g_create_channel(sizeof(uint8_t), G_PS2_KEYBOARD_CHANNEL_CAPACITY);
+	if (mouse_channel == 0 || keyboard_channel == 0) {
+		klog("failed to create input channels");
 		return 1;
 	}
 
-	// set up keyboard pipe
-	g_fs_pipe_status stat = g_pipe_b(&keyboard_pipe_w, &keyboard_pipe_r, false);
-	if (stat != G_FS_PIPE_SUCCESSFUL) {
-		klog("failed to create keyboard pipe (status: %i)", stat);
-		return 1;
-	}
-
-	// initialize memory area
-	shared_area->mouse.lock = false;
-	shared_area->mouse.buffer_empty_lock = true;
-	shared_area->keyboard.buffer_empty_lock = true;
-	shared_area->keyboard.buffer_amount = 0;
-	shared_area->keyboard.buffer_amount_lock = false;
-
 	// initialize mouse
 	initialize_mouse();
 
@@ -104,20 +89,13 @@ int main() {
 			g_ps2_register_request* req =
 					(g_ps2_register_request*) G_MESSAGE_CONTENT(buf);
 
-			// share area with requester
+			// share channels with requester
 			g_pid requester_pid = g_get_pid_for_tid(mes->sender);
-			g_ps2_shared_area* shared_in_target =
-					(g_ps2_shared_area*) g_share_mem((void*) shared_area,
-							sizeof(g_ps2_shared_area), requester_pid);
-
-			// share keyboard pipe with requester
-			g_fd keyboard_pipe_target_read_end = g_clone_fd(keyboard_pipe_r,
-					g_get_pid(), requester_pid);
 
 			// send response
 			g_ps2_register_response response;
-			response.area = shared_in_target;
-			response.keyboard_pipe = keyboard_pipe_target_read_end;
+			response.mouse = g_share_channel(mouse_channel, requester_pid);
+			response.keyboard = g_share_channel(keyboard_channel, requester_pid);
 			g_send_message_t(mes->sender, &response,
 					sizeof(g_ps2_register_response), mes->transaction);
 		}
@@ -209,17 +187,12 @@ void handle_mouse_data(uint8_t b) {
 			int16_t offX = valX - ((flags << 4) & 0x100);
 			int16_t offY = valY - ((flags << 3) & 0x100);
 
-			// wait for handling and set
-			g_atomic_lock(&shared_area->mouse.lock);
-
-			// write data
-			shared_area->mouse.move_x += offX;
-			shared_area->mouse.move_y += offY;
-			shared_area->mouse.flags = flags;
-			shared_area->mouse.buffer_empty_lock = false;
-
-			// show waiter that data is queue
-			shared_area->mouse.lock = false;
+			// pass on, dropped if the receiver is too slow
+			g_ps2_mouse_packet packet;
+			packet.move_x = offX;
+			packet.move_y = offY;
+			packet.flags = flags;
+			g_channel_push(mouse_channel, &packet, false);
 		}
 
 		mouse_packet_number = 0;
@@ -232,15 +205,8 @@ void handle_mouse_data(uint8_t b) {
  */
 void handle_keyboard_data(uint8_t b) {
 
-	// write byte to keyboard pipe
-	g_atomic_lock(&shared_area->keyboard.buffer_amount_lock);
-
-	shared_area->keyboard.buffer_empty_lock = false;
-	g_write(keyboard_pipe_w, &b, 1);
-
-	// increase buffer ocunter
-	shared_area->keyboard.buffer_amount++;
-	shared_area->keyboard.buffer_amount_lock = false;
+	// pass scancode to the receiver, dropped if nobody reads
+	g_channel_push(keyboard_channel, &b, false);
 }
 
 /**
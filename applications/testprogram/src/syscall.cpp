@@ -0,0 +1,78 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "tester.hpp"
+#include <ghost.h>
+
+#define SYSCALL_BENCHMARK_ITERATIONS	100000
+
+static uint64_t readTimestamp()
+{
+	uint32_t low, high;
+	asm volatile("rdtsc" : "=a"(low), "=d"(high));
+	return ((uint64_t) high << 32) | low;
+}
+
+/**
+ * Measures the average number of cycles of a cheap system call.
+ */
+static uint32_t measureSyscall(void (*syscall)(uint32_t, uint32_t))
+{
+	g_syscall_get_tid data;
+
+	uint64_t start = readTimestamp();
+	for(int i = 0; i < SYSCALL_BENCHMARK_ITERATIONS; i++)
+	{
+		syscall(G_SYSCALL_GET_TASK_ID, (uint32_t) &data);
+	}
+	uint64_t end = readTimestamp();
+
+	return (uint32_t) ((end - start) / SYSCALL_BENCHMARK_ITERATIONS);
+}
+
+/**
+ * Compares the interrupt and the SYSENTER system call entry.
+ */
+test_result_t runSyscallBenchmark()
+{
+	g_tid tid = g_get_tid();
+
+	g_syscall_get_tid data;
+	g_syscall_int(G_SYSCALL_GET_TASK_ID, (uint32_t) &data);
+	ASSERT(data.id == tid);
+
+	uint32_t interruptCycles = measureSyscall(g_syscall_int);
+	klog("[Benchmark] int 0x80: %i cycles per call", interruptCycles);
+
+	if(!g_syscall_sysenter_available())
+	{
+		klog("[Benchmark] sysenter: not supported");
+		TEST_SUCCESSFUL;
+	}
+
+	data.id = 0;
+	g_syscall_sysenter(G_SYSCALL_GET_TASK_ID, (uint32_t) &data);
+	ASSERT(data.id == tid);
+
+	uint32_t sysenterCycles = measureSyscall(g_syscall_sysenter);
+	klog("[Benchmark] sysenter: %i cycles per call", sysenterCycles);
+
+	TEST_SUCCESSFUL;
+}
@@ -36,6 +36,7 @@ int main(int argc, char** argv)
 	result += runStdioTest();
 	result += runMessageTest();
 	result += runThreadTests();
+	result += runSyscallBenchmark();
 
 	klog("Test suite finished: %i successful, %i failed", result.successful, result.failed);
 
@@ -25,33 +25,27 @@
 #include <events/event_processor.hpp>
 #include <ghost.h>
 
+/**
+ *
+ */
+command_message_responder_thread_t::command_message_responder_thread_t() {
+	responses = g_create_channel(sizeof(command_message_response_t), 256);
+}
+
 /**
  *
  */
 void command_message_responder_thread_t::run() {
 
-	event_processor_t* eventProcessor = windowserver_t::instance()->event_processor;
+	command_message_response_t response;
 	while (true) {
 
-		// wait until messages are added
-		g_atomic_lock(&buffer_empty);
-		g_atomic_lock(&buffer_lock);
-
-		// process all
-		while (buffer.size() > 0) {
-
-			// get reference to response from the queue
-			command_message_response_t& response = buffer.back();
-			g_send_message_t(response.target, response.message, response.length, response.transaction);
-
-			// delete message buffer
-			delete (g_message_header*) response.message;
-
-			// remove response from queue
-			buffer.pop_back();
-		}
+		// wait until a response is added
+		g_channel_pop(responses, &response, true);
+		g_send_message_t(response.target, response.message, response.length, response.transaction);
 
-		buffer_lock = 0;
+		// delete message buffer
+		delete (g_message_header*) response.message;
 	}
 }
 
@@ -59,9 +53,6 @@ void command_message_responder_thread_t::run() {
  *
  */
 void command_message_responder_thread_t::send_response(command_message_response_t& response) {
-	g_atomic_lock(&buffer_lock);
-	buffer.push_back(response);
-	buffer_empty = false;
-	buffer_lock = 0;
+	g_channel_push(responses, &response, true);
 }
 
@@ -22,7 +22,6 @@
 #define __INTERFACE_COMMAND_MESSAGE_RESPONDER_THREAD__
 
 #include <ghostuser/tasking/thread.hpp>
-#include <deque>
 
 /**
  *
@@ -39,9 +38,13 @@ typedef struct {
  */
 class command_message_responder_thread_t: public g_thread {
 public:
-	std::deque<command_message_response_t> buffer;
-	uint8_t buffer_empty = true;
-	uint8_t buffer_lock = 0;
+	/**
+	 * Responses are only added by the event processor, so a channel with
+	 * a single producer and consumer is sufficient.
+	 */
+	g_channel* responses;
+
+	command_message_responder_thread_t();
 
 	/**
 	 *
@@ -51,6 +51,7 @@ LINKSCRIPT_KERNEL=extra/link-kernel.ld
 #
 RAMDISK=$ISO_SRC/boot/ramdisk
 RAMDISK_WRITER=ramdisk-writer
+RAMDISK_WRITER_FLAGS=-c
 
 #
 # Application processor startup object
@@ -160,7 +161,7 @@ target_link() {
 #
 target_ramdisk() {
 	headline "building ramdisk"
-	$RAMDISK_WRITER "$SYSROOT" "$RAMDISK"
+	$RAMDISK_WRITER "$SYSROOT" "$RAMDISK" $RAMDISK_WRITER_FLAGS
 	failOnError
 }
 
@@ -57,6 +57,10 @@ __BEGIN_C
 #define G_SYSCALL_GET_PARENT_PROCESS_ID			25
 #define G_SYSCALL_TASK_GET_TLS                  27
 #define G_SYSCALL_PROCESS_GET_INFO              28
+#define G_SYSCALL_RING_SUBMIT					29
+#define G_SYSCALL_RING_DRAIN					30
+#define G_SYSCALL_FUTEX_WAIT					31
+#define G_SYSCALL_FUTEX_WAKE					32
 
 #define G_SYSCALL_CALL_VM86						50
 #define G_SYSCALL_LOWER_MEMORY_ALLOCATE			51
@@ -75,6 +79,8 @@ __BEGIN_C
 #define G_SYSCALL_GET_TASK_FOR_IDENTIFIER		91
 #define G_SYSCALL_MESSAGE_SEND					92
 #define G_SYSCALL_MESSAGE_RECEIVE				93
+#define G_SYSCALL_CHANNEL_WAIT					94
+#define G_SYSCALL_CHANNEL_WAKE					95
 
 #define G_SYSCALL_GET_MILLISECONDS				100
 
@@ -92,9 +98,12 @@ __BEGIN_C
 #define G_SYSCALL_FS_REGISTER_AS_DELEGATE		131
 #define G_SYSCALL_FS_SET_TRANSACTION_STATUS		132
 #define G_SYSCALL_FS_CREATE_NODE				133
-#define G_SYSCALL_FS_OPEN_DIRECTORY				134
-#define G_SYSCALL_FS_READ_DIRECTORY				135
-#define G_SYSCALL_FS_CLOSE_DIRECTORY			136
+#define G_SYSCALL_FS_PIPE_CAPACITY				137
+#define G_SYSCALL_FS_SPLICE						138
+#define G_SYSCALL_FS_TEE						139
+#define G_SYSCALL_FS_READV						140
+#define G_SYSCALL_FS_WRITEV						141
+#define G_SYSCALL_FS_LIST_DIRECTORY				142
 
 #define G_SYSCALL_MAX							150
 
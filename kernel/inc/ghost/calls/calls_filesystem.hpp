@@ -100,6 +100,78 @@ typedef struct {
 	int64_t result;
 }__attribute__((packed)) g_syscall_fs_write;
 
+/**
+ * @field fd
+ * 		file descriptor
+ *
+ * @field vectors
+ * 		buffers that are filled in order
+ *
+ * @field count
+ * 		number of buffers, at most {G_FS_IOV_MAX}
+ *
+ * @field positional
+ * 		whether to read at the offset instead of the descriptor offset,
+ * 		which is then left unchanged
+ *
+ * @field offset
+ * 		offset to read at if positional
+ *
+ * @field status
+ * 		one of the {g_fs_read_status} codes
+ *
+ * @field result
+ * 		number of bytes read
+ *
+ * @security-level APPLICATION
+ */
+typedef struct {
+	g_fd fd;
+	g_fs_iovec* vectors;
+	uint32_t count;
+	g_bool positional;
+	int64_t offset;
+
+	g_fs_read_status status;
+	int64_t result;
+}__attribute__((packed)) g_syscall_fs_readv;
+
+/**
+ * @field fd
+ * 		file descriptor
+ *
+ * @field vectors
+ * 		buffers that are written in order
+ *
+ * @field count
+ * 		number of buffers, at most {G_FS_IOV_MAX}
+ *
+ * @field positional
+ * 		whether to write at the offset instead of the descriptor offset,
+ * 		which is then left unchanged
+ *
+ * @field offset
+ * 		offset to write at if positional
+ *
+ * @field status
+ * 		one of the {g_fs_write_status} codes
+ *
+ * @field result
+ * 		number of bytes written
+ *
+ * @security-level APPLICATION
+ */
+typedef struct {
+	g_fd fd;
+	g_fs_iovec* vectors;
+	uint32_t count;
+	g_bool positional;
+	int64_t offset;
+
+	g_fs_write_status status;
+	int64_t result;
+}__attribute__((packed)) g_syscall_fs_writev;
+
 /**
  * @field fd
  * 		file descriptor
@@ -122,8 +194,11 @@ typedef struct {
  * @field follow_symlinks
  * 		whether to follow symbolic links
  *
+ * @field stats
+ * 		filled with the attributes of the node
+ *
  * @field result
- * 		the call result
+ * 		one of the {g_fs_stat_status} codes
  *
  * @security-level APPLICATION
  */
@@ -132,18 +207,18 @@ typedef struct {
 	uint8_t follow_symlinks;
 
 	g_fs_stat_attributes stats;
-	int32_t result;
+	g_fs_stat_status result;
 }__attribute__((packed)) g_syscall_fs_stat;
 
 /**
  * @field fd
  * 		file descriptor
  *
- * @field follow_symlinks
- * 		whether to follow symbolic links
+ * @field stats
+ * 		filled with the attributes of the node
  *
  * @field result
- * 		the call result
+ * 		one of the {g_fs_stat_status} codes
  *
  * @security-level APPLICATION
  */
@@ -151,7 +226,7 @@ typedef struct {
 	g_fd fd;
 
 	g_fs_stat_attributes stats;
-	int32_t result;
+	g_fs_stat_status result;
 }__attribute__((packed)) g_syscall_fs_fstat;
 
 /**
@@ -204,6 +279,58 @@ typedef struct {
 	g_bool blocking;
 }__attribute__((packed)) g_syscall_fs_pipe;
 
+/**
+ * @field fd
+ * 		file descriptor of either end of the pipe
+ *
+ * @field set
+ * 		whether to set the maximum capacity
+ *
+ * @field capacity
+ * 		the maximum capacity to set, is filled with the maximum capacity
+ *
+ * @field status
+ * 		the call status
+ *
+ * @security-level APPLICATION
+ */
+typedef struct {
+	g_fd fd;
+	g_bool set;
+	uint32_t capacity;
+	g_fs_pipe_capacity_status status;
+}__attribute__((packed)) g_syscall_fs_pipe_capacity;
+
+/**
+ * Used for both splice and tee. For splice, one of the descriptors must refer to a
+ * pipe and the data is moved. For tee, both must refer to pipes and the data in the
+ * input pipe stays there.
+ *
+ * @field in
+ * 		descriptor to read from
+ *
+ * @field out
+ * 		descriptor to write to
+ *
+ * @field length
+ * 		maximum number of bytes to transfer
+ *
+ * @field result
+ * 		the number of bytes transferred
+ *
+ * @field status
+ * 		the call status
+ *
+ * @security-level APPLICATION
+ */
+typedef struct {
+	g_fd in;
+	g_fd out;
+	uint64_t length;
+	int64_t result;
+	g_fs_splice_status status;
+}__attribute__((packed)) g_syscall_fs_splice;
+
 /**
  * @field mode
  * 		the mode flags
@@ -339,7 +466,7 @@ typedef struct {
  * 		contains the mountpoint id on success
  *
  * @field transaction_storage
- * 		contains the transaction storage address on success
+ * 		contains the address of the {g_fs_tasked_delegate_ring} on success
  *
  * @security-level DRIVER
  */
@@ -395,47 +522,30 @@ typedef struct {
 }__attribute__((packed)) g_syscall_fs_create_node;
 
 /**
- * @field path
- * 		buffer containing the folders path
- *
- * @field iterator
- * 		pointer to an allocated iterator
+ * @field fd
+ * 		descriptor of the opened directory, its offset is the index of the next entry
  *
- * @field status
- * 		one of the {g_fs_open_directory_status} codes
+ * @field buffer
+ * 		buffer to fill with {g_fs_directory_record} entries
  *
- * @security-level APPLICATION
- */
-typedef struct {
-	char* path;
-	g_fs_directory_iterator* iterator;
-
-	g_fs_open_directory_status status;
-}__attribute__((packed)) g_syscall_fs_open_directory;
-
-/**
- * @field iterator
- * 		pointer to the iterator
+ * @field length
+ * 		length of the buffer
  *
  * @field status
- * 		one of the {g_fs_directory_refresh_status} codes
+ * 		one of the {g_fs_read_directory_status} codes
  *
- * @security-level APPLICATION
- */
-typedef struct {
-	g_fs_directory_iterator* iterator;
-
-	g_fs_directory_refresh_status status;
-}__attribute__((packed)) g_syscall_fs_read_directory;
-
-/**
- * @field iterator
- * 		pointer to the iterator
+ * @field result
+ * 		number of bytes written to the buffer
  *
  * @security-level APPLICATION
  */
 typedef struct {
-	g_fs_directory_iterator* iterator;
-}__attribute__((packed)) g_syscall_fs_close_directory;
+	g_fd fd;
+	uint8_t* buffer;
+	uint32_t length;
+
+	g_fs_read_directory_status status;
+	int32_t result;
+}__attribute__((packed)) g_syscall_fs_list_directory;
 
 #endif
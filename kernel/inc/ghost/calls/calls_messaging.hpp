@@ -36,6 +36,15 @@
  * @field mode
  * 		sending mode
  *
+ * @field transfer
+ * 		page-aligned area that is passed without copying, or null
+ *
+ * @field transferLength
+ * 		length of the transferred area
+ *
+ * @field transferMode
+ * 		whether the area is moved or shared
+ *
  * @field status
  * 		one of the {g_message_send_status} codes
  *
@@ -47,6 +56,9 @@ typedef struct {
 	size_t length;
 	g_message_send_mode mode;
 	g_message_transaction transaction;
+	void* transfer;
+	size_t transferLength;
+	g_message_transfer_mode transferMode;
 
 	g_message_send_status status;
 }__attribute__((packed)) g_syscall_send_message;
@@ -71,6 +83,12 @@ typedef struct {
  * 		when giving, the receiving will wait no more
  * 		once the condition is true
  *
+ * @field has_timeout
+ * 		whether the blocking receive should time out
+ *
+ * @field timeout
+ * 		timeout in milliseconds
+ *
  * @security-level APPLICATION
  */
 typedef struct {
@@ -79,8 +97,47 @@ typedef struct {
 	g_message_receive_mode mode;
 	g_message_transaction transaction;
 	uint8_t* break_condition;
+	g_bool has_timeout;
+	uint64_t timeout;
 
 	g_message_receive_status status;
 }__attribute__((packed)) g_syscall_receive_message;
 
+/**
+ * @field address
+ * 		word in a channel to wait on
+ *
+ * @field expected
+ * 		the task only blocks while the word has this value
+ *
+ * @field has_timeout
+ * 		whether the wait should time out
+ *
+ * @field timeout
+ * 		timeout in milliseconds
+ *
+ * @field status
+ * 		one of the {g_channel_wait_status} codes
+ *
+ * @security-level APPLICATION
+ */
+typedef struct {
+	volatile uint32_t* address;
+	uint32_t expected;
+	g_bool has_timeout;
+	uint64_t timeout;
+
+	g_channel_wait_status status;
+}__attribute__((packed)) g_syscall_channel_wait;
+
+/**
+ * @field address
+ * 		word in a channel that changed
+ *
+ * @security-level APPLICATION
+ */
+typedef struct {
+	volatile uint32_t* address;
+}__attribute__((packed)) g_syscall_channel_wake;
+
 #endif
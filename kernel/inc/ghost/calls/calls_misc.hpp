@@ -22,6 +22,7 @@
 #define GHOST_API_CALLS_MISCCALLS
 
 #include "ghost/kernquery.h"
+#include "ghost/syscall_ring.h"
 
 /**
  * @field message
@@ -68,4 +69,38 @@ typedef struct {
 	g_kernquery_status status;
 }__attribute__((packed)) g_syscall_kernquery;
 
+/**
+ * @field ring
+ * 		the ring to execute the submitted entries of
+ *
+ * @field executed
+ * 		number of entries that were executed
+ *
+ * @field status
+ * 		one of the {g_syscall_ring_status} codes
+ */
+typedef struct {
+	g_syscall_ring* ring;
+
+	uint32_t executed;
+	g_syscall_ring_status status;
+}__attribute__((packed)) g_syscall_ring_submit;
+
+/**
+ * @field ring
+ * 		the ring to drain
+ *
+ * @field worker
+ * 		id of the kernel worker that drains the ring
+ *
+ * @field status
+ * 		one of the {g_syscall_ring_status} codes
+ */
+typedef struct {
+	g_syscall_ring* ring;
+
+	g_tid worker;
+	g_syscall_ring_status status;
+}__attribute__((packed)) g_syscall_ring_drain;
+
 #endif
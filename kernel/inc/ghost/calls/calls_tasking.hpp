@@ -119,6 +119,52 @@ typedef struct {
 	uint8_t timed_out :1;
 }__attribute__((packed)) g_syscall_atomic_lock;
 
+/**
+ * @field address
+ * 		the futex word, must be aligned to four bytes
+ *
+ * @field expected
+ * 		the task only blocks while the word has this value
+ *
+ * @field has_timeout
+ * 		whether the wait should time out
+ *
+ * @field timeout
+ * 		timeout in milliseconds
+ *
+ * @field status
+ * 		one of the {g_futex_wait_status} codes
+ *
+ * @security-level APPLICATION
+ */
+typedef struct {
+	volatile uint32_t* address;
+	uint32_t expected;
+	g_bool has_timeout;
+	uint64_t timeout;
+
+	g_futex_wait_status status;
+}__attribute__((packed)) g_syscall_futex_wait;
+
+/**
+ * @field address
+ * 		the futex word
+ *
+ * @field count
+ * 		maximum number of tasks to wake
+ *
+ * @field woken
+ * 		number of tasks that were woken
+ *
+ * @security-level APPLICATION
+ */
+typedef struct {
+	volatile uint32_t* address;
+	uint32_t count;
+
+	uint32_t woken;
+}__attribute__((packed)) g_syscall_futex_wake;
+
 /**
  * @field identifier
  * 		the identifier
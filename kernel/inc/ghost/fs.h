@@ -41,6 +41,16 @@ typedef uint64_t g_fs_phys_id; // a physical filesystem node identifier
  */
 #define G_PATH_MAX		4096
 #define G_FILENAME_MAX	512
+#define G_FS_IOV_MAX	1024
+
+/**
+ * A buffer in the scatter list of a vectored read or write, same layout as
+ * the iovec structure of the C library.
+ */
+typedef struct {
+	void* base;
+	uint32_t length;
+}__attribute__((packed)) g_fs_iovec;
 
 /**
  * File mode flags
@@ -81,9 +91,21 @@ typedef int g_fs_node_type;
  * Stat attributes
  */
 typedef struct {
-	uint32_t mode;
+	g_fs_virt_id node_id;
+	g_fs_node_type type;
+	uint64_t length;
 }__attribute__((packed)) g_fs_stat_attributes;
 
+/**
+ * Status codes for the {g_fs_stat} and {g_fs_fstat} system calls
+ */
+typedef int g_fs_stat_status;
+#define G_FS_STAT_SUCCESSFUL ((g_fs_stat_status) 0)
+#define G_FS_STAT_NOT_FOUND ((g_fs_stat_status) 1)
+#define G_FS_STAT_INVALID_FD ((g_fs_stat_status) 2)
+#define G_FS_STAT_ERROR ((g_fs_stat_status) 3)
+#define G_FS_STAT_BUSY ((g_fs_stat_status) 4)
+
 /**
  * Create delegate status
  */
@@ -134,6 +156,8 @@ typedef int g_fs_tasked_delegate_request_type;
 #define G_FS_TASKED_DELEGATE_REQUEST_TYPE_READ_DIRECTORY ((g_fs_tasked_delegate_request_type) 4)
 #define G_FS_TASKED_DELEGATE_REQUEST_TYPE_OPEN ((g_fs_tasked_delegate_request_type) 5)
 #define G_FS_TASKED_DELEGATE_REQUEST_TYPE_CLOSE ((g_fs_tasked_delegate_request_type) 6)
+#define G_FS_TASKED_DELEGATE_REQUEST_TYPE_CREATE ((g_fs_tasked_delegate_request_type) 7)
+#define G_FS_TASKED_DELEGATE_REQUEST_TYPE_TRUNCATE ((g_fs_tasked_delegate_request_type) 8)
 
 /**
  * Status codes for the {g_fs_open} system call
@@ -212,6 +236,26 @@ typedef int g_fs_pipe_status;
 #define G_FS_PIPE_SUCCESSFUL ((g_fs_pipe_status) 0)
 #define G_FS_PIPE_ERROR ((g_fs_pipe_status) 1)
 
+/**
+ * Status codes for the {g_pipe_get_capacity} and {g_pipe_set_capacity} system calls
+ */
+typedef int g_fs_pipe_capacity_status;
+#define G_FS_PIPE_CAPACITY_SUCCESSFUL ((g_fs_pipe_capacity_status) 0)
+#define G_FS_PIPE_CAPACITY_INVALID_FD ((g_fs_pipe_capacity_status) 1)
+#define G_FS_PIPE_CAPACITY_NOT_A_PIPE ((g_fs_pipe_capacity_status) 2)
+#define G_FS_PIPE_CAPACITY_BUSY ((g_fs_pipe_capacity_status) 3)
+#define G_FS_PIPE_CAPACITY_ERROR ((g_fs_pipe_capacity_status) 4)
+
+/**
+ * Status codes for the {g_splice} and {g_tee} system calls
+ */
+typedef int g_fs_splice_status;
+#define G_FS_SPLICE_SUCCESSFUL ((g_fs_splice_status) 0)
+#define G_FS_SPLICE_INVALID_FD ((g_fs_splice_status) 1)
+#define G_FS_SPLICE_NOT_A_PIPE ((g_fs_splice_status) 2)
+#define G_FS_SPLICE_BUSY ((g_fs_splice_status) 3)
+#define G_FS_SPLICE_ERROR ((g_fs_splice_status) 4)
+
 /**
  * Status codes for the {g_set_working_directory} system call
  */
@@ -241,6 +285,8 @@ typedef int g_fs_read_directory_status;
 #define G_FS_READ_DIRECTORY_SUCCESSFUL ((g_fs_read_directory_status) 0)
 #define G_FS_READ_DIRECTORY_EOD ((g_fs_read_directory_status) 1)
 #define G_FS_READ_DIRECTORY_ERROR ((g_fs_read_directory_status) 2)
+#define G_FS_READ_DIRECTORY_INVALID_FD ((g_fs_read_directory_status) 3)
+#define G_FS_READ_DIRECTORY_BUFFER_TOO_SMALL ((g_fs_read_directory_status) 4)
 
 typedef int g_fs_directory_refresh_status;
 #define G_FS_DIRECTORY_REFRESH_SUCCESSFUL ((g_fs_directory_refresh_status) 0)
@@ -250,75 +296,111 @@ typedef int g_fs_directory_refresh_status;
 typedef struct {
 	g_fs_virt_id node_id;
 	g_fs_node_type type;
+	uint64_t length;
 	char* name;
 } g_fs_directory_entry;
 
+/**
+ * Record written by the {g_list_directory} system call. The null-terminated name
+ * follows the record, the next record starts "record_length" bytes after this one.
+ */
+typedef struct {
+	uint32_t record_length;
+	g_fs_virt_id node_id;
+	g_fs_node_type type;
+	uint64_t length;
+	char name[];
+}__attribute__((packed)) g_fs_directory_record;
+
+#define G_FS_DIRECTORY_RECORD_ALIGNMENT		4
+
+/**
+ * Size of the buffer that a directory iterator reads records into.
+ */
+#define G_FS_DIRECTORY_ITERATOR_BUFFER_SIZE	0x1000
+
 typedef struct {
 	g_fs_virt_id node_id;
 	int position;
 	g_fs_directory_entry entry_buffer;
+
+	g_fd fd;
+	uint8_t* buffer;
+	uint32_t buffered;
+	uint32_t buffer_position;
 } g_fs_directory_iterator;
 
 /**
- * Transaction storage structures (NOTE limited to 1 page!)
+ * Number of requests that can be in flight on the mount of a tasked delegate, and
+ * the size of the transfer buffer that belongs to each of them.
  */
-typedef struct {
-	g_fs_phys_id parent_phys_fs_id;
-	char name[G_FILENAME_MAX];
-
-	g_fs_discovery_status result_status;
-} g_fs_tasked_delegate_transaction_storage_discovery;
+#define G_FS_TASKED_DELEGATE_SLOTS				16
+#define G_FS_TASKED_DELEGATE_TRANSFER_SIZE		0x4000
 
+/**
+ * A request to a tasked delegate. The transaction id of a request is the mountpoint
+ * id in the upper and the slot in the lower half.
+ *
+ * For discover and create, the transfer buffer contains the null-terminated name.
+ * For read and write, it takes the payload of at most {G_FS_TASKED_DELEGATE_TRANSFER_SIZE}
+ * bytes. For read directory, the delegate fills it with directory records of the
+ * children starting at the index "offset", sets "result" to their number and
+ * is asked again until it reports none.
+ */
 typedef struct {
-	g_fs_phys_id phys_fs_id;
-	void* mapped_buffer;
-	int64_t offset;
-	int64_t length;
-	g_virtual_address mapping_start;
-	int32_t mapping_pages;
+	g_fs_transaction_id transaction;
+	g_fs_tasked_delegate_request_type type;
 
-	int64_t result_read;
-	g_fs_read_status result_status;
-} g_fs_tasked_delegate_transaction_storage_read;
-
-typedef struct {
-	g_fs_phys_id phys_fs_id;
-	void* mapped_buffer;
+	g_fs_phys_id phys_fs_id; // the node, or the parent for discover and create
+	g_fs_virt_id virt_fs_id;
 	int64_t offset;
 	int64_t length;
-	g_virtual_address mapping_start;
-	int32_t mapping_pages;
 
-	int64_t result_write;
-	g_fs_read_status result_status;
-} g_fs_tasked_delegate_transaction_storage_write;
-
-typedef struct {
-	g_fs_phys_id phys_fs_id;
-
-	int64_t result_length;
-	g_fs_read_status result_status;
-} g_fs_tasked_delegate_transaction_storage_get_length;
-
-typedef struct {
-	g_fs_phys_id parent_phys_fs_id;
-	g_fs_phys_id parent_virt_fs_id;
-
-	g_fs_directory_refresh_status result_status;
-} g_fs_tasked_delegate_transaction_storage_directory_refresh;
+	volatile g_fs_transaction_status transaction_status;
+	int32_t result_status; // status code of the respective operation
+	int64_t result;
+	g_fs_phys_id result_phys_fs_id;
+	g_fs_node_type result_type;
+} g_fs_tasked_delegate_request;
 
+/**
+ * Record of a child that a tasked delegate writes for a read directory request.
+ * The null-terminated name follows the record.
+ */
 typedef struct {
+	uint32_t record_length;
 	g_fs_phys_id phys_fs_id;
-	char name[G_FILENAME_MAX];
-
-	g_fs_open_status result_status;
-} g_fs_tasked_delegate_transaction_storage_open;
+	g_fs_node_type type;
+	char name[];
+}__attribute__((packed)) g_fs_tasked_delegate_directory_record;
 
+/**
+ * Memory shared between the kernel and a tasked delegate, the address is returned
+ * when registering as a delegate. The kernel adds the slots of new requests to the
+ * queue and increments "head", the delegate takes them by incrementing "tail". When
+ * a request is done, the delegate sets its transaction status and increments
+ * "completed". Both sides wait on these words with the channel wait call and only
+ * need to wake the other side if it announced that it is waiting.
+ *
+ * The transfer buffers follow on the next page.
+ */
 typedef struct {
-	g_fs_phys_id phys_fs_id;
-
-	g_fs_close_status result_status;
-} g_fs_tasked_delegate_transaction_storage_close;
+	volatile uint32_t head;
+	volatile uint32_t delegate_waiting;
+	uint8_t padding0[56];
+
+	volatile uint32_t tail;
+	volatile uint32_t completed;
+	volatile uint32_t kernel_waiting;
+	uint8_t padding1[52];
+
+	uint32_t queue[G_FS_TASKED_DELEGATE_SLOTS];
+	g_fs_tasked_delegate_request requests[G_FS_TASKED_DELEGATE_SLOTS];
+} g_fs_tasked_delegate_ring;
+
+#define G_FS_TASKED_DELEGATE_TRANSFER_OFFSET	0x1000
+#define G_FS_TASKED_DELEGATE_SHARED_SIZE		(G_FS_TASKED_DELEGATE_TRANSFER_OFFSET + G_FS_TASKED_DELEGATE_SLOTS * G_FS_TASKED_DELEGATE_TRANSFER_SIZE)
+#define G_FS_TASKED_DELEGATE_TRANSFER(ring, slot)	(((uint8_t*) (ring)) + G_FS_TASKED_DELEGATE_TRANSFER_OFFSET + (slot) * G_FS_TASKED_DELEGATE_TRANSFER_SIZE)
 
 __END_C
 
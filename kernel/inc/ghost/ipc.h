@@ -37,6 +37,8 @@ typedef struct _g_message_header {
 	g_tid sender;
 	g_message_transaction transaction;
 	size_t length;
+	void* transfer; // pages transferred with the message, mapped in the receiver
+	size_t transferLength;
 	struct _g_message_header* previous;
 	struct _g_message_header* next;
 }__attribute__((packed)) g_message_header;
@@ -46,6 +48,12 @@ typedef struct _g_message_header {
 // messaging bounds
 #define G_MESSAGE_MAXIMUM_LENGTH			(2048)
 #define G_MESSAGE_MAXIMUM_QUEUE_CONTENT		(2048 * 32)
+#define G_MESSAGE_MAXIMUM_TRANSFER_LENGTH	(0x1000000)
+
+// modes for transferring pages with a message
+typedef int g_message_transfer_mode;
+#define G_MESSAGE_TRANSFER_MODE_MOVE ((g_message_transfer_mode) 0)
+#define G_MESSAGE_TRANSFER_MODE_SHARE ((g_message_transfer_mode) 1)
 
 // modes for message sending
 typedef int g_message_send_mode;
@@ -57,6 +65,38 @@ typedef int g_message_receive_mode;
 #define G_MESSAGE_RECEIVE_MODE_BLOCKING ((g_message_receive_mode) 0)
 #define G_MESSAGE_RECEIVE_MODE_NON_BLOCKING ((g_message_receive_mode) 1)
 
+/**
+ * Single-producer/single-consumer ring of fixed-size records that lives in memory
+ * shared between the two sides. Producer and consumer only use atomic operations on
+ * the indices; a side only enters the kernel when the ring is full or empty and it
+ * needs to block, or when it has to wake the other side that announced to be waiting.
+ *
+ * The indices count records since creation and are masked with (capacity - 1), the
+ * capacity is a power of two. Each side writes to its own cache line.
+ */
+typedef struct {
+	uint32_t recordSize;
+	uint32_t capacity;
+	uint8_t padding0[56];
+
+	volatile uint32_t head; // written by the producer
+	volatile uint32_t producerWaiting;
+	uint8_t padding1[56];
+
+	volatile uint32_t tail; // written by the consumer
+	volatile uint32_t consumerWaiting;
+	uint8_t padding2[56];
+} g_channel;
+
+#define G_CHANNEL_RECORDS(channel)			(((uint8_t*) channel) + sizeof(g_channel))
+
+// status for waiting on a channel
+typedef int g_channel_wait_status;
+#define G_CHANNEL_WAIT_STATUS_WOKEN ((g_channel_wait_status) 0)
+#define G_CHANNEL_WAIT_STATUS_CHANGED ((g_channel_wait_status) 1)
+#define G_CHANNEL_WAIT_STATUS_TIMED_OUT ((g_channel_wait_status) 2)
+#define G_CHANNEL_WAIT_STATUS_INVALID ((g_channel_wait_status) 3)
+
 // status for message sending
 typedef int g_message_send_status;
 #define G_MESSAGE_SEND_STATUS_SUCCESSFUL ((g_message_send_status) 1)
@@ -72,6 +112,7 @@ typedef int g_message_receive_status;
 #define G_MESSAGE_RECEIVE_STATUS_FAILED_NOT_PERMITTED ((g_message_receive_status) 4)
 #define G_MESSAGE_RECEIVE_STATUS_EXCEEDS_BUFFER_SIZE ((g_message_receive_status) 5)
 #define G_MESSAGE_RECEIVE_STATUS_INTERRUPTED ((g_message_receive_status) 6)
+#define G_MESSAGE_RECEIVE_STATUS_TIMED_OUT ((g_message_receive_status) 7)
 
 __END_C
 
@@ -106,9 +106,21 @@ typedef uint8_t g_thread_status;
 #define G_THREAD_STATUS_UNUSED ((g_thread_status) 3)
 
 /**
- * Pipes
+ * Futex wait results
  */
-#define G_PIPE_DEFAULT_CAPACITY		0x400
+typedef int g_futex_wait_status;
+#define G_FUTEX_WAIT_STATUS_WOKEN ((g_futex_wait_status) 0)
+#define G_FUTEX_WAIT_STATUS_CHANGED ((g_futex_wait_status) 1)
+#define G_FUTEX_WAIT_STATUS_TIMED_OUT ((g_futex_wait_status) 2)
+#define G_FUTEX_WAIT_STATUS_INVALID ((g_futex_wait_status) 3)
+
+/**
+ * Pipes start with the default capacity and grow with demand up to their maximum
+ * capacity, which can be changed per pipe up to the upper limit.
+ */
+#define G_PIPE_DEFAULT_CAPACITY				0x400
+#define G_PIPE_DEFAULT_MAXIMUM_CAPACITY		0x10000
+#define G_PIPE_MAXIMUM_CAPACITY				0x100000
 
 /**
  * Process information section header
@@ -44,6 +44,11 @@ typedef int g_kernquery_status;
 #define G_KERNQUERY_TASK_LIST			0x601
 #define G_KERNQUERY_TASK_GET_BY_ID		0x602
 
+#define G_KERNQUERY_PROCESSOR_COUNT		0x700
+#define G_KERNQUERY_PROCESSOR_GET		0x701
+
+#define G_KERNQUERY_HEAP_GET			0x800
+
 /**
  * PCI
  */
@@ -104,6 +109,57 @@ typedef struct {
 	g_virtual_address memory_used;
 }__attribute__((packed)) g_kernquery_task_get_data;
 
+/**
+ * Used in the {G_KERNQUERY_PROCESSOR_COUNT} query to retrieve the number
+ * of processors.
+ */
+typedef struct {
+	uint32_t count;
+}__attribute__((packed)) g_kernquery_processor_count_data;
+
+/**
+ * Used in the {G_KERNQUERY_PROCESSOR_GET} query to retrieve the scheduling
+ * state of the processor at the given position.
+ */
+typedef struct {
+	uint32_t position;
+	uint8_t found;
+
+	uint32_t task_count;
+	uint32_t runnable_count;
+	uint32_t waiting_count;
+	g_tid current;
+}__attribute__((packed)) g_kernquery_processor_get_data;
+
+/**
+ * Usage of a single slab size class of the kernel heap.
+ */
+typedef struct {
+	uint32_t object_size;
+	uint32_t allocated;
+	uint32_t capacity;
+}__attribute__((packed)) g_kernquery_heap_size_class;
+
+#define G_KERNQUERY_HEAP_MAX_SIZE_CLASSES	8
+
+/**
+ * Used in the {G_KERNQUERY_HEAP_GET} query to retrieve usage and
+ * fragmentation statistics of the kernel heap. Small objects are served
+ * from slabs of fixed size classes, larger ones from the chunk area.
+ */
+typedef struct {
+	uint32_t chunk_used;
+	uint32_t chunk_reserved;
+	uint32_t chunk_free_count;
+	uint32_t chunk_largest_free;
+
+	uint32_t slab_pages;
+	uint32_t slab_empty_pages;
+
+	uint32_t size_class_count;
+	g_kernquery_heap_size_class size_classes[G_KERNQUERY_HEAP_MAX_SIZE_CLASSES];
+}__attribute__((packed)) g_kernquery_heap_get_data;
+
 __END_C
 
 #endif
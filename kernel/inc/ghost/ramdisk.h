@@ -38,6 +38,61 @@ typedef int g_ramdisk_entry_type;
 
 typedef uint32_t g_ramdisk_id;
 
+/**
+ * Version 2 ramdisk images start with this header. Images of the first version
+ * have no header, they are a sequence of entries that each start with the type.
+ *
+ * The entry table is indexed by the id, the root has id 0. A folder refers to a
+ * range of the child table, which holds the ids of its children sorted by name.
+ * Names are null-terminated strings in the string table. All offsets are relative
+ * to the start of the image.
+ */
+#define G_RAMDISK_V2_MAGIC		0x32445247 // "GRD2"
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t entryTableOffset;
+	uint32_t childTableOffset;
+	uint32_t childCount;
+	uint32_t stringTableOffset;
+	uint32_t stringTableSize;
+}__attribute__((packed)) g_ramdisk_v2_header;
+
+/**
+ * Entries of this type in the image are files with compressed contents.
+ */
+#define G_RAMDISK_V2_ENTRY_TYPE_COMPRESSED_FILE		2
+
+/**
+ * Compressed files are split into blocks of this size, the last one may be shorter.
+ * Each block is compressed on its own so that it can be decompressed when used.
+ *
+ * A block is a sequence of LZ4-style sequences: a token with the literal length in
+ * the high and the match length minus 4 in the low nibble (15 continues with bytes
+ * that are added until one is not 255), the literals, and a 16 bit little-endian
+ * distance back into the block. The last sequence only has literals. A block whose
+ * compressed size equals its size is stored as it is.
+ */
+#define G_RAMDISK_V2_BLOCK_SIZE		0x4000
+
+/**
+ * For files, data is the offset of the content and size its length. For folders,
+ * data is the index of the first child in the child table and size the number of
+ * children.
+ *
+ * For compressed files, size is the decompressed length and data the offset of a
+ * table with one offset per block plus one for the end of the last block.
+ */
+typedef struct {
+	uint32_t type;
+	g_ramdisk_id parentId;
+	uint32_t nameOffset;
+	uint32_t data;
+	uint32_t size;
+}__attribute__((packed)) g_ramdisk_v2_entry;
+
 /**
  * Ramdisk entry information struct used within system calls
  */
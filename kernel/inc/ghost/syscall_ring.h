@@ -0,0 +1,105 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __GHOST_SYSCALL_RING__
+#define __GHOST_SYSCALL_RING__
+
+#include "ghost/common.h"
+#include "ghost/stdint.h"
+
+__BEGIN_C
+
+/**
+ * Status of an entry in a system call ring
+ */
+typedef int g_syscall_ring_entry_status;
+#define G_SYSCALL_RING_ENTRY_PENDING		((g_syscall_ring_entry_status) 0)
+#define G_SYSCALL_RING_ENTRY_DONE			((g_syscall_ring_entry_status) 1)
+#define G_SYSCALL_RING_ENTRY_UNSUPPORTED	((g_syscall_ring_entry_status) 2)
+#define G_SYSCALL_RING_ENTRY_INVALID		((g_syscall_ring_entry_status) 3)
+
+/**
+ * Status of a ring submission or drain request
+ */
+typedef int g_syscall_ring_status;
+#define G_SYSCALL_RING_STATUS_SUCCESSFUL	((g_syscall_ring_status) 0)
+#define G_SYSCALL_RING_STATUS_INVALID		((g_syscall_ring_status) 1)
+
+/**
+ * Maximum number of entries in a ring.
+ */
+#define G_SYSCALL_RING_MAXIMUM_SIZE			4096
+
+/**
+ * A system call to execute from a ring.
+ *
+ * @field call
+ * 		id of the system call
+ *
+ * @field data
+ * 		the data to pass, usually a pointer to the call struct
+ *
+ * @field status
+ * 		one of the {g_syscall_ring_entry_status} codes, set by the kernel
+ */
+typedef struct {
+	uint32_t call;
+	uint32_t data;
+	volatile g_syscall_ring_entry_status status;
+}__attribute__((packed)) g_syscall_ring_entry;
+
+/**
+ * Ring of system calls that is shared between a process and the kernel. The entries
+ * follow the header directly, which must be word-aligned and may not cross a page
+ * boundary. Both counters run freely, the slot of an entry is its counter value modulo
+ * the size.
+ *
+ * @field size
+ * 		number of entries, must be a power of two; the kernel reads it once when the
+ * 		ring is submitted or drained and only uses that value, a worker stops draining
+ * 		the ring if it is changed
+ *
+ * @field submitted
+ * 		number of entries that were added, only written by the process
+ *
+ * @field completed
+ * 		number of entries that were executed, only written by the kernel
+ *
+ * @field draining
+ * 		set while a kernel worker drains the ring, the process clears it to stop the worker
+ *
+ * @field worker_waiting
+ * 		set by the kernel worker before it sleeps, the process must then wake it on the
+ * 		submitted counter after adding entries
+ */
+typedef struct {
+	uint32_t size;
+	volatile uint32_t submitted;
+	volatile uint32_t completed;
+	volatile uint32_t draining;
+	volatile uint32_t worker_waiting;
+} g_syscall_ring;
+
+#define G_SYSCALL_RING_ENTRIES(ring)		((g_syscall_ring_entry*) (((uint8_t*) (ring)) + sizeof(g_syscall_ring)))
+#define G_SYSCALL_RING_ENTRY(ring, index)	(&G_SYSCALL_RING_ENTRIES(ring)[(index) & ((ring)->size - 1)])
+
+__END_C
+
+#endif
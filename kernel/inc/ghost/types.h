@@ -45,6 +45,7 @@ typedef uint32_t g_far_pointer;
 
 // type used for atomic locks
 typedef uint8_t g_atom;
+typedef volatile uint32_t g_user_mutex;
 typedef uint8_t g_bool;
 
 __END_C
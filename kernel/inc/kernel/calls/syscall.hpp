@@ -35,6 +35,12 @@ struct g_syscall_registration
 {
 	g_syscall_handler handler;
 	bool threaded;
+
+	/**
+	 * Whether the handler may be called from a worker on behalf of the task, which is
+	 * required to execute the call from a system call ring. True for threaded calls.
+	 */
+	bool batchable;
 };
 
 /**
@@ -42,20 +48,27 @@ struct g_syscall_registration
  * to find the issued system call and data.
  *
  * Depending on the call registration, it is then processed either synchronously by
- * calling the respective handler or a thread is created and the source task is put
- * to waiting state.
+ * calling the respective handler or handed to a worker thread while the source task is
+ * put to waiting state.
  */
 void syscallHandle(g_task* task);
 
 /**
- * Executes a system call within a thread. This creates or reuses the system call task on the
- * caller task and starts it within syscallThreadEntry.
+ * Maximum number of idle system call workers that each processor keeps for reuse.
+ */
+#define G_SYSCALL_WORKER_POOL_MAXIMUM	8
+
+/**
+ * Executes a system call within a thread. A worker task is taken from the pool of the
+ * current processor (or created if the pool is empty), attached to the process of the
+ * caller and started within syscallThreadEntry.
  */
 void syscallRunThreaded(g_syscall_handler handler, g_task* caller, void* syscallData);
 
 /**
  * Entry point for threaded system call processing. Reads the system call information from the
- * source task and enters the system call handler accordingly.
+ * source task and enters the system call handler accordingly. Afterwards the worker detaches
+ * from the process and returns to the pool.
  */
 void syscallThreadEntry();
 
@@ -64,6 +77,17 @@ void syscallThreadEntry();
  */
 void syscallRegister(int call, g_syscall_handler handler, bool threaded);
 
+/**
+ * Marks a non-threaded system call as safe to be called from a worker, see
+ * <g_syscall_registration::batchable>.
+ */
+void syscallMarkBatchable(int call);
+
+/**
+ * @return the registration of the call or null if the id is out of range
+ */
+g_syscall_registration* syscallGetRegistration(uint32_t call);
+
 /**
  * Creates the system call table.
  */
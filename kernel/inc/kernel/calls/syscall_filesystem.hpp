@@ -32,6 +32,10 @@ void syscallFsRead(g_task* task, g_syscall_fs_read* data);
 
 void syscallFsWrite(g_task* task, g_syscall_fs_write* data);
 
+void syscallFsReadVector(g_task* task, g_syscall_fs_readv* data);
+
+void syscallFsWriteVector(g_task* task, g_syscall_fs_writev* data);
+
 void syscallFsClose(g_task* task, g_syscall_fs_close* data);
 
 void syscallFsLength(g_task* task, g_syscall_fs_length* data);
@@ -42,9 +46,23 @@ void syscallFsStat(g_task* task, g_syscall_fs_stat* data);
 
 void syscallFsFstat(g_task* task, g_syscall_fs_fstat* data);
 
+void syscallFsListDirectory(g_task* task, g_syscall_fs_list_directory* data);
+
 void syscallFsCloneFd(g_task* task, g_syscall_fs_clonefd* data);
 
 void syscallFsPipe(g_task* task, g_syscall_fs_pipe* data);
 
+void syscallFsPipeCapacity(g_task* task, g_syscall_fs_pipe_capacity* data);
+
+void syscallFsSplice(g_task* task, g_syscall_fs_splice* data);
+
+void syscallFsTee(g_task* task, g_syscall_fs_splice* data);
+
+void syscallFsRegisterAsDelegate(g_task* task, g_syscall_fs_register_as_delegate* data);
+
+void syscallFsSetTransactionStatus(g_task* task, g_syscall_fs_set_transaction_status* data);
+
+void syscallFsCreateNode(g_task* task, g_syscall_fs_create_node* data);
+
 #endif
 
@@ -26,6 +26,10 @@
 
 void syscallAtomicLock(g_task* task, g_syscall_atomic_lock* data);
 
+void syscallFutexWait(g_task* task, g_syscall_futex_wait* data);
+
+void syscallFutexWake(g_task* task, g_syscall_futex_wake* data);
+
 void syscallLog(g_task* task, g_syscall_log* data);
 
 void syscallSetVideoLog(g_task* task, g_syscall_set_video_log* data);
@@ -42,6 +46,6 @@ void syscallGetWorkingDirectory(g_task* task, g_syscall_fs_get_working_directory
 
 void syscallSetWorkingDirectory(g_task* task, g_syscall_fs_set_working_directory* data);
 
-void syscallKernQuery(g_task* task, g_syscall_fs_set_working_directory* data);
+void syscallKernQuery(g_task* task, g_syscall_kernquery* data);
 
 #endif
@@ -30,6 +30,10 @@ void syscallGetTaskForIdentifier(g_task* task, g_syscall_task_id_get* data);
 
 void syscallMessageSend(g_task* task, g_syscall_send_message* data);
 
+void syscallChannelWait(g_task* task, g_syscall_channel_wait* data);
+
+void syscallChannelWake(g_task* task, g_syscall_channel_wake* data);
+
 void syscallMessageReceive(g_task* task, g_syscall_receive_message* data);
 
 #endif
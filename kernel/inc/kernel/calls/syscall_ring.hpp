@@ -0,0 +1,44 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_SYSCALL_RING__
+#define __KERNEL_SYSCALL_RING__
+
+#include "ghost/calls/calls.h"
+#include "kernel/tasking/tasking.hpp"
+
+/**
+ * Executes the submitted entries of a ring in order. Stops after an entry that can't be
+ * executed from a ring, so that the process can issue it directly.
+ */
+void syscallRingSubmit(g_task* task, g_syscall_ring_submit* data);
+
+/**
+ * Starts a kernel worker in the process that executes entries of the ring as they are
+ * submitted, without the process having to trap.
+ */
+void syscallRingDrain(g_task* task, g_syscall_ring_drain* data);
+
+/**
+ * Entry of the kernel worker that drains a ring.
+ */
+void syscallRingDrainThread();
+
+#endif
@@ -73,11 +73,29 @@ struct g_fs_delegate
 	g_fs_open_status (*truncate)(g_fs_node* file);
 	g_fs_close_status (*close)(g_fs_node* node);
 
+	/**
+	 * Optional scatter list versions of read and write. Without them, read and write
+	 * are called for each buffer until one transfers less than its length.
+	 */
+	g_fs_read_status (*readv)(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outRead);
+	g_fs_write_status (*writev)(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outWrote);
+
+	/**
+	 * Optional, adds all children of the folder that are not known yet to the node tree.
+	 * Without it, the node tree is expected to contain all children.
+	 */
+	g_fs_directory_refresh_status (*refreshDirectory)(g_fs_node* folder);
+
 	/**
 	 * When resolvers used when a task needs to wait for a file.
 	 */
 	bool (*waitResolverRead)(g_task* task);
 	bool (*waitResolverWrite)(g_task* task);
+
+	/**
+	 * Data of the mount that the delegate serves, if it needs any.
+	 */
+	void* data;
 };
 
 /**
@@ -123,6 +141,11 @@ g_fs_node* filesystemGetNode(g_fs_virt_id id);
  */
 void filesystemAddChild(g_fs_node* parent, g_fs_node* child);
 
+/**
+ * Removes a child node from a parent. The node itself stays valid.
+ */
+void filesystemRemoveChild(g_fs_node* parent, g_fs_node* child);
+
 /**
  * Creates an empty file system delegate. This delegate can then be filled with handler
  * functions and appended to a node. For all requests on child nodes that have no delegate,
@@ -135,11 +158,21 @@ g_fs_delegate* filesystemCreateDelegate();
  */
 g_fs_node* filesystemGetRoot();
 
+/**
+ * Returns the folder that contains all mountpoints.
+ */
+g_fs_node* filesystemGetMountFolder();
+
 /**
  * Searches for the delegate responsible for this node.
  */
 g_fs_delegate* filesystemFindDelegate(g_fs_node* node);
 
+/**
+ * Returns the working directory node of the process.
+ */
+g_fs_node* filesystemGetWorkingDirectory(g_process* process);
+
 /**
  * Opens a file, creating a file descriptor.
  */
@@ -152,16 +185,30 @@ g_fs_open_status filesystemOpen(g_fs_node* file, g_file_flag_mode flags, g_task*
 g_fs_read_status filesystemRead(g_task* task, g_fd fd, uint8_t* buffer, uint64_t length, int64_t* outRead);
 g_fs_read_status filesystemRead(g_fs_node* file, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outRead);
 
+/**
+ * Reads bytes from a file into a list of buffers. If the offset is negative, the
+ * offset of the descriptor is used and advanced, otherwise it stays unchanged.
+ */
+g_fs_read_status filesystemReadVector(g_task* task, g_fd fd, g_fs_iovec* vectors, uint32_t count, int64_t offset, int64_t* outRead);
+g_fs_read_status filesystemReadVector(g_fs_node* file, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outRead);
+
 /**
  * Writes bytes to a file.
  */
 g_fs_write_status filesystemWrite(g_task* task, g_fd fd, uint8_t* buffer, uint64_t length, int64_t* outWrote);
 g_fs_write_status filesystemWrite(g_fs_node* file, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outWrote);
 
+/**
+ * Writes bytes from a list of buffers to a file. If the offset is negative, the
+ * offset of the descriptor is used and advanced, otherwise it stays unchanged.
+ */
+g_fs_write_status filesystemWriteVector(g_task* task, g_fd fd, g_fs_iovec* vectors, uint32_t count, int64_t offset, int64_t* outWrote);
+g_fs_write_status filesystemWriteVector(g_fs_node* file, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outWrote);
+
 /**
  * Closes a file descriptor.
  */
-g_fs_close_status filesystemClose(g_pid process, g_fd fd, g_bool removeDescriptor);
+g_fs_close_status filesystemClose(g_process* process, g_fd fd, g_bool removeDescriptor);
 
 /**
  * Seeks in a file.
@@ -174,6 +221,31 @@ g_fs_seek_status filesystemSeek(g_task* task, g_fd fd, g_fs_seek_mode mode, int6
 g_fs_length_status filesystemGetLength(g_fs_node* file, uint64_t* outLength);
 g_fs_length_status filesystemGetLength(g_task* task, g_fd fd, uint64_t* outLength);
 
+/**
+ * Retrieves the attributes of a node.
+ */
+g_fs_stat_status filesystemStat(g_fs_node* node, g_fs_stat_attributes* outStats);
+g_fs_stat_status filesystemStat(g_task* task, const char* path, g_fs_stat_attributes* outStats);
+g_fs_stat_status filesystemStat(g_task* task, g_fd fd, g_fs_stat_attributes* outStats);
+
+/**
+ * Asks the delegate to add all children of the folder to the node tree, unless
+ * this was already done.
+ */
+g_fs_directory_refresh_status filesystemRefreshDirectory(g_fs_node* folder);
+
+/**
+ * Maximum number of records that one listing call returns.
+ */
+#define G_FS_LIST_DIRECTORY_BATCH	64
+
+/**
+ * Fills the buffer with as many directory records as fit, but at most
+ * G_FS_LIST_DIRECTORY_BATCH, starting at the child with the index that is stored as
+ * the offset of the descriptor, and advances the offset.
+ */
+g_fs_read_directory_status filesystemListDirectory(g_task* task, g_fd fd, uint8_t* buffer, uint32_t length, int32_t* outWritten);
+
 /**
  * Creates a file.
  */
@@ -201,6 +273,29 @@ void filesystemWaitToRead(g_task* task, g_fs_node* file);
  */
 g_fs_pipe_status filesystemCreatePipe(g_bool blocking, g_fs_node** outPipeNode);
 
+/**
+ * Returns the capacity up to which the pipe behind the descriptor grows. If "set" is
+ * true, the capacity is changed first.
+ */
+g_fs_pipe_capacity_status filesystemPipeCapacity(g_task* task, g_fd fd, g_bool set, uint32_t* inOutCapacity);
+
+/**
+ * Size of the kernel buffer that splice and tee transfer through.
+ */
+#define G_FS_SPLICE_BUFFER_SIZE		0x4000
+
+/**
+ * Moves bytes from one descriptor to another within the kernel, one of them must
+ * refer to a pipe. A pipe input is read before each chunk is written, and the chunk is
+ * limited to the free space of a pipe output.
+ */
+g_fs_splice_status filesystemSplice(g_task* task, g_fd in, g_fd out, uint64_t length, int64_t* outMoved);
+
+/**
+ * Copies bytes from one pipe to another within the kernel, leaving them in the input pipe.
+ */
+g_fs_splice_status filesystemTee(g_task* task, g_fd in, g_fd out, uint64_t length, int64_t* outCopied);
+
 /**
  * Writes the absolute path of node into the given buffer (which must be of G_PATH_MAX bytes size).
  * 
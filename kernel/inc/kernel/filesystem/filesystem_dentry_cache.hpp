@@ -0,0 +1,87 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_FILESYSTEM_DENTRY_CACHE__
+#define __KERNEL_FILESYSTEM_DENTRY_CACHE__
+
+#include "ghost/fs.h"
+#include "kernel/filesystem/filesystem.hpp"
+#include "shared/system/mutex.hpp"
+
+/**
+ * Number of buckets that entries are hashed into by parent and name.
+ */
+#define G_FS_DENTRY_CACHE_BUCKETS			1024
+
+/**
+ * Maximum number of negative entries per bucket, the oldest one is dropped first.
+ */
+#define G_FS_DENTRY_CACHE_NEGATIVE_PER_BUCKET	4
+
+/**
+ * Result of a lookup in the cache.
+ */
+typedef uint8_t g_fs_dentry_lookup;
+#define G_FS_DENTRY_LOOKUP_MISS			((g_fs_dentry_lookup) 0)
+#define G_FS_DENTRY_LOOKUP_FOUND		((g_fs_dentry_lookup) 1)
+#define G_FS_DENTRY_LOOKUP_NEGATIVE		((g_fs_dentry_lookup) 2)
+
+/**
+ * Maps a name within a parent to the node with this name. Entries without a node
+ * remember that the delegate of the parent didn't find the name.
+ */
+struct g_fs_dentry
+{
+	g_fs_virt_id parentId;
+	uint32_t hash;
+	char* name;
+	g_fs_node* node;
+	g_fs_dentry* next;
+};
+
+struct g_fs_dentry_bucket
+{
+	g_mutex lock;
+	g_fs_dentry* head;
+};
+
+/**
+ * Initializes the cache buckets.
+ */
+void filesystemDentryCacheInitialize();
+
+/**
+ * Looks up the child with the given name.
+ */
+g_fs_dentry_lookup filesystemDentryCacheLookup(g_fs_node* parent, const char* name, g_fs_node** outNode);
+
+/**
+ * Remembers the child of the parent. If node is null, a negative entry is added,
+ * but an entry that already has a node is kept.
+ */
+void filesystemDentryCachePut(g_fs_node* parent, const char* name, g_fs_node* node);
+
+/**
+ * Forgets the entry for the given name, so that the delegate is asked again. Used
+ * for delegates whose contents change outside of the VFS.
+ */
+void filesystemDentryCacheRemove(g_fs_node* parent, const char* name);
+
+#endif
@@ -34,6 +34,10 @@ g_fs_read_status filesystemPipeDelegateRead(g_fs_node* node, uint8_t* buffer, ui
 
 g_fs_write_status filesystemPipeDelegateWrite(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outWrote);
 
+g_fs_read_status filesystemPipeDelegateReadVector(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outRead);
+
+g_fs_write_status filesystemPipeDelegateWriteVector(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outWrote);
+
 g_fs_length_status filesystemPipeDelegateGetLength(g_fs_node* node, uint64_t* outLength);
 
 g_fs_open_status filesystemPipeDelegateTruncate(g_fs_node* file);
@@ -23,8 +23,8 @@
 
 #include "ghost/kernel.h"
 #include "ghost/fs.h"
-#include "kernel/utils/hashmap.hpp"
 #include "kernel/filesystem/filesystem.hpp"
+#include "kernel/tasking/tasking.hpp"
 
 /**
  * Structure of a file descriptor.
@@ -38,49 +38,66 @@ struct g_file_descriptor
 };
 
 /**
- * Per-process file system information structure.
+ * Descriptors below this are only created explicitly, they are reserved for the
+ * standard streams that the spawning process passes in.
  */
-struct g_filesystem_process
-{
-	g_fd nextDescriptor;
-	g_mutex nextDescriptorLock;
-	g_hashmap<g_fd, g_file_descriptor*>* descriptors;
-};
+#define G_FILESYSTEM_PROCESS_FIRST_FREE_DESCRIPTOR	3
+
+#define G_FILESYSTEM_PROCESS_INITIAL_DESCRIPTORS	16
+#define G_FILESYSTEM_PROCESS_MAXIMUM_DESCRIPTORS	0x10000
 
 /**
- * Initializes this unit.
+ * Per-process file system information structure. Descriptors are stored in an
+ * array indexed by their id that grows when needed.
  */
-void filesystemProcessInitialize();
+struct g_filesystem_process
+{
+	g_mutex lock;
+	g_file_descriptor** descriptors;
+	g_fd capacity;
+
+	/**
+	 * Searching for a free id starts here, all ids from the first free descriptor
+	 * up to this one are in use.
+	 */
+	g_fd lowestFree;
+};
 
 /**
- * Creates a file system information structure for a process.
+ * Creates the file system information structure of a process.
  */
-void filesystemProcessCreate(g_pid pid);
+void filesystemProcessCreate(g_process* process);
 
 /**
  * Removes file system information for a process. Closes all file descriptors of this process.
  */
-void filesystemProcessRemove(g_pid pid);
+void filesystemProcessRemove(g_process* process);
 
 /**
- * Creates a file descriptor opening a node.
+ * Creates a file descriptor opening a node. Without an explicit id, the lowest free
+ * id is used.
  */
-g_fs_open_status filesystemProcessCreateDescriptor(g_pid pid, g_fs_virt_id nodeId, g_file_flag_mode flags,
+g_fs_open_status filesystemProcessCreateDescriptor(g_process* process, g_fs_virt_id nodeId, g_file_flag_mode flags,
 		g_file_descriptor** outDescriptor, g_fd optionalFd = G_FD_NONE);
 
 /**
  * Finds a file descriptor.
  */
-g_file_descriptor* filesystemProcessGetDescriptor(g_pid pid, g_fd fd);
+g_file_descriptor* filesystemProcessGetDescriptor(g_process* process, g_fd fd);
 
 /**
  * Closes a file descriptor.
  */
-void filesystemProcessRemoveDescriptor(g_pid pid, g_fd fd);
+void filesystemProcessRemoveDescriptor(g_process* process, g_fd fd);
 
 /**
  * Clones a file descriptor.
  */
-g_file_descriptor* filesystemProcessCloneDescriptor(g_file_descriptor* descriptor, g_pid targetPid, g_fd targetFd);
+g_file_descriptor* filesystemProcessCloneDescriptor(g_file_descriptor* descriptor, g_process* target, g_fd targetFd);
+
+/**
+ * Clones all file descriptors of a process into another process, keeping their ids.
+ */
+void filesystemProcessFork(g_process* source, g_process* target);
 
 #endif
@@ -33,6 +33,8 @@ g_fs_open_status filesystemRamdiskDelegateDiscover(g_fs_node* parent, const char
 
 g_fs_read_status filesystemRamdiskDelegateRead(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outRead);
 
+g_fs_read_status filesystemRamdiskDelegateReadVector(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outRead);
+
 g_fs_write_status filesystemRamdiskDelegateWrite(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outWrote);
 
 g_fs_length_status filesystemRamdiskDelegateGetLength(g_fs_node* node, uint64_t* outLength);
@@ -41,4 +43,6 @@ g_fs_open_status filesystemRamdiskDelegateCreate(g_fs_node* parent, const char*
 
 g_fs_open_status filesystemRamdiskDelegateTruncate(g_fs_node* file);
 
+g_fs_directory_refresh_status filesystemRamdiskDelegateRefreshDirectory(g_fs_node* folder);
+
 #endif
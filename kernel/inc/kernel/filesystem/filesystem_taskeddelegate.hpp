@@ -0,0 +1,106 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_FILESYSTEM_TASKED_DELEGATE__
+#define __KERNEL_FILESYSTEM_TASKED_DELEGATE__
+
+#include "ghost/fs.h"
+#include "shared/system/mutex.hpp"
+#include "kernel/filesystem/filesystem.hpp"
+#include "kernel/tasking/tasking.hpp"
+
+/**
+ * A mount that is served by a delegate process. Requests are passed through the ring
+ * that is mapped both into the kernel area and into the delegate process.
+ */
+struct g_fs_tasked_delegate_mount
+{
+	g_mutex lock;
+	g_fs_node* mountpoint;
+	g_pid delegateProcess;
+
+	g_fs_tasked_delegate_ring* ring;
+	g_address ringUserAddress;
+	g_physical_address headPhysical;
+	g_physical_address completedPhysical;
+
+	/**
+	 * Each bit is set while the respective slot is used by a request.
+	 */
+	uint32_t usedSlots;
+
+	/**
+	 * Set once the delegate has exited and the mountpoint was removed. No more slots
+	 * are handed out then. The mount stays allocated for nodes that are still referenced.
+	 */
+	bool detached;
+
+	g_fs_tasked_delegate_mount* next;
+};
+
+/**
+ * Initializes the list of mounts.
+ */
+void filesystemTaskedDelegateInitialize();
+
+/**
+ * Creates a mountpoint with the given name in the mount folder that is served by
+ * the process of the task. The mountpoint of a delegate that has exited is replaced.
+ */
+g_fs_register_as_delegate_status filesystemTaskedDelegateRegister(g_task* task, const char* name, g_fs_phys_id physMountpointId,
+		g_fs_virt_id* outMountpointId, g_address* outTransactionStorage);
+
+/**
+ * Removes the mounts that the process served and frees their shared memory, once
+ * the requests that were still using them have failed. Must be called from a kernel
+ * thread while the address space of the process still exists.
+ */
+void filesystemTaskedDelegateProcessRemoved(g_process* process);
+
+/**
+ * Called by the delegate process once it has finished a request.
+ */
+bool filesystemTaskedDelegateSetTransactionStatus(g_task* task, g_fs_transaction_id transaction, g_fs_transaction_status status);
+
+/**
+ * Called by the delegate process to add a node to a folder of its mount.
+ */
+g_fs_create_node_status filesystemTaskedDelegateCreateNode(g_task* task, g_fs_virt_id parentId, const char* name, g_fs_node_type type,
+		g_fs_phys_id physId, g_fs_virt_id* outCreatedId);
+
+g_fs_open_status filesystemTaskedDelegateOpen(g_fs_node* node);
+
+g_fs_close_status filesystemTaskedDelegateClose(g_fs_node* node);
+
+g_fs_open_status filesystemTaskedDelegateDiscover(g_fs_node* parent, const char* name, g_fs_node** outNode);
+
+g_fs_read_status filesystemTaskedDelegateRead(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outRead);
+
+g_fs_write_status filesystemTaskedDelegateWrite(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outWrote);
+
+g_fs_length_status filesystemTaskedDelegateGetLength(g_fs_node* node, uint64_t* outLength);
+
+g_fs_open_status filesystemTaskedDelegateCreate(g_fs_node* parent, const char* name, g_fs_node** outFile);
+
+g_fs_open_status filesystemTaskedDelegateTruncate(g_fs_node* file);
+
+g_fs_directory_refresh_status filesystemTaskedDelegateRefreshDirectory(g_fs_node* folder);
+
+#endif
@@ -26,12 +26,42 @@
 
 #include "kernel/filesystem/ramdisk_entry.hpp"
 #include "shared/multiboot/multiboot.hpp"
+#include "shared/system/mutex.hpp"
 
 struct g_ramdisk
 {
-	g_ramdisk_entry* firstEntry;
+	g_mutex lock;
 	g_ramdisk_entry* root;
-	uint32_t nextUnusedId = 0;
+	uint32_t nextUnusedId;
+
+	/**
+	 * Tables of an indexed image, which are used in place. Without a header, the
+	 * image has the first format and all entries were created when loading.
+	 */
+	uint8_t* image;
+	uint32_t imageSize;
+	g_ramdisk_v2_header* header;
+	g_ramdisk_v2_entry* imageEntries;
+	g_ramdisk_id* imageChildren;
+	const char* imageStrings;
+
+	/**
+	 * Entries that were used so far, indexed by their id.
+	 */
+	g_ramdisk_entry** entries;
+	uint32_t entriesCapacity;
+};
+
+/**
+ * Attributes of an entry that are taken from the image table, unless the entry was
+ * already created.
+ */
+struct g_ramdisk_entry_summary
+{
+	g_ramdisk_id id;
+	g_ramdisk_entry_type type;
+	const char* name;
+	uint32_t length;
 };
 
 extern g_ramdisk* ramdiskMain;
@@ -47,6 +77,11 @@ void ramdiskLoadFromModule(g_multiboot_module* module);
 
 void ramdiskParseContents(g_multiboot_module* module);
 
+/**
+ * Loads an image of the first format, which has no index, by creating all entries.
+ */
+void ramdiskParseLegacyContents(g_multiboot_module* module);
+
 /**
  * Searches in the folder parent for a file/folder with the given name
  *
@@ -98,6 +133,36 @@ uint32_t ramdiskGetChildCount(g_ramdisk_id id);
  */
 g_ramdisk_entry* ramdiskGetChildAt(g_ramdisk_id id, uint32_t index);
 
+/**
+ * Describes the entry with the given "id" without creating it.
+ *
+ * @param id		the entries id
+ * @param outSummary	receives the attributes
+ * @return whether the entry exists
+ */
+bool ramdiskDescribe(g_ramdisk_id id, g_ramdisk_entry_summary* outSummary);
+
+/**
+ * Describes the child at "index" of the node "id" without creating it.
+ *
+ * @param id		the parent entries id
+ * @param index		the index of the child
+ * @param outSummary	receives the attributes
+ * @return whether the child exists
+ */
+bool ramdiskDescribeChildAt(g_ramdisk_id id, uint32_t index, g_ramdisk_entry_summary* outSummary);
+
+/**
+ * Reads from the contents of a file, decompressing them if necessary.
+ *
+ * @param entry		the file entry
+ * @param offset	offset within the file
+ * @param buffer	target buffer
+ * @param length	maximum number of bytes to read
+ * @return the number of bytes read or -1 if the contents are broken
+ */
+int32_t ramdiskReadData(g_ramdisk_entry* entry, uint32_t offset, uint8_t* buffer, uint32_t length);
+
 /**
  * Returns the root.
  */
@@ -0,0 +1,70 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_RAMDISK_CACHE__
+#define __KERNEL_RAMDISK_CACHE__
+
+#include "ghost/stdint.h"
+#include "kernel/filesystem/ramdisk_entry.hpp"
+
+/**
+ * Maximum number of decompressed blocks that are kept, when it is reached the
+ * block that was used least recently is replaced.
+ */
+#define G_RAMDISK_CACHE_MAXIMUM_BLOCKS	256
+
+/**
+ * Number of buckets that blocks are hashed into by entry and block index.
+ */
+#define G_RAMDISK_CACHE_BUCKETS			64
+
+/**
+ * A decompressed block of a file, stored in its own kernel pages.
+ */
+struct g_ramdisk_cached_block
+{
+	g_ramdisk_id id;
+	uint32_t block;
+	uint8_t* data;
+
+	g_ramdisk_cached_block* nextInBucket;
+	g_ramdisk_cached_block* previousUsed;
+	g_ramdisk_cached_block* nextUsed;
+};
+
+/**
+ * Initializes the block cache.
+ */
+void ramdiskCacheInitialize();
+
+/**
+ * Reads from the contents of a compressed file. The blocks that are touched are
+ * decompressed on first use and then kept in the cache.
+ *
+ * @return false if a block could not be decompressed
+ */
+bool ramdiskCacheRead(g_ramdisk_entry* entry, uint32_t offset, uint8_t* buffer, uint32_t length);
+
+/**
+ * Drops all cached blocks of the entry.
+ */
+void ramdiskCacheDrop(g_ramdisk_id id);
+
+#endif
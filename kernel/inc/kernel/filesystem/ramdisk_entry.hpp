@@ -25,11 +25,11 @@
 #include "ghost/ramdisk.h"
 
 /**
- * Struct of a ramdisk entry
+ * Struct of a ramdisk entry. Entries of an indexed image are only created once they
+ * are used; their name and data refer to the image until the file is written.
  */
 struct g_ramdisk_entry
 {
-	g_ramdisk_entry* next;
 	g_ramdisk_entry_type type;
 	g_ramdisk_id id;
 	g_ramdisk_id parentid;
@@ -40,7 +40,20 @@ struct g_ramdisk_entry
 	uint8_t* data;
 
 	bool dataOnRamdisk;
+
+	/**
+	 * If set, data points to the block table of a compressed file on the ramdisk.
+	 */
+	bool compressed;
 	uint32_t notOnRdBufferLength;
+
+	/**
+	 * Children that are not in the child table of the image, because they were
+	 * created at runtime or loaded from an image of the first version.
+	 */
+	g_ramdisk_entry* firstChild;
+	g_ramdisk_entry* nextSibling;
+	uint32_t childCount;
 };
 
 #endif
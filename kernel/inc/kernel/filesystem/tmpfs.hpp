@@ -0,0 +1,105 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_TMPFS__
+#define __KERNEL_TMPFS__
+
+#include "ghost/stdint.h"
+#include "ghost/types.h"
+#include "shared/system/mutex.hpp"
+
+/**
+ * Each level of the radix tree is a page of pointers that resolves this many bits
+ * of a page index. Three levels cover 4 TiB per file.
+ */
+#define G_TMPFS_RADIX_BITS			10
+#define G_TMPFS_RADIX_SLOTS			(1 << G_TMPFS_RADIX_BITS)
+#define G_TMPFS_MAXIMUM_DEPTH		3
+#define G_TMPFS_PAGE_SHIFT			12
+
+/**
+ * Number of pages that all files together may take, including the levels of their
+ * trees. Writes that would need more pages fail.
+ */
+#define G_TMPFS_MAXIMUM_PAGES		32768
+
+typedef uint32_t g_tmpfs_id;
+
+/**
+ * A file that is kept in memory. The data is held in pages that are taken from the
+ * physical allocator, the page for an index is found in a radix tree. The tree only
+ * grows as high as the largest index needs, pages that were never written are holes
+ * and read as zeros.
+ *
+ * The tree holds physical addresses. Its levels and the data are only mapped into a
+ * window of the accessing processor while the file lock is held.
+ */
+struct g_tmpfs_file
+{
+	g_tmpfs_id id;
+	g_mutex lock;
+	uint64_t length;
+
+	uint32_t depth;
+	g_physical_address root;
+};
+
+/**
+ * Prepares the storage of file ids.
+ */
+void tmpfsInitialize();
+
+/**
+ * Creates an empty file.
+ */
+g_tmpfs_file* tmpfsCreateFile();
+
+/**
+ * Returns the file with the id or null if there is none.
+ */
+g_tmpfs_file* tmpfsGetFile(g_tmpfs_id id);
+
+/**
+ * Copies the file contents at the offset into the buffer.
+ *
+ * @return the number of bytes read, which is 0 at the end of the file
+ */
+int64_t tmpfsRead(g_tmpfs_file* file, uint8_t* buffer, uint64_t offset, uint64_t length);
+
+/**
+ * Copies the buffer into the file at the offset, growing the file if necessary. Writing
+ * beyond the end leaves a hole that takes no memory.
+ *
+ * @return the number of bytes written, which is less than the length if memory ran out
+ * 		or the limit of {G_TMPFS_MAXIMUM_PAGES} was reached
+ */
+int64_t tmpfsWrite(g_tmpfs_file* file, uint8_t* buffer, uint64_t offset, uint64_t length);
+
+/**
+ * Returns the length of the file.
+ */
+uint64_t tmpfsGetLength(g_tmpfs_file* file);
+
+/**
+ * Removes all contents from the file and frees its pages.
+ */
+void tmpfsTruncate(g_tmpfs_file* file);
+
+#endif
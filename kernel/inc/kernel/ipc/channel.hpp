@@ -0,0 +1,66 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_IPC_CHANNEL__
+#define __KERNEL_IPC_CHANNEL__
+
+#include "ghost/kernel.h"
+#include "kernel/tasking/tasking.hpp"
+#include "kernel/tasking/wait_queue.hpp"
+
+/**
+ * Number of wait queues that the waiters on channel words are hashed into.
+ */
+#define G_CHANNEL_WAIT_BUCKETS		64
+
+/**
+ * Channels live in memory that is shared between processes, so waiters are
+ * identified by the physical address of the word they wait on. Different words
+ * may share a bucket; woken tasks check their word again.
+ */
+struct g_channel_wait_bucket
+{
+	g_wait_queue waiters;
+};
+
+/**
+ * Initializes the wait buckets.
+ */
+void channelInitialize();
+
+/**
+ * Resolves the physical address of a word of the given process, which must be the
+ * current address space. Pages that are reserved but not yet mapped are mapped.
+ *
+ * @return the physical address or 0 if the word is not user memory
+ */
+g_physical_address channelGetWordAddress(g_process* process, volatile uint32_t* address);
+
+/**
+ * Returns the wait queue for the word at the given physical address.
+ */
+g_wait_queue* channelGetWaitQueue(g_physical_address word);
+
+/**
+ * Wakes all tasks that wait on the given word of the process.
+ */
+void channelWake(g_process* process, volatile uint32_t* address);
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "ghost.h"
 #include "shared/system/mutex.hpp"
+#include "kernel/tasking/wait_queue.hpp"
 
 struct g_message_queue
 {
@@ -30,6 +31,9 @@ struct g_message_queue
     g_message_header* head;
     g_message_header* tail;
     uint32_t size;
+
+    g_wait_queue waitersSend;
+    g_wait_queue waitersReceive;
 };
 
 /**
@@ -38,15 +42,28 @@ struct g_message_queue
 void messageInitialize();
 
 /**
- * Sends a message.
+ * Sends a message. Optionally a page-aligned area of the sender is passed along without
+ * copying; its frames are either moved out of the sender or shared with the receiver, and
+ * mapped into the receiver once the message is received.
  */
-g_message_send_status messageSend(g_tid sender, g_tid receiver, void* content, uint32_t length, g_message_transaction tx);
+g_message_send_status messageSend(g_tid sender, g_tid receiver, void* content, uint32_t length, g_message_transaction tx,
+        void* transfer = 0, uint32_t transferLength = 0, g_message_transfer_mode transferMode = G_MESSAGE_TRANSFER_MODE_MOVE);
 
 /**
  * Receives a message.
  */
 g_message_receive_status messageReceive(g_tid receiver, g_message_header* out, uint32_t max, g_message_transaction tx);
 
+/**
+ * Registers the sender to be woken once there is space in the queue of the receiver.
+ */
+void messageWaitForSend(g_tid receiver, g_tid sender);
+
+/**
+ * Registers the receiver to be woken once a message is sent to it.
+ */
+void messageWaitForReceive(g_tid receiver);
+
 /**
  * When a task is removed, this function is called to cleanup any occupied memory.
  */
@@ -23,6 +23,7 @@
 
 #include "ghost.h"
 #include "shared/system/mutex.hpp"
+#include "kernel/tasking/wait_queue.hpp"
 
 /**
  * Entry in the reference list of a pipe.
@@ -46,7 +47,24 @@ struct g_pipeline
 	uint32_t size;
 	uint32_t capacity;
 
+	/**
+	 * Number of bytes that were removed from the pipe so far, wraps around. Lets a
+	 * peeking reader notice that another reader has taken bytes meanwhile.
+	 */
+	uint32_t readCount;
+
+	/**
+	 * The buffer is grown up to this capacity when a write doesn't fit.
+	 */
+	uint32_t maximumCapacity;
+
 	uint16_t references;
+
+	/**
+	 * Tasks waiting for data to read or for space to write.
+	 */
+	g_wait_queue waitersRead;
+	g_wait_queue waitersWrite;
 };
 
 /**
@@ -83,10 +101,35 @@ g_fs_read_status pipeRead(g_fs_phys_id pipeId, uint8_t* buffer, uint64_t offset,
 
 g_fs_write_status pipeWrite(g_fs_phys_id pipeId, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outWrote);
 
+/**
+ * Reads into or writes from a list of buffers while holding the pipe lock once.
+ */
+g_fs_read_status pipeReadVector(g_fs_phys_id pipeId, g_fs_iovec* vectors, uint32_t count, int64_t* outRead);
+
+g_fs_write_status pipeWriteVector(g_fs_phys_id pipeId, g_fs_iovec* vectors, uint32_t count, int64_t* outWrote);
+
 g_fs_length_status pipeGetLength(g_fs_phys_id pipeId, uint64_t* outLength);
 
 g_fs_open_status pipeTruncate(g_fs_phys_id pipeId);
 
+/**
+ * Copies bytes from the pipe without removing them, starting "skip" bytes after
+ * the first byte that would be read. The read count of the pipe at that time is
+ * written to outReadCount.
+ */
+g_fs_read_status pipePeek(g_fs_phys_id pipeId, uint32_t skip, uint8_t* buffer, uint64_t length, int64_t* outRead, uint32_t* outReadCount);
+
+/**
+ * Returns the capacity up to which the pipe grows.
+ */
+g_fs_pipe_capacity_status pipeGetCapacity(g_fs_phys_id pipeId, uint32_t* outCapacity);
+
+/**
+ * Sets the capacity up to which the pipe grows. The value is clamped to the range
+ * from the default up to the upper limit. Fails if more bytes are in the pipe.
+ */
+g_fs_pipe_capacity_status pipeSetCapacity(g_fs_phys_id pipeId, uint32_t capacity);
+
 /**
  * Deletes the pipe.
  */
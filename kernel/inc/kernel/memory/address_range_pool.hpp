@@ -24,18 +24,42 @@
 #include "ghost/types.h"
 #include "shared/system/mutex.hpp"
 
+struct g_address_range;
+
+/**
+ * Links of a range in one of the AVL trees of the pool.
+ */
+struct g_address_range_node
+{
+	g_address_range* left;
+	g_address_range* right;
+	int32_t height;
+};
+
 struct g_address_range
 {
 	g_address_range* next;
+	g_address_range* previous;
 	bool used;
 	g_address base;
 	uint32_t pages;
 	uint8_t flags;
+
+	g_address_range_node byBase;
+	g_address_range_node bySize;
 };
 
+/**
+ * All ranges are kept in a list sorted by base address, which is used to find
+ * neighbours for coalescing. Additionally, all ranges are indexed by their base
+ * and the free ranges by their size so that lookups and best-fit allocation
+ * are logarithmic.
+ */
 struct g_address_range_pool
 {
 	g_address_range* first;
+	g_address_range* byBase;
+	g_address_range* freeBySize;
 	g_mutex lock;
 };
 
@@ -47,8 +71,6 @@ void addressRangePoolCloneRanges(g_address_range_pool* pool, g_address_range_poo
 
 void addressRangePoolReleaseRanges(g_address_range_pool* pool);
 
-void addressRangePoolMerge(g_address_range_pool* pool);
-
 g_address addressRangePoolAllocate(g_address_range_pool* pool, uint32_t pages, uint8_t flags = 0);
 
 int32_t addressRangePoolFree(g_address_range_pool* pool, g_address base);
@@ -57,6 +79,11 @@ g_address_range* addressRangePoolGetRanges(g_address_range_pool* pool);
 
 g_address_range* addressRangePoolFind(g_address_range_pool* pool, g_address base);
 
+/**
+ * Finds the range that contains the given address.
+ */
+g_address_range* addressRangePoolFindContaining(g_address_range_pool* pool, g_address address);
+
 void addressRangePoolDump(g_address_range_pool* pool, bool onlyFree = false);
 
 #endif
@@ -56,4 +56,9 @@ uint32_t chunkAllocatorFree(g_chunk_allocator* allocator, void* memory);
 
 void chunkAllocatorMerge(g_chunk_allocator* allocator);
 
+/**
+ * Counts the free chunks and finds the largest one.
+ */
+void chunkAllocatorGetFreeStatistics(g_chunk_allocator* allocator, uint32_t* outFreeChunks, uint32_t* outLargestFree);
+
 #endif
@@ -23,19 +23,27 @@
 
 #include "ghost/types.h"
 #include "shared/memory/constants.hpp"
+#include "ghost/kernquery.h"
 
 /**
  * Initializes the kernel heap using the given range of memory.
  */
 void heapInitialize(g_virtual_address start, g_virtual_address end);
 
+/**
+ * Creates the processor-local free lists for small objects. Must be called
+ * once the number of processors is known.
+ */
+void heapInitializeProcessorCaches();
+
 /**
  * Expands the heap space by {G_CONST_KERNEL_HEAP_EXPAND_STEP} bytes.
  */
 bool heapExpand();
 
 /**
- * Allocates a number of bytes on the kernel heap.
+ * Allocates a number of bytes on the kernel heap. Small sizes are served
+ * from slabs, larger ones from the chunk allocator.
  *
  * Causes a panic if it fails.
  */
@@ -58,4 +66,9 @@ void heapFree(void* memory);
  */
 uint32_t heapGetUsedAmount();
 
+/**
+ * Fills the given structure with usage statistics of the kernel heap.
+ */
+void heapGetStatistics(g_kernquery_heap_get_data* out);
+
 #endif
@@ -31,6 +31,23 @@
 #include "kernel/memory/heap.hpp"
 #include "kernel/memory/address_range_pool.hpp"
 
+/**
+ * Number of physical pages each processor keeps cached in front of the
+ * physical allocator, and how many are moved to/from it at once.
+ */
+#define G_PHYSICAL_PAGE_CACHE_SIZE	64
+#define G_PHYSICAL_PAGE_CACHE_BATCH	32
+
+/**
+ * Processor-local stack of free physical pages. Only ever accessed by the
+ * owning processor with interrupts disabled, so it needs no lock.
+ */
+struct g_physical_page_cache
+{
+	uint32_t count;
+	g_physical_address pages[G_PHYSICAL_PAGE_CACHE_SIZE];
+};
+
 extern g_bitmap_page_allocator memoryPhysicalAllocator;
 extern g_address_range_pool* memoryVirtualRangePool;
 
@@ -38,6 +55,38 @@ void memoryInitialize(g_setup_information* setupInformation);
 
 void memoryInitializePhysicalAllocator(g_setup_information* setupInformation);
 
+/**
+ * Creates the processor-local page caches. Must be called once the number of
+ * processors is known, until then allocations go to the allocator directly.
+ */
+void memoryInitializePhysicalPageCaches();
+
+/**
+ * Allocates a physical page, preferably from the current processor's cache.
+ *
+ * @return the page or 0 if there is no free memory
+ */
+g_physical_address memoryPhysicalAllocate();
+
+/**
+ * Frees a physical page into the current processor's cache.
+ */
+void memoryPhysicalFree(g_physical_address page);
+
+/**
+ * Allocates multiple physical pages, taking them from the current processor's cache
+ * first and the rest from the allocator with a single acquisition of its lock.
+ *
+ * @return the number of pages written to out
+ */
+uint32_t memoryPhysicalAllocateMultiple(g_physical_address* out, uint32_t count);
+
+/**
+ * Frees multiple physical pages into the current processor's cache, pages that don't
+ * fit are given back to the allocator at once.
+ */
+void memoryPhysicalFreeMultiple(g_physical_address* pages, uint32_t count);
+
 void memoryUnmapSetupMemory();
 
 #endif
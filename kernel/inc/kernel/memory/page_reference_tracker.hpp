@@ -55,4 +55,10 @@ void pageReferenceTrackerIncrement(g_physical_address address);
  */
 int16_t pageReferenceTrackerDecrement(g_physical_address address);
 
+/**
+ * Returns the number of references on a physical page. Pages that were never
+ * tracked (like memory-mapped devices) have no references.
+ */
+int16_t pageReferenceTrackerGetCount(g_physical_address address);
+
 #endif
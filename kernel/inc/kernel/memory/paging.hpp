@@ -60,6 +60,29 @@ void pagingMapToTemporaryMappedDirectory(g_physical_address directory, g_virtual
  */
 void pagingUnmapPage(g_virtual_address virt);
 
+/**
+ * Shares all user space tables of the current address space with the given
+ * page directory. Tables and private pages are marked copy-on-write in both
+ * spaces and are only copied once either of them writes to them. Only the TLB
+ * of this processor is flushed, see <taskingMemoryShootdown>.
+ *
+ * @param targetDirectory
+ * 		physical address of the directory of the new address space
+ */
+void pagingForkUserSpace(g_physical_address targetDirectory);
+
+/**
+ * Resolves a write access to a copy-on-write page in the current address space.
+ * Only the TLB of this processor is flushed, see <taskingMemoryShootdown>.
+ *
+ * @param virt
+ * 		the page that was written to
+ *
+ * @return whether the fault was caused by copy-on-write and was resolved, also
+ * 		if another processor has resolved it before
+ */
+bool pagingResolveCopyOnWrite(g_virtual_address virt);
+
 /**
  * Returns the currently set page directory.
  *
@@ -0,0 +1,129 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_SLAB_ALLOCATOR__
+#define __KERNEL_SLAB_ALLOCATOR__
+
+#include "ghost/types.h"
+#include "shared/system/mutex.hpp"
+
+/**
+ * Size classes served by the slab allocator, larger requests must be
+ * handled by a different allocator.
+ */
+#define G_SLAB_CLASS_COUNT			7
+#define G_SLAB_MIN_OBJECT_SIZE		16
+#define G_SLAB_MAX_OBJECT_SIZE		1024
+
+/**
+ * Maximum number of free objects a processor keeps per size class, and the
+ * number of objects moved between the processor and the slabs at once.
+ */
+#define G_SLAB_PROCESSOR_CACHE_LIMIT	32
+#define G_SLAB_PROCESSOR_CACHE_BATCH	16
+
+struct g_slab_cache;
+
+/**
+ * Header at the start of each slab page, followed by the objects.
+ */
+struct g_slab
+{
+	g_slab* previous;
+	g_slab* next;
+	g_slab_cache* cache;
+	void* freeList;
+	uint16_t inUse;
+	uint16_t capacity;
+};
+
+/**
+ * All slabs of one size class. Slabs that have free objects are kept in the
+ * partial list, full slabs are only reachable through their objects.
+ */
+struct g_slab_cache
+{
+	g_mutex lock;
+	uint32_t objectSize;
+	uint32_t objectsPerSlab;
+	g_slab* partial;
+
+	uint32_t slabCount;
+	uint32_t allocated;
+};
+
+/**
+ * Free objects of one size class owned by a processor, linked through their
+ * first word. Only accessed by the owning processor with interrupts disabled.
+ */
+struct g_slab_processor_cache
+{
+	void* head;
+	uint32_t count;
+};
+
+struct g_slab_allocator
+{
+	g_slab_cache caches[G_SLAB_CLASS_COUNT];
+	g_slab_processor_cache* processorCaches;
+
+	/**
+	 * Pages are mapped on demand from this area. Pages of slabs that became
+	 * empty are kept mapped and reused by any size class.
+	 */
+	g_mutex areaLock;
+	g_virtual_address areaStart;
+	g_virtual_address areaEnd;
+	g_virtual_address areaTop;
+	g_slab* emptySlabs;
+	uint32_t emptySlabCount;
+};
+
+/**
+ * Initializes a slab allocator that maps its pages in the given range.
+ */
+void slabAllocatorInitialize(g_slab_allocator* allocator, g_virtual_address start, g_virtual_address end);
+
+/**
+ * Creates the processor-local free lists. Until this is called, all requests
+ * go to the slabs directly.
+ */
+void slabAllocatorInitializeProcessorCaches(g_slab_allocator* allocator, g_slab_processor_cache* caches);
+
+/**
+ * Allocates an object of at least the given size.
+ *
+ * @return the object or 0 if the size is not served or there is no memory
+ */
+void* slabAllocatorAllocate(g_slab_allocator* allocator, uint32_t size);
+
+/**
+ * Frees an object that was allocated with this allocator.
+ *
+ * @return the size of the objects' size class
+ */
+uint32_t slabAllocatorFree(g_slab_allocator* allocator, void* object);
+
+/**
+ * Whether the given memory belongs to this allocator.
+ */
+bool slabAllocatorContains(g_slab_allocator* allocator, void* memory);
+
+#endif
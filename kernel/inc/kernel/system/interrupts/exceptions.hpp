@@ -25,4 +25,22 @@
 
 void exceptionsHandle(g_task* task);
 
+/**
+ * Handles a page fault that the kernel caused while it was already handling an
+ * interrupt, for example when a system call writes to a copy-on-write page of the
+ * calling process. The state of the current task is left untouched.
+ *
+ * @return whether the fault was resolved
+ */
+bool exceptionsHandleKernelPageFault(g_processor_state* state);
+
+/**
+ * Handles an exception that the kernel caused while executing a system call of a
+ * user task. The calling task is killed and the call is abandoned, the kernel
+ * frames on its interrupt stack are discarded when the next task is restored.
+ *
+ * @return whether the fault could be handled this way
+ */
+bool exceptionsHandleSystemCallFault(g_processor_state* state);
+
 #endif
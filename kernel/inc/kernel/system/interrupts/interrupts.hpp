@@ -40,6 +40,27 @@ void interruptsInstallRoutines();
 
 extern "C" g_virtual_address _interruptHandler(g_virtual_address state);
 
+/**
+ * Called by the interrupt routines after they have switched to the returned stack.
+ */
+extern "C" void _interruptStackSwitched();
+
+/**
+ * Sets up the SYSENTER instruction on the current processor, if it is supported.
+ * Must be called after the GDT of the processor is initialized.
+ */
+void interruptsInitializeSysenter();
+
+/**
+ * Handles a system call that was entered via SYSENTER, called by the entry routine.
+ */
+extern "C" g_virtual_address _syscallEnterHandler(g_virtual_address state);
+
+/**
+ * @see assembly
+ */
+extern "C" void _syscallEnterRoutine();
+
 /**
  * @see assembly
  */
@@ -115,6 +115,12 @@
 // the APIC timer is configured to tick every 1 millisecond.
 #define APIC_MILLISECONDS_PER_TICK				1
 
+// vector of the inter-processor interrupt that makes a processor reschedule
+#define APIC_RESCHEDULE_VECTOR					0x82
+
+// vector of the inter-processor interrupt that makes a processor flush its TLB
+#define APIC_TLB_SHOOTDOWN_VECTOR				0x83
+
 void lapicGlobalPrepare(g_physical_address lapicAddress);
 
 bool lapicGlobalIsPrepared();
@@ -127,6 +133,28 @@ void lapicCreateMapping();
 
 void lapicStartTimer();
 
+/**
+ * Programs the timer to fire on vector 32 every millisecond.
+ */
+void lapicStartPeriodicTimer();
+
+/**
+ * Programs the timer to fire once on vector 32 after the given number of milliseconds.
+ * Durations longer than the counter can hold are shortened.
+ */
+void lapicStartOneShotTimer(uint32_t milliseconds);
+
+/**
+ * @return the milliseconds that have passed since the one-shot timer was started,
+ * 		rounded to the nearest millisecond
+ */
+uint32_t lapicGetOneShotElapsed();
+
+/**
+ * Sends a fixed inter-processor interrupt with the vector to the processor.
+ */
+void lapicSendIpi(uint32_t apicId, uint8_t vector);
+
 uint32_t lapicRead(uint32_t reg);
 
 void lapicWrite(uint32_t reg, uint32_t value);
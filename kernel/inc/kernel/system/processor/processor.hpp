@@ -103,6 +103,9 @@ enum class g_cpuid_extended_ecx_feature
 #define IA32_APIC_BASE_MSR			0x1B
 #define IA32_APIC_BASE_MSR_BSP		0x100
 #define IA32_APIC_BASE_MSR_ENABLE	0x800
+#define IA32_SYSENTER_CS_MSR		0x174
+#define IA32_SYSENTER_ESP_MSR		0x175
+#define IA32_SYSENTER_EIP_MSR		0x176
 
 struct g_processor
 {
@@ -202,6 +205,11 @@ void processorPrintInformation();
  */
 void processorEnableSSE();
 
+/**
+ * Enables write protection, so that the kernel can not write to read-only pages.
+ */
+void processorEnableWriteProtection();
+
 /**
  * Returns the CPU's vendor. "out" must be a pointer to a
  * buffer of at least 12 bytes.
@@ -100,6 +100,10 @@ struct g_elf_object {
 
 	/* The relocate order "first" is only filled in the executable object. */
 	g_elf_object* relocateOrderFirst;
+
+	/* Pages of all objects that are not backed by the file and left unmapped
+	until accessed, only filled in the executable object. */
+	g_lazy_area* lazyAreas;
 	g_elf_object* relocateOrderNext;
 
 	/* In-address-space memory pointers */
@@ -0,0 +1,89 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_TASKING_FUTEX__
+#define __KERNEL_TASKING_FUTEX__
+
+#include "ghost/kernel.h"
+#include "kernel/tasking/tasking.hpp"
+#include "shared/system/mutex.hpp"
+
+/**
+ * Number of buckets that futex waiters are hashed into.
+ */
+#define G_FUTEX_BUCKETS		64
+
+/**
+ * A task that waits on a futex word. The word is identified by the address space
+ * and the virtual address, so only tasks of the same process share a futex.
+ */
+struct g_futex_waiter
+{
+	g_tid task;
+	g_physical_address space;
+	g_virtual_address address;
+	g_futex_waiter* next;
+};
+
+struct g_futex_bucket
+{
+	g_mutex lock;
+	g_futex_waiter* head;
+};
+
+/**
+ * Initializes the futex buckets.
+ */
+void futexInitialize();
+
+/**
+ * Checks that the address is a valid futex word of the process, which must be the
+ * current address space. A page that is reserved but not yet mapped is mapped.
+ */
+bool futexCheckAddress(g_process* process, volatile uint32_t* address);
+
+/**
+ * Queues the task on the word if the word still has the expected value. The value is
+ * compared while holding the bucket, so a wake after changing the word can't be missed.
+ *
+ * @return whether the task was queued
+ */
+bool futexEnqueue(g_task* task, volatile uint32_t* address, uint32_t expected);
+
+/**
+ * @return whether the task is queued on the word
+ */
+bool futexIsQueued(g_task* task, volatile uint32_t* address);
+
+/**
+ * Removes the task from the queue of the word.
+ *
+ * @return whether the task was still queued, false if it was woken meanwhile
+ */
+bool futexDequeue(g_task* task, volatile uint32_t* address);
+
+/**
+ * Wakes up to count tasks that are queued on the word of the process.
+ *
+ * @return the number of woken tasks
+ */
+uint32_t futexWake(g_process* process, volatile uint32_t* address, uint32_t count);
+
+#endif
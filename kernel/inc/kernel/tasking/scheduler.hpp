@@ -23,6 +23,11 @@
 
 #include "kernel/tasking/tasking.hpp"
 
+/**
+ * Longest time in milliseconds that an idle processor sleeps without a timer interrupt.
+ */
+#define G_SCHEDULER_TICKLESS_MAX_SLEEP	1000
+
 /**
  * Initializes the scheduler locally.
  */
@@ -33,6 +38,20 @@ void schedulerInitializeLocal();
  */
 void schedulerNewTimeSlot();
 
+/**
+ * Ends tickless idle on the current processor, accounts the time that has passed
+ * while idling and restarts the periodic timer.
+ *
+ * @return whether the processor was tickless
+ */
+bool schedulerLeaveTickless();
+
+/**
+ * Makes a tickless processor reschedule, so that it notices work that was made
+ * available from a different processor.
+ */
+void schedulerKick(g_tasking_local* local);
+
 /**
  * Prepares a new task entry for scheduling.
  */
@@ -48,4 +67,94 @@ void schedulerSchedule(g_tasking_local* local);
  */
 void schedulerPleaseSchedule(g_task* task);
 
+/**
+ * Wakes a waiting task, so that its wait resolver is called on the next schedule
+ * of the processor it is assigned to. May be called from any processor.
+ */
+void schedulerWake(g_task* task);
+
+/**
+ * Lets a waiting task be checked once per time slot. Used by wait resolvers that
+ * have no event that could wake them.
+ */
+void schedulerPollWaiting(g_task* task);
+
+/**
+ * Removes the task from the list of pending wakes of the local.
+ */
+void schedulerRemoveWake(g_tasking_local* local, g_task* task);
+
+/**
+ * @return the number of runnable tasks on the local, including the running one
+ */
+int schedulerGetLoad(g_tasking_local* local);
+
+/**
+ * @return the local of the processor with the lowest load, preferring the current one
+ */
+g_tasking_local* schedulerGetLeastLoaded();
+
+/**
+ * Whether the task may be moved to a different processor.
+ */
+bool schedulerCanMigrate(g_task* task);
+
+/**
+ * Called by the interrupt routines once they have switched to the stack of the
+ * current task. The task that was switched away from may now migrate.
+ */
+void schedulerFinishSwitch(g_tasking_local* local);
+
+/**
+ * Puts the entry into the queue that matches the status of its task. Must be
+ * called while holding the lock of the local.
+ */
+void schedulerEnqueue(g_tasking_local* local, g_schedule_entry* entry);
+
+/**
+ * Removes the entry from whatever queue it is in. Must be called while holding
+ * the lock of the local.
+ */
+void schedulerRemoveEntry(g_tasking_local* local, g_schedule_entry* entry);
+
+/**
+ * Appends an entry to the tail of a queue.
+ */
+void schedulerQueuePush(g_schedule_queue* queue, g_schedule_entry* entry);
+
+/**
+ * Unlinks an entry from the queue it is in.
+ */
+void schedulerQueueRemove(g_schedule_entry* entry);
+
+/**
+ * The backend decides which of the runnable tasks runs next. It only holds
+ * tasks in status running and is always called with the lock of the local held.
+ */
+void schedulerBackendInitializeLocal(g_tasking_local* local);
+
+/**
+ * Adds a runnable entry to the backend.
+ */
+void schedulerBackendEnqueue(g_tasking_local* local, g_schedule_entry* entry);
+
+/**
+ * Removes an entry that is currently held by the backend.
+ */
+void schedulerBackendRemove(g_tasking_local* local, g_schedule_entry* entry);
+
+/**
+ * Takes the next entry to run out of the backend.
+ *
+ * @return the entry or null if there is none
+ */
+g_schedule_entry* schedulerBackendNext(g_tasking_local* local);
+
+/**
+ * Takes an entry out of the backend that may be moved to a different processor.
+ *
+ * @return the entry or null if there is none
+ */
+g_schedule_entry* schedulerBackendTakeMigratable(g_tasking_local* local);
+
 #endif
@@ -30,11 +30,15 @@
 #include "kernel/memory/paging.hpp"
 #include "kernel/memory/address_range_pool.hpp"
 #include "kernel/calls/syscall.hpp"
+#include "kernel/tasking/wait_queue.hpp"
 
 struct g_process;
 struct g_task;
 struct g_tasking_local;
+struct g_schedule_entry;
 struct g_elf_object;
+struct g_filesystem_process;
+struct g_fs_node;
 
 typedef bool (*g_wait_resolver)(g_task*);
 
@@ -84,12 +88,18 @@ struct g_task
 	g_security_level securityLevel;
 	g_thread_status status;
 	g_thread_type type;
+	g_thread_priority priority;
 
 	/**
 	 * Pointer to the processor-local tasking structure that this task is currently scheduled on.
 	 */
 	g_tasking_local* assignment;
 
+	/**
+	 * Entry of this task in the scheduling list of its assigned processor.
+	 */
+	g_schedule_entry* scheduleEntry;
+
 	/**
 	 * Number of times this task was ever scheduled.
 	 */
@@ -131,9 +141,10 @@ struct g_task
 	/**
 	 * For all syscalls (threaded and non-threaded) the handler and data field are filled.
 	 *
-	 * When the task issues a long-running syscall, a kernel task is created to execute it.
-	 * In the executing task, the processingTask field is filled with the task that processes the
-	 * syscall. In the processing task, the sourceTask is the task that issued the syscall.
+	 * When the task issues a long-running syscall, a worker task of the processor is used to
+	 * execute it. In the executing task, the processingTask field is filled with the task that
+	 * processes the syscall. In the processing task, the sourceTask is the task that issued the
+	 * syscall. Idle workers are linked through poolNext.
 	 */
 	struct
 	{
@@ -142,6 +153,7 @@ struct g_task
 
 		g_task* processingTask;
 		g_task* sourceTask;
+		g_task* poolNext;
 	} syscall;
 
 	/**
@@ -151,6 +163,23 @@ struct g_task
 	g_wait_resolver waitResolver;
 	void* waitData;
 
+	/**
+	 * Set while the task is in the list of pending wakes of its assigned processor.
+	 */
+	bool wakePending;
+	g_task* wakeNext;
+
+	/**
+	 * Set while the task is the current task of a processor, and after it was switched
+	 * away from until the processor has left its interrupt stack.
+	 */
+	volatile bool onProcessor;
+
+	/**
+	 * Tasks that wait for this task to finish.
+	 */
+	g_wait_queue joinWaiters;
+
 	/**
 	 * If the task gets interrupted by a signal or an IRQ, the current state is stored in this
 	 * structure and later restored from it.
@@ -181,13 +210,45 @@ struct g_task_entry
 	g_task_entry* next;
 };
 
+/**
+ * Queue of schedule entries. An entry can be in at most one queue at a time.
+ */
+struct g_schedule_queue
+{
+	g_schedule_entry* head;
+	g_schedule_entry* tail;
+	int length;
+};
+
+/**
+ * Entry for each task that is assigned to a processor. The "next" pointer links
+ * all entries of the processor, the queue pointers link the entry within the queue
+ * it currently is in (if any).
+ */
 struct g_schedule_entry
 {
 	g_task* task;
-	uint32_t schedulerRound;
 	g_schedule_entry* next;
+
+	g_schedule_queue* queue;
+	g_schedule_entry* queueNext;
+	g_schedule_entry* queuePrevious;
+};
+
+/**
+ * Timer that wakes a waiting task at the given processor time.
+ */
+struct g_wait_timer
+{
+	uint32_t time;
+	g_tid task;
 };
 
+/**
+ * Number of priority levels that the scheduler distinguishes.
+ */
+#define G_SCHEDULER_PRIORITY_LEVELS	32
+
 /**
  * Processor local tasking structure. For each processor there is one instance
  * of this struct that contains the current state.
@@ -205,9 +266,48 @@ struct g_tasking_local
 		g_task* current;
 		int taskCount;
 
-		uint32_t round;
+		/**
+		 * Runnable tasks are queued by priority level, the bitmap has a bit set
+		 * for each level that has a non-empty queue.
+		 */
+		g_schedule_queue runQueues[G_SCHEDULER_PRIORITY_LEVELS];
+		uint32_t runQueueBitmap;
+		int runnableCount;
+
+		/**
+		 * Tasks that are waiting are parked in the wait queue. When they are woken, they
+		 * are moved to the check queue and their wait resolver is called on the next schedule.
+		 */
+		g_schedule_queue waitQueue;
+		g_schedule_queue checkQueue;
+
+		/**
+		 * Tasks that were woken from other places are collected in this list first. The
+		 * wake lock is never held while acquiring another lock.
+		 */
+		g_mutex wakeLock;
+		g_task* wakeList;
+
+		/**
+		 * Waiting tasks without an event that could wake them are checked once per time slot.
+		 */
+		g_wait_queue pollWaiters;
+
+		/**
+		 * While the processor idles, the periodic timer is stopped and a one-shot timer
+		 * is programmed for the next wait timer. Other processors that make work available
+		 * to a tickless processor send it a reschedule interrupt.
+		 */
+		bool tickless;
+
 		g_task* idleTask;
 		g_task* preferredNextTask;
+
+		/**
+		 * Task whose interrupt stack the processor is still on after switching to
+		 * the current task, until the interrupt returns.
+		 */
+		g_task* switchedFrom;
 	} scheduling;
 
 	/**
@@ -218,11 +318,46 @@ struct g_tasking_local
 	int locksReenableInt;
 	bool inInterruptHandler;
 
+	/**
+	 * Set by another processor that changed the mappings of the address space that
+	 * this processor runs in, see <taskingMemoryShootdown>.
+	 */
+	bool tlbFlushRequested;
+
+	/**
+	 * Set once this processor has initialized its tasking and can take tasks.
+	 */
+	bool ready;
+
+	/**
+	 * Id of the local APIC of this processor.
+	 */
+	uint32_t apicId;
+
 	/**
 	 * Approximation of milliseconds that this processor has run.
 	 */
 	uint32_t time;
 
+	/**
+	 * Idle kernel tasks that execute threaded system calls, see <syscall.hpp>.
+	 */
+	struct
+	{
+		g_task* pool;
+		int poolSize;
+	} syscallWorkers;
+
+	/**
+	 * Wake timers of tasks on this processor, see <wait_timer.hpp>.
+	 */
+	struct
+	{
+		g_wait_timer* heap;
+		int count;
+		int capacity;
+	} timers;
+
 };
 
 /**
@@ -243,6 +378,19 @@ public:
 /* Weak flag signals that the physical memory mapped behind the
 virtual range is not managed by the kernel (for example MMIO). */
 #define G_PROC_VIRTUAL_RANGE_FLAG_WEAK		1
+/* Lazy flag signals that nothing is mapped up front, pages are
+allocated and zeroed when they are first accessed. */
+#define G_PROC_VIRTUAL_RANGE_FLAG_LAZY		2
+
+/**
+ * Area of a process that is filled with zeroed pages on first access.
+ */
+struct g_lazy_area
+{
+	g_virtual_address start;
+	g_virtual_address end;
+	g_lazy_area* next;
+};
 
 /**
  * A process groups multiple tasks.
@@ -274,7 +422,13 @@ struct g_process
 		g_virtual_address end;
 	} image;
 	g_elf_object* object;
+	g_lazy_area* lazyAreas;
 
+	g_filesystem_process* filesystem;
+
+	/**
+	 * Pages of the heap are only mapped once accessed.
+	 */
 	struct
 	{
 		g_virtual_address brk;
@@ -287,6 +441,11 @@ struct g_process
 		const char* arguments;
 		const char* executablePath;
 		char* workingDirectory;
+
+		/**
+		 * Node of the working directory, resolved on first use.
+		 */
+		g_fs_node* workingDirectoryNode;
 	} environment;
 
 	g_process_info* userProcessInfo;
@@ -297,6 +456,11 @@ struct g_process
  */
 g_tasking_local* taskingGetLocal();
 
+/**
+ * @return the processor-local tasking structure of the given processor
+ */
+g_tasking_local* taskingGetLocalForProcessor(uint32_t processor);
+
 /**
  * @return the task that is on this processor currently running or was
  * last running when called from within a system call handler
@@ -324,10 +488,22 @@ void taskingInitializeAp();
 void taskingInitializeLocal();
 
 /**
- * Adds a task to the list of scheduled tasks on the given local.
+ * Adds a task to the list of scheduled tasks on the given local. If the task
+ * is assigned to a different local, it is removed from there first.
  */
 void taskingAssign(g_tasking_local* local, g_task* task);
 
+/**
+ * Assigns a new task to the processor with the lowest load.
+ */
+void taskingAssignBalanced(g_task* task);
+
+/**
+ * Removes a task that is not currently running from the list of scheduled tasks
+ * on the given local.
+ */
+void taskingUnassign(g_tasking_local* local, g_task* task);
+
 /**
  * Creates an empty process. Creates a new page directory with the kernel areas
  * correctly mapped and instantiates a virtual range allocator.
@@ -336,6 +512,17 @@ void taskingAssign(g_tasking_local* local, g_task* task);
  */
 g_process* taskingCreateProcess();
 
+/**
+ * Creates a copy of the process of the given task. User memory is shared copy-on-write,
+ * file descriptors are cloned with the same ids. The new process has a single task that
+ * resumes with the state of the given task, which must be the currently running task.
+ *
+ * The task is not yet assigned to a processor.
+ *
+ * @return the main task of the new process
+ */
+g_task* taskingForkProcess(g_task* task);
+
 /**
  * Creates a task that starts execution on the given entry. The task is added to the
  * task list of the specified process. The task is scheduled only after using <taskingAssign>.
@@ -482,4 +669,9 @@ g_spawn_status taskingSpawn(g_task* spawner, g_fd file, g_security_level securit
  */
 void taskingAddToProcessTaskList(g_process* process, g_task* task);
 
+/**
+ * Removes the task from the process task list.
+ */
+void taskingRemoveFromProcessTaskList(g_process* process, g_task* task);
+
 #endif
@@ -26,6 +26,17 @@
 #define G_TASKING_MEMORY_KERNEL_STACK_PAGES 2
 #define G_TASKING_MEMORY_USER_STACK_PAGES   10
 
+/**
+ * Number of pages that are mapped at once when a lazy page is accessed,
+ * starting at the faulting page. Setting this to 1 disables pre-faulting.
+ */
+#define G_TASKING_MEMORY_LAZY_CLUSTER_PAGES 4
+
+/**
+ * Initializes the global state of the task memory management.
+ */
+void taskingMemoryInitialize();
+
 /**
  * Extends the heap of the task by an amount.
  */
@@ -55,4 +66,50 @@ g_physical_address taskingMemoryCreatePageDirectory();
  */
 void taskingMemoryCreateInterruptStack(g_task* task);
 
+/**
+ * Resolves an access to a page of the process that is reserved but not yet
+ * mapped, meaning it is part of the heap, a lazy virtual range or a lazy area.
+ * Maps zeroed pages for it and up to {G_TASKING_MEMORY_LAZY_CLUSTER_PAGES}
+ * following pages. The address space of the process must be the current one.
+ *
+ * @return whether the page is mapped now
+ */
+bool taskingMemoryResolveLazyPage(g_process* process, g_virtual_address virtPage, uint32_t clusterPages = G_TASKING_MEMORY_LAZY_CLUSTER_PAGES);
+
+/**
+ * Maps all pages in the given range that are not yet mapped but would be
+ * resolved on access. Used before the kernel accesses such memory in a
+ * context where a page fault could not be resolved.
+ */
+void taskingMemoryResolveLazyRange(g_process* process, g_virtual_address start, g_virtual_address end);
+
+/**
+ * Adds a lazy area to the given list.
+ */
+void taskingMemoryAddLazyArea(g_lazy_area** areas, g_virtual_address start, g_virtual_address end);
+
+/**
+ * Maps zeroed pages for all unmapped pages of the range that are within one of
+ * the given areas. The address space must be the current one.
+ */
+void taskingMemoryResolveLazyAreas(g_lazy_area* areas, g_virtual_address start, g_virtual_address end);
+
+/**
+ * Frees a list of lazy areas.
+ */
+void taskingMemoryReleaseLazyAreas(g_lazy_area* areas);
+
+/**
+ * Makes all other processors that currently run a task of the process flush their
+ * TLB and waits until they have done so. Must be called after mappings of the process
+ * were changed or made read-only while other tasks of it may run.
+ */
+void taskingMemoryShootdown(g_process* process);
+
+/**
+ * Flushes the TLB of this processor if another processor has requested it. Called
+ * on the shootdown interrupt and while spinning with interrupts disabled.
+ */
+void taskingMemoryHandleShootdown();
+
 #endif
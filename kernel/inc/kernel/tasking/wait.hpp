@@ -22,6 +22,7 @@
 #define __KERNEL_WAIT__
 
 #include "ghost/types.h"
+#include "ghost/syscall_ring.h"
 #include "kernel/tasking/tasking.hpp"
 #include "kernel/filesystem/filesystem.hpp"
 
@@ -71,6 +72,28 @@ void waitForMessageSend(g_task* task);
  */
 void waitForMessageReceive(g_task* task);
 
+/**
+ * Lets the task wait until it is woken on the futex word it passed to the system call.
+ */
+void waitForFutex(g_task* task);
+
+/**
+ * Lets a kernel thread wait until a word in the memory it shares with a tasked file system
+ * delegate is no longer the value it has seen, or until the delegate process has exited.
+ */
+void waitForTaskedDelegate(g_task* task, volatile uint32_t* word, g_physical_address physicalWord, uint32_t seen, g_pid delegateProcess);
+
+/**
+ * Lets the kernel worker that drains a system call ring wait until the process submits
+ * entries, stops draining or its owning task has exited.
+ */
+void waitForSyscallRing(g_task* task, g_syscall_ring* ring, g_physical_address physicalSubmitted, uint32_t seen, g_tid owner);
+
+/**
+ * Lets the task wait until the channel word it passed to the system call changes.
+ */
+void waitForChannel(g_task* task);
+
 /**
  * Makes the task wait for the VM86 task and then copies the data from the <registerStore>
  * into the source tasks syscall data.
@@ -0,0 +1,64 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_WAIT_QUEUE__
+#define __KERNEL_WAIT_QUEUE__
+
+#include "ghost/kernel.h"
+#include "shared/system/mutex.hpp"
+
+/**
+ * Entry in a wait queue, referring to the waiting task by its id so that
+ * tasks that were removed meanwhile are simply skipped on waking.
+ */
+struct g_wait_queue_entry
+{
+	g_tid task;
+	g_wait_queue_entry* next;
+};
+
+/**
+ * A wait queue is attached to anything a task can wait for. Wait resolvers that
+ * can't finish yet add their task to the respective queue, the producer wakes the
+ * queue once something changed.
+ */
+struct g_wait_queue
+{
+	g_mutex lock;
+	g_wait_queue_entry* head;
+};
+
+/**
+ * Initializes an empty wait queue.
+ */
+void waitQueueInitialize(g_wait_queue* queue);
+
+/**
+ * Adds the task to the queue, if it is not already in it.
+ */
+void waitQueueAdd(g_wait_queue* queue, g_tid task);
+
+/**
+ * Empties the queue and wakes all tasks that were in it, so that their wait
+ * resolvers are called on the next schedule of their processor.
+ */
+void waitQueueWake(g_wait_queue* queue);
+
+#endif
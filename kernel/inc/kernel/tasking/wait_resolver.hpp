@@ -22,6 +22,7 @@
 #define __KERNEL_WAIT_RESOLVER__
 
 #include "ghost/types.h"
+#include "ghost/syscall_ring.h"
 #include "kernel/tasking/tasking.hpp"
 
 struct g_fs_node;
@@ -36,12 +37,43 @@ struct g_wait_resolver_atomic_lock_data
 	uint32_t startTime;
 };
 
+struct g_wait_resolver_receive_message_data
+{
+	uint32_t startTime;
+};
+
 struct g_wait_resolver_for_file_data
 {
 	bool (*waitResolverFromDelegate)(g_task*);
 	g_fs_virt_id nodeId;
 };
 
+struct g_wait_resolver_channel_data
+{
+	uint32_t startTime;
+};
+
+struct g_wait_resolver_futex_data
+{
+	uint32_t startTime;
+};
+
+struct g_wait_resolver_tasked_delegate_data
+{
+	volatile uint32_t* word;
+	g_physical_address physicalWord;
+	uint32_t seen;
+	g_pid delegateProcess;
+};
+
+struct g_wait_resolver_syscall_ring_data
+{
+	g_syscall_ring* ring;
+	g_physical_address physicalSubmitted;
+	uint32_t seen;
+	g_tid owner;
+};
+
 struct g_wait_resolver_join_data
 {
 	g_tid joinedTaskId;
@@ -63,6 +95,14 @@ bool waitResolverSendMessage(g_task* task);
 
 bool waitResolverReceiveMessage(g_task* task);
 
+bool waitResolverChannel(g_task* task);
+
+bool waitResolverFutex(g_task* task);
+
+bool waitResolverTaskedDelegate(g_task* task);
+
+bool waitResolverSyscallRing(g_task* task);
+
 bool waitResolverVm86(g_task* task);
 
 #endif
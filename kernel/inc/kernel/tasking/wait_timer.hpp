@@ -0,0 +1,43 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __KERNEL_WAIT_TIMER__
+#define __KERNEL_WAIT_TIMER__
+
+#include "kernel/tasking/tasking.hpp"
+
+/**
+ * Initializes the timers of the processor-local tasking structure.
+ */
+void waitTimerInitializeLocal(g_tasking_local* local);
+
+/**
+ * Adds a timer that wakes the task once the time of the processor it is assigned
+ * to has reached the given time.
+ */
+void waitTimerAdd(g_task* task, uint32_t time);
+
+/**
+ * Wakes the tasks of all timers that have expired. Must be called while holding
+ * the lock of the local.
+ */
+void waitTimerWakeExpired(g_tasking_local* local);
+
+#endif
@@ -30,6 +30,12 @@ struct g_bitmap_page_allocator
 	uint32_t freePageCount;
 	g_bitmap_entry* bitmap;
 	g_mutex lock;
+
+	/**
+	 * Index of the lowest bitmap entry that may contain a free page. All entries
+	 * below are known to be fully allocated, so searches start here.
+	 */
+	uint32_t searchStart;
 };
 
 void bitmapPageAllocatorInitialize(g_bitmap_page_allocator* allocator, g_bitmap_entry* bitmap);
@@ -40,4 +46,16 @@ void bitmapPageAllocatorMarkFree(g_bitmap_page_allocator* allocator, g_physical_
 
 g_physical_address bitmapPageAllocatorAllocate(g_bitmap_page_allocator* allocator);
 
+/**
+ * Allocates up to count pages while holding the lock only once.
+ *
+ * @return the number of pages written to out
+ */
+uint32_t bitmapPageAllocatorAllocateMultiple(g_bitmap_page_allocator* allocator, g_physical_address* out, uint32_t count);
+
+/**
+ * Marks all given pages as free while holding the lock only once.
+ */
+void bitmapPageAllocatorMarkFreeMultiple(g_bitmap_page_allocator* allocator, g_physical_address* addresses, uint32_t count);
+
 #endif
@@ -39,7 +39,10 @@
 
 #define G_CONST_KERNEL_AREA_START					0xC0000000
 #define G_CONST_KERNEL_HEAP_EXPAND_STEP				0x100000
-#define G_CONST_KERNEL_HEAP_END						0xF0000000
+#define G_CONST_KERNEL_HEAP_END						0xE0000000
+
+#define G_CONST_KERNEL_SLAB_AREA_START				0xE0000000	// pages for small kernel heap objects
+#define G_CONST_KERNEL_SLAB_AREA_END				0xF0000000
 
 #define G_CONST_KERNEL_VIRTUAL_RANGES_START			0xF0000000
 #define G_CONST_KERNEL_VIRTUAL_RANGES_END			0xFFB00000
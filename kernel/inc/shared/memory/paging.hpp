@@ -31,6 +31,7 @@ const uint32_t G_PAGE_TABLE_WRITETHROUGH = 8;
 const uint32_t G_PAGE_TABLE_CACHE_DISABLED = 16;
 const uint32_t G_PAGE_TABLE_ACCESSED = 32;
 const uint32_t G_PAGE_TABLE_SIZE = 64;
+const uint32_t G_PAGE_TABLE_COPY_ON_WRITE = 0x200; // available to software
 
 const uint32_t G_PAGE_PRESENT = 1;
 const uint32_t G_PAGE_READWRITE = 2;
@@ -40,6 +41,7 @@ const uint32_t G_PAGE_CACHE_DISABLED = 16;
 const uint32_t G_PAGE_ACCESSED = 32;
 const uint32_t G_PAGE_DIRTY = 64;
 const uint32_t G_PAGE_GLOBAL = 128;
+const uint32_t G_PAGE_COPY_ON_WRITE = 0x200; // available to software
 
 #define DEFAULT_KERNEL_TABLE_FLAGS (G_PAGE_TABLE_PRESENT | G_PAGE_TABLE_READWRITE)
 #define DEFAULT_KERNEL_PAGE_FLAGS (G_PAGE_PRESENT | G_PAGE_READWRITE | G_PAGE_GLOBAL)
@@ -34,6 +34,13 @@ int stringIndexOf(const char* str, char c);
 
 bool stringEquals(const char* stra, const char* strb);
 
+/**
+ * Compares the strings by their bytes as unsigned values.
+ *
+ * @return less than, equal to or greater than zero if a is less than, equal to or greater than b
+ */
+int stringCompare(const char* stra, const char* strb);
+
 bool stringEquals(const char* straStart, const char* straEnd, const char* strbStart, const char* strbEnd);
 
 bool stringEquals(const char* straStart, const char* straEnd, const char* strb);
@@ -22,6 +22,9 @@
 #include "kernel/calls/syscall.hpp"
 #include "kernel/memory/memory.hpp"
 #include "kernel/tasking/tasking.hpp"
+#include "kernel/tasking/scheduler.hpp"
+#include "kernel/tasking/tasking_memory.hpp"
+#include "kernel/memory/paging.hpp"
 #include "kernel/kernel.hpp"
 
 #include "kernel/calls/syscall_general.hpp"
@@ -30,6 +33,7 @@
 #include "kernel/calls/syscall_filesystem.hpp"
 #include "kernel/calls/syscall_vm86.hpp"
 #include "kernel/calls/syscall_messaging.hpp"
+#include "kernel/calls/syscall_ring.hpp"
 
 static g_syscall_registration* syscallRegistrations = 0;
 
@@ -56,25 +60,75 @@ void syscallHandle(g_task* task)
 	task->syscall.data = syscallData;
 
 	if(reg->threaded)
+	{
 		syscallRunThreaded(reg->handler, task, syscallData);
-	else
-		reg->handler(task, syscallData);
+		return;
+	}
+
+	// Map the call struct up front if it is in lazily mapped memory, so that the
+	// handler doesn't have to take the first access as a fault in the kernel
+	g_virtual_address dataPage = G_PAGE_ALIGN_DOWN((g_virtual_address) syscallData);
+	if(dataPage && dataPage < G_CONST_KERNEL_AREA_START && !pagingVirtualToPhysical(dataPage))
+		taskingMemoryResolveLazyPage(task->process, dataPage, 2);
+
+	reg->handler(task, syscallData);
 }
 
-void syscallRunThreaded(g_syscall_handler handler, g_task* caller, void* syscallData)
+/**
+ * Takes an idle worker from the pool of the local and attaches it to the process, or
+ * creates a new worker if the pool is empty.
+ */
+static g_task* syscallTakeWorker(g_tasking_local* local, g_process* process)
 {
-	g_tasking_local* local = taskingGetLocal();
 	mutexAcquire(&local->lock);
+	g_task* worker = local->syscallWorkers.pool;
+	if(worker)
+	{
+		local->syscallWorkers.pool = worker->syscall.poolNext;
+		local->syscallWorkers.poolSize--;
+	}
+	mutexRelease(&local->lock);
 
-	g_task* thread = caller->syscall.processingTask;
-	if(thread == 0)
+	if(!worker)
 	{
-		thread = taskingCreateThread(0, caller->process, G_SECURITY_LEVEL_KERNEL);
-		thread->type = G_THREAD_TYPE_SYSCALL;
-		thread->syscall.sourceTask = caller;
-		caller->syscall.processingTask = thread;
+		worker = taskingCreateThread(0, process, G_SECURITY_LEVEL_KERNEL);
+		worker->type = G_THREAD_TYPE_SYSCALL;
+		return worker;
 	}
 
+	worker->process = process;
+	taskingAddToProcessTaskList(process, worker);
+	return worker;
+}
+
+/**
+ * Puts a worker that has finished back into the pool. If the pool is full, the worker
+ * is left to the cleanup thread. Must be called while holding the lock of the local.
+ */
+static void syscallReleaseWorker(g_tasking_local* local, g_task* worker)
+{
+	if(local->syscallWorkers.poolSize < G_SYSCALL_WORKER_POOL_MAXIMUM)
+	{
+		worker->status = G_THREAD_STATUS_UNUSED;
+		worker->syscall.poolNext = local->syscallWorkers.pool;
+		local->syscallWorkers.pool = worker;
+		local->syscallWorkers.poolSize++;
+	} else
+	{
+		worker->status = G_THREAD_STATUS_DEAD;
+	}
+}
+
+void syscallRunThreaded(g_syscall_handler handler, g_task* caller, void* syscallData)
+{
+	g_tasking_local* local = taskingGetLocal();
+
+	g_task* thread = syscallTakeWorker(local, caller->process);
+	thread->syscall.sourceTask = caller;
+	caller->syscall.processingTask = thread;
+
+	mutexAcquire(&local->lock);
+
 	thread->state = (g_processor_state*) (thread->stack.end - sizeof(g_processor_state));
 	taskingResetTaskState(thread);
 	thread->status = G_THREAD_STATUS_RUNNING;
@@ -83,10 +137,11 @@ void syscallRunThreaded(g_syscall_handler handler, g_task* caller, void* syscall
 	// Let caller task wait
 	caller->status = G_THREAD_STATUS_WAITING;
 
-	// Put task in scheduling
-	taskingAssign(local, thread);
 	mutexRelease(&local->lock);
 
+	// Put task in scheduling; not holding the local lock, as the thread may still be assigned elsewhere
+	taskingAssign(local, thread);
+
 	taskingPleaseSchedule(thread);
 	taskingSchedule();
 }
@@ -94,16 +149,32 @@ void syscallRunThreaded(g_syscall_handler handler, g_task* caller, void* syscall
 void syscallThreadEntry()
 {
 	g_tasking_local* local = taskingGetLocal();
-	g_task* sourceTask = local->scheduling.current->syscall.sourceTask;
+	g_task* worker = local->scheduling.current;
+	g_task* sourceTask = worker->syscall.sourceTask;
 
 	// Call handler
 	sourceTask->syscall.handler(sourceTask, sourceTask->syscall.data);
 
+	// Detach from the process, unless it was killed meanwhile; then the worker is removed with it
+	g_process* process = worker->process;
+	mutexAcquire(&process->lock);
+	bool killed = worker->status == G_THREAD_STATUS_DEAD;
+	if(!killed)
+	{
+		taskingRemoveFromProcessTaskList(process, worker);
+		worker->process = local->scheduling.idleTask->process;
+	}
+	mutexRelease(&process->lock);
+
 	// Switch back to source task
 	mutexAcquire(&local->lock);
-	sourceTask->status = G_THREAD_STATUS_RUNNING;
-	local->scheduling.current->status = G_THREAD_STATUS_UNUSED;
+	sourceTask->syscall.processingTask = 0;
+	if(sourceTask->status != G_THREAD_STATUS_DEAD)
+		sourceTask->status = G_THREAD_STATUS_RUNNING;
+	if(!killed)
+		syscallReleaseWorker(local, worker);
 	mutexRelease(&local->lock);
+	schedulerWake(sourceTask);
 
 	taskingPleaseSchedule(sourceTask);
 	taskingKernelThreadYield();
@@ -118,6 +189,19 @@ void syscallRegister(int callId, g_syscall_handler handler, bool threaded)
 
 	syscallRegistrations[callId].handler = handler;
 	syscallRegistrations[callId].threaded = threaded;
+	syscallRegistrations[callId].batchable = threaded;
+}
+
+void syscallMarkBatchable(int callId)
+{
+	syscallRegistrations[callId].batchable = true;
+}
+
+g_syscall_registration* syscallGetRegistration(uint32_t callId)
+{
+	if(callId >= G_SYSCALL_MAX)
+		return 0;
+	return &syscallRegistrations[callId];
 }
 
 void syscallRegisterAll()
@@ -126,6 +210,7 @@ void syscallRegisterAll()
 	for(int i = 0; i < G_SYSCALL_MAX; i++)
 	{
 		syscallRegistrations[i].handler = 0;
+		syscallRegistrations[i].batchable = false;
 	}
 
 	syscallRegister(G_SYSCALL_EXIT, (g_syscall_handler) syscallExit, false);
@@ -137,6 +222,8 @@ void syscallRegisterAll()
 	syscallRegister(G_SYSCALL_JOIN, (g_syscall_handler) syscallJoin, false);
 	syscallRegister(G_SYSCALL_SLEEP, (g_syscall_handler) syscallSleep, false);
 	syscallRegister(G_SYSCALL_ATOMIC_LOCK, (g_syscall_handler) syscallAtomicLock, false);
+	syscallRegister(G_SYSCALL_FUTEX_WAIT, (g_syscall_handler) syscallFutexWait, false);
+	syscallRegister(G_SYSCALL_FUTEX_WAKE, (g_syscall_handler) syscallFutexWake, false);
 	syscallRegister(G_SYSCALL_LOG, (g_syscall_handler) syscallLog, false);
 	syscallRegister(G_SYSCALL_SET_VIDEO_LOG, (g_syscall_handler) syscallSetVideoLog, false);
 	syscallRegister(G_SYSCALL_TEST, (g_syscall_handler) syscallTest, false);
@@ -171,19 +258,60 @@ void syscallRegisterAll()
 	syscallRegister(G_SYSCALL_GET_TASK_FOR_IDENTIFIER, (g_syscall_handler) syscallGetTaskForIdentifier, false);
 	syscallRegister(G_SYSCALL_MESSAGE_SEND, (g_syscall_handler) syscallMessageSend, false);
 	syscallRegister(G_SYSCALL_MESSAGE_RECEIVE, (g_syscall_handler) syscallMessageReceive, false);
+	syscallRegister(G_SYSCALL_CHANNEL_WAIT, (g_syscall_handler) syscallChannelWait, false);
+	syscallRegister(G_SYSCALL_CHANNEL_WAKE, (g_syscall_handler) syscallChannelWake, false);
 
 	syscallRegister(G_SYSCALL_GET_MILLISECONDS, (g_syscall_handler) syscallGetMilliseconds, false);
 
-	syscallRegister(G_SYSCALL_FS_OPEN, (g_syscall_handler) syscallFsOpen, true);
-	syscallRegister(G_SYSCALL_FS_SEEK, (g_syscall_handler) syscallFsSeek, true);
+	// Calls that can block or copy large amounts of data are threaded, the others run directly
+	syscallRegister(G_SYSCALL_FS_OPEN, (g_syscall_handler) syscallFsOpen, false);
+	syscallRegister(G_SYSCALL_FS_SEEK, (g_syscall_handler) syscallFsSeek, false);
 	syscallRegister(G_SYSCALL_FS_READ, (g_syscall_handler) syscallFsRead, true);
 	syscallRegister(G_SYSCALL_FS_WRITE, (g_syscall_handler) syscallFsWrite, true);
+	syscallRegister(G_SYSCALL_FS_READV, (g_syscall_handler) syscallFsReadVector, true);
+	syscallRegister(G_SYSCALL_FS_WRITEV, (g_syscall_handler) syscallFsWriteVector, true);
 	syscallRegister(G_SYSCALL_FS_CLOSE, (g_syscall_handler) syscallFsClose, false);
 	syscallRegister(G_SYSCALL_FS_CLONEFD, (g_syscall_handler) syscallFsCloneFd, false);
-	syscallRegister(G_SYSCALL_FS_LENGTH, (g_syscall_handler) syscallFsLength, true);
+	syscallRegister(G_SYSCALL_FS_LENGTH, (g_syscall_handler) syscallFsLength, false);
 	syscallRegister(G_SYSCALL_FS_TELL, (g_syscall_handler) syscallFsTell, false);
-	syscallRegister(G_SYSCALL_FS_STAT, (g_syscall_handler) syscallFsStat, true);
-	syscallRegister(G_SYSCALL_FS_FSTAT, (g_syscall_handler) syscallFsFstat, true);
-	syscallRegister(G_SYSCALL_FS_PIPE, (g_syscall_handler) syscallFsPipe, true);
+	syscallRegister(G_SYSCALL_FS_STAT, (g_syscall_handler) syscallFsStat, false);
+	syscallRegister(G_SYSCALL_FS_FSTAT, (g_syscall_handler) syscallFsFstat, false);
+	syscallRegister(G_SYSCALL_FS_LIST_DIRECTORY, (g_syscall_handler) syscallFsListDirectory, true);
+	syscallRegister(G_SYSCALL_FS_PIPE, (g_syscall_handler) syscallFsPipe, false);
+	syscallRegister(G_SYSCALL_FS_PIPE_CAPACITY, (g_syscall_handler) syscallFsPipeCapacity, false);
+	syscallRegister(G_SYSCALL_FS_SPLICE, (g_syscall_handler) syscallFsSplice, true);
+	syscallRegister(G_SYSCALL_FS_TEE, (g_syscall_handler) syscallFsTee, true);
+	syscallRegister(G_SYSCALL_FS_REGISTER_AS_DELEGATE, (g_syscall_handler) syscallFsRegisterAsDelegate, false);
+	syscallRegister(G_SYSCALL_FS_SET_TRANSACTION_STATUS, (g_syscall_handler) syscallFsSetTransactionStatus, false);
+	syscallRegister(G_SYSCALL_FS_CREATE_NODE, (g_syscall_handler) syscallFsCreateNode, false);
+
+	syscallRegister(G_SYSCALL_RING_SUBMIT, (g_syscall_handler) syscallRingSubmit, true);
+	syscallRegister(G_SYSCALL_RING_DRAIN, (g_syscall_handler) syscallRingDrain, false);
+
+	// An entry is only completed after its handler returns, so a ring must not submit itself
+	syscallRegistrations[G_SYSCALL_RING_SUBMIT].batchable = false;
+
+	// Non-threaded calls that never let the caller wait may also be executed from a ring
+	syscallMarkBatchable(G_SYSCALL_GET_PROCESS_ID);
+	syscallMarkBatchable(G_SYSCALL_GET_TASK_ID);
+	syscallMarkBatchable(G_SYSCALL_GET_PROCESS_ID_FOR_TASK_ID);
+	syscallMarkBatchable(G_SYSCALL_LOG);
+	syscallMarkBatchable(G_SYSCALL_KERNQUERY);
+	syscallMarkBatchable(G_SYSCALL_GET_EXECUTABLE_PATH);
+	syscallMarkBatchable(G_SYSCALL_GET_PARENT_PROCESS_ID);
+	syscallMarkBatchable(G_SYSCALL_REGISTER_TASK_IDENTIFIER);
+	syscallMarkBatchable(G_SYSCALL_GET_TASK_FOR_IDENTIFIER);
+	syscallMarkBatchable(G_SYSCALL_MESSAGE_SEND);
+	syscallMarkBatchable(G_SYSCALL_GET_MILLISECONDS);
+	syscallMarkBatchable(G_SYSCALL_FS_OPEN);
+	syscallMarkBatchable(G_SYSCALL_FS_SEEK);
+	syscallMarkBatchable(G_SYSCALL_FS_CLOSE);
+	syscallMarkBatchable(G_SYSCALL_FS_CLONEFD);
+	syscallMarkBatchable(G_SYSCALL_FS_LENGTH);
+	syscallMarkBatchable(G_SYSCALL_FS_TELL);
+	syscallMarkBatchable(G_SYSCALL_FS_STAT);
+	syscallMarkBatchable(G_SYSCALL_FS_FSTAT);
+	syscallMarkBatchable(G_SYSCALL_FS_PIPE);
+	syscallMarkBatchable(G_SYSCALL_FS_PIPE_CAPACITY);
 }
 
@@ -21,12 +21,30 @@
 #include "kernel/calls/syscall_filesystem.hpp"
 #include "kernel/filesystem/filesystem.hpp"
 #include "kernel/filesystem/filesystem_process.hpp"
+#include "kernel/filesystem/filesystem_taskeddelegate.hpp"
+#include "kernel/calls/syscall.hpp"
 #include "shared/logger/logger.hpp"
 
+/**
+ * Delegates that are served by a process can only be waited for from a kernel thread, so
+ * when they report to be busy on a direct call, the call is repeated on a worker.
+ */
+static bool syscallFsRetryThreaded(g_task* task, g_syscall_handler handler, void* data)
+{
+	if(taskingGetCurrentTask() != task)
+		return false;
+
+	syscallRunThreaded(handler, task, data);
+	return true;
+}
+
 void syscallFsOpen(g_task* task, g_syscall_fs_open* data)
 {
 	g_fd fd;
 	data->status = filesystemOpen(data->path, data->flags, task, &fd);
+	if(data->status == G_FS_OPEN_BUSY && syscallFsRetryThreaded(task, (g_syscall_handler) syscallFsOpen, data))
+		return;
+
 	if(data->status == G_FS_OPEN_SUCCESSFUL)
 	{
 		data->fd = fd;
@@ -59,21 +77,70 @@ void syscallFsWrite(g_task* task, g_syscall_fs_write* data)
 	}
 }
 
+void syscallFsReadVector(g_task* task, g_syscall_fs_readv* data)
+{
+	if(data->count > G_FS_IOV_MAX || (data->positional && data->offset < 0))
+	{
+		data->status = G_FS_READ_ERROR;
+		data->result = G_FD_NONE;
+		return;
+	}
+
+	data->status = filesystemReadVector(task, data->fd, data->vectors, data->count, data->positional ? data->offset : -1, &data->result);
+	if(data->status != G_FS_READ_SUCCESSFUL)
+	{
+		data->result = G_FD_NONE;
+	}
+}
+
+void syscallFsWriteVector(g_task* task, g_syscall_fs_writev* data)
+{
+	if(data->count > G_FS_IOV_MAX || (data->positional && data->offset < 0))
+	{
+		data->status = G_FS_WRITE_ERROR;
+		data->result = G_FD_NONE;
+		return;
+	}
+
+	data->status = filesystemWriteVector(task, data->fd, data->vectors, data->count, data->positional ? data->offset : -1, &data->result);
+	if(data->status != G_FS_WRITE_SUCCESSFUL)
+	{
+		data->result = G_FD_NONE;
+	}
+}
+
 void syscallFsClose(g_task* task, g_syscall_fs_close* data)
 {
-	data->status = filesystemClose(task->process->id, data->fd, true);
+	data->status = filesystemClose(task->process, data->fd, true);
 }
 
 void syscallFsLength(g_task* task, g_syscall_fs_length* data)
 {
 	uint64_t length;
 	data->status = filesystemGetLength(task, data->fd, &length);
+	if(data->status == G_FS_LENGTH_BUSY && syscallFsRetryThreaded(task, (g_syscall_handler) syscallFsLength, data))
+		return;
+
 	data->length = length;
 }
 
+/**
+ * Finds the process with the given id, which is the id of its main task.
+ */
+static g_process* syscallFsGetProcess(g_pid pid)
+{
+	g_task* task = taskingGetById(pid);
+	if(!task || task->process->id != pid)
+		return 0;
+	return task->process;
+}
+
 void syscallFsCloneFd(g_task* task, g_syscall_fs_clonefd* data)
 {
-	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(data->source_pid, data->source_fd);
+	g_process* source = syscallFsGetProcess(data->source_pid);
+	g_process* target = syscallFsGetProcess(data->target_pid);
+
+	g_file_descriptor* descriptor = source ? filesystemProcessGetDescriptor(source, data->source_fd) : 0;
 	if(!descriptor)
 	{
 		data->status = G_FS_CLONEFD_INVALID_SOURCE_FD;
@@ -81,7 +148,7 @@ void syscallFsCloneFd(g_task* task, g_syscall_fs_clonefd* data)
 		return;
 	}
 
-	g_file_descriptor* clone = filesystemProcessCloneDescriptor(descriptor, data->target_pid, data->target_fd);
+	g_file_descriptor* clone = target ? filesystemProcessCloneDescriptor(descriptor, target, data->target_fd) : 0;
 	if(!clone)
 	{
 		data->result = G_FD_NONE;
@@ -96,7 +163,7 @@ void syscallFsCloneFd(g_task* task, g_syscall_fs_clonefd* data)
 void syscallFsTell(g_task* task, g_syscall_fs_tell* data)
 {
 
-	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process->id, data->fd);
+	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process, data->fd);
 	if(!descriptor)
 	{
 		data->status = G_FS_TELL_INVALID_FD;
@@ -110,12 +177,22 @@ void syscallFsTell(g_task* task, g_syscall_fs_tell* data)
 
 void syscallFsStat(g_task* task, g_syscall_fs_stat* data)
 {
-	logInfo("%! stat not implemented", "syscall");
+	// There are no symbolic links, so follow_symlinks makes no difference
+	data->result = filesystemStat(task, data->path, &data->stats);
+	if(data->result == G_FS_STAT_BUSY)
+		syscallFsRetryThreaded(task, (g_syscall_handler) syscallFsStat, data);
 }
 
 void syscallFsFstat(g_task* task, g_syscall_fs_fstat* data)
 {
-	logInfo("%! fstat not implemented", "syscall");
+	data->result = filesystemStat(task, data->fd, &data->stats);
+	if(data->result == G_FS_STAT_BUSY)
+		syscallFsRetryThreaded(task, (g_syscall_handler) syscallFsFstat, data);
+}
+
+void syscallFsListDirectory(g_task* task, g_syscall_fs_list_directory* data)
+{
+	data->status = filesystemListDirectory(task, data->fd, data->buffer, data->length, &data->result);
 }
 
 void syscallFsPipe(g_task* task, g_syscall_fs_pipe* data)
@@ -144,7 +221,7 @@ void syscallFsPipe(g_task* task, g_syscall_fs_pipe* data)
 	g_fs_open_status readOpen = filesystemOpen(pipeNode, readFlags, task, &data->read_fd);
 	if(readOpen != G_FS_OPEN_SUCCESSFUL)
 	{
-		if(filesystemClose(task->process->id, writeOpen, true) != G_FS_CLOSE_SUCCESSFUL)
+		if(filesystemClose(task->process, writeOpen, true) != G_FS_CLOSE_SUCCESSFUL)
 		{
 			logInfo("%! failed to close write end of pipe %i for task %i after failing to open read end", "filesystem", pipeNode->id, task->id);
 		}
@@ -155,3 +232,49 @@ void syscallFsPipe(g_task* task, g_syscall_fs_pipe* data)
 
 	data->status = G_FS_PIPE_SUCCESSFUL;
 }
+
+void syscallFsPipeCapacity(g_task* task, g_syscall_fs_pipe_capacity* data)
+{
+	data->status = filesystemPipeCapacity(task, data->fd, data->set, &data->capacity);
+}
+
+void syscallFsSplice(g_task* task, g_syscall_fs_splice* data)
+{
+	data->status = filesystemSplice(task, data->in, data->out, data->length, &data->result);
+}
+
+void syscallFsTee(g_task* task, g_syscall_fs_splice* data)
+{
+	data->status = filesystemTee(task, data->in, data->out, data->length, &data->result);
+}
+
+void syscallFsRegisterAsDelegate(g_task* task, g_syscall_fs_register_as_delegate* data)
+{
+	if(task->securityLevel > G_SECURITY_LEVEL_DRIVER)
+	{
+		data->result = G_FS_REGISTER_AS_DELEGATE_FAILED_DELEGATE_CREATION;
+		return;
+	}
+
+	data->result = filesystemTaskedDelegateRegister(task, data->name, data->phys_mountpoint_id, &data->mountpoint_id, &data->transaction_storage);
+}
+
+void syscallFsSetTransactionStatus(g_task* task, g_syscall_fs_set_transaction_status* data)
+{
+	if(task->securityLevel > G_SECURITY_LEVEL_DRIVER)
+		return;
+
+	if(!filesystemTaskedDelegateSetTransactionStatus(task, data->transaction, data->status))
+		logInfo("%! task %i tried to finish unknown transaction %h", "filesystem", task->id, (uint32_t) data->transaction);
+}
+
+void syscallFsCreateNode(g_task* task, g_syscall_fs_create_node* data)
+{
+	if(task->securityLevel > G_SECURITY_LEVEL_DRIVER)
+	{
+		data->result = G_FS_CREATE_NODE_STATUS_FAILED_NO_PARENT;
+		return;
+	}
+
+	data->result = filesystemTaskedDelegateCreateNode(task, data->parent_id, data->name, data->type, data->phys_fs_id, &data->created_id);
+}
@@ -20,6 +20,8 @@
 
 #include "kernel/calls/syscall_general.hpp"
 #include "kernel/tasking/wait.hpp"
+#include "kernel/tasking/scheduler.hpp"
+#include "kernel/tasking/futex.hpp"
 
 #include "kernel/memory/heap.hpp"
 #include "shared/logger/logger.hpp"
@@ -27,6 +29,16 @@
 
 void syscallAtomicLock(g_task* task, g_syscall_atomic_lock* data)
 {
+	// single atoms are also taken in userspace, so they must be set atomically
+	if (data->set_on_finish && !data->atom_2) {
+		data->was_set = __sync_bool_compare_and_swap(data->atom_1, 0, 1);
+		if (!data->was_set && !data->is_try) {
+			waitAtomicLock(task);
+			taskingSchedule();
+		}
+		return;
+	}
+
 	// try to immediately resolve it
 	if (data->is_try) {
 		if (*data->atom_1 && (!data->atom_2 || *data->atom_2)) {
@@ -59,6 +71,29 @@ void syscallAtomicLock(g_task* task, g_syscall_atomic_lock* data)
 	}
 }
 
+void syscallFutexWait(g_task* task, g_syscall_futex_wait* data)
+{
+	if(!futexCheckAddress(task->process, data->address))
+	{
+		data->status = G_FUTEX_WAIT_STATUS_INVALID;
+		return;
+	}
+
+	if(!futexEnqueue(task, data->address, data->expected))
+	{
+		data->status = G_FUTEX_WAIT_STATUS_CHANGED;
+		return;
+	}
+
+	waitForFutex(task);
+	taskingSchedule();
+}
+
+void syscallFutexWake(g_task* task, g_syscall_futex_wake* data)
+{
+	data->woken = futexWake(task->process, data->address, data->count);
+}
+
 void syscallLog(g_task* task, g_syscall_log* data)
 {
 	logInfo("%! %i: %s", "log", task->id, data->message);
@@ -133,6 +168,7 @@ void syscallSetWorkingDirectory(g_task* task, g_syscall_fs_set_working_directory
 			int length = filesystemGetAbsolutePathLength(child);
 			task->process->environment.workingDirectory = (char*) heapAllocate(length + 1);
 			filesystemGetAbsolutePath(child, task->process->environment.workingDirectory);
+			task->process->environment.workingDirectoryNode = child;
 			data->result = G_SET_WORKING_DIRECTORY_SUCCESSFUL;
 		} else
 		{
@@ -149,9 +185,41 @@ void syscallSetWorkingDirectory(g_task* task, g_syscall_fs_set_working_directory
 	}
 }
 
-void syscallKernQuery(g_task* task, g_syscall_fs_set_working_directory* data)
+void syscallKernQuery(g_task* task, g_syscall_kernquery* data)
 {
-	logInfo("syscall not implemented: syscallKernQuery");
-	for(;;)
-		;
+	if(data->command == G_KERNQUERY_PROCESSOR_COUNT)
+	{
+		g_kernquery_processor_count_data* countData = (g_kernquery_processor_count_data*) data->buffer;
+		countData->count = processorGetNumberOfProcessors();
+		data->status = G_KERNQUERY_STATUS_SUCCESSFUL;
+
+	} else if(data->command == G_KERNQUERY_PROCESSOR_GET)
+	{
+		g_kernquery_processor_get_data* getData = (g_kernquery_processor_get_data*) data->buffer;
+		if(getData->position < processorGetNumberOfProcessors() && taskingGetLocalForProcessor(getData->position)->ready)
+		{
+			g_tasking_local* local = taskingGetLocalForProcessor(getData->position);
+			mutexAcquire(&local->lock);
+			getData->found = true;
+			getData->task_count = local->scheduling.taskCount;
+			getData->runnable_count = schedulerGetLoad(local);
+			getData->waiting_count = local->scheduling.waitQueue.length + local->scheduling.checkQueue.length;
+			getData->current = local->scheduling.current ? local->scheduling.current->id : -1;
+			mutexRelease(&local->lock);
+		} else
+		{
+			getData->found = false;
+		}
+		data->status = G_KERNQUERY_STATUS_SUCCESSFUL;
+
+	} else if(data->command == G_KERNQUERY_HEAP_GET)
+	{
+		heapGetStatistics((g_kernquery_heap_get_data*) data->buffer);
+		data->status = G_KERNQUERY_STATUS_SUCCESSFUL;
+
+	} else
+	{
+		logDebug("%! task %i used unknown query %h", "kernquery", task->id, data->command);
+		data->status = G_KERNQUERY_STATUS_UNKNOWN_ID;
+	}
 }
\ No newline at end of file
@@ -54,45 +54,13 @@ void syscallAllocateMemory(g_task* task, g_syscall_alloc_mem* data)
 {
 	data->virtualResult = 0;
 
-	uint32_t pages = G_PAGE_ALIGN_UP(data->size);
+	uint32_t pages = G_PAGE_ALIGN_UP(data->size) / G_PAGE_SIZE;
 	if(pages == 0) return;
 
-	/* Prepare a virtual range */
-	g_virtual_address mapped = addressRangePoolAllocate(task->process->virtualRangePool, pages);
+	/* Reserve a virtual range, pages are mapped on first access */
+	g_virtual_address mapped = addressRangePoolAllocate(task->process->virtualRangePool, pages, G_PROC_VIRTUAL_RANGE_FLAG_LAZY);
 	if(mapped == 0) return;
 
-	/* Try to allocate physical memory */
-	bool failedPhysical = false;
-	for (uint32_t i = 0; i < pages; i++)
-	{
-		g_physical_address page = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
-		if(!page)
-		{
-			failedPhysical = true;
-			break;
-		}
-		pagingMapPage(mapped + i * G_PAGE_SIZE, page, DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
-		pageReferenceTrackerIncrement(page);
-	}
-
-	/* If physical mapping fails, clean up allocated memory */
-	if(failedPhysical)
-	{
-		logInfo("%! ran out of physical memory during allocate-memory syscall in %i", "syscall", task->id);
-		for(uint32_t i = 0; i < pages; i++)
-		{
-			g_physical_address page = pagingVirtualToPhysical(mapped + i * G_PAGE_SIZE);
-			if(page)
-			{
-				bitmapPageAllocatorMarkFree(&memoryPhysicalAllocator, page);
-				pageReferenceTrackerDecrement(page);
-			}
-		}
-		addressRangePoolFree(task->process->virtualRangePool, mapped);
-		return;
-	}
-
-	/* Mapping successful */
 	data->virtualResult = (void*) mapped;
 }
 
@@ -101,19 +69,30 @@ void syscallUnmap(g_task* task, g_syscall_unmap* data)
 	g_address_range* range = addressRangePoolFind(task->process->virtualRangePool, data->virtualBase);
 	if(!range) return;
 
-	/* Unmap all pages in the range */
+	/* Unmap all pages in the range, freed pages are given back in batches */
+	g_physical_address freed[G_PHYSICAL_PAGE_CACHE_BATCH];
+	uint32_t freedCount = 0;
 	for(uint32_t i = 0; i < range->pages; i++)
 	{
 		g_virtual_address virt = range->base + i * G_PAGE_SIZE;
 		g_physical_address page = pagingVirtualToPhysical(virt);
 		if(!page) continue;
 
+		pagingUnmapPage(virt);
+
 		/* Free physical memory if possible */
 		if((range->flags & G_PROC_VIRTUAL_RANGE_FLAG_WEAK) == 0 && pageReferenceTrackerDecrement(page) == 0)
-			bitmapPageAllocatorMarkFree(&memoryPhysicalAllocator, page);
-
-		pagingUnmapPage(virt);
+		{
+			freed[freedCount++] = page;
+			if(freedCount == G_PHYSICAL_PAGE_CACHE_BATCH)
+			{
+				memoryPhysicalFreeMultiple(freed, freedCount);
+				freedCount = 0;
+			}
+		}
 	}
+	if(freedCount > 0)
+		memoryPhysicalFreeMultiple(freed, freedCount);
 
 	/* Free range */
 	addressRangePoolFree(task->process->virtualRangePool, range->base);
@@ -149,6 +128,9 @@ void syscallShareMemory(g_task* task, g_syscall_share_mem* data)
 		return;
 	}
 
+	/* Pages that were never accessed must exist before they can be shared */
+	taskingMemoryResolveLazyRange(task->process, memory, memory + pages * G_PAGE_SIZE);
+
 	/* Map required pages */
 	for (uint32_t i = 0; i < pages; i++) {
 		g_physical_address physicalAddr = pagingVirtualToPhysical(memory + i * G_PAGE_SIZE);
@@ -22,6 +22,7 @@
 #include "shared/logger/logger.hpp"
 #include "kernel/tasking/tasking_directory.hpp"
 #include "kernel/ipc/message.hpp"
+#include "kernel/ipc/channel.hpp"
 #include "kernel/tasking/wait.hpp"
 
 void syscallRegisterTaskIdentifier(g_task* task, g_syscall_task_id_register* data)
@@ -36,12 +37,25 @@ void syscallGetTaskForIdentifier(g_task* task, g_syscall_task_id_get* data)
 
 void syscallMessageSend(g_task* task, g_syscall_send_message* data)
 {
-	data->status = messageSend(task->id, data->receiver, data->buffer, data->length, data->transaction);
+	data->status = messageSend(task->id, data->receiver, data->buffer, data->length, data->transaction, data->transfer, data->transferLength,
+			data->transferMode);
 
 	if(data->mode == G_MESSAGE_SEND_MODE_BLOCKING && data->status == G_MESSAGE_SEND_STATUS_QUEUE_FULL)
 	{
-		waitForMessageSend(task);
-		taskingSchedule();
+		if(taskingGetCurrentTask() == task)
+		{
+			waitForMessageSend(task);
+			taskingSchedule();
+			return;
+		}
+
+		// Called from a worker on behalf of the task, so the worker waits itself
+		while(data->status == G_MESSAGE_SEND_STATUS_QUEUE_FULL)
+		{
+			taskingKernelThreadYield();
+			data->status = messageSend(task->id, data->receiver, data->buffer, data->length, data->transaction, data->transfer, data->transferLength,
+					data->transferMode);
+		}
 	}
 }
 
@@ -55,3 +69,26 @@ void syscallMessageReceive(g_task* task, g_syscall_receive_message* data)
 		taskingSchedule();
 	}
 }
+
+void syscallChannelWait(g_task* task, g_syscall_channel_wait* data)
+{
+	if(!channelGetWordAddress(task->process, data->address))
+	{
+		data->status = G_CHANNEL_WAIT_STATUS_INVALID;
+		return;
+	}
+
+	if(*data->address != data->expected)
+	{
+		data->status = G_CHANNEL_WAIT_STATUS_CHANGED;
+		return;
+	}
+
+	waitForChannel(task);
+	taskingSchedule();
+}
+
+void syscallChannelWake(g_task* task, g_syscall_channel_wake* data)
+{
+	channelWake(task->process, data->address);
+}
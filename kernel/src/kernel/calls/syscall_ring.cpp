@@ -0,0 +1,186 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/calls/syscall_ring.hpp"
+#include "kernel/calls/syscall.hpp"
+#include "kernel/tasking/scheduler.hpp"
+#include "kernel/tasking/wait.hpp"
+#include "kernel/ipc/channel.hpp"
+#include "kernel/memory/heap.hpp"
+#include "shared/memory/constants.hpp"
+#include "shared/logger/logger.hpp"
+
+/**
+ * Information for a kernel worker that drains a ring.
+ */
+struct g_syscall_ring_drainer
+{
+	g_syscall_ring* ring;
+	uint32_t size;
+	g_physical_address physicalSubmitted;
+	g_tid owner;
+};
+
+/**
+ * Checks that the ring lies in user space, with its header within one page, and reads
+ * its size. The process may change the size afterwards, so only the returned value may
+ * be used to address entries.
+ *
+ * @return the size of the ring or 0 if it is not valid
+ */
+static uint32_t syscallRingGetValidSize(g_syscall_ring* ring)
+{
+	g_virtual_address start = (g_virtual_address) ring;
+	if(!ring || start >= G_CONST_KERNEL_AREA_START || (start & 3))
+		return 0;
+	if(G_PAGE_ALIGN_DOWN(start) != G_PAGE_ALIGN_DOWN(start + sizeof(g_syscall_ring) - 1))
+		return 0;
+
+	uint32_t size = ring->size;
+	if(size == 0 || size > G_SYSCALL_RING_MAXIMUM_SIZE || (size & (size - 1)) != 0)
+		return 0;
+
+	if(start + sizeof(g_syscall_ring) + size * sizeof(g_syscall_ring_entry) > G_CONST_KERNEL_AREA_START)
+		return 0;
+	return size;
+}
+
+/**
+ * Executes the pending entries of the ring on behalf of the task. Must be called from a
+ * worker or another kernel thread of the process, as the handlers may block. At most
+ * one round of the ring is executed per call.
+ *
+ * @return the number of entries that were executed
+ */
+static uint32_t syscallRingExecute(g_task* task, g_syscall_ring* ring, uint32_t size, bool stopAtUnsupported)
+{
+	uint32_t executed = 0;
+	uint32_t submitted = ring->submitted;
+	for(uint32_t round = 0; round < size && ring->completed != submitted; round++)
+	{
+		g_syscall_ring_entry* entry = &G_SYSCALL_RING_ENTRIES(ring)[ring->completed & (size - 1)];
+		g_syscall_registration* reg = syscallGetRegistration(entry->call);
+
+		bool unsupported = false;
+		if(!reg || !reg->handler)
+		{
+			entry->status = G_SYSCALL_RING_ENTRY_INVALID;
+		} else if(!reg->batchable)
+		{
+			entry->status = G_SYSCALL_RING_ENTRY_UNSUPPORTED;
+			unsupported = true;
+		} else
+		{
+			reg->handler(task, (void*) entry->data);
+			entry->status = G_SYSCALL_RING_ENTRY_DONE;
+			executed++;
+		}
+		ring->completed = ring->completed + 1;
+
+		if(unsupported && stopAtUnsupported)
+			break;
+	}
+	return executed;
+}
+
+void syscallRingSubmit(g_task* task, g_syscall_ring_submit* data)
+{
+	data->executed = 0;
+	uint32_t size = syscallRingGetValidSize(data->ring);
+	if(!size || data->ring->draining)
+	{
+		data->status = G_SYSCALL_RING_STATUS_INVALID;
+		return;
+	}
+
+	data->executed = syscallRingExecute(task, data->ring, size, true);
+	data->status = G_SYSCALL_RING_STATUS_SUCCESSFUL;
+}
+
+void syscallRingDrain(g_task* task, g_syscall_ring_drain* data)
+{
+	data->worker = G_TID_NONE;
+	uint32_t size = syscallRingGetValidSize(data->ring);
+	if(!size || data->ring->draining)
+	{
+		data->status = G_SYSCALL_RING_STATUS_INVALID;
+		return;
+	}
+
+	// The worker sleeps on the submitted counter until the process wakes it
+	g_physical_address physicalSubmitted = channelGetWordAddress(task->process, &data->ring->submitted);
+	if(!physicalSubmitted)
+	{
+		data->status = G_SYSCALL_RING_STATUS_INVALID;
+		return;
+	}
+
+	g_syscall_ring_drainer* drainer = (g_syscall_ring_drainer*) heapAllocate(sizeof(g_syscall_ring_drainer));
+	drainer->ring = data->ring;
+	drainer->size = size;
+	drainer->physicalSubmitted = physicalSubmitted;
+	drainer->owner = task->id;
+
+	g_task* worker = taskingCreateThread((g_virtual_address) syscallRingDrainThread, task->process, G_SECURITY_LEVEL_KERNEL);
+	worker->syscall.data = drainer;
+	data->ring->worker_waiting = 0;
+	data->ring->draining = 1;
+	taskingAssignBalanced(worker);
+
+	data->worker = worker->id;
+	data->status = G_SYSCALL_RING_STATUS_SUCCESSFUL;
+}
+
+void syscallRingDrainThread()
+{
+	g_task* self = taskingGetCurrentTask();
+	g_syscall_ring_drainer* drainer = (g_syscall_ring_drainer*) self->syscall.data;
+	g_syscall_ring* ring = drainer->ring;
+
+	for(;;)
+	{
+		g_task* owner = taskingGetById(drainer->owner);
+		if(!owner || owner->status == G_THREAD_STATUS_DEAD)
+			break;
+
+		// Stop if the ring was unmapped or its size changed since it was validated
+		if(channelGetWordAddress(self->process, &ring->submitted) != drainer->physicalSubmitted)
+			break;
+		if(ring->size != drainer->size || !ring->draining)
+			break;
+
+		syscallRingExecute(owner, ring, drainer->size, false);
+
+		// Announce the sleep before checking again, so that the process either sees
+		// the flag or the worker sees the new entries
+		__atomic_store_n(&ring->worker_waiting, 1, __ATOMIC_SEQ_CST);
+		uint32_t seen = __atomic_load_n(&ring->submitted, __ATOMIC_SEQ_CST);
+		if(seen == ring->completed)
+		{
+			waitForSyscallRing(self, ring, drainer->physicalSubmitted, seen, drainer->owner);
+			taskingKernelThreadYield();
+		}
+		__atomic_store_n(&ring->worker_waiting, 0, __ATOMIC_SEQ_CST);
+	}
+
+	self->syscall.data = 0;
+	heapFree(drainer);
+	taskingKernelThreadExit();
+}
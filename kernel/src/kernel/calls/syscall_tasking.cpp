@@ -196,7 +196,8 @@ void syscallCreateThread(g_task* task, g_syscall_create_thread* data)
 	{
 		data->status = G_CREATE_THREAD_STATUS_FAILED;
 	}
-	taskingAssign(taskingGetLocal(), thread);
+	if(thread)
+		taskingAssignBalanced(thread);
 
 	mutexRelease(&task->process->lock);
 }
@@ -209,9 +210,22 @@ void syscallGetThreadEntry(g_task* task, g_syscall_get_thread_entry* data)
 
 void syscallFork(g_task* task, g_syscall_fork* data)
 {
-	logInfo("syscall not implemented: fork");
-	for(;;)
-		;
+	/* Only the calling thread is duplicated into the new process */
+	if(task != task->process->main)
+	{
+		logInfo("%! task %i tried to fork from a thread that is not the main thread", "tasking", task->id);
+		data->forkedId = G_TID_NONE;
+		return;
+	}
+
+	// Written before the copy, so that the child sees zero
+	data->forkedId = 0;
+
+	g_task* child = taskingForkProcess(task);
+	taskingAssignBalanced(child);
+
+	// Write faults into a private copy of the page
+	data->forkedId = child->id;
 }
 
 void syscallGetParentProcessId(g_task* task, g_syscall_get_parent_pid* data)
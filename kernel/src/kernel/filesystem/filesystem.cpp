@@ -20,13 +20,18 @@
 
 #include "kernel/filesystem/filesystem.hpp"
 #include "kernel/filesystem/filesystem_process.hpp"
+#include "kernel/filesystem/filesystem_dentry_cache.hpp"
 #include "kernel/filesystem/filesystem_ramdiskdelegate.hpp"
 #include "kernel/filesystem/filesystem_pipedelegate.hpp"
+#include "kernel/filesystem/filesystem_taskeddelegate.hpp"
+#include "kernel/filesystem/filesystem_tmpfsdelegate.hpp"
+#include "kernel/filesystem/tmpfs.hpp"
 #include "kernel/tasking/tasking.hpp"
 #include "kernel/tasking/wait.hpp"
 #include "kernel/memory/memory.hpp"
 #include "kernel/ipc/pipes.hpp"
 #include "kernel/kernel.hpp"
+#include "kernel/utils/hashmap.hpp"
 
 #include "shared/system/mutex.hpp"
 #include "shared/utils/string.hpp"
@@ -46,8 +51,9 @@ void filesystemInitialize()
 	filesystemNextNodeId = 0;
 
 	filesystemNodes = hashmapCreateNumeric<g_fs_virt_id, g_fs_node*>(1024);
+	filesystemDentryCacheInitialize();
+	filesystemTaskedDelegateInitialize();
 
-	filesystemProcessInitialize();
 	filesystemCreateRoot();
 }
 
@@ -58,16 +64,20 @@ void filesystemCreateRoot()
 	ramdiskDelegate->open = filesystemRamdiskDelegateOpen;
 	ramdiskDelegate->discover = filesystemRamdiskDelegateDiscover;
 	ramdiskDelegate->read = filesystemRamdiskDelegateRead;
+	ramdiskDelegate->readv = filesystemRamdiskDelegateReadVector;
 	ramdiskDelegate->write = filesystemRamdiskDelegateWrite;
 	ramdiskDelegate->truncate = filesystemRamdiskDelegateTruncate;
 	ramdiskDelegate->create = filesystemRamdiskDelegateCreate;
 	ramdiskDelegate->getLength = filesystemRamdiskDelegateGetLength;
 	ramdiskDelegate->close = filesystemRamdiskDelegateClose;
+	ramdiskDelegate->refreshDirectory = filesystemRamdiskDelegateRefreshDirectory;
 
 	filesystemRoot = filesystemCreateNode(G_FS_NODE_TYPE_ROOT, "root");
 	filesystemRoot->delegate = ramdiskDelegate;
 
+	// Children of virtual folders are all in the node tree already
 	mountFolder = filesystemCreateNode(G_FS_NODE_TYPE_FOLDER, "mount");
+	mountFolder->upToDate = true;
 	filesystemAddChild(filesystemRoot, mountFolder);
 
 	g_fs_node* ramdiskMountpoint = filesystemCreateNode(G_FS_NODE_TYPE_MOUNTPOINT, "ramdisk");
@@ -80,6 +90,8 @@ void filesystemCreateRoot()
 	pipeDelegate->open = filesystemPipeDelegateOpen;
 	pipeDelegate->read = filesystemPipeDelegateRead;
 	pipeDelegate->write = filesystemPipeDelegateWrite;
+	pipeDelegate->readv = filesystemPipeDelegateReadVector;
+	pipeDelegate->writev = filesystemPipeDelegateWriteVector;
 	pipeDelegate->truncate = filesystemPipeDelegateTruncate;
 	pipeDelegate->getLength = filesystemPipeDelegateGetLength;
 	pipeDelegate->waitResolverRead = filesystemPipeDelegateWaitResolverRead;
@@ -88,7 +100,25 @@ void filesystemCreateRoot()
 
 	pipesFolder = filesystemCreateNode(G_FS_NODE_TYPE_FOLDER, "pipes");
 	pipesFolder->delegate = pipeDelegate;
+	pipesFolder->upToDate = true;
 	filesystemAddChild(mountFolder, pipesFolder);
+
+	// Mount tmpfs
+	tmpfsInitialize();
+	g_fs_delegate* tmpfsDelegate = filesystemCreateDelegate();
+	tmpfsDelegate->open = filesystemTmpfsDelegateOpen;
+	tmpfsDelegate->close = filesystemTmpfsDelegateClose;
+	tmpfsDelegate->discover = filesystemTmpfsDelegateDiscover;
+	tmpfsDelegate->read = filesystemTmpfsDelegateRead;
+	tmpfsDelegate->write = filesystemTmpfsDelegateWrite;
+	tmpfsDelegate->getLength = filesystemTmpfsDelegateGetLength;
+	tmpfsDelegate->create = filesystemTmpfsDelegateCreate;
+	tmpfsDelegate->truncate = filesystemTmpfsDelegateTruncate;
+
+	g_fs_node* tmpfsMountpoint = filesystemCreateNode(G_FS_NODE_TYPE_MOUNTPOINT, "tmp");
+	tmpfsMountpoint->delegate = tmpfsDelegate;
+	tmpfsMountpoint->upToDate = true;
+	filesystemAddChild(mountFolder, tmpfsMountpoint);
 }
 
 g_fs_node* filesystemCreateNode(g_fs_node_type type, const char* name)
@@ -116,10 +146,41 @@ void filesystemAddChild(g_fs_node* parent, g_fs_node* child)
 
 	g_fs_node_entry* entry = (g_fs_node_entry*) heapAllocate(sizeof(g_fs_node_entry));
 	entry->node = child;
-	entry->next = child->children;
-	child->children = entry;
+	entry->next = parent->children;
+	parent->children = entry;
 
 	mutexRelease(&delegate->lock);
+
+	// Also replaces a negative entry that was added before the child existed
+	filesystemDentryCachePut(parent, child->name, child);
+}
+
+void filesystemRemoveChild(g_fs_node* parent, g_fs_node* child)
+{
+	g_fs_delegate* delegate = filesystemFindDelegate(parent);
+	mutexAcquire(&delegate->lock);
+
+	g_fs_node_entry* previous = 0;
+	g_fs_node_entry* entry = parent->children;
+	while(entry)
+	{
+		if(entry->node == child)
+		{
+			if(previous)
+				previous->next = entry->next;
+			else
+				parent->children = entry->next;
+			break;
+		}
+		previous = entry;
+		entry = entry->next;
+	}
+
+	mutexRelease(&delegate->lock);
+
+	if(entry)
+		heapFree(entry);
+	filesystemDentryCacheRemove(parent, child->name);
 }
 
 g_fs_virt_id filesystemGetNextNodeId()
@@ -140,6 +201,11 @@ g_fs_node* filesystemGetRoot()
 	return filesystemRoot;
 }
 
+g_fs_node* filesystemGetMountFolder()
+{
+	return mountFolder;
+}
+
 g_fs_delegate* filesystemCreateDelegate()
 {
 	g_fs_delegate* delegate = (g_fs_delegate*) heapAllocateClear(sizeof(g_fs_delegate));
@@ -175,26 +241,24 @@ g_fs_open_status filesystemFindChild(g_fs_node* parent, const char* name, g_fs_n
 		return G_FS_OPEN_SUCCESSFUL;
 	}
 
-	g_fs_node_entry* child = parent->children;
-	g_fs_node* lastKnown = parent;
-	while(child)
-	{
-		if(stringEquals(name, child->node->name))
-		{
-			*outChild = child->node;
-			return G_FS_OPEN_SUCCESSFUL;
-		}
-		lastKnown = child->node;
-		child = child->next;
-	}
+	g_fs_dentry_lookup cached = filesystemDentryCacheLookup(parent, name, outChild);
+	if(cached == G_FS_DENTRY_LOOKUP_FOUND)
+		return G_FS_OPEN_SUCCESSFUL;
+	if(cached == G_FS_DENTRY_LOOKUP_NEGATIVE)
+		return G_FS_OPEN_NOT_FOUND;
 
-	g_fs_delegate* delegate = filesystemFindDelegate(lastKnown);
+	g_fs_delegate* delegate = filesystemFindDelegate(parent);
 	if(!delegate->discover)
 	{
 		*outChild = 0;
 		return G_FS_OPEN_ERROR;
 	}
-	return delegate->discover(lastKnown, name, outChild);
+
+	// Discovered nodes are added to the cache when they are added to the parent
+	g_fs_open_status status = delegate->discover(parent, name, outChild);
+	if(status == G_FS_OPEN_NOT_FOUND)
+		filesystemDentryCachePut(parent, name, 0);
+	return status;
 }
 
 g_fs_open_status filesystemFind(g_fs_node* parent, const char* path, g_fs_node** outChild, bool* outFoundAllButLast, g_fs_node** outLastFoundParent,
@@ -260,22 +324,37 @@ g_fs_open_status filesystemFind(g_fs_node* parent, const char* path, g_fs_node**
 	return status;
 }
 
-g_fs_open_status filesystemOpen(const char* path, g_file_flag_mode flags, g_task* task, g_fd* outFd)
+g_fs_node* filesystemGetWorkingDirectory(g_process* process)
+{
+	g_fs_node* node = process->environment.workingDirectoryNode;
+	if(node)
+		return node;
+
+	const char* workingDirectoryPath = process->environment.workingDirectory;
+	if(workingDirectoryPath == 0 || filesystemFind(0, workingDirectoryPath, &node) != G_FS_OPEN_SUCCESSFUL || !node)
+		return filesystemGetRoot();
+
+	// Nodes are never removed, so the node stays valid for the process
+	process->environment.workingDirectoryNode = node;
+	return node;
+}
+
+/**
+ * Returns the node that the path is resolved from.
+ */
+static g_fs_node* filesystemGetPathOrigin(g_task* task, const char* path)
 {
-	// Decide for relative path origin
 	g_fs_node* relative = 0;
 	if(path[0] != '/')
-	{
-		const char* workingDirectoryPath = task->process->environment.workingDirectory;
-		if(workingDirectoryPath == 0)
-		{
-			workingDirectoryPath = "/";
-		}
-
-		filesystemFind(0, workingDirectoryPath, &relative);
-	}
+		relative = filesystemGetWorkingDirectory(task->process);
 	if(!relative)
 		relative = filesystemGetRoot();
+	return relative;
+}
+
+g_fs_open_status filesystemOpen(const char* path, g_file_flag_mode flags, g_task* task, g_fd* outFd)
+{
+	g_fs_node* relative = filesystemGetPathOrigin(task, path);
 
 	// Try to find existing node
 	g_fs_node* file;
@@ -289,7 +368,11 @@ g_fs_open_status filesystemOpen(const char* path, g_file_flag_mode flags, g_task
 	{
 		if(flags & G_FILE_FLAG_MODE_TRUNCATE)
 		{
-			if(filesystemTruncate(file) != G_FS_OPEN_SUCCESSFUL)
+			g_fs_open_status truncateStatus = filesystemTruncate(file);
+			if(truncateStatus == G_FS_OPEN_BUSY)
+				return G_FS_OPEN_BUSY;
+
+			if(truncateStatus != G_FS_OPEN_SUCCESSFUL)
 			{
 				logInfo("%! failed to truncate file %i", "fs", file->id);
 				return G_FS_OPEN_ERROR;
@@ -303,7 +386,13 @@ g_fs_open_status filesystemOpen(const char* path, g_file_flag_mode flags, g_task
 			{
 				logInfo("%! failed to create file '%s' in parent %i because folders do not exist", "fs", path, relative->id);
 				return G_FS_OPEN_ERROR;
-			} else if(filesystemCreateFile(lastFoundParent, filenameStart, &file) != G_FS_OPEN_SUCCESSFUL)
+			}
+
+			g_fs_open_status createStatus = filesystemCreateFile(lastFoundParent, filenameStart, &file);
+			if(createStatus == G_FS_OPEN_BUSY)
+				return G_FS_OPEN_BUSY;
+
+			if(createStatus != G_FS_OPEN_SUCCESSFUL)
 			{
 				logInfo("%! failed to create file '%s' in parent %i", "fs", path, relative->id);
 				return G_FS_OPEN_ERROR;
@@ -331,7 +420,7 @@ g_fs_open_status filesystemOpen(g_fs_node* file, g_file_flag_mode flags, g_task*
 	if(status == G_FS_OPEN_SUCCESSFUL)
 	{
 		g_file_descriptor* descriptor;
-		filesystemProcessCreateDescriptor(task->process->id, file->id, flags, &descriptor);
+		filesystemProcessCreateDescriptor(task->process, file->id, flags, &descriptor);
 		*outFd = descriptor->id;
 	}
 	return status;
@@ -339,7 +428,15 @@ g_fs_open_status filesystemOpen(g_fs_node* file, g_file_flag_mode flags, g_task*
 
 g_fs_read_status filesystemRead(g_task* task, g_fd fd, uint8_t* buffer, uint64_t length, int64_t* outRead)
 {
-	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process->id, fd);
+	g_fs_iovec vector;
+	vector.base = buffer;
+	vector.length = length;
+	return filesystemReadVector(task, fd, &vector, 1, -1, outRead);
+}
+
+g_fs_read_status filesystemReadVector(g_task* task, g_fd fd, g_fs_iovec* vectors, uint32_t count, int64_t offset, int64_t* outRead)
+{
+	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process, fd);
 	if(!descriptor)
 	{
 		return G_FS_READ_INVALID_FD;
@@ -353,12 +450,15 @@ g_fs_read_status filesystemRead(g_task* task, g_fd fd, uint8_t* buffer, uint64_t
 
 	int64_t read;
 	g_fs_read_status status;
-	while((status = filesystemRead(node, buffer, descriptor->offset, length, &read)) == G_FS_READ_BUSY && node->blocking)
+	while((status = filesystemReadVector(node, vectors, count, offset < 0 ? descriptor->offset : offset, &read)) == G_FS_READ_BUSY
+			&& node->blocking)
 	{
-		filesystemWaitToRead(task, node);
+		// Threaded calls and drained rings are executed by a kernel thread, which
+		// is the one that must wait; the task may still be running
+		filesystemWaitToRead(taskingGetCurrentTask(), node);
 		taskingKernelThreadYield();
 	}
-	if(read > 0)
+	if(read > 0 && offset < 0)
 	{
 		descriptor->offset += read;
 	}
@@ -366,6 +466,36 @@ g_fs_read_status filesystemRead(g_task* task, g_fd fd, uint8_t* buffer, uint64_t
 	return status;
 }
 
+g_fs_read_status filesystemReadVector(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outRead)
+{
+	g_fs_delegate* delegate = filesystemFindDelegate(node);
+	if(delegate->readv)
+		return delegate->readv(node, vectors, count, offset, outRead);
+
+	if(!delegate->read)
+		return G_FS_READ_ERROR;
+
+	int64_t total = 0;
+	g_fs_read_status status = G_FS_READ_SUCCESSFUL;
+	for(uint32_t i = 0; i < count; i++)
+	{
+		int64_t read = 0;
+		status = delegate->read(node, (uint8_t*) vectors[i].base, offset + total, vectors[i].length, &read);
+		if(status != G_FS_READ_SUCCESSFUL)
+			break;
+
+		total += read;
+		if(read < vectors[i].length)
+			break;
+	}
+
+	// What was read before a failing buffer is still a successful read
+	if(total > 0)
+		status = G_FS_READ_SUCCESSFUL;
+	*outRead = total;
+	return status;
+}
+
 g_fs_read_status filesystemRead(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outRead)
 {
 	g_fs_delegate* delegate = filesystemFindDelegate(node);
@@ -377,7 +507,7 @@ g_fs_read_status filesystemRead(g_fs_node* node, uint8_t* buffer, uint64_t offse
 
 g_fs_length_status filesystemGetLength(g_task* task, g_fd fd, uint64_t* outLength)
 {
-	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process->id, fd);
+	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process, fd);
 	if(!descriptor)
 	{
 		return G_FS_LENGTH_INVALID_FD;
@@ -403,7 +533,15 @@ g_fs_length_status filesystemGetLength(g_fs_node* node, uint64_t* outLength)
 
 g_fs_write_status filesystemWrite(g_task* task, g_fd fd, uint8_t* buffer, uint64_t length, int64_t* outWrote)
 {
-	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process->id, fd);
+	g_fs_iovec vector;
+	vector.base = buffer;
+	vector.length = length;
+	return filesystemWriteVector(task, fd, &vector, 1, -1, outWrote);
+}
+
+g_fs_write_status filesystemWriteVector(g_task* task, g_fd fd, g_fs_iovec* vectors, uint32_t count, int64_t offset, int64_t* outWrote)
+{
+	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process, fd);
 	if(!descriptor)
 	{
 		return G_FS_WRITE_INVALID_FD;
@@ -415,8 +553,8 @@ g_fs_write_status filesystemWrite(g_task* task, g_fd fd, uint8_t* buffer, uint64
 		return G_FS_WRITE_INVALID_FD;
 	}
 
-	uint64_t startOffset = descriptor->offset;
-	if(descriptor->openFlags & G_FILE_FLAG_MODE_APPEND)
+	uint64_t startOffset = offset < 0 ? descriptor->offset : offset;
+	if(offset < 0 && (descriptor->openFlags & G_FILE_FLAG_MODE_APPEND))
 	{
 		if(filesystemGetLength(node, &startOffset) != G_FS_LENGTH_SUCCESSFUL)
 		{
@@ -427,12 +565,12 @@ g_fs_write_status filesystemWrite(g_task* task, g_fd fd, uint8_t* buffer, uint64
 
 	int64_t wrote;
 	g_fs_write_status status;
-	while((status = filesystemWrite(node, buffer, startOffset, length, &wrote)) == G_FS_WRITE_BUSY && node->blocking)
+	while((status = filesystemWriteVector(node, vectors, count, startOffset, &wrote)) == G_FS_WRITE_BUSY && node->blocking)
 	{
-		filesystemWaitToWrite(task, node);
+		filesystemWaitToWrite(taskingGetCurrentTask(), node);
 		taskingKernelThreadYield();
 	}
-	if(wrote > 0)
+	if(wrote > 0 && offset < 0)
 	{
 		descriptor->offset = startOffset + wrote;
 	}
@@ -440,6 +578,35 @@ g_fs_write_status filesystemWrite(g_task* task, g_fd fd, uint8_t* buffer, uint64
 	return status;
 }
 
+g_fs_write_status filesystemWriteVector(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outWrote)
+{
+	g_fs_delegate* delegate = filesystemFindDelegate(node);
+	if(delegate->writev)
+		return delegate->writev(node, vectors, count, offset, outWrote);
+
+	if(!delegate->write)
+		return G_FS_WRITE_ERROR;
+
+	int64_t total = 0;
+	g_fs_write_status status = G_FS_WRITE_SUCCESSFUL;
+	for(uint32_t i = 0; i < count; i++)
+	{
+		int64_t wrote = 0;
+		status = delegate->write(node, (uint8_t*) vectors[i].base, offset + total, vectors[i].length, &wrote);
+		if(status != G_FS_WRITE_SUCCESSFUL)
+			break;
+
+		total += wrote;
+		if(wrote < vectors[i].length)
+			break;
+	}
+
+	if(total > 0)
+		status = G_FS_WRITE_SUCCESSFUL;
+	*outWrote = total;
+	return status;
+}
+
 g_fs_write_status filesystemWrite(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outWrote)
 {
 	g_fs_delegate* delegate = filesystemFindDelegate(node);
@@ -449,6 +616,160 @@ g_fs_write_status filesystemWrite(g_fs_node* node, uint8_t* buffer, uint64_t off
 	return delegate->write(node, buffer, offset, length, outWrote);
 }
 
+g_fs_stat_status filesystemStat(g_fs_node* node, g_fs_stat_attributes* outStats)
+{
+	outStats->node_id = node->id;
+	outStats->type = node->type;
+	outStats->length = 0;
+
+	if(node->type == G_FS_NODE_TYPE_FILE || node->type == G_FS_NODE_TYPE_PIPE)
+	{
+		uint64_t length;
+		g_fs_length_status lengthStatus = filesystemGetLength(node, &length);
+		if(lengthStatus == G_FS_LENGTH_BUSY)
+			return G_FS_STAT_BUSY;
+		if(lengthStatus != G_FS_LENGTH_SUCCESSFUL)
+			return G_FS_STAT_ERROR;
+		outStats->length = length;
+	}
+	return G_FS_STAT_SUCCESSFUL;
+}
+
+g_fs_stat_status filesystemStat(g_task* task, const char* path, g_fs_stat_attributes* outStats)
+{
+	g_fs_node* node;
+	g_fs_open_status status = filesystemFind(filesystemGetPathOrigin(task, path), path, &node);
+	if(status == G_FS_OPEN_NOT_FOUND)
+		return G_FS_STAT_NOT_FOUND;
+	if(status == G_FS_OPEN_BUSY)
+		return G_FS_STAT_BUSY;
+	if(status != G_FS_OPEN_SUCCESSFUL || !node)
+		return G_FS_STAT_ERROR;
+
+	return filesystemStat(node, outStats);
+}
+
+g_fs_stat_status filesystemStat(g_task* task, g_fd fd, g_fs_stat_attributes* outStats)
+{
+	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process, fd);
+	if(!descriptor)
+		return G_FS_STAT_INVALID_FD;
+
+	g_fs_node* node = filesystemGetNode(descriptor->nodeId);
+	if(!node)
+		return G_FS_STAT_INVALID_FD;
+
+	return filesystemStat(node, outStats);
+}
+
+g_fs_directory_refresh_status filesystemRefreshDirectory(g_fs_node* folder)
+{
+	if(folder->upToDate)
+		return G_FS_DIRECTORY_REFRESH_SUCCESSFUL;
+
+	g_fs_delegate* delegate = filesystemFindDelegate(folder);
+	if(delegate->refreshDirectory)
+	{
+		g_fs_directory_refresh_status status = delegate->refreshDirectory(folder);
+		if(status != G_FS_DIRECTORY_REFRESH_SUCCESSFUL)
+			return status;
+	}
+
+	// Children created later are added to the tree when they are created
+	folder->upToDate = true;
+	return G_FS_DIRECTORY_REFRESH_SUCCESSFUL;
+}
+
+/**
+ * @return the length of the directory record for the node, including its name
+ */
+static uint32_t filesystemGetDirectoryRecordLength(g_fs_node* node)
+{
+	uint32_t recordLength = sizeof(g_fs_directory_record) + stringLength(node->name) + 1;
+	return G_ALIGN_UP(recordLength, G_FS_DIRECTORY_RECORD_ALIGNMENT);
+}
+
+g_fs_read_directory_status filesystemListDirectory(g_task* task, g_fd fd, uint8_t* buffer, uint32_t length, int32_t* outWritten)
+{
+	*outWritten = 0;
+
+	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process, fd);
+	if(!descriptor)
+		return G_FS_READ_DIRECTORY_INVALID_FD;
+
+	g_fs_node* folder = filesystemGetNode(descriptor->nodeId);
+	if(!folder)
+		return G_FS_READ_DIRECTORY_INVALID_FD;
+
+	if(folder->type != G_FS_NODE_TYPE_FOLDER && folder->type != G_FS_NODE_TYPE_MOUNTPOINT && folder->type != G_FS_NODE_TYPE_ROOT)
+		return G_FS_READ_DIRECTORY_ERROR;
+
+	g_fs_directory_refresh_status refreshStatus = filesystemRefreshDirectory(folder);
+	if(refreshStatus != G_FS_DIRECTORY_REFRESH_SUCCESSFUL)
+		return G_FS_READ_DIRECTORY_ERROR;
+
+	g_fs_delegate* delegate = filesystemFindDelegate(folder);
+	mutexAcquire(&delegate->lock);
+
+	g_fs_node_entry* entry = folder->children;
+	for(uint64_t position = 0; entry && position < descriptor->offset; position++)
+		entry = entry->next;
+
+	// The listed nodes and the offsets of their records are kept on the kernel side,
+	// so that the lengths can be filled in without reading back from the buffer
+	struct
+	{
+		uint32_t offset;
+		g_fs_virt_id id;
+	} listedRecords[G_FS_LIST_DIRECTORY_BATCH];
+
+	uint32_t written = 0;
+	uint32_t listed = 0;
+	g_fs_read_directory_status status = G_FS_READ_DIRECTORY_SUCCESSFUL;
+	for(; entry && listed < G_FS_LIST_DIRECTORY_BATCH; entry = entry->next)
+	{
+		g_fs_node* child = entry->node;
+		uint32_t recordLength = filesystemGetDirectoryRecordLength(child);
+		if(written + recordLength > length)
+		{
+			if(listed == 0)
+				status = G_FS_READ_DIRECTORY_BUFFER_TOO_SMALL;
+			break;
+		}
+
+		g_fs_directory_record* record = (g_fs_directory_record*) &buffer[written];
+		record->record_length = recordLength;
+		record->node_id = child->id;
+		record->type = child->type;
+		record->length = 0;
+		memoryCopy(record->name, child->name, stringLength(child->name) + 1);
+
+		listedRecords[listed].offset = written;
+		listedRecords[listed].id = child->id;
+		written += recordLength;
+		listed++;
+	}
+
+	mutexRelease(&delegate->lock);
+
+	// Lengths are filled outside the lock, as a delegate might have to wait for them
+	for(uint32_t index = 0; index < listed; index++)
+	{
+		g_fs_node* child = filesystemGetNode(listedRecords[index].id);
+
+		g_fs_stat_attributes stats;
+		if(child && filesystemStat(child, &stats) == G_FS_STAT_SUCCESSFUL)
+			((g_fs_directory_record*) &buffer[listedRecords[index].offset])->length = stats.length;
+	}
+
+	if(status == G_FS_READ_DIRECTORY_SUCCESSFUL && listed == 0)
+		status = G_FS_READ_DIRECTORY_EOD;
+
+	descriptor->offset += listed;
+	*outWritten = written;
+	return status;
+}
+
 g_fs_open_status filesystemCreateFile(g_fs_node* parent, const char* name, g_fs_node** outFile)
 {
 	g_fs_delegate* delegate = filesystemFindDelegate(parent);
@@ -510,19 +831,225 @@ g_fs_pipe_status filesystemCreatePipe(g_bool blocking, g_fs_node** outPipeNode)
 	return G_FS_PIPE_SUCCESSFUL;
 }
 
-g_fs_close_status filesystemClose(g_pid pid, g_fd fd, g_bool removeDescriptor)
+g_fs_pipe_capacity_status filesystemPipeCapacity(g_task* task, g_fd fd, g_bool set, uint32_t* inOutCapacity)
+{
+	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process, fd);
+	g_fs_node* node = descriptor ? filesystemGetNode(descriptor->nodeId) : 0;
+	if(!node)
+		return G_FS_PIPE_CAPACITY_INVALID_FD;
+
+	if(node->type != G_FS_NODE_TYPE_PIPE)
+		return G_FS_PIPE_CAPACITY_NOT_A_PIPE;
+
+	if(set)
+	{
+		g_fs_pipe_capacity_status status = pipeSetCapacity(node->physicalId, *inOutCapacity);
+		if(status != G_FS_PIPE_CAPACITY_SUCCESSFUL)
+			return status;
+	}
+	return pipeGetCapacity(node->physicalId, inOutCapacity);
+}
+
+/**
+ * @return how many bytes the pipe can take before it reaches its capacity
+ */
+static uint64_t filesystemGetPipeSpace(g_fs_node* pipeNode)
+{
+	uint32_t capacity;
+	uint64_t size;
+	if(pipeGetCapacity(pipeNode->physicalId, &capacity) != G_FS_PIPE_CAPACITY_SUCCESSFUL
+			|| pipeGetLength(pipeNode->physicalId, &size) != G_FS_LENGTH_SUCCESSFUL || size >= capacity)
+		return 0;
+	return capacity - size;
+}
+
+/**
+ * Writes all bytes that were taken from an input pipe. As they can't be given back,
+ * this also waits for a non-blocking output that another writer has filled meanwhile.
+ */
+static g_fs_write_status filesystemTransferWriteAll(g_task* task, g_fd out, g_fs_node* outNode, uint8_t* buffer, int64_t length,
+		int64_t* outWrote)
+{
+	int64_t written = 0;
+	g_fs_write_status status = G_FS_WRITE_SUCCESSFUL;
+	while(written < length)
+	{
+		int64_t wrote = 0;
+		status = filesystemWrite(task, out, buffer + written, length - written, &wrote);
+		if(status == G_FS_WRITE_BUSY)
+		{
+			filesystemWaitToWrite(taskingGetCurrentTask(), outNode);
+			taskingKernelThreadYield();
+			continue;
+		}
+		if(status == G_FS_WRITE_SUCCESSFUL && wrote <= 0)
+			status = G_FS_WRITE_ERROR;
+		if(status != G_FS_WRITE_SUCCESSFUL)
+			break;
+		written += wrote;
+	}
+	*outWrote = written;
+	return status;
+}
+
+/**
+ * Transfers bytes through a kernel buffer for splice and tee. Like a read, this only
+ * waits for input while nothing was transferred.
+ *
+ * Splice takes bytes from an input pipe under the pipe lock like any other reader, so
+ * concurrent readers never get the same bytes. To not take more than the output can
+ * take, the chunk is limited to the space left in an output pipe.
+ *
+ * Tee peeks behind the bytes it has copied before. If another reader takes bytes from
+ * the input pipe meanwhile, that position has moved, so the transfer stops there.
+ */
+static g_fs_splice_status filesystemTransfer(g_task* task, g_fd in, g_fd out, uint64_t length, bool keepInput, int64_t* outTransferred)
+{
+	*outTransferred = 0;
+
+	g_file_descriptor* inDescriptor = filesystemProcessGetDescriptor(task->process, in);
+	g_file_descriptor* outDescriptor = filesystemProcessGetDescriptor(task->process, out);
+	g_fs_node* inNode = inDescriptor ? filesystemGetNode(inDescriptor->nodeId) : 0;
+	g_fs_node* outNode = outDescriptor ? filesystemGetNode(outDescriptor->nodeId) : 0;
+	if(!inNode || !outNode)
+		return G_FS_SPLICE_INVALID_FD;
+
+	bool inPipe = inNode->type == G_FS_NODE_TYPE_PIPE;
+	bool outPipe = outNode->type == G_FS_NODE_TYPE_PIPE;
+	if(keepInput ? !(inPipe && outPipe) : !(inPipe || outPipe))
+		return G_FS_SPLICE_NOT_A_PIPE;
+
+	if(inNode == outNode)
+		return G_FS_SPLICE_ERROR;
+
+	uint32_t bufferSize = length < G_FS_SPLICE_BUFFER_SIZE ? length : G_FS_SPLICE_BUFFER_SIZE;
+	if(bufferSize == 0)
+		return G_FS_SPLICE_SUCCESSFUL;
+	uint8_t* buffer = (uint8_t*) heapAllocate(bufferSize);
+
+	g_fs_splice_status status = G_FS_SPLICE_SUCCESSFUL;
+	uint64_t transferred = 0;
+	uint32_t firstReadCount = 0;
+	bool consume = inPipe && !keepInput;
+	while(transferred < length)
+	{
+		uint64_t chunk = length - transferred;
+		if(chunk > bufferSize)
+			chunk = bufferSize;
+
+		if(consume && outPipe)
+		{
+			uint64_t space = filesystemGetPipeSpace(outNode);
+			if(space == 0)
+			{
+				if(outNode->blocking)
+				{
+					filesystemWaitToWrite(taskingGetCurrentTask(), outNode);
+					taskingKernelThreadYield();
+					continue;
+				}
+				if(transferred == 0)
+					status = G_FS_SPLICE_BUSY;
+				break;
+			}
+			if(chunk > space)
+				chunk = space;
+		}
+
+		int64_t read;
+		uint32_t readCount = 0;
+		g_fs_read_status readStatus;
+		if(consume)
+			readStatus = pipeRead(inNode->physicalId, buffer, 0, chunk, &read);
+		else if(inPipe)
+			readStatus = pipePeek(inNode->physicalId, transferred, buffer, chunk, &read, &readCount);
+		else
+			readStatus = filesystemRead(inNode, buffer, inDescriptor->offset, chunk, &read);
+
+		// Copying continues behind the bytes that were copied before, which is only
+		// where it left off if no other reader has taken bytes in between
+		if(keepInput)
+		{
+			if(transferred == 0)
+				firstReadCount = readCount;
+			else if(readCount != firstReadCount)
+				break;
+		}
+
+		if(readStatus == G_FS_READ_BUSY)
+		{
+			if(transferred == 0 && inNode->blocking)
+			{
+				filesystemWaitToRead(taskingGetCurrentTask(), inNode);
+				taskingKernelThreadYield();
+				continue;
+			}
+			if(transferred == 0)
+				status = G_FS_SPLICE_BUSY;
+			break;
+		}
+		if(readStatus != G_FS_READ_SUCCESSFUL)
+		{
+			if(transferred == 0)
+				status = G_FS_SPLICE_ERROR;
+			break;
+		}
+		if(read == 0)
+			break;
+
+		int64_t wrote = 0;
+		g_fs_write_status writeStatus;
+		if(consume)
+			writeStatus = filesystemTransferWriteAll(task, out, outNode, buffer, read, &wrote);
+		else
+			writeStatus = filesystemWrite(task, out, buffer, read, &wrote);
+
+		if(writeStatus != G_FS_WRITE_SUCCESSFUL)
+		{
+			if(consume)
+			{
+				logInfo("%! lost %i bytes from pipe %i that could not be written during splice", "filesystem", (int32_t) (read - wrote),
+						inNode->physicalId);
+				transferred += wrote;
+			}
+			if(transferred == 0)
+				status = (writeStatus == G_FS_WRITE_BUSY) ? G_FS_SPLICE_BUSY : G_FS_SPLICE_ERROR;
+			break;
+		}
+
+		if(!inPipe)
+			inDescriptor->offset += wrote;
+		transferred += wrote;
+	}
+
+	heapFree(buffer);
+	*outTransferred = transferred;
+	return status;
+}
+
+g_fs_splice_status filesystemSplice(g_task* task, g_fd in, g_fd out, uint64_t length, int64_t* outMoved)
+{
+	return filesystemTransfer(task, in, out, length, false, outMoved);
+}
+
+g_fs_splice_status filesystemTee(g_task* task, g_fd in, g_fd out, uint64_t length, int64_t* outCopied)
+{
+	return filesystemTransfer(task, in, out, length, true, outCopied);
+}
+
+g_fs_close_status filesystemClose(g_process* process, g_fd fd, g_bool removeDescriptor)
 {
-	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(pid, fd);
+	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(process, fd);
 	if(!descriptor)
 	{
-		logInfo("%! failed to close fd %i in process %i, illegal descriptor", "fs", fd, pid);
+		logInfo("%! failed to close fd %i in process %i, illegal descriptor", "fs", fd, process->id);
 		return G_FS_CLOSE_INVALID_FD;
 	}
 
 	g_fs_node* file = filesystemGetNode(descriptor->nodeId);
 	if(!file)
 	{
-		logInfo("%! failed to close fd %i in process %i, illegal node", "fs", pid);
+		logInfo("%! failed to close fd %i in process %i, illegal node", "fs", fd, process->id);
 		return G_FS_CLOSE_INVALID_FD;
 	}
 
@@ -533,17 +1060,17 @@ g_fs_close_status filesystemClose(g_pid pid, g_fd fd, g_bool removeDescriptor)
 	g_fs_close_status status = delegate->close(file);
 	if(status == G_FS_CLOSE_SUCCESSFUL && removeDescriptor)
 	{
-		filesystemProcessRemoveDescriptor(pid, fd);
+		filesystemProcessRemoveDescriptor(process, fd);
 	}
 
-	logDebug("%! closed file descriptor %i in process %i", "fs", fd, pid);
+	logDebug("%! closed file descriptor %i in process %i", "fs", fd, process->id);
 
 	return status;
 }
 
 g_fs_seek_status filesystemSeek(g_task* task, g_fd fd, g_fs_seek_mode mode, int64_t amount, int64_t* outResult)
 {
-	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process->id, fd);
+	g_file_descriptor* descriptor = filesystemProcessGetDescriptor(task->process, fd);
 	if(!descriptor)
 	{
 		return G_FS_SEEK_INVALID_FD;
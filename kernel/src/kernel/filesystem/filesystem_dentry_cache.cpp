@@ -0,0 +1,168 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/filesystem/filesystem_dentry_cache.hpp"
+#include "kernel/memory/memory.hpp"
+#include "shared/utils/string.hpp"
+
+static g_fs_dentry_bucket filesystemDentryBuckets[G_FS_DENTRY_CACHE_BUCKETS];
+
+static uint32_t filesystemDentryHash(const char* name)
+{
+	uint32_t hash = 2166136261u;
+	while(*name)
+	{
+		hash ^= (uint8_t) *name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static g_fs_dentry_bucket* filesystemDentryGetBucket(g_fs_virt_id parentId, uint32_t hash)
+{
+	return &filesystemDentryBuckets[(hash ^ (parentId * 2654435761u)) % G_FS_DENTRY_CACHE_BUCKETS];
+}
+
+/**
+ * Finds the entry in the bucket, the lock of the bucket must be held.
+ */
+static g_fs_dentry* filesystemDentryFind(g_fs_dentry_bucket* bucket, g_fs_virt_id parentId, uint32_t hash, const char* name, g_fs_dentry** outPrevious)
+{
+	g_fs_dentry* previous = 0;
+	g_fs_dentry* entry = bucket->head;
+	while(entry)
+	{
+		if(entry->parentId == parentId && entry->hash == hash && stringEquals(entry->name, name))
+			break;
+		previous = entry;
+		entry = entry->next;
+	}
+
+	if(outPrevious)
+		*outPrevious = previous;
+	return entry;
+}
+
+void filesystemDentryCacheInitialize()
+{
+	for(int i = 0; i < G_FS_DENTRY_CACHE_BUCKETS; i++)
+	{
+		mutexInitialize(&filesystemDentryBuckets[i].lock);
+		filesystemDentryBuckets[i].head = 0;
+	}
+}
+
+g_fs_dentry_lookup filesystemDentryCacheLookup(g_fs_node* parent, const char* name, g_fs_node** outNode)
+{
+	uint32_t hash = filesystemDentryHash(name);
+	g_fs_dentry_bucket* bucket = filesystemDentryGetBucket(parent->id, hash);
+
+	mutexAcquire(&bucket->lock);
+	g_fs_dentry* entry = filesystemDentryFind(bucket, parent->id, hash, name, 0);
+	g_fs_dentry_lookup result = G_FS_DENTRY_LOOKUP_MISS;
+	if(entry)
+	{
+		*outNode = entry->node;
+		result = entry->node ? G_FS_DENTRY_LOOKUP_FOUND : G_FS_DENTRY_LOOKUP_NEGATIVE;
+	}
+	mutexRelease(&bucket->lock);
+	return result;
+}
+
+void filesystemDentryCachePut(g_fs_node* parent, const char* name, g_fs_node* node)
+{
+	uint32_t hash = filesystemDentryHash(name);
+	g_fs_dentry_bucket* bucket = filesystemDentryGetBucket(parent->id, hash);
+
+	mutexAcquire(&bucket->lock);
+
+	g_fs_dentry* entry = filesystemDentryFind(bucket, parent->id, hash, name, 0);
+	if(entry)
+	{
+		// A miss that raced with adding the child must not hide it again
+		if(node || !entry->node)
+			entry->node = node;
+		mutexRelease(&bucket->lock);
+		return;
+	}
+
+	// Keep the number of negative entries bounded by dropping the oldest one
+	if(!node)
+	{
+		int negatives = 0;
+		g_fs_dentry* oldest = 0;
+		g_fs_dentry* oldestPrevious = 0;
+		g_fs_dentry* previous = 0;
+		for(g_fs_dentry* current = bucket->head; current; current = current->next)
+		{
+			if(!current->node)
+			{
+				negatives++;
+				oldest = current;
+				oldestPrevious = previous;
+			}
+			previous = current;
+		}
+
+		if(negatives >= G_FS_DENTRY_CACHE_NEGATIVE_PER_BUCKET)
+		{
+			if(oldestPrevious)
+				oldestPrevious->next = oldest->next;
+			else
+				bucket->head = oldest->next;
+			heapFree(oldest->name);
+			heapFree(oldest);
+		}
+	}
+
+	entry = (g_fs_dentry*) heapAllocate(sizeof(g_fs_dentry));
+	entry->parentId = parent->id;
+	entry->hash = hash;
+	entry->name = stringDuplicate(name);
+	entry->node = node;
+	entry->next = bucket->head;
+	bucket->head = entry;
+
+	mutexRelease(&bucket->lock);
+}
+
+void filesystemDentryCacheRemove(g_fs_node* parent, const char* name)
+{
+	uint32_t hash = filesystemDentryHash(name);
+	g_fs_dentry_bucket* bucket = filesystemDentryGetBucket(parent->id, hash);
+
+	mutexAcquire(&bucket->lock);
+	g_fs_dentry* previous;
+	g_fs_dentry* entry = filesystemDentryFind(bucket, parent->id, hash, name, &previous);
+	if(entry)
+	{
+		if(previous)
+			previous->next = entry->next;
+		else
+			bucket->head = entry->next;
+	}
+	mutexRelease(&bucket->lock);
+
+	if(entry)
+	{
+		heapFree(entry->name);
+		heapFree(entry);
+	}
+}
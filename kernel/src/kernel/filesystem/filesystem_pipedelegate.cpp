@@ -49,6 +49,16 @@ g_fs_write_status filesystemPipeDelegateWrite(g_fs_node* node, uint8_t* buffer,
 	return pipeWrite(node->physicalId, buffer, offset, length, outWrote);
 }
 
+g_fs_read_status filesystemPipeDelegateReadVector(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outRead)
+{
+	return pipeReadVector(node->physicalId, vectors, count, outRead);
+}
+
+g_fs_write_status filesystemPipeDelegateWriteVector(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outWrote)
+{
+	return pipeWriteVector(node->physicalId, vectors, count, outWrote);
+}
+
 g_fs_length_status filesystemPipeDelegateGetLength(g_fs_node* node, uint64_t* outLength)
 {
 	return pipeGetLength(node->physicalId, outLength);
@@ -77,6 +87,10 @@ bool filesystemPipeDelegateWaitResolverRead(g_task* task)
 		return true;
 	}
 
+	if(pipe->size > 0)
+		return true;
+
+	waitQueueAdd(&pipe->waitersRead, task->id);
 	return pipe->size > 0;
 }
 
@@ -98,5 +112,9 @@ bool filesystemPipeDelegateWaitResolverWrite(g_task* task)
 		return true;
 	}
 
-	return pipe->size < pipe->capacity;
+	if(pipe->size < pipe->maximumCapacity)
+		return true;
+
+	waitQueueAdd(&pipe->waitersWrite, task->id);
+	return pipe->size < pipe->maximumCapacity;
 }
@@ -19,112 +19,205 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "kernel/filesystem/filesystem_process.hpp"
+#include "kernel/filesystem/filesystem.hpp"
 #include "kernel/memory/memory.hpp"
 #include "shared/logger/logger.hpp"
 
-static g_hashmap<g_pid, g_filesystem_process*>* filesystemProcessInfo;
-
-void filesystemProcessInitialize()
-{
-	filesystemProcessInfo = hashmapCreateNumeric<g_pid, g_filesystem_process*>(128);
-}
-
-void filesystemProcessCreate(g_pid pid)
+void filesystemProcessCreate(g_process* process)
 {
 	g_filesystem_process* info = (g_filesystem_process*) heapAllocate(sizeof(g_filesystem_process));
 
-	info->nextDescriptor = 3; // after stdin, stdout, stderr
-	mutexInitialize(&info->nextDescriptorLock);
-	info->descriptors = hashmapCreateNumeric<g_fd, g_file_descriptor*>(128);
+	mutexInitialize(&info->lock);
+	info->capacity = G_FILESYSTEM_PROCESS_INITIAL_DESCRIPTORS;
+	info->descriptors = (g_file_descriptor**) heapAllocate(sizeof(g_file_descriptor*) * info->capacity);
+	memorySetBytes(info->descriptors, 0, sizeof(g_file_descriptor*) * info->capacity);
+	info->lowestFree = G_FILESYSTEM_PROCESS_FIRST_FREE_DESCRIPTOR;
+
+	process->filesystem = info;
+}
 
-	hashmapPut(filesystemProcessInfo, pid, info);
+/**
+ * Grows the descriptor array so that it can hold the given id. The lock of the
+ * process information must be held.
+ */
+static bool filesystemProcessEnsureCapacity(g_filesystem_process* info, g_fd fd)
+{
+	if(fd < info->capacity)
+		return true;
+	if(fd >= G_FILESYSTEM_PROCESS_MAXIMUM_DESCRIPTORS)
+		return false;
+
+	g_fd capacity = info->capacity;
+	while(capacity <= fd)
+		capacity *= 2;
+
+	g_file_descriptor** descriptors = (g_file_descriptor**) heapAllocate(sizeof(g_file_descriptor*) * capacity);
+	memoryCopy(descriptors, info->descriptors, sizeof(g_file_descriptor*) * info->capacity);
+	memorySetBytes(&descriptors[info->capacity], 0, sizeof(g_file_descriptor*) * (capacity - info->capacity));
+
+	heapFree(info->descriptors);
+	info->descriptors = descriptors;
+	info->capacity = capacity;
+	return true;
 }
 
-g_fs_open_status filesystemProcessCreateDescriptor(g_pid pid, g_fs_virt_id nodeId, g_file_flag_mode flags, g_file_descriptor** outDescriptor, g_fd optionalFd)
+g_fs_open_status filesystemProcessCreateDescriptor(g_process* process, g_fs_virt_id nodeId, g_file_flag_mode flags, g_file_descriptor** outDescriptor, g_fd optionalFd)
 {
-	g_filesystem_process* info = hashmapGet<g_pid, g_filesystem_process*>(filesystemProcessInfo, pid, 0);
+	g_filesystem_process* info = process->filesystem;
 	if(!info)
 	{
-		logInfo("%! tried to create file descriptor in process %i that doesn't exist", "filesystem", pid);
+		logInfo("%! tried to create file descriptor in process %i that has no file system information", "filesystem", process->id);
 		return G_FS_OPEN_ERROR;
 	}
 
-	g_file_descriptor* descriptor = (g_file_descriptor*) heapAllocate(sizeof(g_file_descriptor));
+	mutexAcquire(&info->lock);
 
-	if(optionalFd == G_FD_NONE) {
-		mutexAcquire(&info->nextDescriptorLock);
-		descriptor->id = info->nextDescriptor++;
-		mutexRelease(&info->nextDescriptorLock);
-	} else {
-		descriptor->id = optionalFd;
+	g_fd fd = optionalFd;
+	if(fd == G_FD_NONE)
+	{
+		fd = info->lowestFree;
+		while(fd < info->capacity && info->descriptors[fd])
+			fd++;
 	}
+
+	if(fd < 0 || !filesystemProcessEnsureCapacity(info, fd))
+	{
+		mutexRelease(&info->lock);
+		logInfo("%! tried to create illegal file descriptor %i in process %i", "filesystem", fd, process->id);
+		return G_FS_OPEN_ERROR;
+	}
+
+	if(optionalFd == G_FD_NONE)
+		info->lowestFree = fd + 1;
+
+	g_file_descriptor* descriptor = (g_file_descriptor*) heapAllocate(sizeof(g_file_descriptor));
+	descriptor->id = fd;
 	descriptor->nodeId = nodeId;
 	descriptor->offset = 0;
 	descriptor->openFlags = flags;
 
-	hashmapPut<g_fd, g_file_descriptor*>(info->descriptors, descriptor->id, descriptor);
+	g_file_descriptor* replaced = info->descriptors[fd];
+	info->descriptors[fd] = descriptor;
+
+	mutexRelease(&info->lock);
+
+	if(replaced)
+		heapFree(replaced);
+
 	*outDescriptor = descriptor;
 	return G_FS_OPEN_SUCCESSFUL;
 }
 
-g_file_descriptor* filesystemProcessGetDescriptor(g_pid pid, g_fd fd)
+g_file_descriptor* filesystemProcessGetDescriptor(g_process* process, g_fd fd)
 {
-	g_filesystem_process* info = hashmapGet<g_pid, g_filesystem_process*>(filesystemProcessInfo, pid, 0);
-	if(!info)
-	{
-		logInfo("%! tried to create file descriptor in process %i that doesn't exist", "filesystem", pid);
+	g_filesystem_process* info = process->filesystem;
+	if(!info || fd < 0)
 		return 0;
-	}
 
-	return hashmapGet<g_fd, g_file_descriptor*>(info->descriptors, fd, 0);
+	mutexAcquire(&info->lock);
+	g_file_descriptor* descriptor = fd < info->capacity ? info->descriptors[fd] : 0;
+	mutexRelease(&info->lock);
+	return descriptor;
 }
 
-void filesystemProcessRemove(g_pid pid)
+void filesystemProcessRemove(g_process* process)
 {
-	g_filesystem_process* info = hashmapGet<g_pid, g_filesystem_process*>(filesystemProcessInfo, pid, 0);
+	g_filesystem_process* info = process->filesystem;
 	if(!info)
 		return;
 
-	g_hashmap_iterator<g_fd, g_file_descriptor*> iter = hashmapIteratorStart<g_fd, g_file_descriptor*>(info->descriptors);
-	while(hashmapIteratorHasNext<g_fd, g_file_descriptor*>(&iter))
+	for(g_fd fd = 0; fd < info->capacity; fd++)
 	{
-		g_hashmap_entry<g_fd, g_file_descriptor*>* entry = hashmapIteratorNext<g_fd, g_file_descriptor*>(&iter);
-		filesystemClose(pid, entry->key, false);
-		heapFree(entry->value);
+		g_file_descriptor* descriptor = info->descriptors[fd];
+		if(!descriptor)
+			continue;
+
+		filesystemClose(process, fd, false);
+		heapFree(descriptor);
 	}
-	hashmapIteratorEnd<g_fd, g_file_descriptor*>(&iter);
 
+	process->filesystem = 0;
+	heapFree(info->descriptors);
 	heapFree(info);
-	hashmapRemove<g_pid, g_filesystem_process*>(filesystemProcessInfo, pid);
 }
 
-void filesystemProcessRemoveDescriptor(g_pid pid, g_fd fd)
+void filesystemProcessRemoveDescriptor(g_process* process, g_fd fd)
 {
-	g_filesystem_process* info = hashmapGet<g_pid, g_filesystem_process*>(filesystemProcessInfo, pid, 0);
-	if(!info)
+	g_filesystem_process* info = process->filesystem;
+	if(!info || fd < 0)
 		return;
 
-	g_file_descriptor* descriptor = hashmapGet<g_fd, g_file_descriptor*>(info->descriptors, fd, 0);
-	if(!descriptor)
-		return;
+	mutexAcquire(&info->lock);
+	g_file_descriptor* descriptor = 0;
+	if(fd < info->capacity)
+	{
+		descriptor = info->descriptors[fd];
+		info->descriptors[fd] = 0;
+
+		if(fd >= G_FILESYSTEM_PROCESS_FIRST_FREE_DESCRIPTOR && fd < info->lowestFree)
+			info->lowestFree = fd;
+	}
+	mutexRelease(&info->lock);
 
-	hashmapRemove(info->descriptors, fd);
-	heapFree(descriptor);
+	if(descriptor)
+		heapFree(descriptor);
 }
 
-g_file_descriptor* filesystemProcessCloneDescriptor(g_file_descriptor* sourceFd, g_pid targetPid, g_fd targetFd) {
+g_file_descriptor* filesystemProcessCloneDescriptor(g_file_descriptor* sourceFd, g_process* target, g_fd targetFd) {
 
-	if(targetFd != G_FD_NONE)
-		filesystemProcessRemoveDescriptor(targetPid, targetFd);
-	
 	g_file_descriptor* createdFd;
-	g_fs_open_status status = filesystemProcessCreateDescriptor(targetPid, sourceFd->nodeId, sourceFd->openFlags, &createdFd, targetFd);
+	g_fs_open_status status = filesystemProcessCreateDescriptor(target, sourceFd->nodeId, sourceFd->openFlags, &createdFd, targetFd);
 	if(status != G_FS_OPEN_SUCCESSFUL)
 	{
-		logInfo("%! failed to clone descriptor %i to process %i in descriptor %i with status %i", "filesystem", sourceFd->id, targetPid, targetFd, status);
+		logInfo("%! failed to clone descriptor %i to process %i in descriptor %i with status %i", "filesystem", sourceFd->id, target->id, targetFd, status);
 		return 0;
 	}
 
 	createdFd->offset = sourceFd->offset;
 	return createdFd;
 }
+
+void filesystemProcessFork(g_process* source, g_process* target)
+{
+	g_filesystem_process* sourceInfo = source->filesystem;
+	g_filesystem_process* targetInfo = target->filesystem;
+	if(!sourceInfo || !targetInfo)
+		return;
+
+	mutexAcquire(&sourceInfo->lock);
+	mutexAcquire(&targetInfo->lock);
+
+	if(filesystemProcessEnsureCapacity(targetInfo, sourceInfo->capacity - 1))
+	{
+		g_fd lowestFree = sourceInfo->lowestFree;
+		for(g_fd fd = 0; fd < sourceInfo->capacity; fd++)
+		{
+			g_file_descriptor* sourceFd = sourceInfo->descriptors[fd];
+			if(!sourceFd)
+				continue;
+
+			// The delegate counts the new descriptor like any other open, a pipe
+			// must stay alive until both processes have closed it
+			g_fs_node* node = filesystemGetNode(sourceFd->nodeId);
+			g_fs_delegate* delegate = node ? filesystemFindDelegate(node) : 0;
+			if(!delegate || !delegate->open || delegate->open(node) != G_FS_OPEN_SUCCESSFUL)
+			{
+				logInfo("%! failed to open file %i for descriptor %i of forked process %i", "filesystem", sourceFd->nodeId, fd, target->id);
+				if(fd >= G_FILESYSTEM_PROCESS_FIRST_FREE_DESCRIPTOR && fd < lowestFree)
+					lowestFree = fd;
+				continue;
+			}
+
+			g_file_descriptor* descriptor = (g_file_descriptor*) heapAllocate(sizeof(g_file_descriptor));
+			descriptor->id = fd;
+			descriptor->nodeId = sourceFd->nodeId;
+			descriptor->offset = sourceFd->offset;
+			descriptor->openFlags = sourceFd->openFlags;
+			targetInfo->descriptors[fd] = descriptor;
+		}
+		targetInfo->lowestFree = lowestFree;
+	}
+
+	mutexRelease(&targetInfo->lock);
+	mutexRelease(&sourceInfo->lock);
+}
@@ -19,7 +19,9 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "kernel/filesystem/filesystem_ramdiskdelegate.hpp"
+#include "kernel/filesystem/filesystem_dentry_cache.hpp"
 #include "kernel/filesystem/ramdisk.hpp"
+#include "kernel/filesystem/ramdisk_cache.hpp"
 
 #include "kernel/memory/memory.hpp"
 #include "kernel/kernel.hpp"
@@ -72,11 +74,37 @@ g_fs_read_status filesystemRamdiskDelegateRead(g_fs_node* node, uint8_t* buffer,
 	if(!entry)
 		return G_FS_READ_ERROR;
 
-	if(offset + length > entry->dataSize)
-		length = entry->dataSize - offset;
+	int32_t read = ramdiskReadData(entry, offset, buffer, length);
+	if(read < 0)
+		return G_FS_READ_ERROR;
+
+	*outRead = read;
+	return G_FS_READ_SUCCESSFUL;
+}
+
+g_fs_read_status filesystemRamdiskDelegateReadVector(g_fs_node* node, g_fs_iovec* vectors, uint32_t count, uint64_t offset, int64_t* outRead)
+{
+	g_ramdisk_entry* entry = ramdiskFindById(node->physicalId);
+	if(!entry)
+		return G_FS_READ_ERROR;
+
+	int64_t total = 0;
+	for(uint32_t i = 0; i < count; i++)
+	{
+		int32_t read = ramdiskReadData(entry, offset + total, (uint8_t*) vectors[i].base, vectors[i].length);
+		if(read < 0)
+		{
+			if(total == 0)
+				return G_FS_READ_ERROR;
+			break;
+		}
+
+		total += read;
+		if((uint32_t) read < vectors[i].length)
+			break;
+	}
 
-	memoryCopy(buffer, &entry->data[offset], length);
-	*outRead = length;
+	*outRead = total;
 	return G_FS_READ_SUCCESSFUL;
 }
 
@@ -91,10 +119,20 @@ g_fs_write_status filesystemRamdiskDelegateWrite(g_fs_node* node, uint8_t* buffe
 	{
 		uint32_t buflen = entry->dataSize * 1.2;
 		uint8_t* new_buffer = (uint8_t*) heapAllocate(sizeof(uint8_t) * buflen);
-		memoryCopy(new_buffer, entry->data, entry->dataSize);
+		if(ramdiskReadData(entry, 0, new_buffer, entry->dataSize) < 0)
+		{
+			heapFree(new_buffer);
+			return G_FS_WRITE_ERROR;
+		}
 		entry->data = new_buffer;
 		entry->notOnRdBufferLength = buflen;
 
+		if(entry->compressed)
+		{
+			entry->compressed = false;
+			ramdiskCacheDrop(entry->id);
+		}
+
 	} else if(entry->data == nullptr)
 	{
 		uint32_t initbuflen = 32;
@@ -126,11 +164,11 @@ g_fs_write_status filesystemRamdiskDelegateWrite(g_fs_node* node, uint8_t* buffe
 
 g_fs_length_status filesystemRamdiskDelegateGetLength(g_fs_node* node, uint64_t* outLength)
 {
-	g_ramdisk_entry* entry = ramdiskFindById(node->physicalId);
-	if(!entry)
+	g_ramdisk_entry_summary summary;
+	if(!ramdiskDescribe(node->physicalId, &summary))
 		return G_FS_LENGTH_ERROR;
 
-	*outLength = entry->dataSize;
+	*outLength = summary.length;
 	return G_FS_LENGTH_SUCCESSFUL;
 }
 
@@ -166,3 +204,32 @@ g_fs_open_status filesystemRamdiskDelegateTruncate(g_fs_node* file)
 	}
 	return G_FS_OPEN_SUCCESSFUL;
 }
+
+g_fs_directory_refresh_status filesystemRamdiskDelegateRefreshDirectory(g_fs_node* folder)
+{
+	g_ramdisk_id id;
+	if(folder->type == G_FS_NODE_TYPE_MOUNTPOINT)
+		id = ramdiskGetRoot()->id;
+	else
+		id = folder->physicalId;
+
+	// Children are taken from the image table, entries are only created when they are used
+	uint32_t count = ramdiskGetChildCount(id);
+	for(uint32_t index = 0; index < count; index++)
+	{
+		g_ramdisk_entry_summary child;
+		if(!ramdiskDescribeChildAt(id, index, &child))
+			break;
+
+		g_fs_node* existing;
+		if(filesystemDentryCacheLookup(folder, child.name, &existing) == G_FS_DENTRY_LOOKUP_FOUND)
+			continue;
+
+		g_fs_node_type nodeType = child.type == G_RAMDISK_ENTRY_TYPE_FILE ? G_FS_NODE_TYPE_FILE : G_FS_NODE_TYPE_FOLDER;
+		g_fs_node* newNode = filesystemCreateNode(nodeType, child.name);
+		newNode->physicalId = child.id;
+		filesystemAddChild(folder, newNode);
+	}
+
+	return G_FS_DIRECTORY_REFRESH_SUCCESSFUL;
+}
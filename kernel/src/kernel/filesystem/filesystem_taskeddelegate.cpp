@@ -0,0 +1,784 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/filesystem/filesystem_taskeddelegate.hpp"
+#include "kernel/filesystem/filesystem_dentry_cache.hpp"
+#include "kernel/ipc/channel.hpp"
+#include "kernel/memory/memory.hpp"
+#include "kernel/memory/heap.hpp"
+#include "kernel/memory/paging.hpp"
+#include "kernel/tasking/wait.hpp"
+#include "kernel/tasking/wait_queue.hpp"
+
+#include "shared/logger/logger.hpp"
+#include "shared/utils/string.hpp"
+
+static g_fs_tasked_delegate_mount* filesystemTaskedDelegateMounts;
+static g_mutex filesystemTaskedDelegateMountsLock;
+
+void filesystemTaskedDelegateInitialize()
+{
+	mutexInitialize(&filesystemTaskedDelegateMountsLock);
+	filesystemTaskedDelegateMounts = 0;
+}
+
+/**
+ * Unmaps and frees the first pages of the shared memory.
+ */
+static void filesystemTaskedDelegateFreeShared(g_process* process, g_virtual_address kernelBase, g_virtual_address userBase, uint32_t mappedPages)
+{
+	for(uint32_t i = 0; i < mappedPages; i++)
+	{
+		g_physical_address page = pagingVirtualToPhysical(kernelBase + i * G_PAGE_SIZE);
+		pagingUnmapPage(kernelBase + i * G_PAGE_SIZE);
+		pagingUnmapPage(userBase + i * G_PAGE_SIZE);
+		memoryPhysicalFree(page);
+	}
+	addressRangePoolFree(memoryVirtualRangePool, kernelBase);
+	addressRangePoolFree(process->virtualRangePool, userBase);
+}
+
+/**
+ * Allocates the memory that is shared with the delegate and maps it into the kernel area
+ * and into the current address space, which is the one of the delegate process. The
+ * physical memory is not managed by the process, so it stays intact if it exits.
+ */
+static g_fs_tasked_delegate_ring* filesystemTaskedDelegateCreateShared(g_process* process, g_address* outUserAddress)
+{
+	const uint32_t pages = G_FS_TASKED_DELEGATE_SHARED_SIZE / G_PAGE_SIZE;
+
+	g_virtual_address kernelBase = addressRangePoolAllocate(memoryVirtualRangePool, pages);
+	if(!kernelBase)
+		return 0;
+
+	g_virtual_address userBase = addressRangePoolAllocate(process->virtualRangePool, pages, G_PROC_VIRTUAL_RANGE_FLAG_WEAK);
+	if(!userBase)
+	{
+		addressRangePoolFree(memoryVirtualRangePool, kernelBase);
+		return 0;
+	}
+
+	for(uint32_t i = 0; i < pages; i++)
+	{
+		g_physical_address page = memoryPhysicalAllocate();
+		if(!page)
+		{
+			filesystemTaskedDelegateFreeShared(process, kernelBase, userBase, i);
+			return 0;
+		}
+		pagingMapPage(kernelBase + i * G_PAGE_SIZE, page, DEFAULT_KERNEL_TABLE_FLAGS, DEFAULT_KERNEL_PAGE_FLAGS);
+		pagingMapPage(userBase + i * G_PAGE_SIZE, page, DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
+	}
+	memorySetBytes((void*) kernelBase, 0, pages * G_PAGE_SIZE);
+
+	*outUserAddress = userBase;
+	return (g_fs_tasked_delegate_ring*) kernelBase;
+}
+
+static bool filesystemTaskedDelegateIsAlive(g_fs_tasked_delegate_mount* mount)
+{
+	g_task* delegateTask = taskingGetById(mount->delegateProcess);
+	return delegateTask && delegateTask->status != G_THREAD_STATUS_DEAD && delegateTask->status != G_THREAD_STATUS_UNUSED;
+}
+
+/**
+ * Returns the mount that the mountpoint belongs to, if it is served by a delegate
+ * that has exited.
+ */
+static g_fs_tasked_delegate_mount* filesystemTaskedDelegateGetExitedMount(g_fs_node* mountpoint)
+{
+	g_fs_delegate* delegate = mountpoint->delegate;
+	if(!delegate || delegate->discover != filesystemTaskedDelegateDiscover)
+		return 0;
+
+	g_fs_tasked_delegate_mount* mount = (g_fs_tasked_delegate_mount*) delegate->data;
+	if(filesystemTaskedDelegateIsAlive(mount))
+		return 0;
+	return mount;
+}
+
+/**
+ * Removes the mountpoint from the mount folder and wakes the requests that wait for
+ * the delegate, which then see that it has exited.
+ */
+static void filesystemTaskedDelegateDetach(g_fs_tasked_delegate_mount* mount)
+{
+	mutexAcquire(&mount->lock);
+	bool wasDetached = mount->detached;
+	mount->detached = true;
+	mutexRelease(&mount->lock);
+
+	if(wasDetached)
+		return;
+
+	filesystemRemoveChild(filesystemGetMountFolder(), mount->mountpoint);
+	waitQueueWake(channelGetWaitQueue(mount->completedPhysical));
+}
+
+g_fs_register_as_delegate_status filesystemTaskedDelegateRegister(g_task* task, const char* name, g_fs_phys_id physMountpointId,
+		g_fs_virt_id* outMountpointId, g_address* outTransactionStorage)
+{
+	int nameLength = stringLength(name);
+	if(nameLength == 0 || nameLength > G_FILENAME_MAX || stringIndexOf(name, '/') != -1 || stringEquals(name, ".") || stringEquals(name, ".."))
+		return G_FS_REGISTER_AS_DELEGATE_FAILED_DELEGATE_CREATION;
+
+	// All mountpoints are in the node tree, so the cache knows every used name
+	g_fs_node* mountFolder = filesystemGetMountFolder();
+	g_fs_node* existing;
+	if(filesystemDentryCacheLookup(mountFolder, name, &existing) == G_FS_DENTRY_LOOKUP_FOUND)
+	{
+		g_fs_tasked_delegate_mount* exited = filesystemTaskedDelegateGetExitedMount(existing);
+		if(!exited)
+		{
+			logInfo("%! process %i can't mount '%s', the name is already used", "fs", task->process->id, name);
+			return G_FS_REGISTER_AS_DELEGATE_FAILED_EXISTING;
+		}
+
+		// Its shared memory is freed once its process is removed
+		logInfo("%! process %i replaces mountpoint '%s' of exited process %i", "fs", task->process->id, name, exited->delegateProcess);
+		filesystemTaskedDelegateDetach(exited);
+	}
+
+	g_address userAddress;
+	g_fs_tasked_delegate_ring* ring = filesystemTaskedDelegateCreateShared(task->process, &userAddress);
+	if(!ring)
+	{
+		logInfo("%! failed to allocate shared memory for delegate of process %i", "fs", task->process->id);
+		return G_FS_REGISTER_AS_DELEGATE_FAILED_DELEGATE_CREATION;
+	}
+
+	g_fs_tasked_delegate_mount* mount = (g_fs_tasked_delegate_mount*) heapAllocateClear(sizeof(g_fs_tasked_delegate_mount));
+	mutexInitialize(&mount->lock);
+	mount->delegateProcess = task->process->id;
+	mount->ring = ring;
+	mount->ringUserAddress = userAddress;
+
+	// Words are identified like the process identifies them when waiting on them
+	mount->headPhysical = channelGetWordAddress(task->process, &((g_fs_tasked_delegate_ring*) userAddress)->head);
+	mount->completedPhysical = channelGetWordAddress(task->process, &((g_fs_tasked_delegate_ring*) userAddress)->completed);
+
+	g_fs_delegate* delegate = filesystemCreateDelegate();
+	delegate->open = filesystemTaskedDelegateOpen;
+	delegate->close = filesystemTaskedDelegateClose;
+	delegate->discover = filesystemTaskedDelegateDiscover;
+	delegate->read = filesystemTaskedDelegateRead;
+	delegate->write = filesystemTaskedDelegateWrite;
+	delegate->getLength = filesystemTaskedDelegateGetLength;
+	delegate->create = filesystemTaskedDelegateCreate;
+	delegate->truncate = filesystemTaskedDelegateTruncate;
+	delegate->refreshDirectory = filesystemTaskedDelegateRefreshDirectory;
+	delegate->data = mount;
+
+	g_fs_node* mountpoint = filesystemCreateNode(G_FS_NODE_TYPE_MOUNTPOINT, name);
+	mountpoint->physicalId = physMountpointId;
+	mountpoint->delegate = delegate;
+	mount->mountpoint = mountpoint;
+	filesystemAddChild(mountFolder, mountpoint);
+
+	mutexAcquire(&filesystemTaskedDelegateMountsLock);
+	mount->next = filesystemTaskedDelegateMounts;
+	filesystemTaskedDelegateMounts = mount;
+	mutexRelease(&filesystemTaskedDelegateMountsLock);
+
+	logInfo("%! process %i serves mountpoint '%s'", "fs", task->process->id, name);
+	*outMountpointId = mountpoint->id;
+	*outTransactionStorage = userAddress;
+	return G_FS_REGISTER_AS_DELEGATE_SUCCESSFUL;
+}
+
+/**
+ * Returns the mount of the delegate responsible for the node, if it is a tasked
+ * delegate that is served by the process of the task.
+ */
+static g_fs_tasked_delegate_mount* filesystemTaskedDelegateGetOwnedMount(g_task* task, g_fs_node* node)
+{
+	g_fs_delegate* delegate = filesystemFindDelegate(node);
+	if(delegate->discover != filesystemTaskedDelegateDiscover)
+		return 0;
+
+	g_fs_tasked_delegate_mount* mount = (g_fs_tasked_delegate_mount*) delegate->data;
+	if(mount->delegateProcess != task->process->id)
+		return 0;
+	return mount;
+}
+
+static g_fs_tasked_delegate_mount* filesystemTaskedDelegateGetMount(g_fs_node* node)
+{
+	return (g_fs_tasked_delegate_mount*) filesystemFindDelegate(node)->data;
+}
+
+bool filesystemTaskedDelegateSetTransactionStatus(g_task* task, g_fs_transaction_id transaction, g_fs_transaction_status status)
+{
+	g_fs_node* mountpoint = filesystemGetNode((g_fs_virt_id) (transaction >> 32));
+	uint32_t slot = (uint32_t) transaction;
+	if(!mountpoint || slot >= G_FS_TASKED_DELEGATE_SLOTS)
+		return false;
+
+	g_fs_tasked_delegate_mount* mount = filesystemTaskedDelegateGetOwnedMount(task, mountpoint);
+	if(!mount || mount->mountpoint != mountpoint)
+		return false;
+
+	g_fs_tasked_delegate_ring* ring = mount->ring;
+	__atomic_store_n(&ring->requests[slot].transaction_status, status, __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&ring->completed, 1, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&ring->kernel_waiting, __ATOMIC_SEQ_CST))
+		waitQueueWake(channelGetWaitQueue(mount->completedPhysical));
+	return true;
+}
+
+static bool filesystemTaskedDelegateIsValidType(g_fs_node_type type)
+{
+	return type == G_FS_NODE_TYPE_FILE || type == G_FS_NODE_TYPE_FOLDER;
+}
+
+g_fs_create_node_status filesystemTaskedDelegateCreateNode(g_task* task, g_fs_virt_id parentId, const char* name, g_fs_node_type type,
+		g_fs_phys_id physId, g_fs_virt_id* outCreatedId)
+{
+	g_fs_node* parent = filesystemGetNode(parentId);
+	if(!parent || !filesystemTaskedDelegateGetOwnedMount(task, parent))
+		return G_FS_CREATE_NODE_STATUS_FAILED_NO_PARENT;
+
+	int nameLength = stringLength(name);
+	if(!filesystemTaskedDelegateIsValidType(type) || nameLength == 0 || nameLength > G_FILENAME_MAX || stringIndexOf(name, '/') != -1)
+		return G_FS_CREATE_NODE_STATUS_FAILED_NO_PARENT;
+
+	// The name may have appeared outside of the VFS after a lookup has missed it
+	g_fs_node* existing;
+	g_fs_dentry_lookup cached = filesystemDentryCacheLookup(parent, name, &existing);
+	if(cached == G_FS_DENTRY_LOOKUP_NEGATIVE)
+		filesystemDentryCacheRemove(parent, name);
+
+	if(cached == G_FS_DENTRY_LOOKUP_FOUND)
+	{
+		existing->physicalId = physId;
+		existing->type = type;
+		*outCreatedId = existing->id;
+		return G_FS_CREATE_NODE_STATUS_UPDATED;
+	}
+
+	g_fs_node* node = filesystemCreateNode(type, name);
+	node->physicalId = physId;
+	filesystemAddChild(parent, node);
+	*outCreatedId = node->id;
+	return G_FS_CREATE_NODE_STATUS_CREATED;
+}
+
+/**
+ * Only kernel threads that hold no lock may wait for the delegate. Everyone else is
+ * told that the delegate is busy, system calls are then repeated on a worker.
+ */
+static bool filesystemTaskedDelegateCanWait()
+{
+	return taskingGetCurrentTask()->securityLevel == G_SECURITY_LEVEL_KERNEL && taskingGetLocal()->locksHeld == 0;
+}
+
+/**
+ * Takes a free slot. If all slots are used, yields until another request has finished.
+ *
+ * @return whether a slot was taken, which fails once the mount is detached
+ */
+static bool filesystemTaskedDelegateTakeSlot(g_fs_tasked_delegate_mount* mount, uint32_t* outSlot)
+{
+	for(;;)
+	{
+		mutexAcquire(&mount->lock);
+		if(mount->detached)
+		{
+			mutexRelease(&mount->lock);
+			return false;
+		}
+
+		for(uint32_t slot = 0; slot < G_FS_TASKED_DELEGATE_SLOTS; slot++)
+		{
+			if((mount->usedSlots & (1 << slot)) == 0)
+			{
+				mount->usedSlots |= (1 << slot);
+				mutexRelease(&mount->lock);
+				*outSlot = slot;
+				return true;
+			}
+		}
+		mutexRelease(&mount->lock);
+
+		taskingKernelThreadYield();
+	}
+}
+
+static void filesystemTaskedDelegateReleaseSlot(g_fs_tasked_delegate_mount* mount, uint32_t slot)
+{
+	mutexAcquire(&mount->lock);
+	mount->usedSlots &= ~(1 << slot);
+	mutexRelease(&mount->lock);
+}
+
+/**
+ * Prepares the request in the slot for the node. The caller fills in the remaining fields.
+ */
+static g_fs_tasked_delegate_request* filesystemTaskedDelegatePrepare(g_fs_tasked_delegate_mount* mount, uint32_t slot,
+		g_fs_tasked_delegate_request_type type, g_fs_node* node)
+{
+	g_fs_tasked_delegate_request* request = &mount->ring->requests[slot];
+	request->transaction = ((g_fs_transaction_id) mount->mountpoint->id << 32) | slot;
+	request->type = type;
+	request->phys_fs_id = node->physicalId;
+	request->virt_fs_id = node->id;
+	request->offset = 0;
+	request->length = 0;
+	request->result_status = 0;
+	request->result = 0;
+	request->result_phys_fs_id = 0;
+	request->result_type = G_FS_NODE_TYPE_NONE;
+	return request;
+}
+
+/**
+ * Passes the prepared request in the slot to the delegate and waits until the delegate
+ * has finished it. Requests that the delegate asks to repeat are passed again.
+ *
+ * @return whether the delegate has answered
+ */
+static bool filesystemTaskedDelegateExecute(g_fs_tasked_delegate_mount* mount, uint32_t slot)
+{
+	g_task* task = taskingGetCurrentTask();
+	g_fs_tasked_delegate_ring* ring = mount->ring;
+	g_fs_tasked_delegate_request* request = &ring->requests[slot];
+
+	g_fs_transaction_status status;
+	do
+	{
+		if(!filesystemTaskedDelegateIsAlive(mount))
+			return false;
+
+		__atomic_store_n(&request->transaction_status, G_FS_TRANSACTION_WAITING, __ATOMIC_SEQ_CST);
+
+		mutexAcquire(&mount->lock);
+		uint32_t head = ring->head;
+		ring->queue[head % G_FS_TASKED_DELEGATE_SLOTS] = slot;
+		__atomic_store_n(&ring->head, head + 1, __ATOMIC_SEQ_CST);
+		bool wakeDelegate = __atomic_load_n(&ring->delegate_waiting, __ATOMIC_SEQ_CST);
+		mutexRelease(&mount->lock);
+
+		// The delegate only needs a wake if it announced that it goes to sleep
+		if(wakeDelegate)
+			waitQueueWake(channelGetWaitQueue(mount->headPhysical));
+
+		__atomic_add_fetch(&ring->kernel_waiting, 1, __ATOMIC_SEQ_CST);
+		for(;;)
+		{
+			uint32_t seen = __atomic_load_n(&ring->completed, __ATOMIC_SEQ_CST);
+			status = __atomic_load_n(&request->transaction_status, __ATOMIC_SEQ_CST);
+			if(status != G_FS_TRANSACTION_WAITING || !filesystemTaskedDelegateIsAlive(mount))
+				break;
+
+			waitForTaskedDelegate(task, &ring->completed, mount->completedPhysical, seen, mount->delegateProcess);
+			taskingKernelThreadYield();
+		}
+		__atomic_sub_fetch(&ring->kernel_waiting, 1, __ATOMIC_SEQ_CST);
+
+		if(status == G_FS_TRANSACTION_WAITING)
+			return false;
+	} while(status == G_FS_TRANSACTION_REPEAT);
+
+	return true;
+}
+
+g_fs_open_status filesystemTaskedDelegateOpen(g_fs_node* node)
+{
+	// Nodes are only known after the delegate has discovered or created them
+	return G_FS_OPEN_SUCCESSFUL;
+}
+
+g_fs_close_status filesystemTaskedDelegateClose(g_fs_node* node)
+{
+	return G_FS_CLOSE_SUCCESSFUL;
+}
+
+/**
+ * Asks the delegate for a node that needs a name, which is passed in the transfer buffer.
+ */
+static bool filesystemTaskedDelegateExecuteNamed(g_fs_tasked_delegate_mount* mount, uint32_t slot, g_fs_tasked_delegate_request_type type,
+		g_fs_node* parent, const char* name)
+{
+	filesystemTaskedDelegatePrepare(mount, slot, type, parent);
+
+	int nameLength = stringLength(name);
+	if(nameLength >= G_FS_TASKED_DELEGATE_TRANSFER_SIZE)
+		return false;
+	memoryCopy(G_FS_TASKED_DELEGATE_TRANSFER(mount->ring, slot), name, nameLength + 1);
+
+	return filesystemTaskedDelegateExecute(mount, slot);
+}
+
+/**
+ * Adds the node that the delegate reported to the parent, unless the delegate has
+ * created it itself meanwhile.
+ */
+static g_fs_node* filesystemTaskedDelegateAddNode(g_fs_node* parent, const char* name, g_fs_node_type type, g_fs_phys_id physId)
+{
+	g_fs_node* node;
+	if(filesystemDentryCacheLookup(parent, name, &node) == G_FS_DENTRY_LOOKUP_FOUND)
+		return node;
+
+	node = filesystemCreateNode(type, name);
+	node->physicalId = physId;
+	filesystemAddChild(parent, node);
+	return node;
+}
+
+g_fs_open_status filesystemTaskedDelegateDiscover(g_fs_node* parent, const char* name, g_fs_node** outNode)
+{
+	*outNode = 0;
+	if(!filesystemTaskedDelegateCanWait())
+		return G_FS_OPEN_BUSY;
+
+	g_fs_tasked_delegate_mount* mount = filesystemTaskedDelegateGetMount(parent);
+	uint32_t slot;
+	if(!filesystemTaskedDelegateTakeSlot(mount, &slot))
+		return G_FS_OPEN_ERROR;
+	g_fs_tasked_delegate_request* request = &mount->ring->requests[slot];
+
+	g_fs_open_status status = G_FS_OPEN_ERROR;
+	if(filesystemTaskedDelegateExecuteNamed(mount, slot, G_FS_TASKED_DELEGATE_REQUEST_TYPE_DISCOVER, parent, name))
+	{
+		g_fs_discovery_status discovery = request->result_status;
+		if(discovery == G_FS_DISCOVERY_SUCCESSFUL && filesystemTaskedDelegateIsValidType(request->result_type))
+		{
+			*outNode = filesystemTaskedDelegateAddNode(parent, name, request->result_type, request->result_phys_fs_id);
+			status = G_FS_OPEN_SUCCESSFUL;
+		} else if(discovery == G_FS_DISCOVERY_NOT_FOUND)
+		{
+			status = G_FS_OPEN_NOT_FOUND;
+		} else if(discovery == G_FS_DISCOVERY_BUSY)
+		{
+			status = G_FS_OPEN_BUSY;
+		}
+	}
+
+	filesystemTaskedDelegateReleaseSlot(mount, slot);
+	return status;
+}
+
+g_fs_read_status filesystemTaskedDelegateRead(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outRead)
+{
+	*outRead = 0;
+	if(!filesystemTaskedDelegateCanWait())
+		return G_FS_READ_BUSY;
+
+	g_fs_tasked_delegate_mount* mount = filesystemTaskedDelegateGetMount(node);
+	uint32_t slot;
+	if(!filesystemTaskedDelegateTakeSlot(mount, &slot))
+		return G_FS_READ_ERROR;
+	uint8_t* transfer = G_FS_TASKED_DELEGATE_TRANSFER(mount->ring, slot);
+
+	// Larger reads are split into requests that each fit the transfer buffer
+	uint64_t total = 0;
+	g_fs_read_status status = G_FS_READ_SUCCESSFUL;
+	while(total < length)
+	{
+		uint64_t chunk = length - total;
+		if(chunk > G_FS_TASKED_DELEGATE_TRANSFER_SIZE)
+			chunk = G_FS_TASKED_DELEGATE_TRANSFER_SIZE;
+
+		g_fs_tasked_delegate_request* request = filesystemTaskedDelegatePrepare(mount, slot, G_FS_TASKED_DELEGATE_REQUEST_TYPE_READ, node);
+		request->offset = offset + total;
+		request->length = chunk;
+		if(!filesystemTaskedDelegateExecute(mount, slot))
+		{
+			status = G_FS_READ_ERROR;
+			break;
+		}
+
+		if(request->result_status != G_FS_READ_SUCCESSFUL)
+		{
+			status = request->result_status;
+			break;
+		}
+
+		int64_t read = request->result;
+		if(read <= 0)
+			break;
+		if((uint64_t) read > chunk)
+			read = chunk;
+
+		memoryCopy(buffer + total, transfer, read);
+		total += read;
+		if((uint64_t) read < chunk)
+			break;
+	}
+
+	filesystemTaskedDelegateReleaseSlot(mount, slot);
+
+	if(total > 0)
+		status = G_FS_READ_SUCCESSFUL;
+	*outRead = total;
+	return status;
+}
+
+g_fs_write_status filesystemTaskedDelegateWrite(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outWrote)
+{
+	*outWrote = 0;
+	if(!filesystemTaskedDelegateCanWait())
+		return G_FS_WRITE_BUSY;
+
+	g_fs_tasked_delegate_mount* mount = filesystemTaskedDelegateGetMount(node);
+	uint32_t slot;
+	if(!filesystemTaskedDelegateTakeSlot(mount, &slot))
+		return G_FS_WRITE_ERROR;
+	uint8_t* transfer = G_FS_TASKED_DELEGATE_TRANSFER(mount->ring, slot);
+
+	uint64_t total = 0;
+	g_fs_write_status status = G_FS_WRITE_SUCCESSFUL;
+	while(total < length)
+	{
+		uint64_t chunk = length - total;
+		if(chunk > G_FS_TASKED_DELEGATE_TRANSFER_SIZE)
+			chunk = G_FS_TASKED_DELEGATE_TRANSFER_SIZE;
+
+		g_fs_tasked_delegate_request* request = filesystemTaskedDelegatePrepare(mount, slot, G_FS_TASKED_DELEGATE_REQUEST_TYPE_WRITE, node);
+		request->offset = offset + total;
+		request->length = chunk;
+		memoryCopy(transfer, buffer + total, chunk);
+		if(!filesystemTaskedDelegateExecute(mount, slot))
+		{
+			status = G_FS_WRITE_ERROR;
+			break;
+		}
+
+		if(request->result_status != G_FS_WRITE_SUCCESSFUL)
+		{
+			status = request->result_status;
+			break;
+		}
+
+		int64_t wrote = request->result;
+		if(wrote <= 0)
+			break;
+		if((uint64_t) wrote > chunk)
+			wrote = chunk;
+
+		total += wrote;
+		if((uint64_t) wrote < chunk)
+			break;
+	}
+
+	filesystemTaskedDelegateReleaseSlot(mount, slot);
+
+	if(total > 0)
+		status = G_FS_WRITE_SUCCESSFUL;
+	*outWrote = total;
+	return status;
+}
+
+g_fs_length_status filesystemTaskedDelegateGetLength(g_fs_node* node, uint64_t* outLength)
+{
+	*outLength = 0;
+	if(!filesystemTaskedDelegateCanWait())
+		return G_FS_LENGTH_BUSY;
+
+	g_fs_tasked_delegate_mount* mount = filesystemTaskedDelegateGetMount(node);
+	uint32_t slot;
+	if(!filesystemTaskedDelegateTakeSlot(mount, &slot))
+		return G_FS_LENGTH_ERROR;
+	g_fs_tasked_delegate_request* request = filesystemTaskedDelegatePrepare(mount, slot, G_FS_TASKED_DELEGATE_REQUEST_TYPE_GET_LENGTH, node);
+
+	g_fs_length_status status = G_FS_LENGTH_ERROR;
+	if(filesystemTaskedDelegateExecute(mount, slot))
+	{
+		status = request->result_status;
+		if(status == G_FS_LENGTH_SUCCESSFUL)
+			*outLength = request->result;
+	}
+
+	filesystemTaskedDelegateReleaseSlot(mount, slot);
+	return status;
+}
+
+g_fs_open_status filesystemTaskedDelegateCreate(g_fs_node* parent, const char* name, g_fs_node** outFile)
+{
+	*outFile = 0;
+	if(!filesystemTaskedDelegateCanWait())
+		return G_FS_OPEN_BUSY;
+
+	g_fs_tasked_delegate_mount* mount = filesystemTaskedDelegateGetMount(parent);
+	uint32_t slot;
+	if(!filesystemTaskedDelegateTakeSlot(mount, &slot))
+		return G_FS_OPEN_ERROR;
+	g_fs_tasked_delegate_request* request = &mount->ring->requests[slot];
+
+	g_fs_open_status status = G_FS_OPEN_ERROR;
+	if(filesystemTaskedDelegateExecuteNamed(mount, slot, G_FS_TASKED_DELEGATE_REQUEST_TYPE_CREATE, parent, name))
+	{
+		status = request->result_status;
+		if(status == G_FS_OPEN_SUCCESSFUL)
+			*outFile = filesystemTaskedDelegateAddNode(parent, name, G_FS_NODE_TYPE_FILE, request->result_phys_fs_id);
+	}
+
+	filesystemTaskedDelegateReleaseSlot(mount, slot);
+	return status;
+}
+
+g_fs_open_status filesystemTaskedDelegateTruncate(g_fs_node* file)
+{
+	if(!filesystemTaskedDelegateCanWait())
+		return G_FS_OPEN_BUSY;
+
+	g_fs_tasked_delegate_mount* mount = filesystemTaskedDelegateGetMount(file);
+	uint32_t slot;
+	if(!filesystemTaskedDelegateTakeSlot(mount, &slot))
+		return G_FS_OPEN_ERROR;
+	g_fs_tasked_delegate_request* request = filesystemTaskedDelegatePrepare(mount, slot, G_FS_TASKED_DELEGATE_REQUEST_TYPE_TRUNCATE, file);
+
+	g_fs_open_status status = G_FS_OPEN_ERROR;
+	if(filesystemTaskedDelegateExecute(mount, slot))
+		status = request->result_status;
+
+	filesystemTaskedDelegateReleaseSlot(mount, slot);
+	return status;
+}
+
+/**
+ * Adds the children from the directory records in the transfer buffer to the folder.
+ * The buffer is writable by the delegate, so the records are checked and copied first.
+ */
+static void filesystemTaskedDelegateAddRecords(g_fs_node* folder, uint8_t* transfer, int64_t count, char* name)
+{
+	uint32_t position = 0;
+	for(int64_t index = 0; index < count; index++)
+	{
+		if(position + sizeof(g_fs_tasked_delegate_directory_record) > G_FS_TASKED_DELEGATE_TRANSFER_SIZE)
+			break;
+
+		g_fs_tasked_delegate_directory_record* record = (g_fs_tasked_delegate_directory_record*) &transfer[position];
+		uint32_t recordLength = record->record_length;
+		if(recordLength <= sizeof(g_fs_tasked_delegate_directory_record) || recordLength > G_FS_TASKED_DELEGATE_TRANSFER_SIZE - position)
+			break;
+
+		g_fs_phys_id physId = record->phys_fs_id;
+		g_fs_node_type type = record->type;
+
+		uint32_t nameMaximum = recordLength - sizeof(g_fs_tasked_delegate_directory_record);
+		if(nameMaximum > G_FILENAME_MAX)
+			nameMaximum = G_FILENAME_MAX;
+		uint32_t nameLength = 0;
+		while(nameLength < nameMaximum && record->name[nameLength])
+		{
+			name[nameLength] = record->name[nameLength];
+			nameLength++;
+		}
+		name[nameLength] = 0;
+		position += recordLength;
+
+		if(nameLength == 0 || !filesystemTaskedDelegateIsValidType(type) || stringIndexOf(name, '/') != -1)
+			continue;
+		filesystemTaskedDelegateAddNode(folder, name, type, physId);
+	}
+}
+
+g_fs_directory_refresh_status filesystemTaskedDelegateRefreshDirectory(g_fs_node* folder)
+{
+	if(!filesystemTaskedDelegateCanWait())
+		return G_FS_DIRECTORY_REFRESH_BUSY;
+
+	g_fs_tasked_delegate_mount* mount = filesystemTaskedDelegateGetMount(folder);
+	uint32_t slot;
+	if(!filesystemTaskedDelegateTakeSlot(mount, &slot))
+		return G_FS_DIRECTORY_REFRESH_ERROR;
+	uint8_t* transfer = G_FS_TASKED_DELEGATE_TRANSFER(mount->ring, slot);
+	char* name = (char*) heapAllocate(G_FILENAME_MAX + 1);
+
+	// The delegate is asked for the next children until it has no more
+	g_fs_directory_refresh_status status = G_FS_DIRECTORY_REFRESH_SUCCESSFUL;
+	int64_t index = 0;
+	for(;;)
+	{
+		g_fs_tasked_delegate_request* request = filesystemTaskedDelegatePrepare(mount, slot, G_FS_TASKED_DELEGATE_REQUEST_TYPE_READ_DIRECTORY, folder);
+		request->offset = index;
+		request->length = G_FS_TASKED_DELEGATE_TRANSFER_SIZE;
+		if(!filesystemTaskedDelegateExecute(mount, slot))
+		{
+			status = G_FS_DIRECTORY_REFRESH_ERROR;
+			break;
+		}
+
+		if(request->result_status != G_FS_DIRECTORY_REFRESH_SUCCESSFUL)
+		{
+			status = request->result_status;
+			break;
+		}
+
+		int64_t count = request->result;
+		if(count <= 0)
+			break;
+
+		filesystemTaskedDelegateAddRecords(folder, transfer, count, name);
+		index += count;
+	}
+
+	heapFree(name);
+	filesystemTaskedDelegateReleaseSlot(mount, slot);
+	return status;
+}
+
+void filesystemTaskedDelegateProcessRemoved(g_process* process)
+{
+	for(;;)
+	{
+		mutexAcquire(&filesystemTaskedDelegateMountsLock);
+		g_fs_tasked_delegate_mount* previous = 0;
+		g_fs_tasked_delegate_mount* mount = filesystemTaskedDelegateMounts;
+		while(mount && mount->delegateProcess != process->id)
+		{
+			previous = mount;
+			mount = mount->next;
+		}
+		if(mount)
+		{
+			if(previous)
+				previous->next = mount->next;
+			else
+				filesystemTaskedDelegateMounts = mount->next;
+		}
+		mutexRelease(&filesystemTaskedDelegateMountsLock);
+
+		if(!mount)
+			break;
+
+		filesystemTaskedDelegateDetach(mount);
+
+		// Requests that still use the ring fail now that the delegate is gone
+		for(;;)
+		{
+			mutexAcquire(&mount->lock);
+			uint32_t usedSlots = mount->usedSlots;
+			mutexRelease(&mount->lock);
+			if(usedSlots == 0)
+				break;
+			taskingKernelThreadYield();
+		}
+
+		g_physical_address returnDirectory = taskingTemporarySwitchToSpace(process->pageDirectory);
+		filesystemTaskedDelegateFreeShared(process, (g_virtual_address) mount->ring, mount->ringUserAddress,
+				G_FS_TASKED_DELEGATE_SHARED_SIZE / G_PAGE_SIZE);
+		taskingTemporarySwitchBack(returnDirectory);
+		mount->ring = 0;
+
+		logInfo("%! removed mountpoint '%s' of process %i", "fs", mount->mountpoint->name, process->id);
+	}
+}
@@ -0,0 +1,104 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/filesystem/filesystem_tmpfsdelegate.hpp"
+#include "kernel/filesystem/tmpfs.hpp"
+
+g_fs_open_status filesystemTmpfsDelegateOpen(g_fs_node* node)
+{
+	return G_FS_OPEN_SUCCESSFUL;
+}
+
+g_fs_close_status filesystemTmpfsDelegateClose(g_fs_node* node)
+{
+	return G_FS_CLOSE_SUCCESSFUL;
+}
+
+g_fs_open_status filesystemTmpfsDelegateDiscover(g_fs_node* parent, const char* name, g_fs_node** outNode)
+{
+	// All nodes are added to the tree when they are created
+	*outNode = 0;
+	return G_FS_OPEN_NOT_FOUND;
+}
+
+g_fs_read_status filesystemTmpfsDelegateRead(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outRead)
+{
+	g_tmpfs_file* file = node->type == G_FS_NODE_TYPE_FILE ? tmpfsGetFile(node->physicalId) : 0;
+	if(!file)
+		return G_FS_READ_ERROR;
+
+	*outRead = tmpfsRead(file, buffer, offset, length);
+	return G_FS_READ_SUCCESSFUL;
+}
+
+g_fs_write_status filesystemTmpfsDelegateWrite(g_fs_node* node, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outWrote)
+{
+	g_tmpfs_file* file = node->type == G_FS_NODE_TYPE_FILE ? tmpfsGetFile(node->physicalId) : 0;
+	if(!file)
+		return G_FS_WRITE_ERROR;
+
+	int64_t wrote = tmpfsWrite(file, buffer, offset, length);
+	if(wrote == 0 && length > 0)
+		return G_FS_WRITE_ERROR;
+
+	*outWrote = wrote;
+	return G_FS_WRITE_SUCCESSFUL;
+}
+
+g_fs_length_status filesystemTmpfsDelegateGetLength(g_fs_node* node, uint64_t* outLength)
+{
+	if(node->type != G_FS_NODE_TYPE_FILE)
+	{
+		*outLength = 0;
+		return G_FS_LENGTH_SUCCESSFUL;
+	}
+
+	g_tmpfs_file* file = tmpfsGetFile(node->physicalId);
+	if(!file)
+		return G_FS_LENGTH_NOT_FOUND;
+
+	*outLength = tmpfsGetLength(file);
+	return G_FS_LENGTH_SUCCESSFUL;
+}
+
+g_fs_open_status filesystemTmpfsDelegateCreate(g_fs_node* parent, const char* name, g_fs_node** outFile)
+{
+	if(parent->type != G_FS_NODE_TYPE_MOUNTPOINT && parent->type != G_FS_NODE_TYPE_FOLDER)
+		return G_FS_OPEN_ERROR;
+
+	g_tmpfs_file* file = tmpfsCreateFile();
+
+	g_fs_node* newNode = filesystemCreateNode(G_FS_NODE_TYPE_FILE, name);
+	newNode->physicalId = file->id;
+	filesystemAddChild(parent, newNode);
+	*outFile = newNode;
+
+	return G_FS_OPEN_SUCCESSFUL;
+}
+
+g_fs_open_status filesystemTmpfsDelegateTruncate(g_fs_node* file)
+{
+	g_tmpfs_file* tmpfsFile = tmpfsGetFile(file->physicalId);
+	if(!tmpfsFile)
+		return G_FS_OPEN_ERROR;
+
+	tmpfsTruncate(tmpfsFile);
+	return G_FS_OPEN_SUCCESSFUL;
+}
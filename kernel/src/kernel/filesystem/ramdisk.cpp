@@ -19,6 +19,7 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "kernel/filesystem/ramdisk.hpp"
+#include "kernel/filesystem/ramdisk_cache.hpp"
 #include "kernel/memory/memory.hpp"
 #include "kernel/memory/paging.hpp"
 #include "kernel/kernel.hpp"
@@ -49,38 +50,146 @@ void ramdiskLoadFromModule(g_multiboot_module* module)
 	module->moduleEnd = newLocation + (module->moduleEnd - module->moduleStart);
 	module->moduleStart = newLocation;
 
-	ramdiskMain = (g_ramdisk*) heapAllocate(sizeof(g_ramdisk));
+	ramdiskMain = (g_ramdisk*) heapAllocateClear(sizeof(g_ramdisk));
+	mutexInitialize(&ramdiskMain->lock);
+	ramdiskCacheInitialize();
 	ramdiskParseContents(module);
 	logInfo("%! module loaded: %i MB", "ramdisk", (module->moduleEnd - module->moduleStart) / 1024 / 1024);
 	logDebug("%! relocated to kernel space: %h -> %h", "ramdisk", module->moduleStart, G_PAGE_ALIGN_UP(module->moduleEnd));
 }
 
 void ramdiskParseContents(g_multiboot_module* module)
+{
+	uint8_t* image = (uint8_t*) module->moduleStart;
+	uint32_t imageSize = module->moduleEnd - module->moduleStart;
+	ramdiskMain->image = image;
+	ramdiskMain->imageSize = imageSize;
+
+	g_ramdisk_v2_header* header = (g_ramdisk_v2_header*) image;
+	if(imageSize < sizeof(g_ramdisk_v2_header) || header->magic != G_RAMDISK_V2_MAGIC)
+	{
+		ramdiskParseLegacyContents(module);
+		return;
+	}
+
+	if(header->version != 2 || header->entryCount == 0 ||
+			header->entryTableOffset + (uint64_t) header->entryCount * sizeof(g_ramdisk_v2_entry) > imageSize ||
+			header->childTableOffset + (uint64_t) header->childCount * sizeof(g_ramdisk_id) > imageSize ||
+			header->stringTableOffset + (uint64_t) header->stringTableSize > imageSize)
+		kernelPanic("%! image has an invalid header", "ramdisk");
+
+	ramdiskMain->header = header;
+	ramdiskMain->imageEntries = (g_ramdisk_v2_entry*) (image + header->entryTableOffset);
+	ramdiskMain->imageChildren = (g_ramdisk_id*) (image + header->childTableOffset);
+	ramdiskMain->imageStrings = (const char*) (image + header->stringTableOffset);
+	ramdiskMain->nextUnusedId = header->entryCount;
+
+	ramdiskMain->root = ramdiskFindById(0);
+	logDebug("%! indexed image with %i entries", "ramdisk", header->entryCount);
+}
+
+/**
+ * Grows the entry index so that it can hold the id. The ramdisk lock must be held.
+ */
+static void ramdiskEnsureCapacity(g_ramdisk_id id)
+{
+	if(id < ramdiskMain->entriesCapacity)
+		return;
+
+	uint32_t capacity = ramdiskMain->entriesCapacity ? ramdiskMain->entriesCapacity : 64;
+	while(capacity <= id)
+		capacity *= 2;
+
+	g_ramdisk_entry** entries = (g_ramdisk_entry**) heapAllocateClear(sizeof(g_ramdisk_entry*) * capacity);
+	if(ramdiskMain->entries)
+	{
+		memoryCopy(entries, ramdiskMain->entries, sizeof(g_ramdisk_entry*) * ramdiskMain->entriesCapacity);
+		heapFree(ramdiskMain->entries);
+	}
+	ramdiskMain->entries = entries;
+	ramdiskMain->entriesCapacity = capacity;
+}
+
+/**
+ * Adds the entry to the index and to the children list of its parent. The ramdisk lock must be held.
+ */
+static void ramdiskAddEntry(g_ramdisk_entry* entry, g_ramdisk_entry* parent)
+{
+	ramdiskEnsureCapacity(entry->id);
+	ramdiskMain->entries[entry->id] = entry;
+
+	if(parent)
+	{
+		entry->nextSibling = parent->firstChild;
+		parent->firstChild = entry;
+		parent->childCount++;
+	}
+}
+
+/**
+ * Returns the entry with the id, creating it from the image table on first use.
+ * The ramdisk lock must be held.
+ */
+static g_ramdisk_entry* ramdiskGetEntry(g_ramdisk_id id)
+{
+	if(id < ramdiskMain->entriesCapacity && ramdiskMain->entries[id])
+		return ramdiskMain->entries[id];
+
+	g_ramdisk_v2_header* header = ramdiskMain->header;
+	if(!header || id >= header->entryCount)
+		return 0;
+
+	g_ramdisk_v2_entry* imageEntry = &ramdiskMain->imageEntries[id];
+	g_ramdisk_entry* entry = (g_ramdisk_entry*) heapAllocateClear(sizeof(g_ramdisk_entry));
+	entry->type = imageEntry->type;
+	entry->id = id;
+	entry->parentid = imageEntry->parentId;
+	entry->name = (char*) &ramdiskMain->imageStrings[imageEntry->nameOffset];
+	entry->dataOnRamdisk = true;
+	if(imageEntry->type == G_RAMDISK_V2_ENTRY_TYPE_COMPRESSED_FILE)
+	{
+		entry->type = G_RAMDISK_ENTRY_TYPE_FILE;
+		entry->compressed = true;
+	}
+
+	if(entry->type == G_RAMDISK_ENTRY_TYPE_FILE)
+	{
+		entry->data = ramdiskMain->image + imageEntry->data;
+		entry->dataSize = imageEntry->size;
+	}
+
+	ramdiskAddEntry(entry, 0);
+	return entry;
+}
+
+/**
+ * Returns the number of children of the entry in the child table of the image.
+ */
+static uint32_t ramdiskGetImageChildCount(g_ramdisk_id id)
+{
+	g_ramdisk_v2_header* header = ramdiskMain->header;
+	if(!header || id >= header->entryCount || ramdiskMain->imageEntries[id].type != G_RAMDISK_ENTRY_TYPE_FOLDER)
+		return 0;
+	return ramdiskMain->imageEntries[id].size;
+}
+
+void ramdiskParseLegacyContents(g_multiboot_module* module)
 {
 	uint8_t* data = (uint8_t*) module->moduleStart;
 	g_address dataEnd = module->moduleEnd;
 
-	ramdiskMain->root = new g_ramdisk_entry;
-	ramdiskMain->root->id = 0;
-	ramdiskMain->firstEntry = 0;
-	ramdiskMain->nextUnusedId = 0;
+	g_ramdisk_entry* root = (g_ramdisk_entry*) heapAllocateClear(sizeof(g_ramdisk_entry));
+	root->type = G_RAMDISK_ENTRY_TYPE_FOLDER;
+	root->id = 0;
+	root->name = (char*) "";
+	ramdiskAddEntry(root, 0);
+	ramdiskMain->root = root;
+	ramdiskMain->nextUnusedId = 1;
 
 	uint32_t pos = 0;
-	g_ramdisk_entry* currentHeader = 0;
 	while((g_address) (data + pos) < dataEnd)
 	{
-		g_ramdisk_entry* entry = new g_ramdisk_entry;
-		entry->next = 0;
-
-		if(currentHeader == 0)
-		{
-			ramdiskMain->firstEntry = entry;
-			currentHeader = ramdiskMain->firstEntry;
-		} else
-		{
-			currentHeader->next = entry;
-			currentHeader = entry;
-		}
+		g_ramdisk_entry* entry = (g_ramdisk_entry*) heapAllocateClear(sizeof(g_ramdisk_entry));
 
 		// Type (file/folder)
 		uint8_t* typeptr = (uint8_t*) (data + pos);
@@ -126,8 +235,12 @@ void ramdiskParseContents(g_multiboot_module* module)
 			entry->data = 0;
 		}
 
+		// Parents are always written before their children
+		g_ramdisk_entry* parent = entry->parentid < ramdiskMain->entriesCapacity ? ramdiskMain->entries[entry->parentid] : 0;
+		ramdiskAddEntry(entry, parent);
+
 		// start with unused ids after the last one
-		if(entry->id > ramdiskMain->nextUnusedId)
+		if(entry->id >= ramdiskMain->nextUnusedId)
 		{
 			ramdiskMain->nextUnusedId = entry->id + 1;
 		}
@@ -136,41 +249,58 @@ void ramdiskParseContents(g_multiboot_module* module)
 
 g_ramdisk_entry* ramdiskFindChild(g_ramdisk_entry* parent, const char* childName)
 {
+	mutexAcquire(&ramdiskMain->lock);
 
-	g_ramdisk_entry* current = ramdiskMain->firstEntry;
-	while(current)
+	// Children in the image are sorted by name
+	g_ramdisk_entry* found = 0;
+	uint32_t imageChildCount = ramdiskGetImageChildCount(parent->id);
+	if(imageChildCount)
 	{
-		if(current->parentid == parent->id && stringEquals(current->name, childName))
-			return current;
-
-		current = current->next;
-	}
-
-	return 0;
-}
-
-g_ramdisk_entry* ramdiskFindById(g_ramdisk_id id)
-{
-	g_ramdisk_entry* foundNode = 0;
-
-	if(id == 0)
-	{
-		return ramdiskMain->root;
+		g_ramdisk_id* children = &ramdiskMain->imageChildren[ramdiskMain->imageEntries[parent->id].data];
+		uint32_t low = 0;
+		uint32_t high = imageChildCount;
+		while(low < high)
+		{
+			uint32_t middle = low + (high - low) / 2;
+			g_ramdisk_v2_entry* child = &ramdiskMain->imageEntries[children[middle]];
+			int compared = stringCompare(&ramdiskMain->imageStrings[child->nameOffset], childName);
+			if(compared == 0)
+			{
+				found = ramdiskGetEntry(children[middle]);
+				break;
+			}
+
+			if(compared < 0)
+				low = middle + 1;
+			else
+				high = middle;
+		}
 	}
 
-	g_ramdisk_entry* currentNode = ramdiskMain->firstEntry;
-	while(currentNode != 0)
+	if(!found)
 	{
-		if(currentNode->id == id)
+		g_ramdisk_entry* current = parent->firstChild;
+		while(current)
 		{
-			foundNode = currentNode;
-			break;
+			if(stringEquals(current->name, childName))
+			{
+				found = current;
+				break;
+			}
+			current = current->nextSibling;
 		}
-
-		currentNode = currentNode->next;
 	}
 
-	return foundNode;
+	mutexRelease(&ramdiskMain->lock);
+	return found;
+}
+
+g_ramdisk_entry* ramdiskFindById(g_ramdisk_id id)
+{
+	mutexAcquire(&ramdiskMain->lock);
+	g_ramdisk_entry* entry = ramdiskGetEntry(id);
+	mutexRelease(&ramdiskMain->lock);
+	return entry;
 }
 
 g_ramdisk_entry* ramdiskFindAbsolute(const char* path)
@@ -214,39 +344,114 @@ g_ramdisk_entry* ramdiskFindRelative(g_ramdisk_entry* node, const char* path)
 
 uint32_t ramdiskGetChildCount(g_ramdisk_id id)
 {
-	uint32_t count = 0;
+	mutexAcquire(&ramdiskMain->lock);
 
-	g_ramdisk_entry* currentNode = ramdiskMain->firstEntry;
-	while(currentNode != 0)
-	{
-		if(currentNode->parentid == id)
-		{
-			++count;
-		}
-		currentNode = currentNode->next;
-	}
+	uint32_t count = ramdiskGetImageChildCount(id);
+	g_ramdisk_entry* entry = id < ramdiskMain->entriesCapacity ? ramdiskMain->entries[id] : 0;
+	if(entry)
+		count += entry->childCount;
 
+	mutexRelease(&ramdiskMain->lock);
 	return count;
 }
 
 g_ramdisk_entry* ramdiskGetChildAt(g_ramdisk_id id, uint32_t index)
 {
+	mutexAcquire(&ramdiskMain->lock);
 
-	uint32_t pos = 0;
+	g_ramdisk_entry* child = 0;
+	uint32_t imageChildCount = ramdiskGetImageChildCount(id);
+	if(index < imageChildCount)
+	{
+		child = ramdiskGetEntry(ramdiskMain->imageChildren[ramdiskMain->imageEntries[id].data + index]);
+	} else
+	{
+		g_ramdisk_entry* entry = id < ramdiskMain->entriesCapacity ? ramdiskMain->entries[id] : 0;
+		child = entry ? entry->firstChild : 0;
+		for(uint32_t pos = imageChildCount; child && pos < index; pos++)
+			child = child->nextSibling;
+	}
+
+	mutexRelease(&ramdiskMain->lock);
+	return child;
+}
 
-	g_ramdisk_entry* currentNode = ramdiskMain->firstEntry;
-	while(currentNode)
+/**
+ * Fills the summary from the entry if it was created, otherwise from the image table.
+ * The ramdisk lock must be held.
+ */
+static bool ramdiskDescribeUnlocked(g_ramdisk_id id, g_ramdisk_entry_summary* outSummary)
+{
+	g_ramdisk_entry* entry = id < ramdiskMain->entriesCapacity ? ramdiskMain->entries[id] : 0;
+	if(entry)
 	{
-		if(currentNode->parentid == id)
-		{
-			if(pos == index)
-				return currentNode;
-			++pos;
-		}
-		currentNode = currentNode->next;
+		outSummary->id = id;
+		outSummary->type = entry->type;
+		outSummary->name = entry->name;
+		outSummary->length = entry->type == G_RAMDISK_ENTRY_TYPE_FILE ? entry->dataSize : 0;
+		return true;
 	}
 
-	return 0;
+	g_ramdisk_v2_header* header = ramdiskMain->header;
+	if(!header || id >= header->entryCount)
+		return false;
+
+	g_ramdisk_v2_entry* imageEntry = &ramdiskMain->imageEntries[id];
+	outSummary->id = id;
+	outSummary->type = imageEntry->type == G_RAMDISK_V2_ENTRY_TYPE_COMPRESSED_FILE ? G_RAMDISK_ENTRY_TYPE_FILE : imageEntry->type;
+	outSummary->name = &ramdiskMain->imageStrings[imageEntry->nameOffset];
+	outSummary->length = outSummary->type == G_RAMDISK_ENTRY_TYPE_FILE ? imageEntry->size : 0;
+	return true;
+}
+
+bool ramdiskDescribe(g_ramdisk_id id, g_ramdisk_entry_summary* outSummary)
+{
+	mutexAcquire(&ramdiskMain->lock);
+	bool found = ramdiskDescribeUnlocked(id, outSummary);
+	mutexRelease(&ramdiskMain->lock);
+	return found;
+}
+
+bool ramdiskDescribeChildAt(g_ramdisk_id id, uint32_t index, g_ramdisk_entry_summary* outSummary)
+{
+	mutexAcquire(&ramdiskMain->lock);
+
+	bool found = false;
+	uint32_t imageChildCount = ramdiskGetImageChildCount(id);
+	if(index < imageChildCount)
+	{
+		found = ramdiskDescribeUnlocked(ramdiskMain->imageChildren[ramdiskMain->imageEntries[id].data + index], outSummary);
+	} else
+	{
+		g_ramdisk_entry* entry = id < ramdiskMain->entriesCapacity ? ramdiskMain->entries[id] : 0;
+		g_ramdisk_entry* child = entry ? entry->firstChild : 0;
+		for(uint32_t pos = imageChildCount; child && pos < index; pos++)
+			child = child->nextSibling;
+
+		if(child)
+			found = ramdiskDescribeUnlocked(child->id, outSummary);
+	}
+
+	mutexRelease(&ramdiskMain->lock);
+	return found;
+}
+
+int32_t ramdiskReadData(g_ramdisk_entry* entry, uint32_t offset, uint8_t* buffer, uint32_t length)
+{
+	if(offset >= entry->dataSize)
+		return 0;
+	if(length > entry->dataSize - offset)
+		length = entry->dataSize - offset;
+
+	if(entry->compressed)
+	{
+		if(!ramdiskCacheRead(entry, offset, buffer, length))
+			return -1;
+	} else
+	{
+		memoryCopy(buffer, &entry->data[offset], length);
+	}
+	return length;
 }
 
 g_ramdisk_entry* ramdiskGetRoot()
@@ -256,16 +461,13 @@ g_ramdisk_entry* ramdiskGetRoot()
 
 g_ramdisk_entry* ramdiskCreateFile(g_ramdisk_entry* parent, const char* filename)
 {
-	g_ramdisk_entry* entry = (g_ramdisk_entry*) heapAllocate(sizeof(g_ramdisk_entry));
-	entry->next = ramdiskMain->firstEntry;
-	ramdiskMain->firstEntry = entry;
+	g_ramdisk_entry* entry = (g_ramdisk_entry*) heapAllocateClear(sizeof(g_ramdisk_entry));
 
 	int namelen = stringLength(filename);
 	entry->name = (char*) heapAllocate(sizeof(char) * (namelen + 1));
 	stringCopy(entry->name, filename);
 
 	entry->type = G_RAMDISK_ENTRY_TYPE_FILE;
-	entry->id = ramdiskMain->nextUnusedId++;
 	entry->parentid = parent->id;
 
 	entry->data = nullptr;
@@ -273,5 +475,10 @@ g_ramdisk_entry* ramdiskCreateFile(g_ramdisk_entry* parent, const char* filename
 	entry->dataOnRamdisk = false;
 	entry->notOnRdBufferLength = 0;
 
+	mutexAcquire(&ramdiskMain->lock);
+	entry->id = ramdiskMain->nextUnusedId++;
+	ramdiskAddEntry(entry, parent);
+	mutexRelease(&ramdiskMain->lock);
+
 	return entry;
 }
@@ -0,0 +1,319 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/filesystem/ramdisk_cache.hpp"
+#include "kernel/filesystem/ramdisk.hpp"
+#include "kernel/memory/memory.hpp"
+#include "kernel/kernel.hpp"
+#include "shared/system/mutex.hpp"
+
+static g_mutex ramdiskCacheLock;
+static g_ramdisk_cached_block* ramdiskCacheBuckets[G_RAMDISK_CACHE_BUCKETS];
+static g_ramdisk_cached_block* ramdiskCacheMostRecent = 0;
+static g_ramdisk_cached_block* ramdiskCacheLeastRecent = 0;
+static uint32_t ramdiskCacheBlockCount = 0;
+
+#define G_RAMDISK_CACHE_BLOCK_PAGES		(G_RAMDISK_V2_BLOCK_SIZE / G_PAGE_SIZE)
+
+static g_ramdisk_cached_block** ramdiskCacheGetBucket(g_ramdisk_id id, uint32_t block)
+{
+	return &ramdiskCacheBuckets[(id * 2654435761u ^ block) % G_RAMDISK_CACHE_BUCKETS];
+}
+
+/**
+ * Removes the block from its bucket and from the usage list. The cache lock must be held.
+ */
+static void ramdiskCacheUnlink(g_ramdisk_cached_block* cached)
+{
+	g_ramdisk_cached_block** link = ramdiskCacheGetBucket(cached->id, cached->block);
+	while(*link && *link != cached)
+		link = &(*link)->nextInBucket;
+	if(*link)
+		*link = cached->nextInBucket;
+	cached->nextInBucket = 0;
+
+	if(cached->previousUsed)
+		cached->previousUsed->nextUsed = cached->nextUsed;
+	else
+		ramdiskCacheMostRecent = cached->nextUsed;
+
+	if(cached->nextUsed)
+		cached->nextUsed->previousUsed = cached->previousUsed;
+	else
+		ramdiskCacheLeastRecent = cached->previousUsed;
+
+	cached->previousUsed = 0;
+	cached->nextUsed = 0;
+}
+
+/**
+ * Adds the block to its bucket and to the front of the usage list. The cache lock must be held.
+ */
+static void ramdiskCacheLink(g_ramdisk_cached_block* cached)
+{
+	g_ramdisk_cached_block** bucket = ramdiskCacheGetBucket(cached->id, cached->block);
+	cached->nextInBucket = *bucket;
+	*bucket = cached;
+
+	cached->previousUsed = 0;
+	cached->nextUsed = ramdiskCacheMostRecent;
+	if(ramdiskCacheMostRecent)
+		ramdiskCacheMostRecent->previousUsed = cached;
+	ramdiskCacheMostRecent = cached;
+	if(!ramdiskCacheLeastRecent)
+		ramdiskCacheLeastRecent = cached;
+}
+
+static void ramdiskCacheFreeBuffer(uint8_t* data, uint32_t pages)
+{
+	for(uint32_t i = 0; i < pages; i++)
+	{
+		g_virtual_address page = (g_virtual_address) data + i * G_PAGE_SIZE;
+		g_physical_address pagePhys = pagingVirtualToPhysical(page);
+		pagingUnmapPage(page);
+		memoryPhysicalFree(pagePhys);
+	}
+	addressRangePoolFree(memoryVirtualRangePool, (g_virtual_address) data);
+}
+
+/**
+ * Allocates the pages for a decompressed block outside of the kernel heap.
+ */
+static uint8_t* ramdiskCacheAllocateBuffer()
+{
+	g_virtual_address base = addressRangePoolAllocate(memoryVirtualRangePool, G_RAMDISK_CACHE_BLOCK_PAGES);
+	if(!base)
+		return 0;
+
+	for(uint32_t i = 0; i < G_RAMDISK_CACHE_BLOCK_PAGES; i++)
+	{
+		g_physical_address page = memoryPhysicalAllocate();
+		if(!page)
+		{
+			ramdiskCacheFreeBuffer((uint8_t*) base, i);
+			return 0;
+		}
+		pagingMapPage(base + i * G_PAGE_SIZE, page, DEFAULT_KERNEL_TABLE_FLAGS, DEFAULT_KERNEL_PAGE_FLAGS);
+	}
+	return (uint8_t*) base;
+}
+
+static void ramdiskCacheRelease(g_ramdisk_cached_block* cached)
+{
+	ramdiskCacheFreeBuffer(cached->data, G_RAMDISK_CACHE_BLOCK_PAGES);
+	heapFree(cached);
+	ramdiskCacheBlockCount--;
+}
+
+/**
+ * Reads the extended part of a length, which continues while bytes are 255.
+ */
+static bool ramdiskCacheReadLength(const uint8_t*& in, const uint8_t* inEnd, uint32_t& length)
+{
+	uint8_t next;
+	do
+	{
+		if(in >= inEnd)
+			return false;
+		next = *in++;
+		length += next;
+	} while(next == 255);
+	return true;
+}
+
+/**
+ * Decompresses a block, see ghost/ramdisk.h for the format.
+ */
+static bool ramdiskCacheDecompress(const uint8_t* in, uint32_t inLength, uint8_t* out, uint32_t outLength)
+{
+	const uint8_t* inEnd = in + inLength;
+	uint32_t pos = 0;
+
+	while(in < inEnd)
+	{
+		uint8_t token = *in++;
+
+		uint32_t literals = token >> 4;
+		if(literals == 15 && !ramdiskCacheReadLength(in, inEnd, literals))
+			return false;
+		if(literals > (uint32_t) (inEnd - in) || literals > outLength - pos)
+			return false;
+		memoryCopy(&out[pos], in, literals);
+		in += literals;
+		pos += literals;
+
+		// The last sequence has no match
+		if(in == inEnd)
+			break;
+
+		if(inEnd - in < 2)
+			return false;
+		uint32_t distance = in[0] | (in[1] << 8);
+		in += 2;
+
+		uint32_t matchLength = token & 0xF;
+		if(matchLength == 15 && !ramdiskCacheReadLength(in, inEnd, matchLength))
+			return false;
+		matchLength += 4;
+
+		if(distance == 0 || distance > pos || matchLength > outLength - pos)
+			return false;
+
+		// Copied bytewise as the match may overlap itself
+		uint8_t* source = &out[pos - distance];
+		uint8_t* target = &out[pos];
+		for(uint32_t i = 0; i < matchLength; i++)
+			target[i] = source[i];
+		pos += matchLength;
+	}
+
+	return pos == outLength;
+}
+
+/**
+ * Returns the decompressed block of the entry, decompressing it if it is not
+ * cached. The cache lock must be held.
+ */
+static g_ramdisk_cached_block* ramdiskCacheGetBlock(g_ramdisk_entry* entry, uint32_t block)
+{
+	for(g_ramdisk_cached_block* cached = *ramdiskCacheGetBucket(entry->id, block); cached; cached = cached->nextInBucket)
+	{
+		if(cached->id == entry->id && cached->block == block)
+		{
+			ramdiskCacheUnlink(cached);
+			ramdiskCacheLink(cached);
+			return cached;
+		}
+	}
+
+	uint32_t blockCount = (entry->dataSize + G_RAMDISK_V2_BLOCK_SIZE - 1) / G_RAMDISK_V2_BLOCK_SIZE;
+	uint32_t* table = (uint32_t*) entry->data;
+	if(block >= blockCount || (uint8_t*) &table[blockCount + 1] > ramdiskMain->image + ramdiskMain->imageSize)
+		return 0;
+
+	uint32_t start = table[block];
+	uint32_t end = table[block + 1];
+	if(start > end || end > ramdiskMain->imageSize)
+		return 0;
+
+	uint32_t blockLength = entry->dataSize - block * G_RAMDISK_V2_BLOCK_SIZE;
+	if(blockLength > G_RAMDISK_V2_BLOCK_SIZE)
+		blockLength = G_RAMDISK_V2_BLOCK_SIZE;
+
+	// Replace the least recently used block once the cache is full
+	g_ramdisk_cached_block* cached = 0;
+	if(ramdiskCacheBlockCount < G_RAMDISK_CACHE_MAXIMUM_BLOCKS)
+	{
+		uint8_t* data = ramdiskCacheAllocateBuffer();
+		if(data)
+		{
+			cached = (g_ramdisk_cached_block*) heapAllocateClear(sizeof(g_ramdisk_cached_block));
+			cached->data = data;
+			ramdiskCacheBlockCount++;
+		}
+	}
+	if(!cached)
+	{
+		cached = ramdiskCacheLeastRecent;
+		if(!cached)
+			return 0;
+		ramdiskCacheUnlink(cached);
+	}
+
+	uint8_t* source = ramdiskMain->image + start;
+	bool decompressed;
+	if(end - start == blockLength)
+	{
+		memoryCopy(cached->data, source, blockLength);
+		decompressed = true;
+	} else
+	{
+		decompressed = ramdiskCacheDecompress(source, end - start, cached->data, blockLength);
+	}
+
+	if(!decompressed)
+	{
+		logWarn("%! block %i of entry %i is broken", "ramdisk", block, entry->id);
+		ramdiskCacheRelease(cached);
+		return 0;
+	}
+
+	cached->id = entry->id;
+	cached->block = block;
+	ramdiskCacheLink(cached);
+	return cached;
+}
+
+void ramdiskCacheInitialize()
+{
+	mutexInitialize(&ramdiskCacheLock);
+	for(int i = 0; i < G_RAMDISK_CACHE_BUCKETS; i++)
+		ramdiskCacheBuckets[i] = 0;
+}
+
+bool ramdiskCacheRead(g_ramdisk_entry* entry, uint32_t offset, uint8_t* buffer, uint32_t length)
+{
+	mutexAcquire(&ramdiskCacheLock);
+
+	bool success = true;
+	while(length > 0)
+	{
+		uint32_t block = offset / G_RAMDISK_V2_BLOCK_SIZE;
+		uint32_t blockOffset = offset % G_RAMDISK_V2_BLOCK_SIZE;
+
+		g_ramdisk_cached_block* cached = ramdiskCacheGetBlock(entry, block);
+		if(!cached)
+		{
+			success = false;
+			break;
+		}
+
+		uint32_t chunk = G_RAMDISK_V2_BLOCK_SIZE - blockOffset;
+		if(chunk > length)
+			chunk = length;
+		memoryCopy(buffer, &cached->data[blockOffset], chunk);
+
+		buffer += chunk;
+		offset += chunk;
+		length -= chunk;
+	}
+
+	mutexRelease(&ramdiskCacheLock);
+	return success;
+}
+
+void ramdiskCacheDrop(g_ramdisk_id id)
+{
+	mutexAcquire(&ramdiskCacheLock);
+
+	g_ramdisk_cached_block* cached = ramdiskCacheMostRecent;
+	while(cached)
+	{
+		g_ramdisk_cached_block* next = cached->nextUsed;
+		if(cached->id == id)
+		{
+			ramdiskCacheUnlink(cached);
+			ramdiskCacheRelease(cached);
+		}
+		cached = next;
+	}
+
+	mutexRelease(&ramdiskCacheLock);
+}
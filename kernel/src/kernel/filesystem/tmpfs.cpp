@@ -0,0 +1,272 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/filesystem/tmpfs.hpp"
+#include "kernel/memory/memory.hpp"
+#include "kernel/memory/heap.hpp"
+#include "kernel/memory/paging.hpp"
+#include "kernel/utils/hashmap.hpp"
+#include "kernel/system/processor/processor.hpp"
+#include "kernel/kernel.hpp"
+
+#include "shared/memory/memory.hpp"
+
+static g_mutex tmpfsNextIdLock;
+static g_tmpfs_id tmpfsNextId;
+static g_hashmap<g_tmpfs_id, g_tmpfs_file*>* tmpfsFiles;
+
+/**
+ * Each processor has one page in the window area, see <tmpfsMapWindow>.
+ */
+static g_virtual_address tmpfsWindows;
+static uint32_t tmpfsPages = 0;
+
+void tmpfsInitialize()
+{
+	mutexInitialize(&tmpfsNextIdLock);
+	tmpfsNextId = 0;
+	tmpfsFiles = hashmapCreateNumeric<g_tmpfs_id, g_tmpfs_file*>(128);
+
+	tmpfsWindows = addressRangePoolAllocate(memoryVirtualRangePool, processorGetNumberOfProcessors());
+	if(!tmpfsWindows)
+		kernelPanic("%! failed to allocate the windows for accessing file pages", "tmpfs");
+}
+
+g_tmpfs_file* tmpfsCreateFile()
+{
+	g_tmpfs_file* file = (g_tmpfs_file*) heapAllocateClear(sizeof(g_tmpfs_file));
+	mutexInitialize(&file->lock);
+
+	mutexAcquire(&tmpfsNextIdLock);
+	file->id = tmpfsNextId++;
+	mutexRelease(&tmpfsNextIdLock);
+
+	hashmapPut<g_tmpfs_id, g_tmpfs_file*>(tmpfsFiles, file->id, file);
+	return file;
+}
+
+g_tmpfs_file* tmpfsGetFile(g_tmpfs_id id)
+{
+	return hashmapGet<g_tmpfs_id, g_tmpfs_file*>(tmpfsFiles, id, 0);
+}
+
+/**
+ * Maps the page into the window of this processor, replacing the page that was mapped
+ * there before. As a file lock is held while the window is used, the processor does
+ * not switch to another task in between.
+ */
+static uint8_t* tmpfsMapWindow(g_physical_address phys)
+{
+	g_virtual_address window = tmpfsWindows + processorGetCurrentId() * G_PAGE_SIZE;
+	pagingMapPage(window, phys, DEFAULT_KERNEL_TABLE_FLAGS, DEFAULT_KERNEL_PAGE_FLAGS, true);
+	return (uint8_t*) window;
+}
+
+/**
+ * Takes a zeroed page from the physical allocator. Both the data and the levels of the
+ * tree are such pages. Uses the window.
+ */
+static g_physical_address tmpfsAllocatePage()
+{
+	if(__atomic_add_fetch(&tmpfsPages, 1, __ATOMIC_SEQ_CST) > G_TMPFS_MAXIMUM_PAGES)
+	{
+		__atomic_sub_fetch(&tmpfsPages, 1, __ATOMIC_SEQ_CST);
+		return 0;
+	}
+
+	g_physical_address phys = memoryPhysicalAllocate();
+	if(!phys)
+	{
+		__atomic_sub_fetch(&tmpfsPages, 1, __ATOMIC_SEQ_CST);
+		return 0;
+	}
+
+	memorySetBytes(tmpfsMapWindow(phys), 0, G_PAGE_SIZE);
+	return phys;
+}
+
+static void tmpfsFreePage(g_physical_address phys)
+{
+	memoryPhysicalFree(phys);
+	__atomic_sub_fetch(&tmpfsPages, 1, __ATOMIC_SEQ_CST);
+}
+
+static void tmpfsFreeTree(g_physical_address node, uint32_t depth)
+{
+	if(depth > 0)
+	{
+		g_physical_address* table = (g_physical_address*) tmpfsMapWindow(node);
+		for(uint32_t i = 0; i < G_TMPFS_RADIX_SLOTS; i++)
+		{
+			if(!table[i])
+				continue;
+
+			tmpfsFreeTree(table[i], depth - 1);
+			if(depth > 1)
+				tmpfsMapWindow(node);
+		}
+	}
+	tmpfsFreePage(node);
+}
+
+/**
+ * Number of pages that a tree with the given number of levels can address.
+ */
+static uint64_t tmpfsGetCapacity(uint32_t depth)
+{
+	return (uint64_t) 1 << (G_TMPFS_RADIX_BITS * depth);
+}
+
+/**
+ * Finds the data page with the index. When creating, the tree is grown by putting new
+ * levels above the root until the index fits, and missing pages are allocated on the
+ * way down. The file lock must be held. Uses the window.
+ *
+ * @return the physical address of the page, or 0 if it is a hole or no page is left
+ */
+static g_physical_address tmpfsGetPage(g_tmpfs_file* file, uint64_t index, bool create)
+{
+	while(index >= tmpfsGetCapacity(file->depth))
+	{
+		if(!create || file->depth == G_TMPFS_MAXIMUM_DEPTH)
+			return 0;
+
+		// An empty tree can take any height without allocating
+		if(file->root)
+		{
+			g_physical_address table = tmpfsAllocatePage();
+			if(!table)
+				return 0;
+			((g_physical_address*) tmpfsMapWindow(table))[0] = file->root;
+			file->root = table;
+		}
+		file->depth++;
+	}
+
+	if(!file->root)
+	{
+		if(!create)
+			return 0;
+		file->root = tmpfsAllocatePage();
+		if(!file->root)
+			return 0;
+	}
+
+	g_physical_address node = file->root;
+	for(uint32_t level = file->depth; level > 0; level--)
+	{
+		uint32_t slot = (index >> (G_TMPFS_RADIX_BITS * (level - 1))) & (G_TMPFS_RADIX_SLOTS - 1);
+		g_physical_address next = ((g_physical_address*) tmpfsMapWindow(node))[slot];
+		if(!next)
+		{
+			if(!create)
+				return 0;
+			next = tmpfsAllocatePage();
+			if(!next)
+				return 0;
+
+			// Allocating has used the window
+			((g_physical_address*) tmpfsMapWindow(node))[slot] = next;
+		}
+		node = next;
+	}
+	return node;
+}
+
+int64_t tmpfsRead(g_tmpfs_file* file, uint8_t* buffer, uint64_t offset, uint64_t length)
+{
+	mutexAcquire(&file->lock);
+
+	uint64_t done = 0;
+	if(offset < file->length)
+	{
+		if(length > file->length - offset)
+			length = file->length - offset;
+
+		while(done < length)
+		{
+			uint64_t position = offset + done;
+			uint32_t pageOffset = position & G_PAGE_ALIGN_MASK;
+			uint32_t chunk = G_PAGE_SIZE - pageOffset;
+			if(chunk > length - done)
+				chunk = length - done;
+
+			g_physical_address page = tmpfsGetPage(file, position >> G_TMPFS_PAGE_SHIFT, false);
+			if(page)
+				memoryCopy(buffer + done, tmpfsMapWindow(page) + pageOffset, chunk);
+			else
+				memorySetBytes(buffer + done, 0, chunk);
+			done += chunk;
+		}
+	}
+
+	mutexRelease(&file->lock);
+	return done;
+}
+
+int64_t tmpfsWrite(g_tmpfs_file* file, uint8_t* buffer, uint64_t offset, uint64_t length)
+{
+	mutexAcquire(&file->lock);
+
+	// Appends only touch the last page, the existing data is never moved
+	uint64_t done = 0;
+	while(done < length)
+	{
+		uint64_t position = offset + done;
+		uint32_t pageOffset = position & G_PAGE_ALIGN_MASK;
+		uint32_t chunk = G_PAGE_SIZE - pageOffset;
+		if(chunk > length - done)
+			chunk = length - done;
+
+		g_physical_address page = tmpfsGetPage(file, position >> G_TMPFS_PAGE_SHIFT, true);
+		if(!page)
+			break;
+
+		memoryCopy(tmpfsMapWindow(page) + pageOffset, buffer + done, chunk);
+		done += chunk;
+	}
+
+	if(done > 0 && offset + done > file->length)
+		file->length = offset + done;
+
+	mutexRelease(&file->lock);
+	return done;
+}
+
+uint64_t tmpfsGetLength(g_tmpfs_file* file)
+{
+	mutexAcquire(&file->lock);
+	uint64_t length = file->length;
+	mutexRelease(&file->lock);
+	return length;
+}
+
+void tmpfsTruncate(g_tmpfs_file* file)
+{
+	mutexAcquire(&file->lock);
+
+	if(file->root)
+		tmpfsFreeTree(file->root, file->depth);
+	file->root = 0;
+	file->depth = 0;
+	file->length = 0;
+
+	mutexRelease(&file->lock);
+}
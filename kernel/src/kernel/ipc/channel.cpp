@@ -0,0 +1,60 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/ipc/channel.hpp"
+#include "kernel/memory/paging.hpp"
+#include "kernel/tasking/tasking.hpp"
+#include "kernel/tasking/tasking_memory.hpp"
+#include "shared/memory/constants.hpp"
+
+static g_channel_wait_bucket channelWaitBuckets[G_CHANNEL_WAIT_BUCKETS];
+
+void channelInitialize()
+{
+	for(int i = 0; i < G_CHANNEL_WAIT_BUCKETS; i++)
+		waitQueueInitialize(&channelWaitBuckets[i].waiters);
+}
+
+g_physical_address channelGetWordAddress(g_process* process, volatile uint32_t* address)
+{
+	g_virtual_address virt = (g_virtual_address) address;
+	if((virt & 3) || G_TABLE_IN_DIRECTORY_INDEX(virt) == 0 || virt >= G_CONST_KERNEL_AREA_START)
+		return 0;
+
+	g_virtual_address virtPage = G_PAGE_ALIGN_DOWN(virt);
+	taskingMemoryResolveLazyRange(process, virtPage, virtPage + G_PAGE_SIZE);
+
+	g_physical_address page = pagingVirtualToPhysical(virtPage);
+	if(!page)
+		return 0;
+	return page | (virt & G_PAGE_ALIGN_MASK);
+}
+
+g_wait_queue* channelGetWaitQueue(g_physical_address word)
+{
+	return &channelWaitBuckets[(word >> 2) % G_CHANNEL_WAIT_BUCKETS].waiters;
+}
+
+void channelWake(g_process* process, volatile uint32_t* address)
+{
+	g_physical_address word = channelGetWordAddress(process, address);
+	if(word)
+		waitQueueWake(channelGetWaitQueue(word));
+}
@@ -20,6 +20,10 @@
 
 #include "kernel/ipc/message.hpp"
 #include "kernel/memory/memory.hpp"
+#include "kernel/memory/paging.hpp"
+#include "kernel/memory/page_reference_tracker.hpp"
+#include "kernel/tasking/tasking.hpp"
+#include "kernel/tasking/tasking_memory.hpp"
 #include "kernel/utils/hashmap.hpp"
 
 #include "shared/logger/logger.hpp"
@@ -32,9 +36,128 @@ void messageInitialize()
     messageQueues = hashmapCreateNumeric<g_tid, g_message_queue*>(64);
 }
 
+/**
+ * Transferred pages are stored as a list of physical frames behind the message content.
+ */
+static uint32_t messageGetTransferPages(g_message_header* message)
+{
+    return G_PAGE_ALIGN_UP(message->transferLength) / G_PAGE_SIZE;
+}
+
+static g_physical_address* messageGetTransferFrames(g_message_header* message)
+{
+    return (g_physical_address*) (G_MESSAGE_CONTENT(message) + message->length);
+}
+
+static uint32_t messageGetSize(g_message_header* message)
+{
+    return sizeof(g_message_header) + message->length + messageGetTransferPages(message) * sizeof(g_physical_address);
+}
+
+/**
+ * Takes the frames of the area to transfer from the current address space. The area must be
+ * mapped user memory; pages that are lazy or copy-on-write are resolved first, so that the
+ * frames are private to the sender. When moving, the pages are unmapped from the sender and
+ * the message takes over their reference, otherwise a reference is added.
+ */
+static bool messageTakeTransfer(g_process* process, g_message_header* message, g_virtual_address start, g_message_transfer_mode mode)
+{
+    uint32_t pages = messageGetTransferPages(message);
+    g_virtual_address end = start + pages * G_PAGE_SIZE;
+    if((start & G_PAGE_ALIGN_MASK) || G_TABLE_IN_DIRECTORY_INDEX(start) == 0 || end > G_CONST_KERNEL_AREA_START || end < start)
+        return false;
+
+    mutexAcquire(&process->lock);
+    taskingMemoryResolveLazyRange(process, start, end);
+
+    bool copied = false;
+    for(g_virtual_address virt = start; virt < end; virt += G_PAGE_SIZE)
+    {
+        copied |= pagingResolveCopyOnWrite(virt);
+
+        // Device memory is not reference counted and may not be passed on
+        g_physical_address frame = pagingVirtualToPhysical(virt);
+        if(!frame || pageReferenceTrackerGetCount(frame) == 0)
+        {
+            if(copied)
+                taskingMemoryShootdown(process);
+            mutexRelease(&process->lock);
+            return false;
+        }
+    }
+
+    g_physical_address* frames = messageGetTransferFrames(message);
+    for(uint32_t i = 0; i < pages; i++)
+    {
+        g_virtual_address virt = start + i * G_PAGE_SIZE;
+        frames[i] = pagingVirtualToPhysical(virt);
+        if(mode == G_MESSAGE_TRANSFER_MODE_MOVE)
+            pagingUnmapPage(virt);
+        else
+            pageReferenceTrackerIncrement(frames[i]);
+    }
+
+    // Other threads of the sender must neither write to copied nor to moved frames
+    if(copied || mode == G_MESSAGE_TRANSFER_MODE_MOVE)
+        taskingMemoryShootdown(process);
+    mutexRelease(&process->lock);
+    return true;
+}
+
+/**
+ * Reverts taking the transfer when the message could not be queued.
+ */
+static void messageReturnTransfer(g_process* process, g_message_header* message, g_virtual_address start, g_message_transfer_mode mode)
+{
+    uint32_t pages = messageGetTransferPages(message);
+    g_physical_address* frames = messageGetTransferFrames(message);
+
+    mutexAcquire(&process->lock);
+    for(uint32_t i = 0; i < pages; i++)
+    {
+        if(mode == G_MESSAGE_TRANSFER_MODE_MOVE)
+            pagingMapPage(start + i * G_PAGE_SIZE, frames[i], DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
+        else
+            pageReferenceTrackerDecrement(frames[i]);
+    }
+    mutexRelease(&process->lock);
+}
+
+/**
+ * Maps the transferred frames into a new range of the current address space,
+ * the references held by the message are taken over by the mapping.
+ */
+static g_virtual_address messageMapTransfer(g_process* process, g_message_header* message)
+{
+    uint32_t pages = messageGetTransferPages(message);
+    g_physical_address* frames = messageGetTransferFrames(message);
+
+    g_virtual_address start = addressRangePoolAllocate(process->virtualRangePool, pages);
+    if(!start)
+        return 0;
+
+    mutexAcquire(&process->lock);
+    for(uint32_t i = 0; i < pages; i++)
+        pagingMapPage(start + i * G_PAGE_SIZE, frames[i], DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
+    mutexRelease(&process->lock);
+    return start;
+}
+
+static void messageReleaseTransfer(g_message_header* message)
+{
+    uint32_t pages = messageGetTransferPages(message);
+    g_physical_address* frames = messageGetTransferFrames(message);
+
+    for(uint32_t i = 0; i < pages; i++)
+    {
+        if(pageReferenceTrackerDecrement(frames[i]) == 0)
+            memoryPhysicalFree(frames[i]);
+    }
+}
+
 void messageRemoveFromQueue(g_message_queue* queue, g_message_header* message)
 {
-    queue->size -= sizeof(g_message_header) + message->length;
+    queue->size -= messageGetSize(message);
 
     if(message == queue->head)
         queue->head = message->next;
@@ -51,7 +174,7 @@ void messageRemoveFromQueue(g_message_queue* queue, g_message_header* message)
 
 void messageAddToQueueTail(g_message_queue* queue, g_message_header* message)
 {
-    queue->size += sizeof(g_message_header) + message->length;
+    queue->size += messageGetSize(message);
 
     message->next = 0;
     if(!queue->head)
@@ -68,47 +191,74 @@ void messageAddToQueueTail(g_message_queue* queue, g_message_header* message)
     queue->tail = message;
 }
 
-g_message_send_status messageSend(g_tid sender, g_tid receiver, void* content, uint32_t length, g_message_transaction tx)
+g_message_queue* messageGetOrCreateQueue(g_tid receiver)
 {
-    if(length > G_MESSAGE_MAXIMUM_LENGTH)
+    auto receiverEntry = hashmapGetEntry(messageQueues, receiver);
+    if(receiverEntry)
     {
-        return G_MESSAGE_SEND_STATUS_EXCEEDS_MAXIMUM;
+        return receiverEntry->value;
     }
 
-    auto receiverEntry = hashmapGetEntry(messageQueues, receiver);
+    g_message_queue* queue = (g_message_queue*) heapAllocate(sizeof(g_message_queue));
+    queue->size = 0;
+    queue->head = 0;
+    queue->tail = 0;
+    mutexInitialize(&queue->lock);
+    waitQueueInitialize(&queue->waitersSend);
+    waitQueueInitialize(&queue->waitersReceive);
+    hashmapPut(messageQueues, receiver, queue);
+    return queue;
+}
 
-    g_message_queue* queue;
-    if(receiverEntry)
+g_message_send_status messageSend(g_tid sender, g_tid receiver, void* content, uint32_t length, g_message_transaction tx,
+        void* transfer, uint32_t transferLength, g_message_transfer_mode transferMode)
+{
+    if(length > G_MESSAGE_MAXIMUM_LENGTH || transferLength > G_MESSAGE_MAXIMUM_TRANSFER_LENGTH)
     {
-        queue = receiverEntry->value;
+        return G_MESSAGE_SEND_STATUS_EXCEEDS_MAXIMUM;
     }
-    else {
-        queue = (g_message_queue*) heapAllocate(sizeof(g_message_queue));
-        queue->size = 0;
-        queue->head = 0;
-        queue->tail = 0;
-        mutexInitialize(&queue->lock);
-        hashmapPut(messageQueues, receiver, queue);
+
+    uint32_t transferPages = G_PAGE_ALIGN_UP(transferLength) / G_PAGE_SIZE;
+    uint32_t len = sizeof(g_message_header) + length + transferPages * sizeof(g_physical_address);
+
+    g_message_header* message = (g_message_header*) heapAllocate(len);
+    message->length = length;
+    message->sender = sender;
+    message->transaction = tx;
+    message->transfer = 0;
+    message->transferLength = transferLength;
+    memoryCopy(G_MESSAGE_CONTENT(message), content, length);
+
+    g_task* senderTask = 0;
+    if(transferPages)
+    {
+        senderTask = taskingGetById(sender);
+        if(!senderTask || !messageTakeTransfer(senderTask->process, message, (g_virtual_address) transfer, transferMode))
+        {
+            heapFree(message);
+            return G_MESSAGE_SEND_STATUS_FAILED;
+        }
     }
 
+    g_message_queue* queue = messageGetOrCreateQueue(receiver);
+
     mutexAcquire(&queue->lock);
 
-    uint32_t len = sizeof(g_message_header) + length;
     if(queue->size + len > G_MESSAGE_MAXIMUM_QUEUE_CONTENT)
     {
         mutexRelease(&queue->lock);
+
+        if(transferPages)
+            messageReturnTransfer(senderTask->process, message, (g_virtual_address) transfer, transferMode);
+        heapFree(message);
         return G_MESSAGE_SEND_STATUS_QUEUE_FULL;
     }
 
-    g_message_header* message = (g_message_header*) heapAllocate(len);
-    message->length = length;
-    message->sender = sender;
-    message->transaction = tx;
-    memoryCopy(G_MESSAGE_CONTENT(message), content, length);
 	messageAddToQueueTail(queue, message);
 
     mutexRelease(&queue->lock);
 
+    waitQueueWake(&queue->waitersReceive);
     return G_MESSAGE_SEND_STATUS_SUCCESSFUL;
 }
 
@@ -139,12 +289,35 @@ g_message_receive_status messageReceive(g_tid receiver, g_message_header* out, u
                 return G_MESSAGE_RECEIVE_STATUS_EXCEEDS_BUFFER_SIZE;
             }
 
-            memoryCopy((void*) out, message, len);
 			messageRemoveFromQueue(queue, message);
+            mutexRelease(&queue->lock);
+
+            // Mapping takes the process lock, so it happens outside of the queue lock
+            g_message_receive_status status = G_MESSAGE_RECEIVE_STATUS_SUCCESSFUL;
+            g_virtual_address transferStart = 0;
+            if(message->transferLength)
+            {
+                g_task* receiverTask = taskingGetById(receiver);
+                if(receiverTask)
+                    transferStart = messageMapTransfer(receiverTask->process, message);
+
+                if(!transferStart)
+                {
+                    logInfo("%! failed to map %i transferred bytes in task %i, message dropped", "messages", message->transferLength, receiver);
+                    messageReleaseTransfer(message);
+                    status = G_MESSAGE_RECEIVE_STATUS_FAILED;
+                }
+            }
+
+            if(status == G_MESSAGE_RECEIVE_STATUS_SUCCESSFUL)
+            {
+                memoryCopy((void*) out, message, len);
+                out->transfer = (void*) transferStart;
+            }
 			heapFree(message);
 
-            mutexRelease(&queue->lock);
-            return G_MESSAGE_RECEIVE_STATUS_SUCCESSFUL;
+            waitQueueWake(&queue->waitersSend);
+            return status;
         }
 
         message = message->next;
@@ -154,6 +327,16 @@ g_message_receive_status messageReceive(g_tid receiver, g_message_header* out, u
     return G_MESSAGE_RECEIVE_STATUS_QUEUE_EMPTY;
 }
 
+void messageWaitForSend(g_tid receiver, g_tid sender)
+{
+    waitQueueAdd(&messageGetOrCreateQueue(receiver)->waitersSend, sender);
+}
+
+void messageWaitForReceive(g_tid receiver)
+{
+    waitQueueAdd(&messageGetOrCreateQueue(receiver)->waitersReceive, receiver);
+}
+
 void messageTaskRemoved(g_tid task)
 {
     auto receiverEntry = hashmapGetEntry(messageQueues, task);
@@ -167,6 +350,7 @@ void messageTaskRemoved(g_tid task)
     while(head)
     {
         g_message_header* next = head->next;
+        messageReleaseTransfer(head);
         heapFree(head);
         head = next;
     }
@@ -174,6 +358,8 @@ void messageTaskRemoved(g_tid task)
     mutexRelease(&queue->lock);
 
     hashmapRemove(messageQueues, task);
+    waitQueueWake(&queue->waitersSend);
+    waitQueueWake(&queue->waitersReceive);
     heapFree(queue);
 }
 
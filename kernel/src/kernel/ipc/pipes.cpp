@@ -45,10 +45,13 @@ g_fs_pipe_status pipeCreate(g_fs_phys_id* outPipeId)
 
 	mutexInitialize(&pipe->lock);
 	pipe->capacity = G_PIPE_DEFAULT_CAPACITY;
+	pipe->maximumCapacity = G_PIPE_DEFAULT_MAXIMUM_CAPACITY;
 	pipe->size = 0;
 	pipe->buffer = (uint8_t*) heapAllocate(pipe->capacity);
 	pipe->readPosition = pipe->buffer;
 	pipe->writePosition = pipe->buffer;
+	waitQueueInitialize(&pipe->waitersRead);
+	waitQueueInitialize(&pipe->waitersWrite);
 
 	g_fs_phys_id pipeId = pipeGetNextId();
 	hashmapPut<g_fs_phys_id, g_pipeline*>(pipeMap, pipeId, pipe);
@@ -113,65 +116,139 @@ void pipeRemoveReference(g_fs_phys_id pipeId)
 
 void pipeDeleteInternal(g_fs_phys_id pipeId, g_pipeline* pipe)
 {
-	heapFree(pipe);
 	hashmapRemove(pipeMap, pipeId);
+	waitQueueWake(&pipe->waitersRead);
+	waitQueueWake(&pipe->waitersWrite);
+	heapFree(pipe->buffer);
+	heapFree(pipe);
 
 	logDebug("%! deleted pipe %i", "pipe", pipeId);
 }
 
-g_fs_read_status pipeRead(g_fs_phys_id pipeId, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outRead)
+/**
+ * Copies bytes that are in the pipe, starting "skip" bytes after the read position,
+ * without removing them. The pipe lock must be held.
+ */
+static uint32_t pipeCopyOut(g_pipeline* pipe, uint32_t skip, uint8_t* buffer, uint32_t length)
 {
-	g_pipeline* pipe = pipeGetById(pipeId);
-	if(!pipe)
-		return G_FS_READ_ERROR;
+	if(skip >= pipe->size)
+		return 0;
+	if(length > pipe->size - skip)
+		length = pipe->size - skip;
 
-	mutexAcquire(&pipe->lock);
+	uint32_t start = ((pipe->readPosition - pipe->buffer) + skip) % pipe->capacity;
+	uint32_t spaceToEnd = pipe->capacity - start;
+	if(length > spaceToEnd)
+	{
+		memoryCopy(buffer, &pipe->buffer[start], spaceToEnd);
+		memoryCopy(&buffer[spaceToEnd], pipe->buffer, length - spaceToEnd);
+	} else
+	{
+		memoryCopy(buffer, &pipe->buffer[start], length);
+	}
+	return length;
+}
 
-	// find out what size can be read at maximum
-	length = (pipe->size >= length) ? length : pipe->size;
+/**
+ * Removes bytes from the front of the pipe. The pipe lock must be held.
+ */
+static void pipeConsume(g_pipeline* pipe, uint32_t length)
+{
+	pipe->readPosition = pipe->buffer + ((pipe->readPosition - pipe->buffer) + length) % pipe->capacity;
+	pipe->size -= length;
+	pipe->readCount += length;
+}
 
-	// calculate how much space remains until the end of the pipe
-	uint32_t spaceToEnd = ((uint32_t) pipe->buffer + pipe->capacity) - (uint32_t) pipe->readPosition;
+/**
+ * Moves the contents of the pipe to the start of a new buffer. The pipe lock must be held.
+ */
+static void pipeResize(g_pipeline* pipe, uint32_t capacity)
+{
+	uint8_t* buffer = (uint8_t*) heapAllocate(capacity);
+	pipeCopyOut(pipe, 0, buffer, pipe->size);
+	heapFree(pipe->buffer);
+
+	pipe->buffer = buffer;
+	pipe->capacity = capacity;
+	pipe->readPosition = buffer;
+	pipe->writePosition = buffer + pipe->size % capacity;
+}
+
+/**
+ * Copies bytes to the write position, as many as there is space for. The pipe lock must be held.
+ */
+static uint32_t pipeCopyIn(g_pipeline* pipe, uint8_t* buffer, uint32_t length)
+{
+	uint32_t space = pipe->capacity - pipe->size;
+	if(length > space)
+		length = space;
+
+	// check how many bytes can be written at the write pointer
+	uint32_t spaceToEnd = ((uint32_t) pipe->buffer + pipe->capacity) - (uint32_t) pipe->writePosition;
 
-	// if we want to read more than remaining
 	if(length > spaceToEnd)
 	{
-		// copy bytes from the location of the read pointer
-		memoryCopy(buffer, pipe->readPosition, spaceToEnd);
+		// write bytes at the write pointer
+		memoryCopy(pipe->writePosition, buffer, spaceToEnd);
 
-		// copy remaining data
-		uint32_t remaining = length - spaceToEnd;
-		memoryCopy(&buffer[spaceToEnd], pipe->buffer, remaining);
+		// write remaining bytes to the start of the pipe
+		uint32_t remain = length - spaceToEnd;
+		memoryCopy(pipe->buffer, &buffer[spaceToEnd], remain);
 
-		// set the read pointer to it's new location
-		pipe->readPosition = (uint8_t*) ((uint32_t) pipe->buffer + remaining);
+		// set the write pointer to the new location
+		pipe->writePosition = (uint8_t*) ((uint32_t) pipe->buffer + remain);
 
 	} else
 	{
-		// there are enough bytes left from read pointer, copy it to buffer
-		memoryCopy(buffer, pipe->readPosition, length);
+		// just write bytes at write pointer
+		memoryCopy(pipe->writePosition, buffer, length);
 
-		// set the read pointer to it's new location
-		pipe->readPosition = (uint8_t*) ((uint32_t) pipe->readPosition + length);
+		// set the write pointer to the new location
+		pipe->writePosition = (uint8_t*) ((uint32_t) pipe->writePosition + length);
 	}
 
-	// reset read pointer if end reached
-	if(pipe->readPosition == pipe->buffer + pipe->capacity)
+	// reset write pointer if end reached
+	if(pipe->writePosition == pipe->buffer + pipe->capacity)
 	{
-		pipe->readPosition = pipe->buffer;
+		pipe->writePosition = pipe->buffer;
 	}
 
-	g_fs_read_status status;
-	// if any bytes could be copied
-	if(length > 0)
+	pipe->size += length;
+	return length;
+}
+
+g_fs_read_status pipeRead(g_fs_phys_id pipeId, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outRead)
+{
+	g_fs_iovec vector;
+	vector.base = buffer;
+	vector.length = length;
+	return pipeReadVector(pipeId, &vector, 1, outRead);
+}
+
+g_fs_read_status pipeReadVector(g_fs_phys_id pipeId, g_fs_iovec* vectors, uint32_t count, int64_t* outRead)
+{
+	g_pipeline* pipe = pipeGetById(pipeId);
+	if(!pipe)
+		return G_FS_READ_ERROR;
+
+	mutexAcquire(&pipe->lock);
+
+	// fill the buffers in order until the pipe is empty
+	uint32_t read = 0;
+	for(uint32_t i = 0; i < count; i++)
 	{
-		// decrease pipes remaining bytes
-		pipe->size -= length;
+		uint32_t copied = pipeCopyOut(pipe, read, (uint8_t*) vectors[i].base, vectors[i].length);
+		read += copied;
+		if(copied < vectors[i].length)
+			break;
+	}
+	pipeConsume(pipe, read);
 
-		// finish with success
-		*outRead = length;
+	g_fs_read_status status;
+	if(read > 0)
+	{
+		*outRead = read;
 		status = G_FS_READ_SUCCESSFUL;
-
 	} else
 	{
 		*outRead = 0;
@@ -179,57 +256,57 @@ g_fs_read_status pipeRead(g_fs_phys_id pipeId, uint8_t* buffer, uint64_t offset,
 	}
 
 	mutexRelease(&pipe->lock);
+
+	if(status == G_FS_READ_SUCCESSFUL)
+		waitQueueWake(&pipe->waitersWrite);
+
 	return status;
 }
 
 g_fs_write_status pipeWrite(g_fs_phys_id pipeId, uint8_t* buffer, uint64_t offset, uint64_t length, int64_t* outWrote)
+{
+	g_fs_iovec vector;
+	vector.base = buffer;
+	vector.length = length;
+	return pipeWriteVector(pipeId, &vector, 1, outWrote);
+}
+
+g_fs_write_status pipeWriteVector(g_fs_phys_id pipeId, g_fs_iovec* vectors, uint32_t count, int64_t* outWrote)
 {
 	g_pipeline* pipe = pipeGetById(pipeId);
 	if(!pipe)
 		return G_FS_WRITE_ERROR;
 
+	uint64_t length = 0;
+	for(uint32_t i = 0; i < count; i++)
+		length += vectors[i].length;
+
 	mutexAcquire(&pipe->lock);
 
-	uint32_t space = (pipe->capacity - pipe->size);
+	// grow the buffer if the data doesn't fit
+	if(pipe->capacity - pipe->size < length && pipe->capacity < pipe->maximumCapacity)
+	{
+		uint32_t capacity = pipe->capacity;
+		while(capacity < pipe->maximumCapacity && capacity - pipe->size < length)
+			capacity *= 2;
+		if(capacity > pipe->maximumCapacity)
+			capacity = pipe->maximumCapacity;
+		pipeResize(pipe, capacity);
+	}
 
 	g_fs_write_status status;
-	if(space > 0)
+	if(pipe->size < pipe->capacity)
 	{
-		// check how many bytes can be written
-		length = (space >= length) ? length : space;
-
-		// check how many bytes can be written at the write pointer
-		uint32_t spaceToEnd = ((uint32_t) pipe->buffer + pipe->capacity) - (uint32_t) pipe->writePosition;
-
-		if(length > spaceToEnd)
-		{
-			// write bytes at the write pointer
-			memoryCopy(pipe->writePosition, buffer, spaceToEnd);
-
-			// write remaining bytes to the start of the pipe
-			uint32_t remain = length - spaceToEnd;
-			memoryCopy(pipe->buffer, &buffer[spaceToEnd], remain);
-
-			// set the write pointer to the new location
-			pipe->writePosition = (uint8_t*) ((uint32_t) pipe->buffer + remain);
-
-		} else
+		uint32_t wrote = 0;
+		for(uint32_t i = 0; i < count; i++)
 		{
-			// just write bytes at write pointer
-			memoryCopy(pipe->writePosition, buffer, length);
-
-			// set the write pointer to the new location
-			pipe->writePosition = (uint8_t*) ((uint32_t) pipe->writePosition + length);
-		}
-
-		// reset write pointer if end reached
-		if(pipe->writePosition == pipe->buffer + pipe->capacity)
-		{
-			pipe->writePosition = pipe->buffer;
+			uint32_t copied = pipeCopyIn(pipe, (uint8_t*) vectors[i].base, vectors[i].length);
+			wrote += copied;
+			if(copied < vectors[i].length)
+				break;
 		}
 
-		pipe->size += length;
-		*outWrote = length;
+		*outWrote = wrote;
 		status = G_FS_WRITE_SUCCESSFUL;
 
 	} else
@@ -240,6 +317,9 @@ g_fs_write_status pipeWrite(g_fs_phys_id pipeId, uint8_t* buffer, uint64_t offse
 
 	mutexRelease(&pipe->lock);
 
+	if(status == G_FS_WRITE_SUCCESSFUL)
+		waitQueueWake(&pipe->waitersRead);
+
 	return status;
 }
 
@@ -249,7 +329,8 @@ g_fs_length_status pipeGetLength(g_fs_phys_id pipeId, uint64_t* outLength)
 	if(!pipe)
 		return G_FS_LENGTH_ERROR;
 
-	return pipe->size;
+	*outLength = pipe->size;
+	return G_FS_LENGTH_SUCCESSFUL;
 }
 
 g_fs_open_status pipeTruncate(g_fs_phys_id pipeId)
@@ -264,5 +345,65 @@ g_fs_open_status pipeTruncate(g_fs_phys_id pipeId)
 	pipe->writePosition = pipe->buffer;
 	mutexRelease(&pipe->lock);
 
+	waitQueueWake(&pipe->waitersWrite);
+
 	return G_FS_OPEN_SUCCESSFUL;
 }
+
+g_fs_read_status pipePeek(g_fs_phys_id pipeId, uint32_t skip, uint8_t* buffer, uint64_t length, int64_t* outRead, uint32_t* outReadCount)
+{
+	g_pipeline* pipe = pipeGetById(pipeId);
+	if(!pipe)
+		return G_FS_READ_ERROR;
+
+	mutexAcquire(&pipe->lock);
+	uint32_t read = pipeCopyOut(pipe, skip, buffer, (pipe->size >= length) ? length : pipe->size);
+	*outReadCount = pipe->readCount;
+	mutexRelease(&pipe->lock);
+
+	*outRead = read;
+	return read > 0 ? G_FS_READ_SUCCESSFUL : G_FS_READ_BUSY;
+}
+
+g_fs_pipe_capacity_status pipeGetCapacity(g_fs_phys_id pipeId, uint32_t* outCapacity)
+{
+	g_pipeline* pipe = pipeGetById(pipeId);
+	if(!pipe)
+		return G_FS_PIPE_CAPACITY_ERROR;
+
+	*outCapacity = pipe->maximumCapacity;
+	return G_FS_PIPE_CAPACITY_SUCCESSFUL;
+}
+
+g_fs_pipe_capacity_status pipeSetCapacity(g_fs_phys_id pipeId, uint32_t capacity)
+{
+	g_pipeline* pipe = pipeGetById(pipeId);
+	if(!pipe)
+		return G_FS_PIPE_CAPACITY_ERROR;
+
+	if(capacity < G_PIPE_DEFAULT_CAPACITY)
+		capacity = G_PIPE_DEFAULT_CAPACITY;
+	else if(capacity > G_PIPE_MAXIMUM_CAPACITY)
+		capacity = G_PIPE_MAXIMUM_CAPACITY;
+
+	mutexAcquire(&pipe->lock);
+
+	g_fs_pipe_capacity_status status;
+	if(pipe->size > capacity)
+	{
+		status = G_FS_PIPE_CAPACITY_BUSY;
+	} else
+	{
+		if(pipe->capacity > capacity)
+			pipeResize(pipe, capacity);
+		pipe->maximumCapacity = capacity;
+		status = G_FS_PIPE_CAPACITY_SUCCESSFUL;
+	}
+
+	mutexRelease(&pipe->lock);
+
+	if(status == G_FS_PIPE_CAPACITY_SUCCESSFUL)
+		waitQueueWake(&pipe->waitersWrite);
+
+	return status;
+}
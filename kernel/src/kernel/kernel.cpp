@@ -31,6 +31,8 @@
 #include "kernel/filesystem/filesystem.hpp"
 #include "kernel/ipc/pipes.hpp"
 #include "kernel/ipc/message.hpp"
+#include "kernel/ipc/channel.hpp"
+#include "kernel/tasking/futex.hpp"
 
 #include "shared/runtime/constructors.hpp"
 #include "shared/video/console_video.hpp"
@@ -78,9 +80,13 @@ void kernelRunBootstrapCore(g_physical_address initialPdPhys)
 	mutexAcquire(&bootstrapCoreLock, false);
 
 	systemInitializeBsp(initialPdPhys);
+	memoryInitializePhysicalPageCaches();
+	heapInitializeProcessorCaches();
 	filesystemInitialize();
 	pipeInitialize();
 	messageInitialize();
+	channelInitialize();
+	futexInitialize();
 
 	taskingInitializeBsp();
 	syscallRegisterAll();
@@ -25,9 +25,266 @@
 #include "shared/memory/paging.hpp"
 #include "shared/logger/logger.hpp"
 
+static g_address_range_node* addressRangeNode(g_address_range* range, bool bySize)
+{
+	return bySize ? &range->bySize : &range->byBase;
+}
+
+static int32_t addressRangeHeight(g_address_range* range, bool bySize)
+{
+	return range ? addressRangeNode(range, bySize)->height : 0;
+}
+
+/**
+ * Orders ranges by base, or by size and then base so that keys are unique.
+ */
+static int32_t addressRangeCompare(g_address_range* a, g_address_range* b, bool bySize)
+{
+	if(bySize && a->pages != b->pages)
+		return a->pages < b->pages ? -1 : 1;
+	if(a->base != b->base)
+		return a->base < b->base ? -1 : 1;
+	return 0;
+}
+
+static void addressRangeUpdateHeight(g_address_range* range, bool bySize)
+{
+	g_address_range_node* node = addressRangeNode(range, bySize);
+	int32_t left = addressRangeHeight(node->left, bySize);
+	int32_t right = addressRangeHeight(node->right, bySize);
+	node->height = (left > right ? left : right) + 1;
+}
+
+static g_address_range* addressRangeRotateRight(g_address_range* range, bool bySize)
+{
+	g_address_range* left = addressRangeNode(range, bySize)->left;
+	addressRangeNode(range, bySize)->left = addressRangeNode(left, bySize)->right;
+	addressRangeNode(left, bySize)->right = range;
+	addressRangeUpdateHeight(range, bySize);
+	addressRangeUpdateHeight(left, bySize);
+	return left;
+}
+
+static g_address_range* addressRangeRotateLeft(g_address_range* range, bool bySize)
+{
+	g_address_range* right = addressRangeNode(range, bySize)->right;
+	addressRangeNode(range, bySize)->right = addressRangeNode(right, bySize)->left;
+	addressRangeNode(right, bySize)->left = range;
+	addressRangeUpdateHeight(range, bySize);
+	addressRangeUpdateHeight(right, bySize);
+	return right;
+}
+
+static g_address_range* addressRangeBalance(g_address_range* range, bool bySize)
+{
+	addressRangeUpdateHeight(range, bySize);
+
+	g_address_range_node* node = addressRangeNode(range, bySize);
+	int32_t balance = addressRangeHeight(node->left, bySize) - addressRangeHeight(node->right, bySize);
+	if(balance > 1)
+	{
+		g_address_range_node* left = addressRangeNode(node->left, bySize);
+		if(addressRangeHeight(left->left, bySize) < addressRangeHeight(left->right, bySize))
+			node->left = addressRangeRotateLeft(node->left, bySize);
+		return addressRangeRotateRight(range, bySize);
+	}
+	if(balance < -1)
+	{
+		g_address_range_node* right = addressRangeNode(node->right, bySize);
+		if(addressRangeHeight(right->right, bySize) < addressRangeHeight(right->left, bySize))
+			node->right = addressRangeRotateRight(node->right, bySize);
+		return addressRangeRotateLeft(range, bySize);
+	}
+	return range;
+}
+
+static g_address_range* addressRangeTreeInsert(g_address_range* root, g_address_range* range, bool bySize)
+{
+	if(!root)
+	{
+		g_address_range_node* node = addressRangeNode(range, bySize);
+		node->left = 0;
+		node->right = 0;
+		node->height = 1;
+		return range;
+	}
+
+	g_address_range_node* node = addressRangeNode(root, bySize);
+	if(addressRangeCompare(range, root, bySize) < 0)
+		node->left = addressRangeTreeInsert(node->left, range, bySize);
+	else
+		node->right = addressRangeTreeInsert(node->right, range, bySize);
+	return addressRangeBalance(root, bySize);
+}
+
+static g_address_range* addressRangeTreeRemoveMinimum(g_address_range* root, g_address_range** outMinimum, bool bySize)
+{
+	g_address_range_node* node = addressRangeNode(root, bySize);
+	if(!node->left)
+	{
+		*outMinimum = root;
+		return node->right;
+	}
+	node->left = addressRangeTreeRemoveMinimum(node->left, outMinimum, bySize);
+	return addressRangeBalance(root, bySize);
+}
+
+static g_address_range* addressRangeTreeRemove(g_address_range* root, g_address_range* range, bool bySize)
+{
+	if(!root)
+		return 0;
+
+	g_address_range_node* node = addressRangeNode(root, bySize);
+	int32_t comparison = addressRangeCompare(range, root, bySize);
+	if(comparison < 0)
+	{
+		node->left = addressRangeTreeRemove(node->left, range, bySize);
+	}
+	else if(comparison > 0)
+	{
+		node->right = addressRangeTreeRemove(node->right, range, bySize);
+	}
+	else
+	{
+		if(!node->right)
+			return node->left;
+
+		g_address_range* successor;
+		g_address_range* right = addressRangeTreeRemoveMinimum(node->right, &successor, bySize);
+		addressRangeNode(successor, bySize)->left = node->left;
+		addressRangeNode(successor, bySize)->right = right;
+		root = successor;
+	}
+	return addressRangeBalance(root, bySize);
+}
+
+/**
+ * Finds the range with the given base.
+ */
+static g_address_range* addressRangePoolLookup(g_address_range_pool* pool, g_address base)
+{
+	g_address_range* range = pool->byBase;
+	while(range && range->base != base)
+		range = base < range->base ? range->byBase.left : range->byBase.right;
+	return range;
+}
+
+/**
+ * Finds the range with the highest base below the given base.
+ */
+static g_address_range* addressRangePoolLookupBelow(g_address_range_pool* pool, g_address base)
+{
+	g_address_range* below = 0;
+	g_address_range* range = pool->byBase;
+	while(range)
+	{
+		if(range->base < base)
+		{
+			below = range;
+			range = range->byBase.right;
+		}
+		else
+		{
+			range = range->byBase.left;
+		}
+	}
+	return below;
+}
+
+/**
+ * Finds the smallest free range with at least the given number of pages.
+ */
+static g_address_range* addressRangePoolLookupBestFit(g_address_range_pool* pool, uint32_t pages)
+{
+	g_address_range* best = 0;
+	g_address_range* range = pool->freeBySize;
+	while(range)
+	{
+		if(range->pages >= pages)
+		{
+			best = range;
+			range = range->bySize.left;
+		}
+		else
+		{
+			range = range->bySize.right;
+		}
+	}
+	return best;
+}
+
+/**
+ * Inserts a range into the list after the given range and into the base index.
+ */
+static void addressRangePoolLink(g_address_range_pool* pool, g_address_range* range, g_address_range* after)
+{
+	range->previous = after;
+	if(after)
+	{
+		range->next = after->next;
+		after->next = range;
+	}
+	else
+	{
+		range->next = pool->first;
+		pool->first = range;
+	}
+	if(range->next)
+		range->next->previous = range;
+
+	pool->byBase = addressRangeTreeInsert(pool->byBase, range, false);
+}
+
+static void addressRangePoolUnlink(g_address_range_pool* pool, g_address_range* range)
+{
+	if(range->previous)
+		range->previous->next = range->next;
+	else
+		pool->first = range->next;
+	if(range->next)
+		range->next->previous = range->previous;
+
+	pool->byBase = addressRangeTreeRemove(pool->byBase, range, false);
+}
+
+static bool addressRangeIsAdjacentFree(g_address_range* lower, g_address_range* upper)
+{
+	return !lower->used && !upper->used && lower->base + lower->pages * G_PAGE_SIZE == upper->base;
+}
+
+/**
+ * Merges a free range that is not in the size index with its free neighbours
+ * and adds the result to the size index.
+ */
+static void addressRangePoolCoalesce(g_address_range_pool* pool, g_address_range* range)
+{
+	g_address_range* previous = range->previous;
+	if(previous && addressRangeIsAdjacentFree(previous, range))
+	{
+		pool->freeBySize = addressRangeTreeRemove(pool->freeBySize, previous, true);
+		previous->pages += range->pages;
+		addressRangePoolUnlink(pool, range);
+		heapFree(range);
+		range = previous;
+	}
+
+	g_address_range* next = range->next;
+	if(next && addressRangeIsAdjacentFree(range, next))
+	{
+		pool->freeBySize = addressRangeTreeRemove(pool->freeBySize, next, true);
+		range->pages += next->pages;
+		addressRangePoolUnlink(pool, next);
+		heapFree(next);
+	}
+
+	pool->freeBySize = addressRangeTreeInsert(pool->freeBySize, range, true);
+}
+
 void addressRangePoolInitialize(g_address_range_pool* pool)
 {
 	pool->first = 0;
+	pool->byBase = 0;
+	pool->freeBySize = 0;
 	mutexInitialize(&pool->lock);
 }
 
@@ -38,47 +295,13 @@ void addressRangePoolAddRange(g_address_range_pool* pool, g_address start, g_add
 	g_address_range* newRange = (g_address_range*) heapAllocate(sizeof(g_address_range));
 	newRange->base = start;
 	newRange->used = false;
-	newRange->next = 0;
 	newRange->pages = (end - start) / G_PAGE_SIZE;
 	newRange->flags = 0;
 
-	if(pool->first == 0)
-	{
-		// If the pool is empty, add it as first
-		newRange->next = 0;
-		pool->first = newRange;
-
-	} else
-	{
-		// Find the last range that has a lower base than this one
-		g_address_range* lastBelow = 0;
-		g_address_range* range = pool->first;
-		while(range)
-		{
-			if(range->base < newRange->base)
-			{
-				lastBelow = range;
-			}
-			range = range->next;
-		}
-
-		if(lastBelow)
-		{
-			// Place the new range between the lastBelow and the one after it
-			newRange->next = lastBelow->next;
-			lastBelow->next = newRange;
+	addressRangePoolLink(pool, newRange, addressRangePoolLookupBelow(pool, start));
+	addressRangePoolCoalesce(pool, newRange);
 
-		} else
-		{
-			// There was no range found that has a lower base than this,
-			// so add it as first
-			newRange->next = pool->first;
-			pool->first = newRange;
-		}
-	}
 	mutexRelease(&pool->lock);
-
-	addressRangePoolMerge(pool);
 }
 
 void addressRangePoolCloneRanges(g_address_range_pool* pool, g_address_range_pool* other)
@@ -94,17 +317,12 @@ void addressRangePoolCloneRanges(g_address_range_pool* pool, g_address_range_poo
 	{
 		g_address_range* newRange = (g_address_range*) heapAllocate(sizeof(g_address_range));
 		*newRange = *otherCurrent;
-		newRange->next = 0;
 
-		if(last)
-		{
-			last->next = newRange;
-			last = newRange;
-		} else
-		{
-			pool->first = newRange;
-			last = newRange;
-		}
+		addressRangePoolLink(pool, newRange, last);
+		if(!newRange->used)
+			pool->freeBySize = addressRangeTreeInsert(pool->freeBySize, newRange, true);
+
+		last = newRange;
 		otherCurrent = otherCurrent->next;
 	}
 
@@ -128,18 +346,11 @@ g_address addressRangePoolAllocate(g_address_range_pool* pool, uint32_t requeste
 		requestedPages = 1;
 	}
 
-	// Find an unused range that has more/equal requested pages
-	g_address_range* range = pool->first;
-	while(range)
-	{
-		if(!range->used && range->pages >= requestedPages)
-			break;
-
-		range = range->next;
-	}
-
+	// Find the smallest unused range that has more/equal requested pages
+	g_address_range* range = addressRangePoolLookupBestFit(pool, requestedPages);
 	if(range)
 	{
+		pool->freeBySize = addressRangeTreeRemove(pool->freeBySize, range, true);
 		range->used = true;
 		range->flags = flags;
 
@@ -151,10 +362,10 @@ g_address addressRangePoolAllocate(g_address_range_pool* pool, uint32_t requeste
 			splinter->pages = remainingPages;
 			splinter->base = range->base + requestedPages * G_PAGE_SIZE;
 			splinter->flags = 0;
-
-			splinter->next = range->next;
-			range->next = splinter;
 			range->pages = requestedPages;
+
+			addressRangePoolLink(pool, splinter, range);
+			pool->freeBySize = addressRangeTreeInsert(pool->freeBySize, splinter, true);
 		}
 
 		mutexRelease(&pool->lock);
@@ -173,16 +384,7 @@ int32_t addressRangePoolFree(g_address_range_pool* pool, g_address base)
 
 	int32_t freedPages = -1;
 
-	g_address_range* range = pool->first;
-	while(range)
-	{
-		if(range->base == base)
-		{
-			break;
-		}
-		range = range->next;
-	}
-
+	g_address_range* range = addressRangePoolLookup(pool, base);
 	if(!range)
 	{
 		logInfo("%! bug: tried to free a range (%h) that doesn't exist", "addrpool", base);
@@ -198,33 +400,12 @@ int32_t addressRangePoolFree(g_address_range_pool* pool, g_address base)
 
 	range->used = false;
 	freedPages = range->pages;
-	addressRangePoolMerge(pool);
+	addressRangePoolCoalesce(pool, range);
 
 	mutexRelease(&pool->lock);
 	return freedPages;
 }
 
-void addressRangePoolMerge(g_address_range_pool* pool)
-{
-	g_address_range* current = (g_address_range*) pool->first;
-
-	while(current && current->next)
-	{
-		if(!current->used && !current->next->used && ((current->base + current->pages * G_PAGE_SIZE) == current->next->base))
-		{
-			current->pages += current->next->pages;
-
-			g_address_range* nextnext = current->next->next;
-			delete current->next;
-			current->next = nextnext;
-
-		} else
-		{
-			current = current->next;
-		}
-	}
-}
-
 void addressRangePoolDump(g_address_range_pool* pool, bool onlyFree)
 {
 	logDebug("%! range structure:", "vra");
@@ -255,22 +436,25 @@ void addressRangePoolReleaseRanges(g_address_range_pool* pool)
 		range = next;
 	}
 	pool->first = 0;
+	pool->byBase = 0;
+	pool->freeBySize = 0;
 }
 
 g_address_range* addressRangePoolFind(g_address_range_pool* pool, g_address base)
 {
 	mutexAcquire(&pool->lock);
+	g_address_range* range = addressRangePoolLookup(pool, base);
+	mutexRelease(&pool->lock);
 
-	g_address_range* range = pool->first;
-	while(range)
-	{
-		if(range->base == base)
-		{
-			break;
-		}
-		range = range->next;
-	}
+	return range;
+}
 
+g_address_range* addressRangePoolFindContaining(g_address_range_pool* pool, g_address address)
+{
+	mutexAcquire(&pool->lock);
+	g_address_range* range = addressRangePoolLookupBelow(pool, address + 1);
+	if(range && address >= range->base + range->pages * G_PAGE_SIZE)
+		range = 0;
 	mutexRelease(&pool->lock);
 
 	return range;
@@ -122,3 +122,25 @@ void chunkAllocatorMerge(g_chunk_allocator* allocator)
 
 	mutexRelease(&allocator->lock);
 }
+
+void chunkAllocatorGetFreeStatistics(g_chunk_allocator* allocator, uint32_t* outFreeChunks, uint32_t* outLargestFree)
+{
+	mutexAcquire(&allocator->lock);
+
+	uint32_t freeChunks = 0;
+	uint32_t largestFree = 0;
+	for(g_chunk_header* current = allocator->first; current; current = current->next)
+	{
+		if(current->used)
+			continue;
+
+		freeChunks++;
+		if(current->size > largestFree)
+			largestFree = current->size;
+	}
+
+	mutexRelease(&allocator->lock);
+
+	*outFreeChunks = freeChunks;
+	*outLargestFree = largestFree;
+}
@@ -69,6 +69,11 @@ void gdtInitialize()
 	_loadTss(G_GDT_DESCRIPTOR_TSS);
 }
 
+g_gdt_list_entry* gdtGetForCore(uint32_t coreId)
+{
+	return gdtList[coreId];
+}
+
 void gdtSetTssEsp0(uint32_t esp0)
 {
 	gdtList[processorGetCurrentId()]->tss.esp0 = esp0;
@@ -23,10 +23,13 @@
 #include "kernel/memory/paging.hpp"
 #include "kernel/memory/memory.hpp"
 #include "kernel/memory/chunk_allocator.hpp"
+#include "kernel/memory/slab_allocator.hpp"
+#include "kernel/system/processor/processor.hpp"
 #include "shared/memory/bitmap_page_allocator.hpp"
 #include "shared/system/mutex.hpp"
 
 static g_chunk_allocator heapAllocator;
+static g_slab_allocator heapSlabAllocator;
 static g_virtual_address heapStart = 0;
 static g_virtual_address heapEnd = 0;
 static uint32_t heapAmountInUse = 0;
@@ -40,6 +43,7 @@ void heapInitialize(g_virtual_address start, g_virtual_address end)
 	mutexAcquire(&heapLock);
 
 	chunkAllocatorInitialize(&heapAllocator, start, end);
+	slabAllocatorInitialize(&heapSlabAllocator, G_CONST_KERNEL_SLAB_AREA_START, G_CONST_KERNEL_SLAB_AREA_END);
 	heapStart = start;
 	heapEnd = end;
 
@@ -49,6 +53,12 @@ void heapInitialize(g_virtual_address start, g_virtual_address end)
 	mutexRelease(&heapLock);
 }
 
+void heapInitializeProcessorCaches()
+{
+	g_slab_processor_cache* caches = (g_slab_processor_cache*) heapAllocateClear(sizeof(g_slab_processor_cache) * G_SLAB_CLASS_COUNT * processorGetNumberOfProcessors());
+	slabAllocatorInitializeProcessorCaches(&heapSlabAllocator, caches);
+}
+
 bool heapExpand()
 {
 	if(heapEnd + G_CONST_KERNEL_HEAP_EXPAND_STEP > G_CONST_KERNEL_HEAP_END)
@@ -59,7 +69,7 @@ bool heapExpand()
 
 	for(g_virtual_address v = heapEnd; v < heapEnd + G_CONST_KERNEL_HEAP_EXPAND_STEP; v += G_PAGE_SIZE)
 	{
-		g_physical_address p = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+		g_physical_address p = memoryPhysicalAllocate();
 		if(p == 0)
 		{
 			logWarn("%! failed to expand kernel heap, out of physical memory", "kernheap");
@@ -79,11 +89,18 @@ bool heapExpand()
 
 void* heapAllocate(uint32_t size)
 {
-	mutexAcquire(&heapLock);
-
 	if(!heapInitialized)
 		kernelPanic("%! tried to use uninitialized kernel heap", "kernheap");
 
+	if(size <= G_SLAB_MAX_OBJECT_SIZE)
+	{
+		void* object = slabAllocatorAllocate(&heapSlabAllocator, size);
+		if(object)
+			return object;
+	}
+
+	mutexAcquire(&heapLock);
+
 	void* ptr = chunkAllocatorAllocate(&heapAllocator, size);
 	if(!ptr)
 	{
@@ -114,6 +131,12 @@ void heapFree(void* ptr)
 	if(!heapInitialized)
 		kernelPanic("%! tried to use uninitialized kernel heap", "kernheap");
 
+	if(slabAllocatorContains(&heapSlabAllocator, ptr))
+	{
+		slabAllocatorFree(&heapSlabAllocator, ptr);
+		return;
+	}
+
 	mutexAcquire(&heapLock);
 	heapAmountInUse -= chunkAllocatorFree(&heapAllocator, ptr);
 	mutexRelease(&heapLock);
@@ -121,7 +144,33 @@ void heapFree(void* ptr)
 
 uint32_t heapGetUsedAmount()
 {
-	return heapAmountInUse;
+	uint32_t used = heapAmountInUse;
+	for(int i = 0; i < G_SLAB_CLASS_COUNT; i++)
+		used += heapSlabAllocator.caches[i].allocated * heapSlabAllocator.caches[i].objectSize;
+	return used;
+}
+
+void heapGetStatistics(g_kernquery_heap_get_data* out)
+{
+	out->chunk_used = heapAmountInUse;
+	out->chunk_reserved = heapEnd - heapStart;
+	uint32_t freeChunks;
+	uint32_t largestFree;
+	chunkAllocatorGetFreeStatistics(&heapAllocator, &freeChunks, &largestFree);
+	out->chunk_free_count = freeChunks;
+	out->chunk_largest_free = largestFree;
+
+	out->slab_pages = (heapSlabAllocator.areaTop - heapSlabAllocator.areaStart) / G_PAGE_SIZE;
+	out->slab_empty_pages = heapSlabAllocator.emptySlabCount;
+
+	out->size_class_count = G_SLAB_CLASS_COUNT;
+	for(int i = 0; i < G_SLAB_CLASS_COUNT && i < G_KERNQUERY_HEAP_MAX_SIZE_CLASSES; i++)
+	{
+		g_slab_cache* cache = &heapSlabAllocator.caches[i];
+		out->size_classes[i].object_size = cache->objectSize;
+		out->size_classes[i].allocated = cache->allocated;
+		out->size_classes[i].capacity = cache->slabCount * cache->objectsPerSlab;
+	}
 }
 
 void* operator new(size_t size)
@@ -25,10 +25,13 @@
 #include "kernel/kernel.hpp"
 #include "kernel/debug/debug_interface.hpp"
 #include "kernel/memory/page_reference_tracker.hpp"
+#include "kernel/system/interrupts/interrupts.hpp"
+#include "kernel/system/processor/processor.hpp"
 
 g_bitmap_page_allocator memoryPhysicalAllocator;
 static g_bitmap_entry memoryPhysicalBitmap[G_BITMAP_SIZE];
 g_address_range_pool* memoryVirtualRangePool = 0;
+static g_physical_page_cache* memoryPhysicalPageCaches = 0;
 
 void memoryInitialize(g_setup_information* setupInformation)
 {
@@ -57,6 +60,105 @@ void memoryInitializePhysicalAllocator(g_setup_information* setupInformation)
 	logInfo("%! available memory: %i MB", "memory", (memoryPhysicalAllocator.freePageCount * G_PAGE_SIZE) / 1024 / 1024);
 }
 
+void memoryInitializePhysicalPageCaches()
+{
+	memoryPhysicalPageCaches = (g_physical_page_cache*) heapAllocateClear(sizeof(g_physical_page_cache) * processorGetNumberOfProcessors());
+}
+
+g_physical_address memoryPhysicalAllocate()
+{
+	if(!memoryPhysicalPageCaches)
+		return bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+
+	bool enableInt = interruptsAreEnabled();
+	if(enableInt)
+		interruptsDisable();
+
+	g_physical_page_cache* cache = &memoryPhysicalPageCaches[processorGetCurrentId()];
+	if(cache->count == 0)
+		cache->count = bitmapPageAllocatorAllocateMultiple(&memoryPhysicalAllocator, cache->pages, G_PHYSICAL_PAGE_CACHE_BATCH);
+
+	g_physical_address page = 0;
+	if(cache->count > 0)
+		page = cache->pages[--cache->count];
+
+	if(enableInt)
+		interruptsEnable();
+	return page;
+}
+
+void memoryPhysicalFree(g_physical_address page)
+{
+	if(!memoryPhysicalPageCaches)
+	{
+		bitmapPageAllocatorMarkFree(&memoryPhysicalAllocator, page);
+		return;
+	}
+
+	bool enableInt = interruptsAreEnabled();
+	if(enableInt)
+		interruptsDisable();
+
+	g_physical_page_cache* cache = &memoryPhysicalPageCaches[processorGetCurrentId()];
+	if(cache->count == G_PHYSICAL_PAGE_CACHE_SIZE)
+	{
+		cache->count -= G_PHYSICAL_PAGE_CACHE_BATCH;
+		bitmapPageAllocatorMarkFreeMultiple(&memoryPhysicalAllocator, &cache->pages[cache->count], G_PHYSICAL_PAGE_CACHE_BATCH);
+	}
+	cache->pages[cache->count++] = page;
+
+	if(enableInt)
+		interruptsEnable();
+}
+
+uint32_t memoryPhysicalAllocateMultiple(g_physical_address* out, uint32_t count)
+{
+	if(!memoryPhysicalPageCaches)
+		return bitmapPageAllocatorAllocateMultiple(&memoryPhysicalAllocator, out, count);
+
+	bool enableInt = interruptsAreEnabled();
+	if(enableInt)
+		interruptsDisable();
+
+	g_physical_page_cache* cache = &memoryPhysicalPageCaches[processorGetCurrentId()];
+	uint32_t allocated = 0;
+	while(allocated < count && cache->count > 0)
+		out[allocated++] = cache->pages[--cache->count];
+
+	if(allocated < count)
+		allocated += bitmapPageAllocatorAllocateMultiple(&memoryPhysicalAllocator, &out[allocated], count - allocated);
+
+	if(enableInt)
+		interruptsEnable();
+	return allocated;
+}
+
+void memoryPhysicalFreeMultiple(g_physical_address* pages, uint32_t count)
+{
+	if(!memoryPhysicalPageCaches)
+	{
+		bitmapPageAllocatorMarkFreeMultiple(&memoryPhysicalAllocator, pages, count);
+		return;
+	}
+
+	bool enableInt = interruptsAreEnabled();
+	if(enableInt)
+		interruptsDisable();
+
+	g_physical_page_cache* cache = &memoryPhysicalPageCaches[processorGetCurrentId()];
+	uint32_t cached = G_PHYSICAL_PAGE_CACHE_SIZE - cache->count;
+	if(cached > count)
+		cached = count;
+	for(uint32_t i = 0; i < cached; i++)
+		cache->pages[cache->count++] = pages[i];
+
+	if(cached < count)
+		bitmapPageAllocatorMarkFreeMultiple(&memoryPhysicalAllocator, &pages[cached], count - cached);
+
+	if(enableInt)
+		interruptsEnable();
+}
+
 void memoryUnmapSetupMemory()
 {
 	for(g_virtual_address addr = G_CONST_LOWER_MEMORY_END; addr < G_CONST_KERNEL_AREA_START; addr += G_PAGE_SIZE)
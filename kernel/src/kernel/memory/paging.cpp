@@ -22,10 +22,17 @@
 #include "kernel/kernel.hpp"
 #include "kernel/memory/memory.hpp"
 #include "kernel/memory/address_range_pool.hpp"
+#include "kernel/memory/page_reference_tracker.hpp"
 
 #include "shared/memory/constants.hpp"
 #include "shared/memory/bitmap_page_allocator.hpp"
 
+/**
+ * Gives the current address space a private copy of the table at the given index,
+ * if it is still shared with another address space after a fork.
+ */
+static void pagingUnshareTable(uint32_t ti);
+
 bool pagingMapPage(g_virtual_address virt, g_physical_address phys, uint32_t tableFlags, uint32_t pageFlags, bool allowOverride)
 {
 	if((virt & G_PAGE_ALIGN_MASK) || (phys & G_PAGE_ALIGN_MASK))
@@ -39,7 +46,7 @@ bool pagingMapPage(g_virtual_address virt, g_physical_address phys, uint32_t tab
 
 	if(directory[ti] == 0)
 	{
-		g_physical_address newTablePage = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+		g_physical_address newTablePage = memoryPhysicalAllocate();
 		if(!newTablePage)
 			kernelPanic("%! no pages left for mapping", "paging");
 
@@ -50,6 +57,10 @@ bool pagingMapPage(g_virtual_address virt, g_physical_address phys, uint32_t tab
 	} else if((tableFlags & G_PAGE_TABLE_USERSPACE) && ((directory[ti] & G_PAGE_ALIGN_MASK) & G_PAGE_TABLE_USERSPACE) == 0)
 	{
 		kernelPanic("%! tried to map user page in kernel space table, virt %h", "paging", virt);
+
+	} else if(directory[ti] & G_PAGE_TABLE_COPY_ON_WRITE)
+	{
+		pagingUnshareTable(ti);
 	}
 
 	if(table[pi] == 0 || allowOverride)
@@ -101,7 +112,7 @@ void pagingMapToTemporaryMappedDirectory(g_physical_address directoryPhys, g_vir
 	// Create table if necessary
 	if(directoryTemp[ti] == 0)
 	{
-		g_physical_address tablePhys = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+		g_physical_address tablePhys = memoryPhysicalAllocate();
 		g_virtual_address tableTempVirt = addressRangePoolAllocate(memoryVirtualRangePool, 1);
 		pagingMapPage(tableTempVirt, tablePhys);
 
@@ -149,10 +160,155 @@ void pagingUnmapPage(g_virtual_address virt)
 	if(!table[pi])
 		return;
 
+	if(directory[ti] & G_PAGE_TABLE_COPY_ON_WRITE)
+		pagingUnshareTable(ti);
+
 	table[pi] = 0;
 	G_INVLPG(virt);
 }
 
+void pagingForkUserSpace(g_physical_address targetDirectoryPhys)
+{
+	g_page_directory directory = (g_page_directory) G_CONST_RECURSIVE_PAGE_DIRECTORY_ADDRESS;
+
+	g_virtual_address targetDirectoryVirt = addressRangePoolAllocate(memoryVirtualRangePool, 1);
+	pagingMapPage(targetDirectoryVirt, targetDirectoryPhys);
+	g_page_directory targetDirectory = (g_page_directory) targetDirectoryVirt;
+
+	// The first table holds the shared lower memory and is never forked
+	for(uint32_t ti = 1; ti < G_TABLE_IN_DIRECTORY_INDEX(G_CONST_KERNEL_AREA_START); ti++)
+	{
+		uint32_t entry = directory[ti];
+		if((entry & G_PAGE_TABLE_PRESENT) == 0 || (entry & G_PAGE_TABLE_USERSPACE) == 0)
+			continue;
+
+		if((entry & G_PAGE_TABLE_COPY_ON_WRITE) == 0)
+		{
+			// Private pages become read-only; shared memory and device memory stay writable
+			g_page_table table = G_CONST_RECURSIVE_PAGE_TABLE(ti);
+			for(uint32_t pi = 0; pi < 1024; pi++)
+			{
+				uint32_t page = table[pi];
+				if((page & G_PAGE_PRESENT) && (page & G_PAGE_READWRITE) && pageReferenceTrackerGetCount(page & ~G_PAGE_ALIGN_MASK) == 1)
+					table[pi] = (page & ~G_PAGE_READWRITE) | G_PAGE_COPY_ON_WRITE;
+			}
+
+			entry = (entry & ~G_PAGE_TABLE_READWRITE) | G_PAGE_TABLE_COPY_ON_WRITE;
+			directory[ti] = entry;
+			pageReferenceTrackerIncrement(entry & ~G_PAGE_ALIGN_MASK);
+		}
+
+		pageReferenceTrackerIncrement(entry & ~G_PAGE_ALIGN_MASK);
+		targetDirectory[ti] = entry;
+	}
+
+	pagingUnmapPage(targetDirectoryVirt);
+	addressRangePoolFree(memoryVirtualRangePool, targetDirectoryVirt);
+
+	pagingSwitchToSpace(pagingGetCurrentSpace());
+}
+
+static void pagingUnshareTable(uint32_t ti)
+{
+	g_page_directory directory = (g_page_directory) G_CONST_RECURSIVE_PAGE_DIRECTORY_ADDRESS;
+	g_page_table table = G_CONST_RECURSIVE_PAGE_TABLE(ti);
+
+	g_physical_address tablePhys = directory[ti] & ~G_PAGE_ALIGN_MASK;
+	uint32_t tableFlags = (directory[ti] & G_PAGE_ALIGN_MASK & ~G_PAGE_TABLE_COPY_ON_WRITE) | G_PAGE_TABLE_READWRITE;
+
+	// Last holder of the table can simply take it
+	if(pageReferenceTrackerDecrement(tablePhys) == 0)
+	{
+		directory[ti] = tablePhys | tableFlags;
+		pagingSwitchToSpace(pagingGetCurrentSpace());
+		return;
+	}
+
+	g_physical_address copyPhys = memoryPhysicalAllocate();
+	if(!copyPhys)
+		kernelPanic("%! no pages left for copying table", "paging");
+
+	g_virtual_address copyVirt = addressRangePoolAllocate(memoryVirtualRangePool, 1);
+	pagingMapPage(copyVirt, copyPhys);
+	g_page_table copy = (g_page_table) copyVirt;
+
+	for(uint32_t pi = 0; pi < 1024; pi++)
+	{
+		uint32_t page = table[pi];
+		copy[pi] = page;
+		if(page)
+		{
+			g_physical_address pagePhys = page & ~G_PAGE_ALIGN_MASK;
+			if(pageReferenceTrackerGetCount(pagePhys) > 0)
+				pageReferenceTrackerIncrement(pagePhys);
+		}
+	}
+
+	pagingUnmapPage(copyVirt);
+	addressRangePoolFree(memoryVirtualRangePool, copyVirt);
+
+	directory[ti] = copyPhys | tableFlags;
+	pagingSwitchToSpace(pagingGetCurrentSpace());
+}
+
+bool pagingResolveCopyOnWrite(g_virtual_address virt)
+{
+	uint32_t ti = G_TABLE_IN_DIRECTORY_INDEX(virt);
+	uint32_t pi = G_PAGE_IN_TABLE_INDEX(virt);
+
+	g_page_directory directory = (g_page_directory) G_CONST_RECURSIVE_PAGE_DIRECTORY_ADDRESS;
+	g_page_table table = G_CONST_RECURSIVE_PAGE_TABLE(ti);
+
+	if((directory[ti] & G_PAGE_TABLE_PRESENT) == 0)
+		return false;
+
+	bool resolved = false;
+	if(directory[ti] & G_PAGE_TABLE_COPY_ON_WRITE)
+	{
+		pagingUnshareTable(ti);
+		resolved = true;
+	}
+
+	uint32_t page = table[pi];
+	if((page & G_PAGE_PRESENT) && (page & G_PAGE_READWRITE) && (directory[ti] & G_PAGE_TABLE_READWRITE))
+	{
+		// Another processor has resolved it while this one still used the old entry
+		G_INVLPG(virt);
+		return true;
+	}
+	if((page & G_PAGE_PRESENT) == 0 || (page & G_PAGE_COPY_ON_WRITE) == 0)
+		return resolved;
+
+	g_physical_address pagePhys = page & ~G_PAGE_ALIGN_MASK;
+	uint32_t pageFlags = (page & G_PAGE_ALIGN_MASK & ~G_PAGE_COPY_ON_WRITE) | G_PAGE_READWRITE;
+
+	// Nobody else references the page anymore
+	if(pageReferenceTrackerGetCount(pagePhys) <= 1)
+	{
+		table[pi] = pagePhys | pageFlags;
+		G_INVLPG(virt);
+		return true;
+	}
+
+	g_physical_address copyPhys = memoryPhysicalAllocate();
+	if(!copyPhys)
+		kernelPanic("%! no pages left for copy-on-write", "paging");
+
+	g_virtual_address copyVirt = addressRangePoolAllocate(memoryVirtualRangePool, 1);
+	pagingMapPage(copyVirt, copyPhys);
+	memoryCopy((void*) copyVirt, (void*) virt, G_PAGE_SIZE);
+	pagingUnmapPage(copyVirt);
+	addressRangePoolFree(memoryVirtualRangePool, copyVirt);
+
+	table[pi] = copyPhys | pageFlags;
+	G_INVLPG(virt);
+
+	pageReferenceTrackerIncrement(copyPhys);
+	if(pageReferenceTrackerDecrement(pagePhys) == 0)
+		memoryPhysicalFree(pagePhys);
+	return true;
+}
+
 g_physical_address pagingGetCurrentSpace()
 {
 	uint32_t directory;
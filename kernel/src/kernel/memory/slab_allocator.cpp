@@ -0,0 +1,301 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/memory/slab_allocator.hpp"
+#include "kernel/memory/memory.hpp"
+#include "kernel/memory/paging.hpp"
+#include "kernel/system/interrupts/interrupts.hpp"
+#include "kernel/system/processor/processor.hpp"
+#include "shared/logger/logger.hpp"
+
+#define G_SLAB_OBJECTS_OFFSET	((sizeof(g_slab) + G_SLAB_MIN_OBJECT_SIZE - 1) & ~(G_SLAB_MIN_OBJECT_SIZE - 1))
+#define G_SLAB_FOR_OBJECT(object)	((g_slab*) (((g_virtual_address) object) & ~(G_PAGE_SIZE - 1)))
+
+void slabAllocatorInitialize(g_slab_allocator* allocator, g_virtual_address start, g_virtual_address end)
+{
+	for(int i = 0; i < G_SLAB_CLASS_COUNT; i++)
+	{
+		g_slab_cache* cache = &allocator->caches[i];
+		mutexInitialize(&cache->lock);
+		cache->objectSize = G_SLAB_MIN_OBJECT_SIZE << i;
+		cache->objectsPerSlab = (G_PAGE_SIZE - G_SLAB_OBJECTS_OFFSET) / cache->objectSize;
+		cache->partial = 0;
+		cache->slabCount = 0;
+		cache->allocated = 0;
+	}
+	allocator->processorCaches = 0;
+
+	mutexInitialize(&allocator->areaLock);
+	allocator->areaStart = start;
+	allocator->areaEnd = end;
+	allocator->areaTop = start;
+	allocator->emptySlabs = 0;
+	allocator->emptySlabCount = 0;
+}
+
+void slabAllocatorInitializeProcessorCaches(g_slab_allocator* allocator, g_slab_processor_cache* caches)
+{
+	allocator->processorCaches = caches;
+}
+
+bool slabAllocatorContains(g_slab_allocator* allocator, void* memory)
+{
+	g_virtual_address address = (g_virtual_address) memory;
+	return address >= allocator->areaStart && address < allocator->areaTop;
+}
+
+/**
+ * Returns the index of the smallest size class that fits the size, or
+ * G_SLAB_CLASS_COUNT if it is too large.
+ */
+static int slabAllocatorGetClass(uint32_t size)
+{
+	int index = 0;
+	while(index < G_SLAB_CLASS_COUNT && size > ((uint32_t) G_SLAB_MIN_OBJECT_SIZE << index))
+		index++;
+	return index;
+}
+
+/**
+ * Takes a page for a new slab, either one that was released before or
+ * a freshly mapped one.
+ */
+static g_slab* slabAllocatorTakePage(g_slab_allocator* allocator)
+{
+	mutexAcquire(&allocator->areaLock);
+
+	g_slab* slab = allocator->emptySlabs;
+	if(slab)
+	{
+		allocator->emptySlabs = slab->next;
+		allocator->emptySlabCount--;
+	}
+	else if(allocator->areaTop + G_PAGE_SIZE <= allocator->areaEnd)
+	{
+		g_physical_address page = memoryPhysicalAllocate();
+		if(page)
+		{
+			pagingMapPage(allocator->areaTop, page, DEFAULT_KERNEL_TABLE_FLAGS, DEFAULT_KERNEL_PAGE_FLAGS);
+			slab = (g_slab*) allocator->areaTop;
+			allocator->areaTop += G_PAGE_SIZE;
+		}
+	}
+	else
+	{
+		logWarn("%! out of virtual memory for slabs", "slab");
+	}
+
+	mutexRelease(&allocator->areaLock);
+	return slab;
+}
+
+static void slabAllocatorReleasePage(g_slab_allocator* allocator, g_slab* slab)
+{
+	mutexAcquire(&allocator->areaLock);
+	slab->next = allocator->emptySlabs;
+	allocator->emptySlabs = slab;
+	allocator->emptySlabCount++;
+	mutexRelease(&allocator->areaLock);
+}
+
+static void slabCacheUnlinkPartial(g_slab_cache* cache, g_slab* slab)
+{
+	if(slab->previous)
+		slab->previous->next = slab->next;
+	else
+		cache->partial = slab->next;
+
+	if(slab->next)
+		slab->next->previous = slab->previous;
+}
+
+static void slabCacheLinkPartial(g_slab_cache* cache, g_slab* slab)
+{
+	slab->previous = 0;
+	slab->next = cache->partial;
+	if(cache->partial)
+		cache->partial->previous = slab;
+	cache->partial = slab;
+}
+
+/**
+ * Takes up to count objects from the slabs of the cache, creating new slabs
+ * when necessary.
+ *
+ * @return the number of objects written to out
+ */
+static uint32_t slabCacheTake(g_slab_allocator* allocator, g_slab_cache* cache, void** out, uint32_t count)
+{
+	mutexAcquire(&cache->lock);
+
+	uint32_t taken = 0;
+	while(taken < count)
+	{
+		g_slab* slab = cache->partial;
+		if(!slab)
+		{
+			slab = slabAllocatorTakePage(allocator);
+			if(!slab)
+				break;
+
+			slab->cache = cache;
+			slab->inUse = 0;
+			slab->capacity = cache->objectsPerSlab;
+			slab->freeList = 0;
+			g_virtual_address object = ((g_virtual_address) slab) + G_SLAB_OBJECTS_OFFSET;
+			for(uint32_t i = 0; i < cache->objectsPerSlab; i++)
+			{
+				*((void**) object) = slab->freeList;
+				slab->freeList = (void*) object;
+				object += cache->objectSize;
+			}
+
+			slabCacheLinkPartial(cache, slab);
+			cache->slabCount++;
+		}
+
+		void* object = slab->freeList;
+		slab->freeList = *((void**) object);
+		slab->inUse++;
+		out[taken++] = object;
+
+		if(!slab->freeList)
+			slabCacheUnlinkPartial(cache, slab);
+	}
+
+	mutexRelease(&cache->lock);
+	return taken;
+}
+
+/**
+ * Puts the objects back into their slabs. A slab that becomes empty is
+ * released unless it is the last one with free objects.
+ */
+static void slabCacheReturn(g_slab_allocator* allocator, g_slab_cache* cache, void** objects, uint32_t count)
+{
+	mutexAcquire(&cache->lock);
+
+	for(uint32_t i = 0; i < count; i++)
+	{
+		g_slab* slab = G_SLAB_FOR_OBJECT(objects[i]);
+		if(!slab->freeList)
+			slabCacheLinkPartial(cache, slab);
+
+		*((void**) objects[i]) = slab->freeList;
+		slab->freeList = objects[i];
+		slab->inUse--;
+
+		if(slab->inUse == 0 && (cache->partial != slab || slab->next))
+		{
+			slabCacheUnlinkPartial(cache, slab);
+			cache->slabCount--;
+			slabAllocatorReleasePage(allocator, slab);
+		}
+	}
+
+	mutexRelease(&cache->lock);
+}
+
+void* slabAllocatorAllocate(g_slab_allocator* allocator, uint32_t size)
+{
+	int index = slabAllocatorGetClass(size);
+	if(index == G_SLAB_CLASS_COUNT)
+		return 0;
+
+	g_slab_cache* cache = &allocator->caches[index];
+	void* object = 0;
+
+	if(allocator->processorCaches)
+	{
+		bool enableInt = interruptsAreEnabled();
+		if(enableInt)
+			interruptsDisable();
+
+		g_slab_processor_cache* local = &allocator->processorCaches[processorGetCurrentId() * G_SLAB_CLASS_COUNT + index];
+		if(!local->head)
+		{
+			void* batch[G_SLAB_PROCESSOR_CACHE_BATCH];
+			uint32_t taken = slabCacheTake(allocator, cache, batch, G_SLAB_PROCESSOR_CACHE_BATCH);
+			for(uint32_t i = 0; i < taken; i++)
+			{
+				*((void**) batch[i]) = local->head;
+				local->head = batch[i];
+			}
+			local->count = taken;
+		}
+
+		if(local->head)
+		{
+			object = local->head;
+			local->head = *((void**) object);
+			local->count--;
+		}
+
+		if(enableInt)
+			interruptsEnable();
+	}
+	else
+	{
+		slabCacheTake(allocator, cache, &object, 1);
+	}
+
+	if(object)
+		__sync_fetch_and_add(&cache->allocated, 1);
+	return object;
+}
+
+uint32_t slabAllocatorFree(g_slab_allocator* allocator, void* object)
+{
+	g_slab_cache* cache = G_SLAB_FOR_OBJECT(object)->cache;
+	__sync_fetch_and_sub(&cache->allocated, 1);
+
+	if(allocator->processorCaches)
+	{
+		bool enableInt = interruptsAreEnabled();
+		if(enableInt)
+			interruptsDisable();
+
+		g_slab_processor_cache* local = &allocator->processorCaches[processorGetCurrentId() * G_SLAB_CLASS_COUNT + (cache - allocator->caches)];
+		*((void**) object) = local->head;
+		local->head = object;
+		local->count++;
+
+		if(local->count > G_SLAB_PROCESSOR_CACHE_LIMIT)
+		{
+			void* batch[G_SLAB_PROCESSOR_CACHE_BATCH];
+			for(uint32_t i = 0; i < G_SLAB_PROCESSOR_CACHE_BATCH; i++)
+			{
+				batch[i] = local->head;
+				local->head = *((void**) batch[i]);
+			}
+			local->count -= G_SLAB_PROCESSOR_CACHE_BATCH;
+			slabCacheReturn(allocator, cache, batch, G_SLAB_PROCESSOR_CACHE_BATCH);
+		}
+
+		if(enableInt)
+			interruptsEnable();
+	}
+	else
+	{
+		slabCacheReturn(allocator, cache, &object, 1);
+	}
+
+	return cache->objectSize;
+}
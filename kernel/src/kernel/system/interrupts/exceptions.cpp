@@ -22,6 +22,7 @@
 #include "shared/logger/logger.hpp"
 #include "kernel/memory/paging.hpp"
 #include "kernel/tasking/tasking.hpp"
+#include "kernel/tasking/tasking_memory.hpp"
 #include "kernel/system/processor/virtual_8086_monitor.hpp"
 #include "kernel/tasking/elf/elf_loader.hpp"
 #include "kernel/memory/page_reference_tracker.hpp"
@@ -148,21 +149,84 @@ bool exceptionsHandleStackOverflow(g_task* task, g_virtual_address accessedVirtP
 		pageFlags = DEFAULT_USER_PAGE_FLAGS;
 	}
 
-	g_physical_address extendedStackPage = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+	g_physical_address extendedStackPage = memoryPhysicalAllocate();
 	pageReferenceTrackerIncrement(extendedStackPage);
 	pagingMapPage(accessedVirtPage, extendedStackPage, tableFlags, pageFlags);
 	return true;
 }
 
+/**
+ * Resolves faults on user pages that are only mapped or copied when accessed.
+ */
+bool exceptionsResolveUserPage(g_task* task, g_virtual_address virtPage, uint32_t error)
+{
+	if(virtPage >= G_CONST_KERNEL_AREA_START)
+		return false;
+
+	/* Write to memory that is shared copy-on-write after a fork */
+	bool presentWrite = (error & 3) == 3;
+	if(presentWrite)
+	{
+		mutexAcquire(&task->process->lock);
+		bool resolved = pagingResolveCopyOnWrite(virtPage);
+		if(resolved)
+			taskingMemoryShootdown(task->process);
+		mutexRelease(&task->process->lock);
+		if(resolved)
+			return true;
+	}
+
+	/* Reserved memory that is mapped on first access */
+	bool notPresent = (error & 1) == 0;
+	return notPresent && taskingMemoryResolveLazyPage(task->process, virtPage);
+}
+
+bool exceptionsHandleKernelPageFault(g_processor_state* state)
+{
+	g_task* task = taskingGetCurrentTask();
+	if(!task)
+		return false;
+
+	return exceptionsResolveUserPage(task, G_PAGE_ALIGN_DOWN(exceptionsGetCR2()), state->error);
+}
+
+bool exceptionsHandleSystemCallFault(g_processor_state* state)
+{
+	g_tasking_local* local = taskingGetLocal();
+	g_task* task = local->scheduling.current;
+	if(!task || task->securityLevel == G_SECURITY_LEVEL_KERNEL || task->state->intr != 0x80)
+		return false;
+
+	/* Kernel locks taken by the call can not be given back when it is abandoned */
+	if(local->locksHeld > 0)
+		return false;
+
+	logInfo("%! task %i killed due to exception %i (error %i) in system call %i at EIP %h", "exception", task->id, state->intr,
+		state->error, task->state->eax, state->eip);
+	if(state->intr == 0x0E)
+		logInfo("%#    accessed address: %h", exceptionsGetCR2());
+
+	task->status = G_THREAD_STATUS_DEAD;
+	taskingSchedule();
+	return true;
+}
+
 bool exceptionsHandlePageFault(g_task* task)
 {
 	g_virtual_address accessed = exceptionsGetCR2();
 	g_virtual_address virtPage = G_PAGE_ALIGN_DOWN(accessed);
 	g_physical_address physPage = pagingVirtualToPhysical(virtPage);
 
+	bool presentWrite = (task->state->error & 3) == 3;
+	if(presentWrite && exceptionsResolveUserPage(task, virtPage, task->state->error))
+		return true;
+
 	if(exceptionsHandleStackOverflow(task, virtPage))
 		return true;
 
+	if(!presentWrite && exceptionsResolveUserPage(task, virtPage, task->state->error))
+		return true;
+
 	logInfo("%! task %i (core %i) EIP: %x (accessed %h, mapped page %h)", "pagefault", task->id, processorGetCurrentId(), task->state->eip, accessed, physPage);
 
 	exceptionsDumpTask(task);
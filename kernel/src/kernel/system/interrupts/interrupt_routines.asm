@@ -25,6 +25,8 @@ BITS 32
 ; C handler functions
 ;
 extern _interruptHandler
+extern _syscallEnterHandler
+extern _interruptStackSwitched
 
 ;
 ; Handler routine
@@ -81,7 +83,10 @@ interruptRoutine:
 	call _interruptHandler
 	; Set stack from return value
 	mov esp, eax
+	; The task that was interrupted has now been left
+	call _interruptStackSwitched
 
+interruptRoutineReturn:
 	; Restore segments
 	pop gs
 	pop fs
@@ -119,6 +124,102 @@ interruptRoutine:
 	iret
 
 
+;
+; Fast system call entry
+;
+global _syscallEnterRoutine
+_syscallEnterRoutine:
+	;
+	; SYSENTER has loaded ESP from the IA32_SYSENTER_ESP MSR, which points to
+	; the TSS of this processor. Its ESP0 field is the interrupt stack of the
+	; current task. The caller has put its return address into EDX and its
+	; stack pointer into ECX.
+	;
+	mov esp, [esp + 4]
+
+	; Build the same frame that an interrupt from ring 3 would push, so that
+	; the scheduler can switch tasks as usual
+	push 0x23						; ss
+	push ecx						; esp
+	pushfd							; eflags, interrupts were enabled in ring 3
+	or dword [esp], 0x200
+	push 0x1B						; cs
+	push edx						; eip
+	push 0							; error
+	push 0x80						; intr
+
+	; Store general purpose
+	push edi
+	push esi
+	push ebp
+	push ebx
+	push edx
+	push ecx
+	push eax
+
+	; Store segments
+	push ds
+	push es
+	push fs
+	push gs
+
+	; Switch to kernel segments
+	mov ax, 0x10
+	mov ds, ax
+	mov es, ax
+	mov fs, ax
+	mov gs, ax
+
+	; Stack pointer argument
+	push esp
+
+	; Call handler
+	call _syscallEnterHandler
+
+	; Set stack from return value, the task that was interrupted has now been left
+	mov ecx, [esp]
+	mov esp, eax
+	push ecx
+	call _interruptStackSwitched
+	pop ecx
+
+	; If a different task continues, or the state was changed, return with IRET
+	cmp esp, ecx
+	jne interruptRoutineReturn
+	cmp dword [esp + 56], 0x1B		; cs
+	jne interruptRoutineReturn
+	mov eax, [esp + 52]				; eip must still be in edx
+	cmp eax, [esp + 24]
+	jne interruptRoutineReturn
+	mov eax, [esp + 64]				; esp must still be in ecx
+	cmp eax, [esp + 20]
+	jne interruptRoutineReturn
+
+	; Restore segments
+	pop gs
+	pop fs
+	pop es
+	pop ds
+
+	; Restore general purpose
+	pop eax
+	pop ecx
+	pop edx
+	pop ebx
+	pop ebp
+	pop esi
+	pop edi
+
+	; Skip intr, error, eip and cs
+	add esp, 16
+
+	; Restore flags with interrupts still disabled, STI only takes effect
+	; after SYSEXIT has loaded EIP from EDX and ESP from ECX
+	and dword [esp], 0xFFFFFDFF
+	popfd
+	sti
+	sysexit
+
 ; Handle routine macro for interrupts with error code
 %macro handleRoutine 2
 global %1
@@ -28,7 +28,9 @@
 #include "kernel/system/interrupts/idt.hpp"
 #include "shared/system/mutex.hpp"
 #include "kernel/tasking/tasking.hpp"
+#include "kernel/tasking/scheduler.hpp"
 #include "kernel/memory/gdt.hpp"
+#include "kernel/calls/syscall.hpp"
 #include "kernel/kernel.hpp"
 
 void interruptsInitializeBsp()
@@ -87,6 +89,22 @@ bool interruptsAreEnabled()
 extern "C" g_virtual_address _interruptHandler(g_virtual_address esp)
 {
 	g_tasking_local* local = taskingGetLocal();
+
+	// Fault within the kernel while an interrupt or system call is handled
+	if(local->inInterruptHandler)
+	{
+		g_processor_state* state = (g_processor_state*) esp;
+		if(state->intr == 0x0E && exceptionsHandleKernelPageFault(state))
+			return esp;
+
+		// Faulting system calls of user tasks kill the caller instead
+		if(!exceptionsHandleSystemCallFault(state))
+			kernelPanic("%! unresolved exception %i in interrupt handler at EIP: %h", "exception", state->intr, state->eip);
+
+		local->inInterruptHandler = false;
+		return taskingRestore(esp);
+	}
+
 	local->inInterruptHandler = true;
 
 	if(taskingStore(esp))
@@ -105,6 +123,40 @@ extern "C" g_virtual_address _interruptHandler(g_virtual_address esp)
 	return esp;
 }
 
+extern "C" void _interruptStackSwitched()
+{
+	schedulerFinishSwitch(taskingGetLocal());
+}
+
+void interruptsInitializeSysenter()
+{
+	if(!processorHasFeature(g_cpuid_standard_edx_feature::SEP))
+	{
+		logDebug("%! not supported", "sysenter");
+		return;
+	}
+
+	/* The entry routine loads the stack of the current task from ESP0 of the TSS */
+	g_gdt_list_entry* localGdt = gdtGetForCore(processorGetCurrentId());
+	processorWriteMsr(IA32_SYSENTER_CS_MSR, G_GDT_DESCRIPTOR_KERNEL_CODE, 0);
+	processorWriteMsr(IA32_SYSENTER_ESP_MSR, (uint32_t) &localGdt->tss, 0);
+	processorWriteMsr(IA32_SYSENTER_EIP_MSR, (uint32_t) _syscallEnterRoutine, 0);
+}
+
+extern "C" g_virtual_address _syscallEnterHandler(g_virtual_address esp)
+{
+	g_tasking_local* local = taskingGetLocal();
+	local->inInterruptHandler = true;
+
+	if(taskingStore(esp))
+	{
+		syscallHandle(local->scheduling.current);
+	}
+
+	local->inInterruptHandler = false;
+	return taskingRestore(esp);
+}
+
 void interruptsInstallRoutines()
 {
 	idtCreateGate(0, (uint32_t) _irout0, 0x08, 0x8E);
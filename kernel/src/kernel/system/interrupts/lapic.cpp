@@ -19,6 +19,7 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "kernel/system/interrupts/lapic.hpp"
+#include "kernel/system/interrupts/interrupts.hpp"
 #include "kernel/system/timing/pit.hpp"
 #include "kernel/system/processor/processor.hpp"
 #include "kernel/memory/memory.hpp"
@@ -30,6 +31,9 @@ static bool globalPrepared = false;
 static g_physical_address physicalBase = 0;
 static g_virtual_address virtualBase = 0;
 
+// Timer ticks per millisecond, calibrated when the timer is started
+static uint32_t timerTicksPerMillisecond = 0;
+
 void lapicGlobalPrepare(g_physical_address lapicAddress)
 {
 	physicalBase = lapicAddress;
@@ -125,10 +129,36 @@ void lapicStartTimer()
 	// Now we know how often the APIC timer has ticked in 10ms
 	uint32_t ticksPer10ms = 0xFFFFFFFF - lapicRead(APIC_REGISTER_TIMER_CURRCNT);
 
+	timerTicksPerMillisecond = ticksPer10ms / 10;
+	lapicStartPeriodicTimer();
+}
+
+void lapicStartPeriodicTimer()
+{
 	// Start timer as periodic on IRQ 0
 	lapicWrite(APIC_REGISTER_LVT_TIMER, 32 | APIC_LVT_TIMER_MODE_PERIODIC);
 	lapicWrite(APIC_REGISTER_TIMER_DIV, 0x3);
-	lapicWrite(APIC_REGISTER_TIMER_INITCNT, ticksPer10ms / 10);
+	lapicWrite(APIC_REGISTER_TIMER_INITCNT, timerTicksPerMillisecond * APIC_MILLISECONDS_PER_TICK);
+}
+
+void lapicStartOneShotTimer(uint32_t milliseconds)
+{
+	uint32_t maximum = 0xFFFFFFFF / timerTicksPerMillisecond;
+	if(milliseconds > maximum)
+		milliseconds = maximum;
+	if(milliseconds == 0)
+		milliseconds = 1;
+
+	lapicWrite(APIC_REGISTER_LVT_TIMER, 32 | APIC_LVT_TIMER_MODE_ONESHOT);
+	lapicWrite(APIC_REGISTER_TIMER_DIV, 0x3);
+	lapicWrite(APIC_REGISTER_TIMER_INITCNT, milliseconds * timerTicksPerMillisecond);
+}
+
+uint32_t lapicGetOneShotElapsed()
+{
+	// The current count runs down to zero and stays there once the timer fired
+	uint32_t elapsedTicks = lapicRead(APIC_REGISTER_TIMER_INITCNT) - lapicRead(APIC_REGISTER_TIMER_CURRCNT);
+	return (elapsedTicks + timerTicksPerMillisecond / 2) / timerTicksPerMillisecond;
 }
 
 uint32_t lapicReadId()
@@ -143,6 +173,21 @@ void lapicSendEndOfInterrupt()
 	lapicWrite(APIC_REGISTER_EOI, 0);
 }
 
+void lapicSendIpi(uint32_t apicId, uint8_t vector)
+{
+	// The two ICR writes must not be interleaved with another IPI from this processor
+	bool enableInterrupts = interruptsAreEnabled();
+	if(enableInterrupts)
+		interruptsDisable();
+
+	lapicWaitForIcrSend();
+	lapicWrite(APIC_REGISTER_INT_COMMAND_HIGH, apicId << 24);
+	lapicWrite(APIC_REGISTER_INT_COMMAND_LOW, vector | APIC_ICR_DELMOD_FIXED | APIC_ICR_LEVEL_ASSERT);
+
+	if(enableInterrupts)
+		interruptsEnable();
+}
+
 void lapicWaitForIcrSend()
 {
 	while(APIC_LVT_GET_DELIVERY_STATUS(lapicRead(APIC_REGISTER_INT_COMMAND_HIGH)) == APIC_ICR_DELIVS_SEND_PENDING)
@@ -24,6 +24,7 @@
 #include "kernel/system/processor/processor.hpp"
 #include "kernel/tasking/tasking.hpp"
 #include "kernel/tasking/scheduler.hpp"
+#include "kernel/tasking/tasking_memory.hpp"
 #include "kernel/memory/memory.hpp"
 
 #include "shared/logger/logger.hpp"
@@ -40,11 +41,24 @@ void requestsHandle(g_task* task)
 {
 	const uint32_t intr = task->state->intr;
 
+	/* Any interrupt ends tickless idle, the time that passed is accounted there */
+	bool wasTickless = intr != 0x80 && schedulerLeaveTickless();
+
 	/* Special handling for when a kernel thread yields using <taskingKernelThreadYield> */
 	if(intr == 0x81)
 	{
 		taskingSchedule();
 
+	/* Another processor has made work available to this one */
+	} else if(intr == APIC_RESCHEDULE_VECTOR)
+	{
+		taskingSchedule();
+
+	/* Another processor has changed the mappings of the current address space */
+	} else if(intr == APIC_TLB_SHOOTDOWN_VECTOR)
+	{
+		taskingMemoryHandleShootdown();
+
 	/* System calls */
 	} else if(intr == 0x80)
 	{
@@ -57,7 +71,8 @@ void requestsHandle(g_task* task)
 		/* Timer interrupt request triggers the scheduler */
 		if(irq == 0)
 		{
-			taskingGetLocal()->time += APIC_MILLISECONDS_PER_TICK;
+			if(!wasTickless)
+				taskingGetLocal()->time += APIC_MILLISECONDS_PER_TICK;
 			schedulerNewTimeSlot();
 			taskingSchedule();
 
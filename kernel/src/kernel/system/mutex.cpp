@@ -21,6 +21,7 @@
 #include "shared/system/mutex.hpp"
 
 #include "kernel/tasking/tasking.hpp"
+#include "kernel/tasking/tasking_memory.hpp"
 #include "kernel/system/interrupts/interrupts.hpp"
 
 #include "shared/logger/logger.hpp"
@@ -61,7 +62,12 @@ void mutexAcquire(g_mutex* mutex, bool smp)
 		mutexErrorUninitialized(mutex);
 
 	while(!mutexTryAcquire(mutex, smp))
+	{
+		// The holder may be waiting for this processor to flush its TLB
+		if(smp)
+			taskingMemoryHandleShootdown();
 		asm("pause");
+	}
 }
 
 bool mutexTryAcquire(g_mutex* mutex)
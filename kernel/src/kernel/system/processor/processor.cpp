@@ -35,6 +35,7 @@ void processorInitializeBsp()
 
 	processorPrintInformation();
 	processorEnableSSE();
+	processorEnableWriteProtection();
 
 	if(!processorHasFeature(g_cpuid_standard_edx_feature::APIC))
 		kernelPanic("%! processor has no APIC", "cpu");
@@ -43,6 +44,7 @@ void processorInitializeBsp()
 void processorInitializeAp()
 {
 	processorEnableSSE();
+	processorEnableWriteProtection();
 }
 
 void processorApicIdCreateMappingTable()
@@ -144,6 +146,15 @@ void processorEnableSSE()
 	}
 }
 
+void processorEnableWriteProtection()
+{
+	// CR0.WP makes read-only pages fault on kernel writes too, required for copy-on-write
+	uint32_t cr0;
+	asm volatile("mov %%cr0, %0" : "=r"(cr0));
+	cr0 |= (1 << 16);
+	asm volatile("mov %0, %%cr0" :: "r"(cr0));
+}
+
 bool processorHasFeature(g_cpuid_standard_edx_feature feature)
 {
 	uint32_t eax;
@@ -45,7 +45,7 @@ void smpInitialize(g_physical_address initialPageDirectoryPhysical)
 	for(uint32_t i = 0; i < processorGetNumberOfProcessors(); i++)
 	{
 
-		g_physical_address stackPhysical = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+		g_physical_address stackPhysical = memoryPhysicalAllocate();
 		if(stackPhysical == 0)
 		{
 			logInfo("%*%! could not allocate physical page for AP stack", 0x0C, "smp");
@@ -74,7 +74,11 @@ void smpInitialize(g_physical_address initialPageDirectoryPhysical)
 		logInfo("%*%! could not initialize due to missing apstartup object at '%s'", 0x0C, "smp", ap_startup_location);
 		return;
 	}
-	memoryCopy((uint8_t*) G_CONST_SMP_STARTUP_AREA_CODE_START, (uint8_t*) startupObject->data, startupObject->dataSize);
+	if(ramdiskReadData(startupObject, 0, (uint8_t*) G_CONST_SMP_STARTUP_AREA_CODE_START, startupObject->dataSize) < 0)
+	{
+		logInfo("%*%! could not initialize due to broken apstartup object at '%s'", 0x0C, "smp", ap_startup_location);
+		return;
+	}
 
 	smpInitialized = true;
 
@@ -38,6 +38,7 @@ void systemInitializeBsp(g_physical_address initialPdPhys)
 
 	gdtPrepare();
 	gdtInitialize();
+	interruptsInitializeSysenter();
 
 	applicationCoresWaiting = processorGetNumberOfProcessors() - 1;
 	bspInitialized = true;
@@ -49,6 +50,7 @@ void systemInitializeAp()
 	interruptsInitializeAp();
 
 	gdtInitialize();
+	interruptsInitializeSysenter();
 
 	systemMarkApplicationCoreReady();
 }
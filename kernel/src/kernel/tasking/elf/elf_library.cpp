@@ -22,6 +22,7 @@
 #include "kernel/memory/page_reference_tracker.hpp"
 #include "kernel/filesystem/filesystem.hpp"
 #include "kernel/memory/memory.hpp"
+#include "kernel/tasking/tasking_memory.hpp"
 
 
 g_spawn_status elfLibraryLoad(g_task* caller, g_elf_object* parentObject, const char* name, g_virtual_address baseAddress,
@@ -45,7 +46,7 @@ g_spawn_status elfLibraryLoad(g_task* caller, g_elf_object* parentObject, const
 		return G_SPAWN_STATUS_DEPENDENCY_ERROR;
 	}
 	g_spawn_status status = elfObjectLoad(caller, parentObject, name, fd, baseAddress, rangeAllocator, outNextBase, outObject);
-	filesystemClose(caller->process->id, fd, true);
+	filesystemClose(caller->process, fd, true);
 	return status;
 }
 
@@ -183,6 +184,17 @@ void elfObjectApplyRelocations(g_task* caller, g_fd file, g_elf_object* object)
 				}
 			}
 
+			/* Relocation targets and copy sources may lie in pages that are not mapped yet */
+			if(type == R_386_COPY)
+			{
+				taskingMemoryResolveLazyAreas(executableObject->lazyAreas, cP, cP + symbolSize);
+				if(cS)
+					taskingMemoryResolveLazyAreas(executableObject->lazyAreas, cS, cS + symbolSize);
+			} else
+			{
+				taskingMemoryResolveLazyAreas(executableObject->lazyAreas, cP, cP + sizeof(uint32_t));
+			}
+
 			if(type == R_386_32)
 			{
 				int32_t cA = *((int32_t*) cP);
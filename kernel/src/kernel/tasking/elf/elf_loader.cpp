@@ -22,6 +22,7 @@
 #include "kernel/memory/page_reference_tracker.hpp"
 #include "kernel/filesystem/filesystem.hpp"
 #include "kernel/memory/memory.hpp"
+#include "kernel/tasking/tasking_memory.hpp"
 
 
 g_spawn_status elfLoadExecutable(g_task* caller, g_fd fd, g_security_level securityLevel, g_process** outProcess, g_spawn_validation_details* outDetails)
@@ -51,6 +52,8 @@ g_spawn_status elfLoadExecutable(g_task* caller, g_fd fd, g_security_level secur
 
 	/* Update process */
 	targetProcess->object = executableObject;
+	targetProcess->lazyAreas = executableObject->lazyAreas;
+	executableObject->lazyAreas = 0;
 	targetProcess->image.start = executableObject->startAddress;
 	targetProcess->image.end = executableImageEnd;
 	logDebug("%! process loaded to %h - %h", "elf", targetProcess->image.start, targetProcess->image.end);
@@ -62,12 +65,41 @@ g_spawn_status elfLoadExecutable(g_task* caller, g_fd fd, g_security_level secur
 		logInfo("%! failed to create main thread to spawn ELF binary from ramdisk", "elf");
 		return G_SPAWN_STATUS_TASKING_ERROR;
 	}
-	taskingAssign(taskingGetLocal(), thread);
+	taskingAssignBalanced(thread);
 
 	if(outProcess) *outProcess = targetProcess;
 	return G_SPAWN_STATUS_SUCCESSFUL;
 }
 
+/**
+ * Maps newly allocated pages to the area in the current address space. The physical
+ * pages are taken in batches of up to {ELF_MAXIMUM_LOAD_PAGES_AT_ONCE}.
+ *
+ * @return whether all pages could be allocated
+ */
+static bool elfLoadMapPages(g_virtual_address start, uint32_t pages)
+{
+	g_physical_address physical[ELF_MAXIMUM_LOAD_PAGES_AT_ONCE];
+	for(uint32_t mapped = 0; mapped < pages;)
+	{
+		uint32_t batch = pages - mapped;
+		if(batch > ELF_MAXIMUM_LOAD_PAGES_AT_ONCE)
+			batch = ELF_MAXIMUM_LOAD_PAGES_AT_ONCE;
+
+		uint32_t allocated = memoryPhysicalAllocateMultiple(physical, batch);
+		for(uint32_t i = 0; i < allocated; i++)
+		{
+			pageReferenceTrackerIncrement(physical[i]);
+			pagingMapPage(start + (mapped + i) * G_PAGE_SIZE, physical[i], DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
+		}
+		if(allocated < batch)
+			return false;
+
+		mapped += batch;
+	}
+	return true;
+}
+
 g_virtual_address elfUserProcessCreateInfo(g_process* process, g_elf_object* executableObject, g_virtual_address executableImageEnd)
 {
 	/* Calculate required space */
@@ -87,11 +119,10 @@ g_virtual_address elfUserProcessCreateInfo(g_process* process, g_elf_object* exe
 	/* Preserve memory after executable */
 	uint32_t areaStart = executableImageEnd;
 	uint32_t pages = G_PAGE_ALIGN_UP(totalRequired) / G_PAGE_SIZE;
-	for(uint32_t i = 0; i < pages; i++)
+	if(!elfLoadMapPages(areaStart, pages))
 	{
-		g_physical_address page = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
-		pageReferenceTrackerIncrement(page);
-		pagingMapPage(areaStart + i * G_PAGE_SIZE, page, DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
+		logInfo("%! not enough memory to create process information", "elf");
+		return executableImageEnd;
 	}
 
 	/* Fill with data */
@@ -147,6 +178,21 @@ g_spawn_status elfLoadLoadSegment(g_task* caller, g_fd file, elf32_phdr* phdr, g
 		object->endAddress = memoryEnd;
 	}
 
+	/* Pages that have no file content are only mapped once accessed */
+	g_virtual_address lazyStart = G_PAGE_ALIGN_UP(loadEnd);
+	if(lazyStart < memoryStart)
+		lazyStart = memoryStart;
+	if(lazyStart < memoryEnd)
+	{
+		g_elf_object* executableObject = object;
+		while(executableObject->parent)
+			executableObject = executableObject->parent;
+		taskingMemoryAddLazyArea(&executableObject->lazyAreas, lazyStart, memoryEnd);
+
+		logDebug("%!   [%h-%h] reserved %h bytes of blank", "elf", lazyStart, memoryEnd, memoryEnd - lazyStart);
+		memoryEnd = lazyStart;
+	}
+
 	uint32_t pagesTotal = (memoryEnd - memoryStart) / G_PAGE_SIZE;
 	uint32_t pagesLoaded = 0;
 
@@ -162,11 +208,10 @@ g_spawn_status elfLoadLoadSegment(g_task* caller, g_fd file, elf32_phdr* phdr, g
 		g_virtual_address areaStart = memoryStart + pagesLoaded * G_PAGE_SIZE;
 		g_virtual_address areaEnd = (areaStart + areaPages * G_PAGE_SIZE);
 
-		for(uint32_t i = 0; i < areaPages; i++)
+		if(!elfLoadMapPages(areaStart, areaPages))
 		{
-			g_physical_address page = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
-			pageReferenceTrackerIncrement(page);
-			pagingMapPage(areaStart + i * G_PAGE_SIZE, page, DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
+			logInfo("%! not enough memory to load PT_LOAD segment", "elf");
+			return G_SPAWN_STATUS_MEMORY_ERROR;
 		}
 
 		if(loadPosition < loadEnd)
@@ -70,7 +70,7 @@ void elf32TlsCreateMasterImage(g_task* caller, g_fd file, g_process* process, g_
 	g_virtual_address tlsStart = addressRangePoolAllocate(process->virtualRangePool, requiredPages);
 	for(uint32_t i = 0; i < requiredPages; i++)
 	{
-		g_physical_address page = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+		g_physical_address page = memoryPhysicalAllocate();
 		pagingMapPage(tlsStart + i * G_PAGE_SIZE, page, DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
 		pageReferenceTrackerIncrement(page);
 	}
@@ -0,0 +1,180 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/tasking/futex.hpp"
+#include "kernel/tasking/scheduler.hpp"
+#include "kernel/tasking/tasking_memory.hpp"
+#include "kernel/memory/heap.hpp"
+#include "kernel/memory/paging.hpp"
+#include "shared/memory/constants.hpp"
+
+static g_futex_bucket futexBuckets[G_FUTEX_BUCKETS];
+
+static g_futex_bucket* futexGetBucket(g_physical_address space, g_virtual_address address)
+{
+	return &futexBuckets[((address >> 2) ^ (space >> 12)) % G_FUTEX_BUCKETS];
+}
+
+void futexInitialize()
+{
+	for(int i = 0; i < G_FUTEX_BUCKETS; i++)
+	{
+		mutexInitialize(&futexBuckets[i].lock);
+		futexBuckets[i].head = 0;
+	}
+}
+
+bool futexCheckAddress(g_process* process, volatile uint32_t* address)
+{
+	g_virtual_address virt = (g_virtual_address) address;
+	if((virt & 3) || G_TABLE_IN_DIRECTORY_INDEX(virt) == 0 || virt >= G_CONST_KERNEL_AREA_START)
+		return false;
+
+	g_virtual_address virtPage = G_PAGE_ALIGN_DOWN(virt);
+	taskingMemoryResolveLazyRange(process, virtPage, virtPage + G_PAGE_SIZE);
+	return pagingVirtualToPhysical(virtPage) != 0;
+}
+
+bool futexEnqueue(g_task* task, volatile uint32_t* address, uint32_t expected)
+{
+	g_physical_address space = task->process->pageDirectory;
+	g_futex_bucket* bucket = futexGetBucket(space, (g_virtual_address) address);
+
+	g_futex_waiter* waiter = (g_futex_waiter*) heapAllocate(sizeof(g_futex_waiter));
+	waiter->task = task->id;
+	waiter->space = space;
+	waiter->address = (g_virtual_address) address;
+
+	mutexAcquire(&bucket->lock);
+	bool queued = *address == expected;
+	if(queued)
+	{
+		waiter->next = bucket->head;
+		bucket->head = waiter;
+	}
+	mutexRelease(&bucket->lock);
+
+	if(!queued)
+		heapFree(waiter);
+	return queued;
+}
+
+bool futexIsQueued(g_task* task, volatile uint32_t* address)
+{
+	g_physical_address space = task->process->pageDirectory;
+	g_futex_bucket* bucket = futexGetBucket(space, (g_virtual_address) address);
+
+	mutexAcquire(&bucket->lock);
+	g_futex_waiter* waiter = bucket->head;
+	while(waiter)
+	{
+		if(waiter->task == task->id && waiter->space == space && waiter->address == (g_virtual_address) address)
+			break;
+		waiter = waiter->next;
+	}
+	mutexRelease(&bucket->lock);
+
+	return waiter != 0;
+}
+
+bool futexDequeue(g_task* task, volatile uint32_t* address)
+{
+	g_physical_address space = task->process->pageDirectory;
+	g_futex_bucket* bucket = futexGetBucket(space, (g_virtual_address) address);
+
+	mutexAcquire(&bucket->lock);
+	g_futex_waiter* previous = 0;
+	g_futex_waiter* waiter = bucket->head;
+	while(waiter)
+	{
+		if(waiter->task == task->id && waiter->space == space && waiter->address == (g_virtual_address) address)
+		{
+			if(previous)
+				previous->next = waiter->next;
+			else
+				bucket->head = waiter->next;
+			break;
+		}
+		previous = waiter;
+		waiter = waiter->next;
+	}
+	mutexRelease(&bucket->lock);
+
+	if(!waiter)
+		return false;
+	heapFree(waiter);
+	return true;
+}
+
+uint32_t futexWake(g_process* process, volatile uint32_t* address, uint32_t count)
+{
+	g_physical_address space = process->pageDirectory;
+	g_futex_bucket* bucket = futexGetBucket(space, (g_virtual_address) address);
+
+	/* Waiters are unlinked while holding the bucket and only woken afterwards, so that
+	no scheduler lock is acquired while holding the bucket. Waiters of tasks that died
+	while waiting are dropped without counting them. */
+	g_futex_waiter* woken = 0;
+	uint32_t wokenCount = 0;
+
+	mutexAcquire(&bucket->lock);
+	g_futex_waiter* previous = 0;
+	g_futex_waiter* waiter = bucket->head;
+	while(waiter && wokenCount < count)
+	{
+		g_futex_waiter* next = waiter->next;
+		if(waiter->space != space || waiter->address != (g_virtual_address) address)
+		{
+			previous = waiter;
+			waiter = next;
+			continue;
+		}
+
+		if(previous)
+			previous->next = next;
+		else
+			bucket->head = next;
+
+		g_task* task = taskingGetById(waiter->task);
+		if(task && task->status != G_THREAD_STATUS_DEAD && task->status != G_THREAD_STATUS_UNUSED)
+		{
+			waiter->next = woken;
+			woken = waiter;
+			wokenCount++;
+		}
+		else
+		{
+			heapFree(waiter);
+		}
+		waiter = next;
+	}
+	mutexRelease(&bucket->lock);
+
+	while(woken)
+	{
+		g_futex_waiter* next = woken->next;
+		g_task* task = taskingGetById(woken->task);
+		if(task)
+			schedulerWake(task);
+		heapFree(woken);
+		woken = next;
+	}
+	return wokenCount;
+}
@@ -0,0 +1,463 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/tasking/scheduler.hpp"
+#include "kernel/memory/heap.hpp"
+#include "shared/logger/logger.hpp"
+#include "kernel/tasking/wait.hpp"
+#include "kernel/tasking/wait_timer.hpp"
+#include "kernel/system/interrupts/lapic.hpp"
+
+void schedulerInitializeLocal()
+{
+	g_tasking_local* local = taskingGetLocal();
+	local->scheduling.waitQueue.head = 0;
+	local->scheduling.waitQueue.tail = 0;
+	local->scheduling.waitQueue.length = 0;
+	local->scheduling.checkQueue.head = 0;
+	local->scheduling.checkQueue.tail = 0;
+	local->scheduling.checkQueue.length = 0;
+
+	mutexInitialize(&local->scheduling.wakeLock);
+	local->scheduling.wakeList = 0;
+	local->scheduling.tickless = false;
+	waitQueueInitialize(&local->scheduling.pollWaiters);
+	waitTimerInitializeLocal(local);
+
+	schedulerBackendInitializeLocal(local);
+}
+
+void schedulerNewTimeSlot()
+{
+	waitQueueWake(&taskingGetLocal()->scheduling.pollWaiters);
+}
+
+/**
+ * Stops the periodic timer while the processor idles. The one-shot timer is set to
+ * the first wait timer, or to the maximum sleep time if there is none. Processors
+ * with tasks that are polled or woken keep ticking.
+ */
+static void schedulerEnterTickless(g_tasking_local* local)
+{
+	if(!local->ready || local->scheduling.pollWaiters.head)
+		return;
+
+	uint32_t sleep = G_SCHEDULER_TICKLESS_MAX_SLEEP;
+	if(local->timers.count > 0)
+	{
+		int32_t untilTimer = (int32_t) (local->timers.heap[0].time - local->time);
+		if(untilTimer <= 0)
+			return;
+		if((uint32_t) untilTimer < sleep)
+			sleep = untilTimer;
+	}
+
+	/* Setting the flag under the wake lock makes sure that a waker either sees it
+	and kicks this processor, or its wake is already in the list. */
+	mutexAcquire(&local->scheduling.wakeLock);
+	bool pending = local->scheduling.wakeList != 0;
+	if(!pending)
+		local->scheduling.tickless = true;
+	mutexRelease(&local->scheduling.wakeLock);
+
+	if(!pending)
+		lapicStartOneShotTimer(sleep);
+}
+
+bool schedulerLeaveTickless()
+{
+	g_tasking_local* local = taskingGetLocal();
+	if(!local->scheduling.tickless)
+		return false;
+
+	local->scheduling.tickless = false;
+	local->time += lapicGetOneShotElapsed();
+	lapicStartPeriodicTimer();
+	return true;
+}
+
+void schedulerKick(g_tasking_local* local)
+{
+	if(local != taskingGetLocal() && local->scheduling.tickless)
+		lapicSendIpi(local->apicId, APIC_RESCHEDULE_VECTOR);
+}
+
+void schedulerPrepareEntry(g_schedule_entry* entry)
+{
+	entry->queue = 0;
+	entry->queueNext = 0;
+	entry->queuePrevious = 0;
+}
+
+void schedulerPleaseSchedule(g_task* task)
+{
+	taskingGetLocal()->scheduling.preferredNextTask = task;
+}
+
+void schedulerQueuePush(g_schedule_queue* queue, g_schedule_entry* entry)
+{
+	entry->queue = queue;
+	entry->queueNext = 0;
+	entry->queuePrevious = queue->tail;
+	if(queue->tail)
+		queue->tail->queueNext = entry;
+	else
+		queue->head = entry;
+	queue->tail = entry;
+	queue->length++;
+}
+
+void schedulerQueueRemove(g_schedule_entry* entry)
+{
+	g_schedule_queue* queue = entry->queue;
+	if(!queue)
+		return;
+
+	if(entry->queuePrevious)
+		entry->queuePrevious->queueNext = entry->queueNext;
+	else
+		queue->head = entry->queueNext;
+
+	if(entry->queueNext)
+		entry->queueNext->queuePrevious = entry->queuePrevious;
+	else
+		queue->tail = entry->queuePrevious;
+
+	queue->length--;
+	entry->queue = 0;
+	entry->queueNext = 0;
+	entry->queuePrevious = 0;
+}
+
+void schedulerWake(g_task* task)
+{
+	g_tasking_local* local = task->assignment;
+	if(!local)
+		return;
+
+	mutexAcquire(&local->scheduling.wakeLock);
+	if(!task->wakePending)
+	{
+		task->wakePending = true;
+		task->wakeNext = local->scheduling.wakeList;
+		local->scheduling.wakeList = task;
+	}
+	mutexRelease(&local->scheduling.wakeLock);
+
+	schedulerKick(local);
+}
+
+void schedulerPollWaiting(g_task* task)
+{
+	waitQueueAdd(&task->assignment->scheduling.pollWaiters, task->id);
+}
+
+void schedulerRemoveWake(g_tasking_local* local, g_task* task)
+{
+	mutexAcquire(&local->scheduling.wakeLock);
+	if(task->wakePending)
+	{
+		g_task* previous = 0;
+		g_task* pending = local->scheduling.wakeList;
+		while(pending)
+		{
+			if(pending == task)
+			{
+				if(previous)
+					previous->wakeNext = task->wakeNext;
+				else
+					local->scheduling.wakeList = task->wakeNext;
+				break;
+			}
+			previous = pending;
+			pending = pending->wakeNext;
+		}
+		task->wakePending = false;
+	}
+	mutexRelease(&local->scheduling.wakeLock);
+}
+
+void schedulerRemoveEntry(g_tasking_local* local, g_schedule_entry* entry)
+{
+	if(entry->queue == &local->scheduling.waitQueue || entry->queue == &local->scheduling.checkQueue)
+		schedulerQueueRemove(entry);
+	else if(entry->queue)
+		schedulerBackendRemove(local, entry);
+}
+
+int schedulerGetLoad(g_tasking_local* local)
+{
+	int load = local->scheduling.runnableCount;
+	if(local->scheduling.current && local->scheduling.current != local->scheduling.idleTask)
+		load++;
+	return load;
+}
+
+g_tasking_local* schedulerGetLeastLoaded()
+{
+	g_tasking_local* best = taskingGetLocal();
+	int bestLoad = schedulerGetLoad(best);
+
+	uint16_t processors = processorGetNumberOfProcessors();
+	for(uint32_t processor = 0; processor < processors && bestLoad > 0; processor++)
+	{
+		g_tasking_local* local = taskingGetLocalForProcessor(processor);
+		if(!local->ready)
+			continue;
+
+		int load = schedulerGetLoad(local);
+		if(load < bestLoad)
+		{
+			best = local;
+			bestLoad = load;
+		}
+	}
+	return best;
+}
+
+bool schedulerCanMigrate(g_task* task)
+{
+	/* Kernel tasks may rely on the processor they were started on. A task that was
+	just switched away from is queued before its processor has left its stack. */
+	return task->status == G_THREAD_STATUS_RUNNING && task->type == G_THREAD_TYPE_DEFAULT && task->securityLevel != G_SECURITY_LEVEL_KERNEL
+		&& !task->onProcessor;
+}
+
+/**
+ * Makes the task the current task of the local. The processor remains on the stack
+ * of the task that was interrupted until the interrupt returns, so that task stays
+ * marked until <schedulerFinishSwitch> is called.
+ */
+static void schedulerSetCurrent(g_tasking_local* local, g_task* next)
+{
+	g_task* current = local->scheduling.current;
+	if(current == next)
+		return;
+
+	if(!local->scheduling.switchedFrom)
+		local->scheduling.switchedFrom = current;
+	else if(current)
+		current->onProcessor = false;
+
+	if(local->scheduling.switchedFrom == next)
+		local->scheduling.switchedFrom = 0;
+
+	next->onProcessor = true;
+	local->scheduling.current = next;
+}
+
+void schedulerFinishSwitch(g_tasking_local* local)
+{
+	g_task* switchedFrom = local->scheduling.switchedFrom;
+	if(switchedFrom)
+	{
+		local->scheduling.switchedFrom = 0;
+		__atomic_store_n(&switchedFrom->onProcessor, false, __ATOMIC_RELEASE);
+	}
+}
+
+/**
+ * Takes a runnable task from the processor with the highest load and assigns it to
+ * the given local. The lock of the other local is only tried, so that two processors
+ * stealing from each other can't deadlock.
+ *
+ * @return whether a task was stolen
+ */
+static bool schedulerSteal(g_tasking_local* local)
+{
+	g_tasking_local* victim = 0;
+	int victimLoad = 1;
+
+	uint16_t processors = processorGetNumberOfProcessors();
+	for(uint32_t processor = 0; processor < processors; processor++)
+	{
+		g_tasking_local* other = taskingGetLocalForProcessor(processor);
+		if(other == local || !other->ready || other->scheduling.runnableCount == 0)
+			continue;
+
+		int load = schedulerGetLoad(other);
+		if(load > victimLoad)
+		{
+			victim = other;
+			victimLoad = load;
+		}
+	}
+
+	if(!victim || !mutexTryAcquire(&victim->lock))
+		return false;
+
+	g_schedule_entry* entry = schedulerBackendTakeMigratable(victim);
+	g_task* task = entry ? entry->task : 0;
+	if(task)
+	{
+		taskingUnassign(victim, task);
+	}
+	mutexRelease(&victim->lock);
+
+	if(!task)
+		return false;
+
+	taskingAssign(local, task);
+	return true;
+}
+
+void schedulerEnqueue(g_tasking_local* local, g_schedule_entry* entry)
+{
+	schedulerRemoveEntry(local, entry);
+
+	g_thread_status status = entry->task->status;
+	if(status == G_THREAD_STATUS_RUNNING)
+	{
+		schedulerBackendEnqueue(local, entry);
+
+	} else if(status == G_THREAD_STATUS_WAITING)
+	{
+		/* A task that starts waiting is checked once, which lets its wait resolver
+		register the task wherever it expects to be woken from. */
+		schedulerQueuePush(&local->scheduling.checkQueue, entry);
+
+	} else
+	{
+		/* Dead and unused tasks are in no queue; the cleanup thread removes dead
+		tasks, unused ones are enqueued again once they are reassigned. */
+		waitQueueWake(&entry->task->joinWaiters);
+	}
+}
+
+/**
+ * Moves all tasks that were woken since the last schedule from the wait queue
+ * to the check queue.
+ */
+static void schedulerTakeWakes(g_tasking_local* local)
+{
+	mutexAcquire(&local->scheduling.wakeLock);
+
+	g_task* task = local->scheduling.wakeList;
+	local->scheduling.wakeList = 0;
+	while(task)
+	{
+		g_task* next = task->wakeNext;
+		task->wakePending = false;
+
+		g_schedule_entry* entry = task->scheduleEntry;
+		if(entry && entry->queue == &local->scheduling.waitQueue)
+		{
+			schedulerQueueRemove(entry);
+			schedulerQueuePush(&local->scheduling.checkQueue, entry);
+		}
+
+		task = next;
+	}
+
+	mutexRelease(&local->scheduling.wakeLock);
+}
+
+/**
+ * Calls the wait resolver of each task in the check queue. Tasks that can continue
+ * are given to the backend, the others are parked in the wait queue.
+ */
+static void schedulerCheckWaiting(g_tasking_local* local)
+{
+	g_schedule_entry* entry;
+	while((entry = local->scheduling.checkQueue.head) != 0)
+	{
+		schedulerQueueRemove(entry);
+
+		g_task* task = entry->task;
+		if(task->status == G_THREAD_STATUS_WAITING)
+		{
+			if(waitTryWake(task))
+				schedulerBackendEnqueue(local, entry);
+			else
+				schedulerQueuePush(&local->scheduling.waitQueue, entry);
+		} else
+		{
+			schedulerEnqueue(local, entry);
+		}
+	}
+}
+
+/**
+ * The current task is put back into the queue that matches its status. Waiting
+ * tasks are only checked if they were woken or their timer expired, then the backend is asked for the next task. A preferred task is taken out of its queue
+ * and run directly.
+ *
+ * If there is no runnable task, a task is stolen from another processor or the idle task is run.
+ */
+void schedulerSchedule(g_tasking_local* local)
+{
+	mutexAcquire(&local->lock);
+
+	g_task* previous = local->scheduling.current;
+	if(previous && previous != local->scheduling.idleTask && previous->scheduleEntry && previous->assignment == local)
+	{
+		schedulerEnqueue(local, previous->scheduleEntry);
+	}
+
+	waitTimerWakeExpired(local);
+	schedulerTakeWakes(local);
+	schedulerCheckWaiting(local);
+
+	g_task* next = 0;
+
+	g_task* preferred = local->scheduling.preferredNextTask;
+	local->scheduling.preferredNextTask = 0;
+	if(preferred && preferred->assignment == local && preferred->scheduleEntry && preferred->status == G_THREAD_STATUS_RUNNING)
+	{
+		schedulerRemoveEntry(local, preferred->scheduleEntry);
+		next = preferred;
+	}
+
+	bool stolen = false;
+	while(!next)
+	{
+		g_schedule_entry* entry = schedulerBackendNext(local);
+		if(!entry)
+		{
+			/* Before idling, try to take work from a busy processor */
+			if(!stolen && local->ready)
+			{
+				stolen = true;
+				if(schedulerSteal(local))
+					continue;
+			}
+			break;
+		}
+
+		/* Status may have changed while the task was queued */
+		if(entry->task->status == G_THREAD_STATUS_RUNNING)
+			next = entry->task;
+		else
+			schedulerEnqueue(local, entry);
+	}
+
+	if(next)
+	{
+		schedulerSetCurrent(local, next);
+		next->timesScheduled++;
+	} else
+	{
+		// Nothing to schedule, idle
+		schedulerSetCurrent(local, local->scheduling.idleTask);
+		schedulerEnterTickless(local);
+	}
+
+	mutexRelease(&local->lock);
+}
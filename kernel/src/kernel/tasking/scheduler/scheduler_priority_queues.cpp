@@ -0,0 +1,102 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/tasking/scheduler.hpp"
+
+/**
+ * This scheduler backend keeps one queue of runnable entries per priority level.
+ * A bit in the run queue bitmap is set for each level that has a non-empty queue,
+ * so that the highest priority level (lowest number) can be found in constant time.
+ * Within a level, tasks are scheduled round-robin.
+ */
+
+static int schedulerPriorityLevel(g_task* task)
+{
+	if(task->priority >= G_SCHEDULER_PRIORITY_LEVELS)
+		return G_SCHEDULER_PRIORITY_LEVELS - 1;
+	return task->priority;
+}
+
+void schedulerBackendInitializeLocal(g_tasking_local* local)
+{
+	for(int level = 0; level < G_SCHEDULER_PRIORITY_LEVELS; level++)
+	{
+		local->scheduling.runQueues[level].head = 0;
+		local->scheduling.runQueues[level].tail = 0;
+		local->scheduling.runQueues[level].length = 0;
+	}
+	local->scheduling.runQueueBitmap = 0;
+	local->scheduling.runnableCount = 0;
+}
+
+void schedulerBackendEnqueue(g_tasking_local* local, g_schedule_entry* entry)
+{
+	int level = schedulerPriorityLevel(entry->task);
+	schedulerQueuePush(&local->scheduling.runQueues[level], entry);
+	local->scheduling.runQueueBitmap |= (1 << level);
+	local->scheduling.runnableCount++;
+}
+
+void schedulerBackendRemove(g_tasking_local* local, g_schedule_entry* entry)
+{
+	g_schedule_queue* queue = entry->queue;
+	schedulerQueueRemove(entry);
+	local->scheduling.runnableCount--;
+
+	if(queue->length == 0)
+	{
+		int level = queue - local->scheduling.runQueues;
+		local->scheduling.runQueueBitmap &= ~(1 << level);
+	}
+}
+
+g_schedule_entry* schedulerBackendNext(g_tasking_local* local)
+{
+	uint32_t bitmap = local->scheduling.runQueueBitmap;
+	if(bitmap == 0)
+		return 0;
+
+	int level = __builtin_ctz(bitmap);
+	g_schedule_entry* entry = local->scheduling.runQueues[level].head;
+	schedulerBackendRemove(local, entry);
+	return entry;
+}
+
+g_schedule_entry* schedulerBackendTakeMigratable(g_tasking_local* local)
+{
+	/* Prefer the tasks of lowest priority that would run last */
+	for(int level = G_SCHEDULER_PRIORITY_LEVELS - 1; level >= 0; level--)
+	{
+		if(!(local->scheduling.runQueueBitmap & (1 << level)))
+			continue;
+
+		g_schedule_entry* entry = local->scheduling.runQueues[level].tail;
+		while(entry)
+		{
+			if(schedulerCanMigrate(entry->task))
+			{
+				schedulerBackendRemove(local, entry);
+				return entry;
+			}
+			entry = entry->queuePrevious;
+		}
+	}
+	return 0;
+}
@@ -29,13 +29,16 @@
 
 #include "kernel/ipc/message.hpp"
 #include "kernel/filesystem/filesystem_process.hpp"
+#include "kernel/filesystem/filesystem_taskeddelegate.hpp"
 #include "kernel/system/processor/processor.hpp"
 #include "kernel/memory/memory.hpp"
 #include "kernel/memory/lower_heap.hpp"
 #include "kernel/memory/gdt.hpp"
 #include "kernel/memory/page_reference_tracker.hpp"
+#include "kernel/memory/paging.hpp"
 #include "kernel/kernel.hpp"
 #include "shared/logger/logger.hpp"
+#include "shared/utils/string.hpp"
 #include "kernel/utils/hashmap.hpp"
 #include "kernel/system/interrupts/ivt.hpp"
 #include "kernel/memory/lower_heap.hpp"
@@ -51,6 +54,11 @@ g_tasking_local* taskingGetLocal()
 	return &taskingLocal[processorGetCurrentId()];
 }
 
+g_tasking_local* taskingGetLocalForProcessor(uint32_t processor)
+{
+	return &taskingLocal[processor];
+}
+
 g_task* taskingGetCurrentTask()
 {
 	return taskingGetLocal()->scheduling.current;
@@ -72,7 +80,8 @@ g_task* taskingGetById(g_tid id)
 void taskingInitializeBsp()
 {
 	mutexInitialize(&taskingIdLock);
-	taskingLocal = (g_tasking_local*) heapAllocate(sizeof(g_tasking_local) * processorGetNumberOfProcessors());
+	taskingMemoryInitialize();
+	taskingLocal = (g_tasking_local*) heapAllocateClear(sizeof(g_tasking_local) * processorGetNumberOfProcessors());
 	taskGlobalMap = hashmapCreateNumeric<g_tid, g_task*>(128);
 
 	taskingInitializeLocal();
@@ -89,19 +98,24 @@ void taskingInitializeLocal()
 	g_tasking_local* local = taskingGetLocal();
 	local->locksHeld = 0;
 	local->time = 0;
+	local->apicId = lapicReadId();
+	local->tlbFlushRequested = false;
 
 	local->scheduling.current = 0;
 	local->scheduling.list = 0;
 	local->scheduling.taskCount = 0;
-	local->scheduling.round = 0;
 	local->scheduling.idleTask = 0;
 	local->scheduling.preferredNextTask = 0;
+	local->syscallWorkers.pool = 0;
+	local->syscallWorkers.poolSize = 0;
 
 	mutexInitialize(&local->lock);
+	schedulerInitializeLocal();
 
 	g_process* idle = taskingCreateProcess();
 	local->scheduling.idleTask = taskingCreateThread((g_virtual_address) taskingIdleThread, idle, G_SECURITY_LEVEL_KERNEL);
 	local->scheduling.idleTask->type = G_THREAD_TYPE_VITAL;
+	local->scheduling.idleTask->priority = G_THREAD_PRIORITY_IDLE;
 	logDebug("%! core: %i idle task: %i", "tasking", processorGetCurrentId(), idle->main->id);
 
 	g_process* cleanup = taskingCreateProcess();
@@ -110,7 +124,7 @@ void taskingInitializeLocal()
 	taskingAssign(taskingGetLocal(), cleanupTask);
 	logDebug("%! core: %i cleanup task: %i", "tasking", processorGetCurrentId(), cleanup->main->id);
 
-	schedulerInitializeLocal();
+	local->ready = true;
 }
 
 void taskingApplySecurityLevel(volatile g_processor_state* state, g_security_level securityLevel)
@@ -159,8 +173,35 @@ void taskingAddToProcessTaskList(g_process* process, g_task* task)
 	{
 		process->main = task;
 		process->id = task->id;
-		filesystemProcessCreate((g_pid) task->id);
+		filesystemProcessCreate(process);
+	}
+	mutexRelease(&process->lock);
+}
+
+void taskingRemoveFromProcessTaskList(g_process* process, g_task* task)
+{
+	mutexAcquire(&process->lock);
+
+	g_task_entry* entry = process->tasks;
+	g_task_entry* previous = 0;
+	while(entry)
+	{
+		if(entry->task == task)
+		{
+			if(previous)
+			{
+				previous->next = entry->next;
+			} else
+			{
+				process->tasks = entry->next;
+			}
+			heapFree(entry);
+			break;
+		}
+		previous = entry;
+		entry = entry->next;
 	}
+
 	mutexRelease(&process->lock);
 }
 
@@ -193,6 +234,8 @@ g_task* taskingCreateThread(g_virtual_address eip, g_process* process, g_securit
 
 	taskingTemporarySwitchBack(returnDirectory);
 
+	waitQueueInitialize(&task->joinWaiters);
+
 	// Put in process task list & global map
 	taskingAddToProcessTaskList(process, task);
 	hashmapPut(taskGlobalMap, task->id, task);
@@ -241,6 +284,8 @@ g_task* taskingCreateThreadVm86(g_process* process, uint32_t intr, g_vm86_regist
 
 	taskingTemporarySwitchBack(returnDirectory);
 
+	waitQueueInitialize(&task->joinWaiters);
+
 	// Put in process task list & global map
 	taskingAddToProcessTaskList(process, task);
 	hashmapPut(taskGlobalMap, task->id, task);
@@ -249,33 +294,77 @@ g_task* taskingCreateThreadVm86(g_process* process, uint32_t intr, g_vm86_regist
 
 void taskingAssign(g_tasking_local* local, g_task* task)
 {
-	mutexAcquire(&local->lock);
-
-	bool alreadyInList = false;
-	g_schedule_entry* existing = local->scheduling.list;
-	while(existing)
+	g_tasking_local* previous = task->assignment;
+	if(previous && previous != local)
 	{
-		if(existing->task == task)
-		{
-			alreadyInList = true;
-			break;
-		}
-		existing = existing->next;
+		taskingUnassign(previous, task);
 	}
 
-	if(!alreadyInList)
+	mutexAcquire(&local->lock);
+
+	g_schedule_entry* entry = task->scheduleEntry;
+	if(!entry)
 	{
-		g_schedule_entry* newEntry = (g_schedule_entry*) heapAllocate(sizeof(g_schedule_entry));
-		newEntry->task = task;
-		newEntry->next = local->scheduling.list;
-		schedulerPrepareEntry(newEntry);
-		local->scheduling.list = newEntry;
+		entry = (g_schedule_entry*) heapAllocate(sizeof(g_schedule_entry));
+		entry->task = task;
+		entry->next = local->scheduling.list;
+		schedulerPrepareEntry(entry);
+		local->scheduling.list = entry;
+		task->scheduleEntry = entry;
 
 		local->scheduling.taskCount++;
 	}
 
 	task->assignment = local;
 
+	// The current task is enqueued when it is scheduled away
+	if(local->scheduling.current != task)
+	{
+		schedulerEnqueue(local, entry);
+	}
+
+	mutexRelease(&local->lock);
+
+	schedulerKick(local);
+}
+
+void taskingAssignBalanced(g_task* task)
+{
+	taskingAssign(schedulerGetLeastLoaded(), task);
+}
+
+void taskingUnassign(g_tasking_local* local, g_task* task)
+{
+	mutexAcquire(&local->lock);
+
+	g_schedule_entry* entry = task->scheduleEntry;
+	if(entry)
+	{
+		schedulerRemoveEntry(local, entry);
+
+		g_schedule_entry* previous = 0;
+		g_schedule_entry* listEntry = local->scheduling.list;
+		while(listEntry)
+		{
+			if(listEntry == entry)
+			{
+				if(previous)
+					previous->next = entry->next;
+				else
+					local->scheduling.list = entry->next;
+				local->scheduling.taskCount--;
+				break;
+			}
+			previous = listEntry;
+			listEntry = listEntry->next;
+		}
+
+		task->scheduleEntry = 0;
+		heapFree(entry);
+	}
+	schedulerRemoveWake(local, task);
+	task->assignment = 0;
+
 	mutexRelease(&local->lock);
 }
 
@@ -370,14 +459,90 @@ g_process* taskingCreateProcess()
 	process->heap.brk = 0;
 	process->heap.start = 0;
 	process->heap.pages = 0;
+	process->lazyAreas = 0;
+	process->filesystem = 0;
 
 	process->environment.arguments = 0;
 	process->environment.executablePath = 0;
 	process->environment.workingDirectory = 0;
+	process->environment.workingDirectoryNode = 0;
 
 	return process;
 }
 
+g_task* taskingForkProcess(g_task* task)
+{
+	g_process* parent = task->process;
+	g_process* process = taskingCreateProcess();
+
+	mutexAcquire(&parent->lock);
+
+	addressRangePoolCloneRanges(process->virtualRangePool, parent->virtualRangePool);
+	process->tlsMaster.location = parent->tlsMaster.location;
+	process->tlsMaster.size = parent->tlsMaster.size;
+	process->tlsMaster.userThreadOffset = parent->tlsMaster.userThreadOffset;
+	process->image.start = parent->image.start;
+	process->image.end = parent->image.end;
+	process->object = parent->object;
+	process->heap.brk = parent->heap.brk;
+	process->heap.start = parent->heap.start;
+	process->heap.pages = parent->heap.pages;
+	process->userProcessInfo = parent->userProcessInfo;
+
+	for(g_lazy_area* area = parent->lazyAreas; area; area = area->next)
+		taskingMemoryAddLazyArea(&process->lazyAreas, area->start, area->end);
+
+	if(parent->environment.arguments)
+		process->environment.arguments = stringDuplicate(parent->environment.arguments);
+	if(parent->environment.executablePath)
+		process->environment.executablePath = stringDuplicate(parent->environment.executablePath);
+	if(parent->environment.workingDirectory)
+		process->environment.workingDirectory = stringDuplicate(parent->environment.workingDirectory);
+	process->environment.workingDirectoryNode = parent->environment.workingDirectoryNode;
+
+	pagingForkUserSpace(process->pageDirectory);
+
+	// Other threads of the parent must not keep writing to pages that are now shared
+	taskingMemoryShootdown(parent);
+
+	g_task* child = (g_task*) heapAllocateClear(sizeof(g_task));
+	child->id = process->id;
+	child->process = process;
+	child->securityLevel = task->securityLevel;
+	child->status = G_THREAD_STATUS_RUNNING;
+	child->type = task->type;
+	child->priority = task->priority;
+	child->stack.start = task->stack.start;
+	child->stack.end = task->stack.end;
+	child->tlsCopy.userThreadObject = task->tlsCopy.userThreadObject;
+	child->tlsCopy.start = task->tlsCopy.start;
+	child->tlsCopy.end = task->tlsCopy.end;
+	child->userEntry.function = task->userEntry.function;
+	child->userEntry.data = task->userEntry.data;
+
+	for(int i = 0; i < SIG_COUNT; i++)
+	{
+		process->signalHandlers[i].handlerAddress = parent->signalHandlers[i].handlerAddress;
+		process->signalHandlers[i].returnAddress = parent->signalHandlers[i].returnAddress;
+		process->signalHandlers[i].task = parent->signalHandlers[i].task == task->id ? child->id : 0;
+	}
+
+	// Resume where the forking task was interrupted
+	taskingMemoryCreateInterruptStack(child);
+	child->state = (g_processor_state*) (child->interruptStack.end - sizeof(g_processor_state));
+	memoryCopy((void*) child->state, (void*) task->state, sizeof(g_processor_state));
+
+	mutexRelease(&parent->lock);
+
+	waitQueueInitialize(&child->joinWaiters);
+
+	taskingAddToProcessTaskList(process, child);
+	hashmapPut(taskGlobalMap, child->id, child);
+
+	filesystemProcessFork(parent, process);
+	return child;
+}
+
 void taskingPrepareThreadLocalStorage(g_task* thread)
 {
 	// if tls master copy available, copy it to thread
@@ -397,7 +562,7 @@ void taskingPrepareThreadLocalStorage(g_task* thread)
 	// copy tls contents
 	for(g_virtual_address page = tlsCopyStart; page < tlsCopyEnd; page += G_PAGE_SIZE)
 	{
-		g_physical_address phys = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+		g_physical_address phys = memoryPhysicalAllocate();
 		pagingMapPage(page, phys, DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
 		pageReferenceTrackerIncrement(phys);
 	}
@@ -473,6 +638,10 @@ void taskingCleanupThread()
 			g_schedule_entry* next = entry->next;
 			if(entry->task->status == G_THREAD_STATUS_DEAD)
 			{
+				schedulerRemoveEntry(local, entry);
+				schedulerRemoveWake(local, entry->task);
+				local->scheduling.taskCount--;
+
 				if(previous)
 					previous->next = next;
 				else
@@ -524,7 +693,7 @@ void taskingRemoveThread(g_task* task)
 			if(pagePhys > 0)
 			{
 				if(pageReferenceTrackerDecrement(pagePhys) == 0)
-					bitmapPageAllocatorMarkFree(&memoryPhysicalAllocator, pagePhys);
+					memoryPhysicalFree(pagePhys);
 				pagingUnmapPage(page);
 			}
 		}
@@ -535,9 +704,10 @@ void taskingRemoveThread(g_task* task)
 		g_physical_address pagePhys = pagingVirtualToPhysical(page);
 		if(pagePhys > 0)
 		{
-			if(pageReferenceTrackerDecrement(pagePhys) == 0)
-				bitmapPageAllocatorMarkFree(&memoryPhysicalAllocator, pagePhys);
+			// Unmap first, a table that is shared copy-on-write is copied before
 			pagingUnmapPage(page);
+			if(pageReferenceTrackerDecrement(pagePhys) == 0)
+				memoryPhysicalFree(pagePhys);
 		}
 	}
 
@@ -563,9 +733,9 @@ void taskingRemoveThread(g_task* task)
 			g_physical_address pagePhys = pagingVirtualToPhysical(page);
 			if(pagePhys > 0)
 			{
-				if(pageReferenceTrackerDecrement(pagePhys) == 0)
-					bitmapPageAllocatorMarkFree(&memoryPhysicalAllocator, pagePhys);
 				pagingUnmapPage(page);
+				if(pageReferenceTrackerDecrement(pagePhys) == 0)
+					memoryPhysicalFree(pagePhys);
 			}
 		}
 		addressRangePoolFree(task->process->virtualRangePool, task->tlsCopy.start);
@@ -574,29 +744,7 @@ void taskingRemoveThread(g_task* task)
 	taskingTemporarySwitchBack(returnDirectory);
 
 	/* Remove self from process */
-	mutexAcquire(&task->process->lock);
-
-	g_task_entry* entry = task->process->tasks;
-	g_task_entry* previous = 0;
-	while(entry)
-	{
-		if(entry->task == task)
-		{
-			if(previous)
-			{
-				previous->next = entry->next;
-			} else
-			{
-				task->process->tasks = entry->next;
-			}
-			heapFree(entry);
-			break;
-		}
-		previous = entry;
-		entry = entry->next;
-	}
-
-	mutexRelease(&task->process->lock);
+	taskingRemoveFromProcessTaskList(task->process, task);
 
 	/* Kill process if necessary */
 	if(task->process->tasks == 0)
@@ -610,6 +758,7 @@ void taskingRemoveThread(g_task* task)
 
 	/* Finalize freeing */
 	hashmapRemove(taskGlobalMap, task->id);
+	waitQueueWake(&task->joinWaiters);
 	if(task->vm86Data) heapFree(task->vm86Data);
 	heapFree(task);
 }
@@ -629,6 +778,7 @@ void taskingKillProcess(g_pid pid)
 	while(entry)
 	{
 		entry->task->status = G_THREAD_STATUS_DEAD;
+		schedulerWake(entry->task);
 		entry = entry->next;
 	}
 
@@ -637,9 +787,11 @@ void taskingKillProcess(g_pid pid)
 
 void taskingRemoveProcess(g_process* process)
 {
+	filesystemTaskedDelegateProcessRemoved(process);
+
 	mutexAcquire(&process->lock);
 
-	filesystemProcessRemove(process->id);
+	filesystemProcessRemove(process);
 
 	g_physical_address returnDirectory = taskingTemporarySwitchToSpace(process->pageDirectory);
 
@@ -649,6 +801,11 @@ void taskingRemoveProcess(g_process* process)
 	{
 		if((directoryCurrent[ti] & G_PAGE_ALIGN_MASK) & G_PAGE_TABLE_USERSPACE)
 		{
+			// Tables shared after a fork keep their pages while others still use them
+			g_physical_address tablePhys = directoryCurrent[ti] & ~G_PAGE_ALIGN_MASK;
+			if((directoryCurrent[ti] & G_PAGE_TABLE_COPY_ON_WRITE) && pageReferenceTrackerDecrement(tablePhys) > 0)
+				continue;
+
 			g_page_table table = ((g_page_table) G_CONST_RECURSIVE_PAGE_DIRECTORY_AREA) + (0x400 * ti);
 			for(uint32_t pi = 0; pi < 1024; pi++)
 			{
@@ -659,7 +816,7 @@ void taskingRemoveProcess(g_process* process)
 					int rem = pageReferenceTrackerDecrement(page);
 					if(rem == 0)
 					{
-						bitmapPageAllocatorMarkFree(&memoryPhysicalAllocator, page);
+						memoryPhysicalFree(page);
 					}
 				}
 			}
@@ -669,8 +826,10 @@ void taskingRemoveProcess(g_process* process)
 	taskingTemporarySwitchBack(returnDirectory);
 	mutexRelease(&process->lock);
 
+	addressRangePoolReleaseRanges(process->virtualRangePool);
 	heapFree(process->virtualRangePool);
-	bitmapPageAllocatorMarkFree(&memoryPhysicalAllocator, process->pageDirectory);
+	taskingMemoryReleaseLazyAreas(process->lazyAreas);
+	memoryPhysicalFree(process->pageDirectory);
 	heapFree(process);
 }
 
@@ -758,6 +917,7 @@ void taskingInterruptTask(g_task* task, g_virtual_address entry, g_virtual_addre
 	task->waitData = 0;
 	task->waitResolver = 0;
 	task->status = G_THREAD_STATUS_RUNNING;
+	schedulerWake(task);
 
 	// Save processor state
 	memoryCopy(&task->interruptionInfo->state, task->state, sizeof(g_processor_state));
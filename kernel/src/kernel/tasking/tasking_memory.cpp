@@ -21,8 +21,21 @@
 #include "kernel/tasking/tasking_memory.hpp"
 #include "kernel/memory/memory.hpp"
 #include "kernel/memory/page_reference_tracker.hpp"
+#include "kernel/system/interrupts/lapic.hpp"
 #include "shared/logger/logger.hpp"
 
+/**
+ * Only one shootdown is done at a time, each requested processor decrements the
+ * pending count once it has flushed.
+ */
+static g_mutex taskingMemoryShootdownLock;
+static volatile uint32_t taskingMemoryShootdownPending = 0;
+
+void taskingMemoryInitialize()
+{
+	mutexInitialize(&taskingMemoryShootdownLock);
+}
+
 bool taskingMemoryExtendHeap(g_task* task, int32_t amount, uint32_t* outAddress)
 {
 	g_process* process = task->process;
@@ -34,10 +47,6 @@ bool taskingMemoryExtendHeap(g_task* task, int32_t amount, uint32_t* outAddress)
 	{
 		g_virtual_address heapStart = process->image.end;
 
-		g_physical_address phys = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
-		pagingMapPage(heapStart, phys, DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
-		pageReferenceTrackerIncrement(phys);
-
 		process->heap.brk = heapStart;
 		process->heap.start = heapStart;
 		process->heap.pages = 1;
@@ -56,28 +65,36 @@ bool taskingMemoryExtendHeap(g_task* task, int32_t amount, uint32_t* outAddress)
 
 	} else
 	{
-		// expand if necessary
-		g_virtual_address virt_above;
-		while(newBrk > (virt_above = process->heap.start + process->heap.pages * G_PAGE_SIZE))
+		// expand if necessary, pages are mapped once accessed
+		while(newBrk > process->heap.start + process->heap.pages * G_PAGE_SIZE)
 		{
-			g_physical_address phys = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
-			pagingMapPage(virt_above, phys, DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
-			pageReferenceTrackerIncrement(phys);
 			++process->heap.pages;
 		}
 
-		// shrink if possible
+		// shrink if possible, freed pages are given back in batches
+		g_physical_address freed[G_PHYSICAL_PAGE_CACHE_BATCH];
+		uint32_t freedCount = 0;
 		g_virtual_address virtAligned;
 		while(newBrk < (virtAligned = process->heap.start + process->heap.pages * G_PAGE_SIZE - G_PAGE_SIZE))
 		{
 			g_physical_address phys = pagingVirtualToPhysical(virtAligned);
-			pagingUnmapPage(virtAligned);
-			if(pageReferenceTrackerDecrement(phys) == 0)
+			if(phys)
 			{
-				bitmapPageAllocatorMarkFree(&memoryPhysicalAllocator, phys);
+				pagingUnmapPage(virtAligned);
+				if(pageReferenceTrackerDecrement(phys) == 0)
+				{
+					freed[freedCount++] = phys;
+					if(freedCount == G_PHYSICAL_PAGE_CACHE_BATCH)
+					{
+						memoryPhysicalFreeMultiple(freed, freedCount);
+						freedCount = 0;
+					}
+				}
 			}
 			--process->heap.pages;
 		}
+		if(freedCount > 0)
+			memoryPhysicalFreeMultiple(freed, freedCount);
 
 		process->heap.brk = newBrk;
 		*outAddress = oldBrk;
@@ -89,10 +106,146 @@ bool taskingMemoryExtendHeap(g_task* task, int32_t amount, uint32_t* outAddress)
 	return success;
 }
 
+/**
+ * Maps zeroed pages to the given area in the current address space. The physical
+ * pages are allocated at once, at most {G_TASKING_MEMORY_LAZY_CLUSTER_PAGES}.
+ *
+ * @return the number of pages that were mapped
+ */
+static uint32_t taskingMemoryMapZeroedPages(g_virtual_address start, uint32_t pages)
+{
+	if(pages > G_TASKING_MEMORY_LAZY_CLUSTER_PAGES)
+		pages = G_TASKING_MEMORY_LAZY_CLUSTER_PAGES;
+
+	g_physical_address physical[G_TASKING_MEMORY_LAZY_CLUSTER_PAGES];
+	uint32_t allocated = memoryPhysicalAllocateMultiple(physical, pages);
+	for(uint32_t i = 0; i < allocated; i++)
+	{
+		g_virtual_address virtPage = start + i * G_PAGE_SIZE;
+		pagingMapPage(virtPage, physical[i], DEFAULT_USER_TABLE_FLAGS, DEFAULT_USER_PAGE_FLAGS);
+		pageReferenceTrackerIncrement(physical[i]);
+		memorySetBytes((void*) virtPage, 0, G_PAGE_SIZE);
+	}
+	return allocated;
+}
+
+/**
+ * Maps a zeroed page to the given address in the current address space.
+ */
+static bool taskingMemoryMapZeroedPage(g_virtual_address virtPage)
+{
+	return taskingMemoryMapZeroedPages(virtPage, 1) == 1;
+}
+
+static g_lazy_area* taskingMemoryFindLazyArea(g_lazy_area* areas, g_virtual_address address)
+{
+	for(g_lazy_area* area = areas; area; area = area->next)
+	{
+		if(address >= area->start && address < area->end)
+			return area;
+	}
+	return 0;
+}
+
+/**
+ * Returns the end of the reserved but lazily mapped region that contains the
+ * page, or 0 if the page is not part of such a region.
+ */
+static g_virtual_address taskingMemoryGetLazyEnd(g_process* process, g_virtual_address virtPage)
+{
+	g_virtual_address heapEnd = process->heap.start + process->heap.pages * G_PAGE_SIZE;
+	if(virtPage >= process->heap.start && virtPage < heapEnd)
+		return heapEnd;
+
+	g_address_range* range = addressRangePoolFindContaining(process->virtualRangePool, virtPage);
+	if(range && range->used && (range->flags & G_PROC_VIRTUAL_RANGE_FLAG_LAZY))
+		return range->base + range->pages * G_PAGE_SIZE;
+
+	g_lazy_area* area = taskingMemoryFindLazyArea(process->lazyAreas, virtPage);
+	if(area)
+		return G_PAGE_ALIGN_UP(area->end);
+
+	return 0;
+}
+
+bool taskingMemoryResolveLazyPage(g_process* process, g_virtual_address virtPage, uint32_t clusterPages)
+{
+	mutexAcquire(&process->lock);
+
+	bool resolved = false;
+	g_virtual_address end = taskingMemoryGetLazyEnd(process, virtPage);
+	if(end)
+	{
+		if(pagingVirtualToPhysical(virtPage))
+		{
+			// another thread was faster
+			resolved = true;
+		}
+		else
+		{
+			// The unmapped pages that follow in the cluster are allocated together
+			g_virtual_address clusterEnd = virtPage + clusterPages * G_PAGE_SIZE;
+			if(clusterEnd > end)
+				clusterEnd = end;
+
+			uint32_t pages = 1;
+			while(virtPage + pages * G_PAGE_SIZE < clusterEnd && !pagingVirtualToPhysical(virtPage + pages * G_PAGE_SIZE))
+				pages++;
+
+			resolved = taskingMemoryMapZeroedPages(virtPage, pages) > 0;
+		}
+
+		if(!resolved)
+		{
+			logInfo("%! out of physical memory when resolving lazy page %h in process %i", "memory", virtPage, process->id);
+		}
+	}
+
+	mutexRelease(&process->lock);
+	return resolved;
+}
+
+void taskingMemoryResolveLazyRange(g_process* process, g_virtual_address start, g_virtual_address end)
+{
+	for(g_virtual_address virt = G_PAGE_ALIGN_DOWN(start); virt < end; virt += G_PAGE_SIZE)
+	{
+		if(!pagingVirtualToPhysical(virt))
+			taskingMemoryResolveLazyPage(process, virt, 1);
+	}
+}
+
+void taskingMemoryAddLazyArea(g_lazy_area** areas, g_virtual_address start, g_virtual_address end)
+{
+	g_lazy_area* area = (g_lazy_area*) heapAllocate(sizeof(g_lazy_area));
+	area->start = start;
+	area->end = end;
+	area->next = *areas;
+	*areas = area;
+}
+
+void taskingMemoryResolveLazyAreas(g_lazy_area* areas, g_virtual_address start, g_virtual_address end)
+{
+	for(g_virtual_address virt = G_PAGE_ALIGN_DOWN(start); virt < end; virt += G_PAGE_SIZE)
+	{
+		if(taskingMemoryFindLazyArea(areas, virt) && !pagingVirtualToPhysical(virt))
+			taskingMemoryMapZeroedPage(virt);
+	}
+}
+
+void taskingMemoryReleaseLazyAreas(g_lazy_area* areas)
+{
+	while(areas)
+	{
+		g_lazy_area* next = areas->next;
+		heapFree(areas);
+		areas = next;
+	}
+}
+
 void taskingMemoryCreateInterruptStack(g_task* task)
 {
 	// Interrupt stack
-	g_physical_address intPhys = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+	g_physical_address intPhys = memoryPhysicalAllocate();
 	g_virtual_address intVirt = addressRangePoolAllocate(memoryVirtualRangePool, 1);
 	pagingMapPage(intVirt, intPhys, DEFAULT_KERNEL_TABLE_FLAGS, DEFAULT_KERNEL_PAGE_FLAGS);
 	pageReferenceTrackerIncrement(intPhys);
@@ -132,7 +285,7 @@ void taskingMemoryCreateStacks(g_task* task)
 
 	/* Here we reserve a virtual address range for the stack and allocate a physical page
 	only as the last page of our range. When the process faults, the stack is filled up. */
-	g_physical_address pagePhys = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+	g_physical_address pagePhys = memoryPhysicalAllocate();
 	pageReferenceTrackerIncrement(pagePhys);
 
 	task->stack.start = stackVirt;
@@ -147,7 +300,7 @@ g_physical_address taskingMemoryCreatePageDirectory()
 {
 	g_page_directory directoryCurrent = (g_page_directory) G_CONST_RECURSIVE_PAGE_DIRECTORY_ADDRESS;
 
-	g_physical_address directoryPhys = bitmapPageAllocatorAllocate(&memoryPhysicalAllocator);
+	g_physical_address directoryPhys = memoryPhysicalAllocate();
 	g_virtual_address directoryTempVirt = addressRangePoolAllocate(memoryVirtualRangePool, 1);
 	g_page_directory directoryTemp = (g_page_directory) directoryTempVirt;
 	pagingMapPage(directoryTempVirt, directoryPhys);
@@ -171,3 +324,55 @@ g_physical_address taskingMemoryCreatePageDirectory()
 	return directoryPhys;
 }
 
+
+/**
+ * @return whether another processor currently runs a task of the process
+ */
+static bool taskingMemoryRunsOnOther(g_tasking_local* local, g_process* process)
+{
+	if(!local->ready || local == taskingGetLocal())
+		return false;
+
+	g_task* current = local->scheduling.current;
+	return current && current->process == process;
+}
+
+void taskingMemoryShootdown(g_process* process)
+{
+	/* A processor that switches to the process afterwards loads the changed entries
+	with its page directory, so the changes must be visible before looking at others. */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	uint16_t processors = processorGetNumberOfProcessors();
+	bool required = false;
+	for(uint32_t processor = 0; processor < processors && !required; processor++)
+		required = taskingMemoryRunsOnOther(taskingGetLocalForProcessor(processor), process);
+	if(!required)
+		return;
+
+	mutexAcquire(&taskingMemoryShootdownLock);
+	for(uint32_t processor = 0; processor < processors; processor++)
+	{
+		g_tasking_local* local = taskingGetLocalForProcessor(processor);
+		if(!taskingMemoryRunsOnOther(local, process))
+			continue;
+
+		__atomic_add_fetch(&taskingMemoryShootdownPending, 1, __ATOMIC_SEQ_CST);
+		__atomic_store_n(&local->tlbFlushRequested, true, __ATOMIC_SEQ_CST);
+		lapicSendIpi(local->apicId, APIC_TLB_SHOOTDOWN_VECTOR);
+	}
+
+	while(__atomic_load_n(&taskingMemoryShootdownPending, __ATOMIC_SEQ_CST) > 0)
+		asm("pause");
+	mutexRelease(&taskingMemoryShootdownLock);
+}
+
+void taskingMemoryHandleShootdown()
+{
+	g_tasking_local* local = taskingGetLocal();
+	if(!__atomic_exchange_n(&local->tlbFlushRequested, false, __ATOMIC_SEQ_CST))
+		return;
+
+	pagingSwitchToSpace(pagingGetCurrentSpace());
+	__atomic_sub_fetch(&taskingMemoryShootdownPending, 1, __ATOMIC_SEQ_CST);
+}
@@ -18,8 +18,11 @@
  *                                                                           *
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
+#include "ghost/calls/calls.h"
+
 #include "kernel/tasking/wait.hpp"
 #include "kernel/tasking/wait_resolver.hpp"
+#include "kernel/tasking/wait_timer.hpp"
 
 #include "kernel/memory/heap.hpp"
 #include "shared/logger/logger.hpp"
@@ -49,6 +52,16 @@ bool waitTryWake(g_task* task)
 	return wake;
 }
 
+/**
+ * Adds a timer for a wait with a timeout. Timeouts that exceed the range of the
+ * processor time are only detected when the task is checked for other reasons.
+ */
+static void waitAddTimeout(g_task* task, uint32_t startTime, uint64_t timeout)
+{
+	if(timeout < 0x80000000)
+		waitTimerAdd(task, startTime + (uint32_t) timeout);
+}
+
 void waitSleep(g_task* task, uint64_t milliseconds)
 {
 	mutexAcquire(&task->process->lock);
@@ -60,6 +73,8 @@ void waitSleep(g_task* task, uint64_t milliseconds)
 	task->status = G_THREAD_STATUS_WAITING;
 
 	mutexRelease(&task->process->lock);
+
+	waitTimerAdd(task, waitData->wakeTime);
 }
 
 void waitAtomicLock(g_task* task)
@@ -73,6 +88,10 @@ void waitAtomicLock(g_task* task)
 	task->status = G_THREAD_STATUS_WAITING;
 
 	mutexRelease(&task->process->lock);
+
+	g_syscall_atomic_lock* data = (g_syscall_atomic_lock*) task->syscall.data;
+	if(data->has_timeout)
+		waitAddTimeout(task, waitData->startTime, data->timeout);
 }
 
 void waitForFile(g_task* task, g_fs_node* file, bool (*waitResolverFromDelegate)(g_task*))
@@ -117,11 +136,83 @@ void waitForMessageReceive(g_task* task)
 {
 	mutexAcquire(&task->process->lock);
 
-	task->waitData = 0;
+	g_wait_resolver_receive_message_data* waitData = (g_wait_resolver_receive_message_data*) heapAllocate(sizeof(g_wait_resolver_receive_message_data));
+	waitData->startTime = taskingGetLocal()->time;
+	task->waitData = waitData;
 	task->waitResolver = waitResolverReceiveMessage;
 	task->status = G_THREAD_STATUS_WAITING;
 
 	mutexRelease(&task->process->lock);
+
+	g_syscall_receive_message* data = (g_syscall_receive_message*) task->syscall.data;
+	if(data->has_timeout)
+		waitAddTimeout(task, waitData->startTime, data->timeout);
+}
+
+void waitForChannel(g_task* task)
+{
+	mutexAcquire(&task->process->lock);
+
+	g_wait_resolver_channel_data* waitData = (g_wait_resolver_channel_data*) heapAllocate(sizeof(g_wait_resolver_channel_data));
+	waitData->startTime = taskingGetLocal()->time;
+	task->waitData = waitData;
+	task->waitResolver = waitResolverChannel;
+	task->status = G_THREAD_STATUS_WAITING;
+
+	mutexRelease(&task->process->lock);
+
+	g_syscall_channel_wait* data = (g_syscall_channel_wait*) task->syscall.data;
+	if(data->has_timeout)
+		waitAddTimeout(task, waitData->startTime, data->timeout);
+}
+
+void waitForFutex(g_task* task)
+{
+	mutexAcquire(&task->process->lock);
+
+	g_wait_resolver_futex_data* waitData = (g_wait_resolver_futex_data*) heapAllocate(sizeof(g_wait_resolver_futex_data));
+	waitData->startTime = taskingGetLocal()->time;
+	task->waitData = waitData;
+	task->waitResolver = waitResolverFutex;
+	task->status = G_THREAD_STATUS_WAITING;
+
+	mutexRelease(&task->process->lock);
+
+	g_syscall_futex_wait* data = (g_syscall_futex_wait*) task->syscall.data;
+	if(data->has_timeout)
+		waitAddTimeout(task, waitData->startTime, data->timeout);
+}
+
+void waitForTaskedDelegate(g_task* task, volatile uint32_t* word, g_physical_address physicalWord, uint32_t seen, g_pid delegateProcess)
+{
+	mutexAcquire(&task->process->lock);
+
+	g_wait_resolver_tasked_delegate_data* waitData = (g_wait_resolver_tasked_delegate_data*) heapAllocate(sizeof(g_wait_resolver_tasked_delegate_data));
+	waitData->word = word;
+	waitData->physicalWord = physicalWord;
+	waitData->seen = seen;
+	waitData->delegateProcess = delegateProcess;
+	task->waitData = waitData;
+	task->waitResolver = waitResolverTaskedDelegate;
+	task->status = G_THREAD_STATUS_WAITING;
+
+	mutexRelease(&task->process->lock);
+}
+
+void waitForSyscallRing(g_task* task, g_syscall_ring* ring, g_physical_address physicalSubmitted, uint32_t seen, g_tid owner)
+{
+	mutexAcquire(&task->process->lock);
+
+	g_wait_resolver_syscall_ring_data* waitData = (g_wait_resolver_syscall_ring_data*) heapAllocate(sizeof(g_wait_resolver_syscall_ring_data));
+	waitData->ring = ring;
+	waitData->physicalSubmitted = physicalSubmitted;
+	waitData->seen = seen;
+	waitData->owner = owner;
+	task->waitData = waitData;
+	task->waitResolver = waitResolverSyscallRing;
+	task->status = G_THREAD_STATUS_WAITING;
+
+	mutexRelease(&task->process->lock);
 }
 
 void waitForVm86(g_task* task, g_task* vm86Task, g_vm86_registers* registerStore)
@@ -0,0 +1,74 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/tasking/wait_queue.hpp"
+#include "kernel/tasking/scheduler.hpp"
+#include "kernel/memory/heap.hpp"
+
+void waitQueueInitialize(g_wait_queue* queue)
+{
+	mutexInitialize(&queue->lock);
+	queue->head = 0;
+}
+
+void waitQueueAdd(g_wait_queue* queue, g_tid task)
+{
+	mutexAcquire(&queue->lock);
+
+	g_wait_queue_entry* entry = queue->head;
+	while(entry)
+	{
+		if(entry->task == task)
+		{
+			mutexRelease(&queue->lock);
+			return;
+		}
+		entry = entry->next;
+	}
+
+	entry = (g_wait_queue_entry*) heapAllocate(sizeof(g_wait_queue_entry));
+	entry->task = task;
+	entry->next = queue->head;
+	queue->head = entry;
+
+	mutexRelease(&queue->lock);
+}
+
+void waitQueueWake(g_wait_queue* queue)
+{
+	/* The list is taken out of the queue first, so that no other lock is
+	acquired while holding the lock of the queue. */
+	mutexAcquire(&queue->lock);
+	g_wait_queue_entry* entry = queue->head;
+	queue->head = 0;
+	mutexRelease(&queue->lock);
+
+	while(entry)
+	{
+		g_wait_queue_entry* next = entry->next;
+
+		g_task* task = taskingGetById(entry->task);
+		if(task)
+			schedulerWake(task);
+
+		heapFree(entry);
+		entry = next;
+	}
+}
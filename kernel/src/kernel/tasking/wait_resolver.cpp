@@ -24,12 +24,15 @@
 #include "kernel/memory/heap.hpp"
 #include "shared/logger/logger.hpp"
 #include "kernel/ipc/message.hpp"
+#include "kernel/ipc/channel.hpp"
+#include "kernel/tasking/futex.hpp"
+#include "kernel/tasking/scheduler.hpp"
 
 
 bool waitResolverSleep(g_task* task)
 {
 	g_wait_resolver_sleep_data* waitData = (g_wait_resolver_sleep_data*) task->waitData;
-	return taskingGetLocal()->time > waitData->wakeTime;
+	return (int32_t) (taskingGetLocal()->time - waitData->wakeTime) >= 0;
 }
 
 bool waitResolverAtomicLock(g_task* task)
@@ -38,7 +41,7 @@ bool waitResolverAtomicLock(g_task* task)
 	g_syscall_atomic_lock* data = (g_syscall_atomic_lock*) task->syscall.data;
 
 	// check timeout
-	if (data->has_timeout && (taskingGetLocal()->time - waitData->startTime > data->timeout)) {
+	if (data->has_timeout && (taskingGetLocal()->time - waitData->startTime >= data->timeout)) {
 		data->timed_out = true;
 		return true;
 	}
@@ -46,7 +49,12 @@ bool waitResolverAtomicLock(g_task* task)
 	// once waiting is finished, set the atom if required
 	bool keep_wait = *data->atom_1 && (!data->atom_2 || *data->atom_2);
 
-	if (!keep_wait && data->set_on_finish) {
+	// single atoms are also taken in userspace, so they must be set atomically
+	if (!keep_wait && data->set_on_finish && !data->atom_2) {
+		keep_wait = !__sync_bool_compare_and_swap(data->atom_1, 0, 1);
+		data->was_set = !keep_wait;
+
+	} else if (!keep_wait && data->set_on_finish) {
 		*data->atom_1 = true;
 		if (data->atom_2) {
 			*data->atom_2 = true;
@@ -54,6 +62,10 @@ bool waitResolverAtomicLock(g_task* task)
 		data->was_set = true;
 	}
 
+	// atoms are released in userspace, so there is no event to wake on
+	if(keep_wait)
+		schedulerPollWaiting(task);
+
 	return !keep_wait;
 }
 
@@ -69,6 +81,7 @@ bool waitResolverJoin(g_task* task)
 		return true;
 	}
 
+	waitQueueAdd(&otherTask->joinWaiters, task->id);
 	return false;
 }
 
@@ -76,7 +89,11 @@ bool waitResolverSendMessage(g_task* task)
 {
 	g_syscall_send_message* data = (g_syscall_send_message*) task->syscall.data;
 
-	data->status = messageSend(task->id, data->receiver, data->buffer, data->length, data->transaction);
+	// register before trying, so that space freed meanwhile is not missed
+	messageWaitForSend(data->receiver, task->id);
+
+	data->status = messageSend(task->id, data->receiver, data->buffer, data->length, data->transaction, data->transfer, data->transferLength,
+			data->transferMode);
 	if(data->status == G_MESSAGE_SEND_STATUS_QUEUE_FULL)
 	{
 		return false;
@@ -86,6 +103,7 @@ bool waitResolverSendMessage(g_task* task)
 
 bool waitResolverReceiveMessage(g_task* task)
 {
+	g_wait_resolver_receive_message_data* waitData = (g_wait_resolver_receive_message_data*) task->waitData;
 	g_syscall_receive_message* data = (g_syscall_receive_message*) task->syscall.data;
 
 	if(data->break_condition && *data->break_condition)
@@ -94,14 +112,112 @@ bool waitResolverReceiveMessage(g_task* task)
 		return true;
 	}
 
+	// register before trying, so that a message sent meanwhile is not missed
+	messageWaitForReceive(task->id);
+	if(data->break_condition)
+		schedulerPollWaiting(task);
+
 	data->status = messageReceive(task->id, data->buffer, data->maximum, data->transaction);
 	if(data->status == G_MESSAGE_RECEIVE_STATUS_QUEUE_EMPTY)
 	{
+		if(data->has_timeout && (taskingGetLocal()->time - waitData->startTime >= data->timeout))
+		{
+			data->status = G_MESSAGE_RECEIVE_STATUS_TIMED_OUT;
+			return true;
+		}
 		return false;
 	}
 	return true;
 }
 
+bool waitResolverChannel(g_task* task)
+{
+	g_wait_resolver_channel_data* waitData = (g_wait_resolver_channel_data*) task->waitData;
+	g_syscall_channel_wait* data = (g_syscall_channel_wait*) task->syscall.data;
+
+	g_physical_address word = channelGetWordAddress(task->process, data->address);
+	if(!word)
+	{
+		data->status = G_CHANNEL_WAIT_STATUS_INVALID;
+		return true;
+	}
+
+	// register before checking, so that a wake meanwhile is not missed
+	waitQueueAdd(channelGetWaitQueue(word), task->id);
+
+	if(*data->address != data->expected)
+	{
+		data->status = G_CHANNEL_WAIT_STATUS_WOKEN;
+		return true;
+	}
+
+	if(data->has_timeout && (taskingGetLocal()->time - waitData->startTime >= data->timeout))
+	{
+		data->status = G_CHANNEL_WAIT_STATUS_TIMED_OUT;
+		return true;
+	}
+	return false;
+}
+
+bool waitResolverFutex(g_task* task)
+{
+	g_wait_resolver_futex_data* waitData = (g_wait_resolver_futex_data*) task->waitData;
+	g_syscall_futex_wait* data = (g_syscall_futex_wait*) task->syscall.data;
+
+	// the waker removes the task from the futex queue
+	if(data->has_timeout && (taskingGetLocal()->time - waitData->startTime >= data->timeout))
+	{
+		data->status = futexDequeue(task, data->address) ? G_FUTEX_WAIT_STATUS_TIMED_OUT : G_FUTEX_WAIT_STATUS_WOKEN;
+		return true;
+	}
+
+	if(futexIsQueued(task, data->address))
+		return false;
+
+	data->status = G_FUTEX_WAIT_STATUS_WOKEN;
+	return true;
+}
+
+bool waitResolverTaskedDelegate(g_task* task)
+{
+	g_wait_resolver_tasked_delegate_data* waitData = (g_wait_resolver_tasked_delegate_data*) task->waitData;
+
+	// register before checking, so that a wake meanwhile is not missed
+	waitQueueAdd(channelGetWaitQueue(waitData->physicalWord), task->id);
+	if(*waitData->word != waitData->seen)
+		return true;
+
+	// A delegate that has exited will never answer
+	g_task* delegateTask = taskingGetById(waitData->delegateProcess);
+	if(delegateTask == 0 || delegateTask->status == G_THREAD_STATUS_DEAD || delegateTask->status == G_THREAD_STATUS_UNUSED)
+		return true;
+
+	waitQueueAdd(&delegateTask->joinWaiters, task->id);
+	return false;
+}
+
+bool waitResolverSyscallRing(g_task* task)
+{
+	g_wait_resolver_syscall_ring_data* waitData = (g_wait_resolver_syscall_ring_data*) task->waitData;
+
+	// The worker must look at the ring again if its memory was unmapped
+	g_syscall_ring* ring = waitData->ring;
+	if(channelGetWordAddress(task->process, &ring->submitted) != waitData->physicalSubmitted)
+		return true;
+
+	// register before checking, so that a wake meanwhile is not missed
+	waitQueueAdd(channelGetWaitQueue(waitData->physicalSubmitted), task->id);
+	if(ring->submitted != waitData->seen || !ring->draining)
+		return true;
+
+	g_task* owner = taskingGetById(waitData->owner);
+	if(owner == 0 || owner->status == G_THREAD_STATUS_DEAD || owner->status == G_THREAD_STATUS_UNUSED)
+		return true;
+
+	waitQueueAdd(&owner->joinWaiters, task->id);
+	return false;
+}
+
 bool waitResolverVm86(g_task* task)
 {
 	g_wait_vm86_data* waitData = (g_wait_vm86_data*) task->waitData;
@@ -120,5 +236,6 @@ bool waitResolverVm86(g_task* task)
 	}
 
 	/* VM86 task still working */
+	waitQueueAdd(&vm86Task->joinWaiters, task->id);
 	return false;
 }
@@ -0,0 +1,119 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "kernel/tasking/wait_timer.hpp"
+#include "kernel/tasking/scheduler.hpp"
+#include "kernel/memory/heap.hpp"
+#include "kernel/memory/memory.hpp"
+
+/**
+ * The timers are kept in a binary min-heap ordered by their expiry time, so that
+ * only the expired timers must be looked at on each schedule.
+ */
+#define G_WAIT_TIMER_INITIAL_CAPACITY	32
+
+/**
+ * Compares two times, taking a wrap-around of the processor time into account.
+ */
+static bool waitTimerBefore(uint32_t a, uint32_t b)
+{
+	return (int32_t) (a - b) < 0;
+}
+
+void waitTimerInitializeLocal(g_tasking_local* local)
+{
+	local->timers.heap = (g_wait_timer*) heapAllocate(sizeof(g_wait_timer) * G_WAIT_TIMER_INITIAL_CAPACITY);
+	local->timers.capacity = G_WAIT_TIMER_INITIAL_CAPACITY;
+	local->timers.count = 0;
+}
+
+void waitTimerAdd(g_task* task, uint32_t time)
+{
+	g_tasking_local* local = task->assignment ? task->assignment : taskingGetLocal();
+	mutexAcquire(&local->lock);
+
+	if(local->timers.count == local->timers.capacity)
+	{
+		int capacity = local->timers.capacity * 2;
+		g_wait_timer* heap = (g_wait_timer*) heapAllocate(sizeof(g_wait_timer) * capacity);
+		memoryCopy(heap, local->timers.heap, sizeof(g_wait_timer) * local->timers.count);
+		heapFree(local->timers.heap);
+		local->timers.heap = heap;
+		local->timers.capacity = capacity;
+	}
+
+	g_wait_timer* heap = local->timers.heap;
+	int index = local->timers.count++;
+	while(index > 0)
+	{
+		int parent = (index - 1) / 2;
+		if(!waitTimerBefore(time, heap[parent].time))
+			break;
+
+		heap[index] = heap[parent];
+		index = parent;
+	}
+	heap[index].time = time;
+	heap[index].task = task->id;
+
+	mutexRelease(&local->lock);
+}
+
+/**
+ * Removes the first timer from the heap.
+ */
+static void waitTimerRemoveFirst(g_tasking_local* local)
+{
+	g_wait_timer* heap = local->timers.heap;
+	g_wait_timer last = heap[--local->timers.count];
+	int count = local->timers.count;
+
+	int index = 0;
+	for(;;)
+	{
+		int child = index * 2 + 1;
+		if(child >= count)
+			break;
+
+		if(child + 1 < count && waitTimerBefore(heap[child + 1].time, heap[child].time))
+			child++;
+
+		if(!waitTimerBefore(heap[child].time, last.time))
+			break;
+
+		heap[index] = heap[child];
+		index = child;
+	}
+	heap[index] = last;
+}
+
+void waitTimerWakeExpired(g_tasking_local* local)
+{
+	while(local->timers.count > 0 && !waitTimerBefore(local->time, local->timers.heap[0].time))
+	{
+		g_tid taskId = local->timers.heap[0].task;
+		waitTimerRemoveFirst(local);
+
+		/* The task might have stopped waiting meanwhile, then the wake is ignored */
+		g_task* task = taskingGetById(taskId);
+		if(task && task->status == G_THREAD_STATUS_WAITING)
+			schedulerWake(task);
+	}
+}
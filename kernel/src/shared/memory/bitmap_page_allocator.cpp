@@ -28,6 +28,7 @@ void bitmapPageAllocatorInitialize(g_bitmap_page_allocator* allocator, g_bitmap_
 {
 	allocator->bitmap = bitmap;
 	allocator->freePageCount = 0;
+	allocator->searchStart = 0;
 	mutexInitialize(&allocator->lock);
 
 	for(uint32_t i = 0; i < G_BITMAP_SIZE; i++)
@@ -36,8 +37,12 @@ void bitmapPageAllocatorInitialize(g_bitmap_page_allocator* allocator, g_bitmap_
 
 void bitmapPageAllocatorRefresh(g_bitmap_page_allocator* allocator)
 {
+	allocator->searchStart = G_BITMAP_SIZE;
 	for(uint32_t i = 0; i < G_BITMAP_SIZE; i++)
 	{
+		if(allocator->bitmap[i] && i < allocator->searchStart)
+			allocator->searchStart = i;
+
 		for(uint8_t b = 0; b < G_BITMAP_BITS_PER_ENTRY; b++)
 		{
 			if(G_BITMAP_IS_SET(allocator->bitmap, i, b))
@@ -48,40 +53,79 @@ void bitmapPageAllocatorRefresh(g_bitmap_page_allocator* allocator)
 	}
 }
 
-void bitmapPageAllocatorMarkFree(g_bitmap_page_allocator* allocator, g_physical_address address)
+/**
+ * Marks a single page as free, the caller must hold the lock.
+ */
+static void bitmapPageAllocatorMarkFreeUnlocked(g_bitmap_page_allocator* allocator, g_physical_address address)
 {
-	mutexAcquire(&allocator->lock);
-
 	uint32_t index = G_ADDRESS_TO_BITMAP_INDEX(address);
 	uint32_t bit = G_ADDRESS_TO_BITMAP_BIT(address);
 	G_BITMAP_SET(allocator->bitmap, index, bit);
 	allocator->freePageCount++;
 
+	if(index < allocator->searchStart)
+		allocator->searchStart = index;
+}
+
+/**
+ * Takes the lowest free page, the caller must hold the lock. Entries that are
+ * found to be full on the way move the search start forward.
+ */
+static g_physical_address bitmapPageAllocatorTakeUnlocked(g_bitmap_page_allocator* allocator)
+{
+	for(uint32_t i = allocator->searchStart; i < G_BITMAP_SIZE; i++)
+	{
+		g_bitmap_entry entry = allocator->bitmap[i];
+		if(!entry)
+			continue;
+
+		uint32_t b = __builtin_ctz(entry);
+		G_BITMAP_UNSET(allocator->bitmap, i, b);
+		allocator->freePageCount--;
+		allocator->searchStart = i;
+		return G_BITMAP_TO_ADDRESS(i, b);
+	}
+
+	allocator->searchStart = G_BITMAP_SIZE;
+	return 0;
+}
+
+void bitmapPageAllocatorMarkFree(g_bitmap_page_allocator* allocator, g_physical_address address)
+{
+	mutexAcquire(&allocator->lock);
+	bitmapPageAllocatorMarkFreeUnlocked(allocator, address);
 	mutexRelease(&allocator->lock);
 }
 
-g_physical_address bitmapPageAllocatorAllocate(g_bitmap_page_allocator* allocator)
+void bitmapPageAllocatorMarkFreeMultiple(g_bitmap_page_allocator* allocator, g_physical_address* addresses, uint32_t count)
 {
 	mutexAcquire(&allocator->lock);
+	for(uint32_t i = 0; i < count; i++)
+		bitmapPageAllocatorMarkFreeUnlocked(allocator, addresses[i]);
+	mutexRelease(&allocator->lock);
+}
 
-	for(uint32_t i = 0; i < G_BITMAP_SIZE; i++)
-	{
-		if(!allocator->bitmap[i])
-			continue;
+g_physical_address bitmapPageAllocatorAllocate(g_bitmap_page_allocator* allocator)
+{
+	mutexAcquire(&allocator->lock);
+	g_physical_address page = bitmapPageAllocatorTakeUnlocked(allocator);
+	mutexRelease(&allocator->lock);
+	return page;
+}
 
-		for(uint32_t b = 0; b < G_BITMAP_BITS_PER_ENTRY; b++)
-		{
-			if(G_BITMAP_IS_SET(allocator->bitmap, i, b))
-			{
-				G_BITMAP_UNSET(allocator->bitmap, i, b);
-				allocator->freePageCount--;
+uint32_t bitmapPageAllocatorAllocateMultiple(g_bitmap_page_allocator* allocator, g_physical_address* out, uint32_t count)
+{
+	mutexAcquire(&allocator->lock);
 
-				mutexRelease(&allocator->lock);
-				return G_BITMAP_TO_ADDRESS(i, b);
-			}
-		}
+	uint32_t allocated = 0;
+	while(allocated < count)
+	{
+		g_physical_address page = bitmapPageAllocatorTakeUnlocked(allocator);
+		if(!page)
+			break;
+		out[allocated++] = page;
 	}
 
 	mutexRelease(&allocator->lock);
-	return 0;
+	return allocated;
 }
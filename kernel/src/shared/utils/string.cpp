@@ -82,6 +82,16 @@ bool stringEquals(const char* stra, const char* strb)
 	return true;
 }
 
+int stringCompare(const char* stra, const char* strb)
+{
+	while(*stra && *stra == *strb)
+	{
+		++stra;
+		++strb;
+	}
+	return (uint8_t) *stra - (uint8_t) *strb;
+}
+
 bool stringEquals(const char* straStart, const char* straEnd, const char* strbStart, const char* strbEnd)
 {
 	if(straEnd - straStart != strbEnd - strbStart)
@@ -80,6 +80,73 @@ void g_atomic_block_dual(g_atom* a1, g_atom* a2);
 g_bool g_atomic_block_to(g_atom* atom, uint64_t timeout);
 g_bool g_atomic_block_dual_to(g_atom* a1, g_atom* a2, uint64_t timeout);
 
+/**
+ * Blocks the executing task while the word has the expected value, until another
+ * task wakes it with {g_futex_wake}. The task may also return spuriously, so the
+ * caller must check its condition again.
+ *
+ * @param address
+ * 		the futex word, aligned to four bytes
+ * @param expected
+ * 		the value the word is expected to have
+ * @param-opt timeout
+ * 		maximum number of milliseconds to wait
+ *
+ * @return one of the {g_futex_wait_status} codes
+ *
+ * @security-level APPLICATION
+ */
+g_futex_wait_status g_futex_wait(volatile uint32_t* address, uint32_t expected);
+g_futex_wait_status g_futex_wait_to(volatile uint32_t* address, uint32_t expected, uint64_t timeout);
+
+/**
+ * Wakes tasks of the executing process that wait on the futex word.
+ *
+ * @param address
+ * 		the futex word
+ * @param count
+ * 		maximum number of tasks to wake
+ *
+ * @return the number of woken tasks
+ *
+ * @security-level APPLICATION
+ */
+uint32_t g_futex_wake(volatile uint32_t* address, uint32_t count);
+
+/**
+ * Locks a mutex that is shared by the threads of a process. Acquiring a free mutex
+ * and releasing a mutex that nobody waits for doesn't enter the kernel. A mutex
+ * must be initialized to zero.
+ *
+ * @param mutex
+ * 		the mutex to use
+ *
+ * @security-level APPLICATION
+ */
+void g_user_mutex_lock(g_user_mutex* mutex);
+
+/**
+ * Tries to lock a mutex without waiting.
+ *
+ * @param mutex
+ * 		the mutex to use
+ *
+ * @return true if the mutex was locked
+ *
+ * @security-level APPLICATION
+ */
+g_bool g_user_mutex_try_lock(g_user_mutex* mutex);
+
+/**
+ * Unlocks a mutex and wakes one of the waiting tasks.
+ *
+ * @param mutex
+ * 		the mutex to use
+ *
+ * @security-level APPLICATION
+ */
+void g_user_mutex_unlock(g_user_mutex* mutex);
+
 /**
  * Spawns a program binary.
  *
@@ -125,8 +192,9 @@ g_kill_status g_kill(g_pid pid);
 void g_log(const char* message);
 
 /**
- * Performs the software interrupt necessary for the system call passing the
- * given data (usually a pointer to a call struct).
+ * Performs the system call passing the given data (usually a pointer to a call struct).
+ * Uses the SYSENTER instruction if the processor supports it, otherwise the software
+ * interrupt.
  *
  * @param call
  * 		the call to execute
@@ -143,6 +211,40 @@ void g_log(const char* message);
  */
 void g_syscall(uint32_t call, uint32_t data);
 
+/**
+ * Performs the system call using the software interrupt 0x80.
+ *
+ * @param call
+ * 		the call to execute
+ * @param data
+ * 		the data to pass
+ *
+ * @security-level APPLICATION
+ */
+void g_syscall_int(uint32_t call, uint32_t data);
+
+/**
+ * Performs the system call using the SYSENTER instruction. May only be used if
+ * <g_syscall_sysenter_available> returns true.
+ *
+ * @param call
+ * 		the call to execute
+ * @param data
+ * 		the data to pass
+ *
+ * @security-level APPLICATION
+ */
+void g_syscall_sysenter(uint32_t call, uint32_t data);
+
+/**
+ * Checks whether the processor supports the SYSENTER instruction.
+ *
+ * @return true if <g_syscall_sysenter> may be used
+ *
+ * @security-level APPLICATION
+ */
+g_bool g_syscall_sysenter_available();
+
 /**
  * Opens a file.
  *
@@ -189,6 +291,62 @@ g_fs_close_status g_close(g_fd fd);
 int64_t g_length(g_fd fd);
 int64_t g_length_s(g_fd fd, g_fs_length_status* out_status);
 
+/**
+ * Retrieves the attributes of the node at the given path.
+ *
+ * @param path
+ * 		path of the node
+ *
+ * @param out_stats
+ * 		is filled with the attributes
+ *
+ * @return one of the {g_fs_stat_status} codes
+ *
+ * @security-level APPLICATION
+ */
+g_fs_stat_status g_stat(const char* path, g_fs_stat_attributes* out_stats);
+
+/**
+ * Retrieves the attributes of the node that the file descriptor refers to.
+ *
+ * @param fd
+ * 		the file descriptor
+ *
+ * @param out_stats
+ * 		is filled with the attributes
+ *
+ * @return one of the {g_fs_stat_status} codes
+ *
+ * @security-level APPLICATION
+ */
+g_fs_stat_status g_fstat(g_fd fd, g_fs_stat_attributes* out_stats);
+
+/**
+ * Fills the buffer with {g_fs_directory_record} entries for as many children of
+ * the opened directory as fit. The kernel may return fewer records per call, so
+ * this is repeated until the end of the directory. The offset of the descriptor
+ * counts the children that were listed, seeking to 0 starts over.
+ *
+ * @param fd
+ * 		descriptor of the opened directory
+ *
+ * @param buffer
+ * 		target buffer
+ *
+ * @param length
+ * 		length of the buffer
+ *
+ * @param out_status
+ * 		is filled with the status code
+ *
+ * @return the number of bytes written, 0 at the end of the directory and
+ * 		-1 if not successful
+ *
+ * @security-level APPLICATION
+ */
+int32_t g_list_directory(g_fd fd, void* buffer, uint32_t length);
+int32_t g_list_directory_s(g_fd fd, void* buffer, uint32_t length, g_fs_read_directory_status* out_status);
+
 /**
  * Opens a directory.
  *
@@ -367,6 +525,90 @@ int32_t g_read_s(g_fd fd, void* buffer, uint64_t length, g_fs_read_status* out_s
 int32_t g_write(g_fd fd, const void* buffer, uint64_t length);
 int32_t g_write_s(g_fd fd, const void* buffer, uint64_t length, g_fs_write_status* out_status);
 
+/**
+ * Reads bytes from the file into a list of buffers, filling one after the other.
+ *
+ * @param fd
+ * 		the file descriptor
+ * @param vectors
+ * 		the target buffers
+ * @param count
+ * 		the number of buffers, at most {G_FS_IOV_MAX}
+ * @param-opt out_status
+ * 		filled with one of the {g_fs_read_status} codes
+ *
+ * @return if the read was successful the length of bytes or
+ * 		zero if EOF, otherwise -1
+ *
+ * @security-level APPLICATION
+ */
+int64_t g_readv(g_fd fd, const g_fs_iovec* vectors, uint32_t count);
+int64_t g_readv_s(g_fd fd, const g_fs_iovec* vectors, uint32_t count, g_fs_read_status* out_status);
+
+/**
+ * Writes bytes from a list of buffers to the file, one after the other.
+ *
+ * @param fd
+ * 		the file descriptor
+ * @param vectors
+ * 		the source buffers
+ * @param count
+ * 		the number of buffers, at most {G_FS_IOV_MAX}
+ * @param-opt out_status
+ * 		filled with one of the {g_fs_write_status} codes
+ *
+ * @return if successful the number of bytes that were written, otherwise -1
+ *
+ * @security-level APPLICATION
+ */
+int64_t g_writev(g_fd fd, const g_fs_iovec* vectors, uint32_t count);
+int64_t g_writev_s(g_fd fd, const g_fs_iovec* vectors, uint32_t count, g_fs_write_status* out_status);
+
+/**
+ * Reads bytes from the file at the given offset. The offset of the descriptor is
+ * neither used nor changed, so multiple threads can read from the same descriptor.
+ *
+ * @param fd
+ * 		the file descriptor
+ * @param buffer
+ * 		the target buffer
+ * @param length
+ * 		the length in bytes
+ * @param offset
+ * 		the offset within the file
+ * @param-opt out_status
+ * 		filled with one of the {g_fs_read_status} codes
+ *
+ * @return if the read was successful the length of bytes or
+ * 		zero if EOF, otherwise -1
+ *
+ * @security-level APPLICATION
+ */
+int64_t g_pread(g_fd fd, void* buffer, uint32_t length, int64_t offset);
+int64_t g_pread_s(g_fd fd, void* buffer, uint32_t length, int64_t offset, g_fs_read_status* out_status);
+
+/**
+ * Writes bytes to the file at the given offset. The offset of the descriptor is
+ * neither used nor changed.
+ *
+ * @param fd
+ * 		the file descriptor
+ * @param buffer
+ * 		the source buffer
+ * @param length
+ * 		the length in bytes
+ * @param offset
+ * 		the offset within the file
+ * @param-opt out_status
+ * 		filled with one of the {g_fs_write_status} codes
+ *
+ * @return if successful the number of bytes that were written, otherwise -1
+ *
+ * @security-level APPLICATION
+ */
+int64_t g_pwrite(g_fd fd, const void* buffer, uint32_t length, int64_t offset);
+int64_t g_pwrite_s(g_fd fd, const void* buffer, uint32_t length, int64_t offset, g_fs_write_status* out_status);
+
 /**
  * Returns the next transaction id that can be used for messaging.
  * When sending a message, a transaction can be added so that one can wait
@@ -526,6 +768,43 @@ g_message_send_status g_send_message_m(g_tid target, void* buf, size_t len, g_me
 g_message_send_status g_send_message_t(g_tid tid, void* buf, size_t len, g_message_transaction tx);
 g_message_send_status g_send_message_tm(g_tid tid, void* buf, size_t len, g_message_transaction tx, g_message_send_mode mode);
 
+/**
+ * Sends a message together with a page-aligned memory area that is not copied. Instead
+ * the physical pages of the area are mapped into the receiver when it receives the message;
+ * the address is then found in the <transfer> field of the received message header.
+ *
+ * The transfer mode specifies what happens with the area in the sender:
+ * - {G_MESSAGE_TRANSFER_MODE_MOVE} the pages are unmapped from the sender
+ * - {G_MESSAGE_TRANSFER_MODE_SHARE} the pages stay mapped and are shared with the receiver
+ *
+ * The area may be no longer than {G_MESSAGE_MAXIMUM_TRANSFER_LENGTH}. The receiver should
+ * unmap the area with {g_unmap} once it is done with it.
+ *
+ * @param target
+ * 		id of the target task
+ * @param buf
+ * 		message content buffer
+ * @param len
+ * 		number of bytes to copy from the buffer
+ * @param transfer
+ * 		page-aligned start of the area to transfer
+ * @param transferLength
+ * 		length of the area to transfer
+ * @param transferMode
+ * 		whether the area is moved or shared
+ * @param tx
+ * 		transaction id
+ * @param mode
+ * 		determines how the function blocks
+ *
+ * @return one of the <g_message_send_status> codes, {G_MESSAGE_SEND_STATUS_FAILED} if the
+ * 		area is not aligned or not entirely allocated
+ *
+ * @security-level APPLICATION
+ */
+g_message_send_status g_send_message_transfer(g_tid target, void* buf, size_t len, void* transfer, size_t transferLength,
+		g_message_transfer_mode transferMode, g_message_transaction tx, g_message_send_mode mode);
+
 /**
  * Receives a message. At maximum <max> bytes will be attempted to be copied to
  * the buffer <buf>. Note that when receiving a message, a buffer with a size of
@@ -556,6 +835,9 @@ g_message_send_status g_send_message_tm(g_tid tid, void* buf, size_t len, g_mess
  * 		transaction id
  * @param break_condition
  * 		can be used to break the waiting process by setting its value to 1
+ * @param-opt timeout
+ * 		when given, a blocking receive returns {G_MESSAGE_RECEIVE_STATUS_TIMED_OUT}
+ * 		if no message arrived within this number of milliseconds
  *
  * @security-level APPLICATION
  */
@@ -564,6 +846,8 @@ g_message_receive_status g_receive_message_m(void* buf, size_t max, g_message_re
 g_message_receive_status g_receive_message_t(void* buf, size_t max, g_message_transaction tx);
 g_message_receive_status g_receive_message_tm(void* buf, size_t max, g_message_transaction tx, g_message_receive_mode mode);
 g_message_receive_status g_receive_message_tmb(void* buf, size_t max, g_message_transaction tx, g_message_receive_mode mode, uint8_t* break_condition);
+g_message_receive_status g_receive_message_to(void* buf, size_t max, uint64_t timeout);
+g_message_receive_status g_receive_message_tmb_to(void* buf, size_t max, g_message_transaction tx, g_message_receive_mode mode, uint8_t* break_condition, uint64_t timeout);
 
 /**
  * Registers the executing task for the given identifier.
@@ -769,7 +1053,66 @@ g_fs_pipe_status g_pipe(g_fd* out_write, g_fd* out_read);
 g_fs_pipe_status g_pipe_b(g_fd* out_write, g_fd* out_read, g_bool blocking);
 
 /**
- * Creates a mountpoint and registers the current thread as its file system delegate.
+ * Pipes grow with demand up to their maximum capacity. These calls retrieve or set
+ * the maximum capacity of the pipe behind either end.
+ *
+ * @param fd
+ * 		the file descriptor of a pipe end
+ * @param capacity
+ * 		the new maximum capacity, clamped to {G_PIPE_MAXIMUM_CAPACITY}
+ * @param-opt out_status
+ * 		is filled with the status code
+ *
+ * @return the maximum capacity, or 0 on failure
+ *
+ * @security-level APPLICATION
+ */
+uint32_t g_pipe_get_capacity(g_fd fd, g_fs_pipe_capacity_status* out_status);
+uint32_t g_pipe_set_capacity(g_fd fd, uint32_t capacity, g_fs_pipe_capacity_status* out_status);
+
+/**
+ * Moves data from one file descriptor to another within the kernel. One of the
+ * descriptors must refer to a pipe. Waits for input only if the input is blocking
+ * and nothing was moved yet.
+ *
+ * @param in
+ * 		the descriptor to read from
+ * @param out
+ * 		the descriptor to write to
+ * @param length
+ * 		the maximum number of bytes to move
+ * @param-opt out_status
+ * 		is filled with the status code
+ *
+ * @return the number of bytes moved, or -1 on failure
+ *
+ * @security-level APPLICATION
+ */
+int64_t g_splice(g_fd in, g_fd out, uint64_t length, g_fs_splice_status* out_status);
+
+/**
+ * Copies data from one pipe to another within the kernel, without removing it from
+ * the input pipe.
+ *
+ * @param in
+ * 		the pipe to read from
+ * @param out
+ * 		the pipe to write to
+ * @param length
+ * 		the maximum number of bytes to copy
+ * @param-opt out_status
+ * 		is filled with the status code
+ *
+ * @return the number of bytes copied, or -1 on failure
+ *
+ * @security-level APPLICATION
+ */
+int64_t g_tee(g_fd in, g_fd out, uint64_t length, g_fs_splice_status* out_status);
+
+/**
+ * Creates a mountpoint and registers the current process as its file system delegate.
+ * Requests for the mountpoint are then passed through the returned transaction storage,
+ * see {g_fs_delegate_take}.
  *
  * @param name
  * 		the wanted name
@@ -781,7 +1124,7 @@ g_fs_pipe_status g_pipe_b(g_fd* out_write, g_fd* out_read, g_bool blocking);
  * 		is filled with the node id of the mountpoint on success
  *
  * @param out_transaction_storage
- * 		is filled with the address of the transaction storage
+ * 		is filled with the address of the {g_fs_tasked_delegate_ring}
  *
  * @return one of the {g_fs_register_as_delegate_status} codes
  *
@@ -827,6 +1170,52 @@ void g_fs_set_transaction_status(g_fs_transaction_id id, g_fs_transaction_status
  */
 g_fs_create_node_status g_fs_create_node(uint32_t parent, char* name, g_fs_node_type type, uint64_t fs_id, uint32_t* out_created_id);
 
+/**
+ * Takes the next requests that the kernel has passed to a file system delegate, waiting
+ * until there is at least one. The requests are found in the ring at the returned slots.
+ *
+ * @param ring
+ * 		the transaction storage of the delegate
+ *
+ * @param slots
+ * 		is filled with the slots of the requests
+ *
+ * @param maximum
+ * 		the maximum number of requests to take
+ *
+ * @return the number of requests taken
+ *
+ * @security-level DRIVER
+ */
+uint32_t g_fs_delegate_take(g_fs_tasked_delegate_ring* ring, uint32_t* slots, uint32_t maximum);
+
+/**
+ * Marks the request in the slot as finished. Several requests can be finished before
+ * waking the kernel once with {g_fs_delegate_flush}, without entering the kernel.
+ *
+ * @param ring
+ * 		the transaction storage of the delegate
+ *
+ * @param slot
+ * 		slot of the request
+ *
+ * @param status
+ * 		the transaction status, usually {G_FS_TRANSACTION_FINISHED}
+ *
+ * @security-level DRIVER
+ */
+void g_fs_delegate_finish(g_fs_tasked_delegate_ring* ring, uint32_t slot, g_fs_transaction_status status);
+
+/**
+ * Wakes the kernel threads that wait for requests that were finished, if there are any.
+ *
+ * @param ring
+ * 		the transaction storage of the delegate
+ *
+ * @security-level DRIVER
+ */
+void g_fs_delegate_flush(g_fs_tasked_delegate_ring* ring);
+
 /**
  * Registers the <handler> routine as the handler for the <irq>.
  *
@@ -914,6 +1303,138 @@ void* g_task_get_tls();
  */
 g_process_info* g_process_get_info();
 
+/**
+ * Creates a ring that system calls can be added to and then executed together.
+ *
+ * @param size
+ * 		number of entries, must be a power of two
+ *
+ * @return the ring or null if failed
+ *
+ * @security-level APPLICATION
+ */
+g_syscall_ring* g_create_syscall_ring(uint32_t size);
+
+/**
+ * Adds a system call to the ring. The call is not executed before the ring is submitted
+ * or drained by the kernel. The data must stay valid until the call was completed.
+ *
+ * @param ring
+ * 		the ring
+ * @param call
+ * 		the call to execute
+ * @param data
+ * 		the data to pass
+ *
+ * @return true if the call was added, false if the ring is full
+ *
+ * @security-level APPLICATION
+ */
+g_bool g_push_syscall(g_syscall_ring* ring, uint32_t call, void* data);
+
+/**
+ * Executes all calls that were added to the ring. The kernel executes them in order
+ * with a single trap; calls that can't be executed from a ring are issued directly.
+ *
+ * @param ring
+ * 		the ring
+ *
+ * @return one of the {g_syscall_ring_status} codes
+ *
+ * @security-level APPLICATION
+ */
+g_syscall_ring_status g_submit_syscall_ring(g_syscall_ring* ring);
+
+/**
+ * Starts a kernel worker that executes calls as they are added to the ring, without
+ * any trap. Calls that can't be executed from a ring are completed with the status
+ * {G_SYSCALL_RING_ENTRY_UNSUPPORTED}.
+ *
+ * @param ring
+ * 		the ring
+ *
+ * @return the id of the worker or {G_TID_NONE} if failed
+ *
+ * @security-level APPLICATION
+ */
+g_tid g_drain_syscall_ring(g_syscall_ring* ring);
+
+/**
+ * Stops the kernel worker that drains the ring.
+ *
+ * @param ring
+ * 		the ring
+ *
+ * @security-level APPLICATION
+ */
+void g_stop_draining_syscall_ring(g_syscall_ring* ring);
+
+/**
+ * Creates a channel that passes fixed-size records from one producer thread to one
+ * consumer thread. The channel is a ring in memory that can be shared with another
+ * process using {g_share_channel}. Pushing and popping don't enter the kernel unless
+ * the ring is full or empty and the call blocks, or the other side is blocked.
+ *
+ * @param record_size
+ * 		size of each record in bytes
+ * @param capacity
+ * 		number of records, must be a power of two
+ *
+ * @return the channel or null if failed
+ *
+ * @security-level APPLICATION
+ */
+g_channel* g_create_channel(uint32_t record_size, uint32_t capacity);
+
+/**
+ * Shares a channel with another process.
+ *
+ * @param channel
+ * 		the channel
+ * @param pid
+ * 		the id of the target process
+ *
+ * @return the address of the channel within the target address space
+ *
+ * @security-level APPLICATION
+ */
+g_channel* g_share_channel(g_channel* channel, g_pid pid);
+
+/**
+ * Adds a record to the channel. May only be called by the producer.
+ *
+ * @param channel
+ * 		the channel
+ * @param record
+ * 		record to copy into the channel
+ * @param blocking
+ * 		whether to wait if the channel is full
+ *
+ * @return true if the record was added
+ *
+ * @security-level APPLICATION
+ */
+g_bool g_channel_push(g_channel* channel, const void* record, g_bool blocking);
+
+/**
+ * Takes the next record from the channel. May only be called by the consumer.
+ *
+ * @param channel
+ * 		the channel
+ * @param record
+ * 		buffer of the channels record size
+ * @param blocking
+ * 		whether to wait if the channel is empty
+ * @param-opt timeout
+ * 		maximum number of milliseconds to wait
+ *
+ * @return true if a record was taken
+ *
+ * @security-level APPLICATION
+ */
+g_bool g_channel_pop(g_channel* channel, void* record, g_bool blocking);
+g_bool g_channel_pop_to(g_channel* channel, void* record, uint64_t timeout);
+
 __END_C
 
 #endif
@@ -26,6 +26,21 @@
  */
 g_bool __g_atomic_lock(g_atom* atom_1, g_atom* atom_2, bool set_on_finish, bool is_try, g_bool has_timeout, uint64_t timeout) {
 
+	// a single atom that is free is taken without entering the kernel
+	if (!atom_2) {
+		if (set_on_finish) {
+			g_atom expected = 0;
+			if (__atomic_compare_exchange_n(atom_1, &expected, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+				return is_try;
+			}
+			if (is_try) {
+				return false;
+			}
+		} else if (!__atomic_load_n(atom_1, __ATOMIC_ACQUIRE)) {
+			return false;
+		}
+	}
+
 	g_syscall_atomic_lock data;
 	data.atom_1 = atom_1;
 	data.atom_2 = atom_2;
@@ -42,6 +42,16 @@ size_t __g_strlen(const char* s);
  */
 g_bool __g_atomic_lock(g_atom* atom_1, g_atom* atom_2, bool set_on_finish, bool is_try, g_bool has_timeout, uint64_t timeout);
 
+/**
+ * Blocks while the word has the expected value, or until the timeout elapsed.
+ */
+g_channel_wait_status __g_channel_wait(volatile uint32_t* address, uint32_t expected, g_bool has_timeout, uint64_t timeout);
+
+/**
+ * Wakes the tasks that wait on the word.
+ */
+void __g_channel_wake(volatile uint32_t* address);
+
 __END_C
 
 #endif
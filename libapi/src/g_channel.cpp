@@ -0,0 +1,156 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ghost/user.h"
+#include "__internal.h"
+
+/**
+ *
+ */
+g_channel_wait_status __g_channel_wait(volatile uint32_t* address, uint32_t expected, g_bool has_timeout, uint64_t timeout) {
+	g_syscall_channel_wait data;
+	data.address = address;
+	data.expected = expected;
+	data.has_timeout = has_timeout;
+	data.timeout = timeout;
+	g_syscall(G_SYSCALL_CHANNEL_WAIT, (uint32_t) &data);
+	return data.status;
+}
+
+/**
+ *
+ */
+void __g_channel_wake(volatile uint32_t* address) {
+	g_syscall_channel_wake data;
+	data.address = address;
+	g_syscall(G_SYSCALL_CHANNEL_WAKE, (uint32_t) &data);
+}
+
+/**
+ *
+ */
+g_channel* g_create_channel(uint32_t record_size, uint32_t capacity) {
+	if(record_size == 0 || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+		return 0;
+	}
+
+	g_channel* channel = (g_channel*) g_alloc_mem(sizeof(g_channel) + record_size * capacity);
+	if(channel) {
+		channel->recordSize = record_size;
+		channel->capacity = capacity;
+		channel->head = 0;
+		channel->producerWaiting = 0;
+		channel->tail = 0;
+		channel->consumerWaiting = 0;
+	}
+	return channel;
+}
+
+/**
+ *
+ */
+g_channel* g_share_channel(g_channel* channel, g_pid pid) {
+	return (g_channel*) g_share_mem(channel, sizeof(g_channel) + channel->recordSize * channel->capacity, pid);
+}
+
+/**
+ *
+ */
+g_bool g_channel_push(g_channel* channel, const void* record, g_bool blocking) {
+	uint32_t head = channel->head;
+	uint32_t tail = __atomic_load_n(&channel->tail, __ATOMIC_ACQUIRE);
+
+	while(head - tail == channel->capacity) {
+		if(!blocking) {
+			return false;
+		}
+
+		// Announce before checking again, so that the consumer wakes us after taking a record
+		__atomic_store_n(&channel->producerWaiting, 1, __ATOMIC_SEQ_CST);
+		tail = __atomic_load_n(&channel->tail, __ATOMIC_SEQ_CST);
+		if(head - tail == channel->capacity) {
+			__g_channel_wait(&channel->tail, tail, false, 0);
+			tail = __atomic_load_n(&channel->tail, __ATOMIC_ACQUIRE);
+		}
+		__atomic_store_n(&channel->producerWaiting, 0, __ATOMIC_RELAXED);
+	}
+
+	__g_memcpy(G_CHANNEL_RECORDS(channel) + (head & (channel->capacity - 1)) * channel->recordSize, record, channel->recordSize);
+	__atomic_store_n(&channel->head, head + 1, __ATOMIC_SEQ_CST);
+
+	if(__atomic_load_n(&channel->consumerWaiting, __ATOMIC_SEQ_CST)) {
+		__g_channel_wake(&channel->head);
+	}
+	return true;
+}
+
+/**
+ * Takes a record; when blocking, waits at most until the deadline if one is given.
+ */
+static g_bool g_channel_pop_until(g_channel* channel, void* record, g_bool blocking, g_bool has_deadline, uint64_t deadline) {
+	uint32_t tail = channel->tail;
+	uint32_t head = __atomic_load_n(&channel->head, __ATOMIC_ACQUIRE);
+
+	while(head == tail) {
+		if(!blocking) {
+			return false;
+		}
+
+		uint64_t timeout = 0;
+		if(has_deadline) {
+			uint64_t now = g_millis();
+			if(now >= deadline) {
+				return false;
+			}
+			timeout = deadline - now;
+		}
+
+		// Announce before checking again, so that the producer wakes us after adding a record
+		__atomic_store_n(&channel->consumerWaiting, 1, __ATOMIC_SEQ_CST);
+		head = __atomic_load_n(&channel->head, __ATOMIC_SEQ_CST);
+		if(head == tail) {
+			__g_channel_wait(&channel->head, head, has_deadline, timeout);
+			head = __atomic_load_n(&channel->head, __ATOMIC_ACQUIRE);
+		}
+		__atomic_store_n(&channel->consumerWaiting, 0, __ATOMIC_RELAXED);
+	}
+
+	__g_memcpy(record, G_CHANNEL_RECORDS(channel) + (tail & (channel->capacity - 1)) * channel->recordSize, channel->recordSize);
+	__atomic_store_n(&channel->tail, tail + 1, __ATOMIC_SEQ_CST);
+
+	if(__atomic_load_n(&channel->producerWaiting, __ATOMIC_SEQ_CST)) {
+		__g_channel_wake(&channel->tail);
+	}
+	return true;
+}
+
+/**
+ *
+ */
+g_bool g_channel_pop(g_channel* channel, void* record, g_bool blocking) {
+	return g_channel_pop_until(channel, record, blocking, false, 0);
+}
+
+/**
+ *
+ */
+g_bool g_channel_pop_to(g_channel* channel, void* record, uint64_t timeout) {
+	return g_channel_pop_until(channel, record, true, true, g_millis() + timeout);
+}
@@ -26,6 +26,7 @@
  *
  */
 void g_close_directory(g_fs_directory_iterator* iterator) {
-	free(iterator->entry_buffer.name);
+	g_close(iterator->fd);
+	free(iterator->buffer);
 	free(iterator);
 }
@@ -0,0 +1,66 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ghost/user.h"
+#include "__internal.h"
+
+/**
+ *
+ */
+uint32_t g_fs_delegate_take(g_fs_tasked_delegate_ring* ring, uint32_t* slots, uint32_t maximum) {
+	uint32_t tail = ring->tail;
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+	while(head == tail) {
+		// Announce before checking again, so that the kernel wakes us after adding a request
+		__atomic_store_n(&ring->delegate_waiting, 1, __ATOMIC_SEQ_CST);
+		head = __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST);
+		if(head == tail) {
+			__g_channel_wait(&ring->head, head, false, 0);
+			head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+		}
+		__atomic_store_n(&ring->delegate_waiting, 0, __ATOMIC_RELAXED);
+	}
+
+	uint32_t taken = 0;
+	while(tail != head && taken < maximum) {
+		slots[taken++] = ring->queue[tail % G_FS_TASKED_DELEGATE_SLOTS];
+		tail++;
+	}
+	__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+	return taken;
+}
+
+/**
+ *
+ */
+void g_fs_delegate_finish(g_fs_tasked_delegate_ring* ring, uint32_t slot, g_fs_transaction_status status) {
+	__atomic_store_n(&ring->requests[slot].transaction_status, status, __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&ring->completed, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ *
+ */
+void g_fs_delegate_flush(g_fs_tasked_delegate_ring* ring) {
+	if(__atomic_load_n(&ring->kernel_waiting, __ATOMIC_SEQ_CST)) {
+		__g_channel_wake(&ring->completed);
+	}
+}
@@ -0,0 +1,60 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ghost/user.h"
+#include "__internal.h"
+
+/**
+ *
+ */
+static g_futex_wait_status __g_futex_wait(volatile uint32_t* address, uint32_t expected, g_bool has_timeout, uint64_t timeout) {
+	g_syscall_futex_wait data;
+	data.address = address;
+	data.expected = expected;
+	data.has_timeout = has_timeout;
+	data.timeout = timeout;
+	g_syscall(G_SYSCALL_FUTEX_WAIT, (uint32_t) &data);
+	return data.status;
+}
+
+/**
+ *
+ */
+g_futex_wait_status g_futex_wait(volatile uint32_t* address, uint32_t expected) {
+	return __g_futex_wait(address, expected, false, 0);
+}
+
+/**
+ *
+ */
+g_futex_wait_status g_futex_wait_to(volatile uint32_t* address, uint32_t expected, uint64_t timeout) {
+	return __g_futex_wait(address, expected, true, timeout);
+}
+
+/**
+ *
+ */
+uint32_t g_futex_wake(volatile uint32_t* address, uint32_t count) {
+	g_syscall_futex_wake data;
+	data.address = address;
+	data.count = count;
+	g_syscall(G_SYSCALL_FUTEX_WAKE, (uint32_t) &data);
+	return data.woken;
+}
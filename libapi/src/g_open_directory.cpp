@@ -33,22 +33,42 @@ g_fs_directory_iterator* g_open_directory(const char* path) {
  */
 g_fs_directory_iterator* g_open_directory_s(const char* path, g_fs_open_directory_status* out_status) {
 
-	g_fs_directory_iterator* iterator = (g_fs_directory_iterator*) malloc(sizeof(g_fs_directory_iterator));
-	iterator->entry_buffer.name = (char*) malloc(G_FILENAME_MAX);
+	g_fs_open_directory_status status = G_FS_OPEN_DIRECTORY_SUCCESSFUL;
+	g_fs_stat_attributes stats;
+
+	g_fs_open_status open_status;
+	g_fd fd = g_open_fs(path, G_FILE_FLAG_MODE_READ, &open_status);
+
+	if (open_status == G_FS_OPEN_NOT_FOUND) {
+		status = G_FS_OPEN_DIRECTORY_NOT_FOUND;
+
+	} else if (open_status != G_FS_OPEN_SUCCESSFUL) {
+		status = G_FS_OPEN_DIRECTORY_ERROR;
 
-	g_syscall_fs_open_directory data;
-	data.path = (char*) path;
-	data.iterator = iterator;
-	g_syscall(G_SYSCALL_FS_OPEN_DIRECTORY, (uint32_t) &data);
+	} else if (g_fstat(fd, &stats) != G_FS_STAT_SUCCESSFUL) {
+		g_close(fd);
+		status = G_FS_OPEN_DIRECTORY_ERROR;
+
+	} else if (stats.type != G_FS_NODE_TYPE_FOLDER && stats.type != G_FS_NODE_TYPE_MOUNTPOINT && stats.type != G_FS_NODE_TYPE_ROOT) {
+		g_close(fd);
+		status = G_FS_OPEN_DIRECTORY_NOT_FOUND;
+	}
 
 	if (out_status) {
-		*out_status = data.status;
+		*out_status = status;
 	}
 
-	if (data.status == G_FS_OPEN_DIRECTORY_SUCCESSFUL) {
-		return iterator;
+	if (status != G_FS_OPEN_DIRECTORY_SUCCESSFUL) {
+		return 0;
 	}
 
-	free(iterator);
-	return 0;
+	// entries are read in batches of records, names are used from the buffer
+	g_fs_directory_iterator* iterator = (g_fs_directory_iterator*) malloc(sizeof(g_fs_directory_iterator));
+	iterator->node_id = stats.node_id;
+	iterator->position = 0;
+	iterator->fd = fd;
+	iterator->buffer = (uint8_t*) malloc(G_FS_DIRECTORY_ITERATOR_BUFFER_SIZE);
+	iterator->buffered = 0;
+	iterator->buffer_position = 0;
+	return iterator;
 }
@@ -0,0 +1,53 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ghost/user.h"
+
+/**
+ *
+ */
+uint32_t g_pipe_get_capacity(g_fd fd, g_fs_pipe_capacity_status* out_status) {
+
+	g_syscall_fs_pipe_capacity data;
+	data.fd = fd;
+	data.set = false;
+	data.capacity = 0;
+	g_syscall(G_SYSCALL_FS_PIPE_CAPACITY, (uint32_t) &data);
+	if (out_status) {
+		*out_status = data.status;
+	}
+	return data.status == G_FS_PIPE_CAPACITY_SUCCESSFUL ? data.capacity : 0;
+}
+
+/**
+ *
+ */
+uint32_t g_pipe_set_capacity(g_fd fd, uint32_t capacity, g_fs_pipe_capacity_status* out_status) {
+
+	g_syscall_fs_pipe_capacity data;
+	data.fd = fd;
+	data.set = true;
+	data.capacity = capacity;
+	g_syscall(G_SYSCALL_FS_PIPE_CAPACITY, (uint32_t) &data);
+	if (out_status) {
+		*out_status = data.status;
+	}
+	return data.status == G_FS_PIPE_CAPACITY_SUCCESSFUL ? data.capacity : 0;
+}
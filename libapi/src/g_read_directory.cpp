@@ -32,17 +32,34 @@ g_fs_directory_entry* g_read_directory(g_fs_directory_iterator* iterator) {
  */
 g_fs_directory_entry* g_read_directory_s(g_fs_directory_iterator* iterator, g_fs_read_directory_status* out_status) {
 
-	g_syscall_fs_read_directory data;
-	data.iterator = iterator;
-	g_syscall(G_SYSCALL_FS_READ_DIRECTORY, (uint32_t) &data);
+	// fetch the next batch once all buffered records were used
+	if (iterator->buffer_position >= iterator->buffered) {
+		g_fs_read_directory_status status;
+		int32_t listed = g_list_directory_s(iterator->fd, iterator->buffer, G_FS_DIRECTORY_ITERATOR_BUFFER_SIZE, &status);
 
-	if (out_status) {
-		*out_status = data.status;
-	}
+		if (status != G_FS_READ_DIRECTORY_SUCCESSFUL) {
+			if (out_status) {
+				*out_status = status;
+			}
+			return 0;
+		}
 
-	if (data.status == G_FS_READ_DIRECTORY_SUCCESSFUL) {
-		return &iterator->entry_buffer;
+		iterator->buffered = listed;
+		iterator->buffer_position = 0;
 	}
 
-	return 0;
+	g_fs_directory_record* record = (g_fs_directory_record*) &iterator->buffer[iterator->buffer_position];
+	iterator->buffer_position += record->record_length;
+	iterator->position++;
+
+	g_fs_directory_entry* entry = &iterator->entry_buffer;
+	entry->node_id = record->node_id;
+	entry->type = record->type;
+	entry->length = record->length;
+	entry->name = record->name;
+
+	if (out_status) {
+		*out_status = G_FS_READ_DIRECTORY_SUCCESSFUL;
+	}
+	return entry;
 }
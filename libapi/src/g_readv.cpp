@@ -0,0 +1,45 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ghost/user.h"
+#include "ghost/stdint.h"
+
+// redirect
+int64_t g_readv(g_fd fd, const g_fs_iovec* vectors, uint32_t count) {
+	return g_readv_s(fd, vectors, count, 0);
+}
+
+/**
+ *
+ */
+int64_t g_readv_s(g_fd fd, const g_fs_iovec* vectors, uint32_t count, g_fs_read_status* out_status) {
+
+	g_syscall_fs_readv data;
+	data.fd = fd;
+	data.vectors = (g_fs_iovec*) vectors;
+	data.count = count;
+	data.positional = false;
+	data.offset = 0;
+	g_syscall(G_SYSCALL_FS_READV, (uint32_t) &data);
+	if (out_status) {
+		*out_status = data.status;
+	}
+	return data.result;
+}
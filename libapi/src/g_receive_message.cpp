@@ -51,6 +51,30 @@ g_message_receive_status g_receive_message_tmb(void* buf, size_t max, g_message_
 	data.mode = mode;
 	data.transaction = tx;
 	data.break_condition = break_condition;
+	data.has_timeout = false;
+	data.timeout = 0;
+	g_syscall(G_SYSCALL_MESSAGE_RECEIVE, (uint32_t) &data);
+	return data.status;
+}
+
+// redirect
+g_message_receive_status g_receive_message_to(void* buf, size_t max, uint64_t timeout) {
+	return g_receive_message_tmb_to(buf, max, G_MESSAGE_TRANSACTION_NONE, G_MESSAGE_RECEIVE_MODE_BLOCKING, nullptr, timeout);
+}
+
+/**
+ *
+ */
+g_message_receive_status g_receive_message_tmb_to(void* buf, size_t max, g_message_transaction tx, g_message_receive_mode mode, uint8_t* break_condition, uint64_t timeout) {
+
+	g_syscall_receive_message data;
+	data.buffer = (g_message_header*) buf;
+	data.maximum = max;
+	data.mode = mode;
+	data.transaction = tx;
+	data.break_condition = break_condition;
+	data.has_timeout = true;
+	data.timeout = timeout;
 	g_syscall(G_SYSCALL_MESSAGE_RECEIVE, (uint32_t) &data);
 	return data.status;
 }
@@ -49,6 +49,27 @@ g_message_send_status g_send_message_tm(g_tid tid, void* buf, size_t len, g_mess
 	data.receiver = tid;
 	data.mode = mode;
 	data.transaction = tx;
+	data.transfer = 0;
+	data.transferLength = 0;
+	data.transferMode = G_MESSAGE_TRANSFER_MODE_MOVE;
+	g_syscall(G_SYSCALL_MESSAGE_SEND, (uint32_t) &data);
+	return data.status;
+}
+
+/**
+ *
+ */
+g_message_send_status g_send_message_transfer(g_tid tid, void* buf, size_t len, void* transfer, size_t transferLength, g_message_transfer_mode transferMode,
+		g_message_transaction tx, g_message_send_mode mode) {
+	g_syscall_send_message data;
+	data.buffer = buf;
+	data.length = len;
+	data.receiver = tid;
+	data.mode = mode;
+	data.transaction = tx;
+	data.transfer = transfer;
+	data.transferLength = transferLength;
+	data.transferMode = transferMode;
 	g_syscall(G_SYSCALL_MESSAGE_SEND, (uint32_t) &data);
 	return data.status;
 }
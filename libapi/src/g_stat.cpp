@@ -0,0 +1,52 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ghost/user.h"
+
+/**
+ *
+ */
+g_fs_stat_status g_stat(const char* path, g_fs_stat_attributes* out_stats) {
+
+	g_syscall_fs_stat data;
+	data.path = (char*) path;
+	data.follow_symlinks = true;
+	g_syscall(G_SYSCALL_FS_STAT, (uint32_t) &data);
+
+	if (data.result == G_FS_STAT_SUCCESSFUL) {
+		*out_stats = data.stats;
+	}
+	return data.result;
+}
+
+/**
+ *
+ */
+g_fs_stat_status g_fstat(g_fd fd, g_fs_stat_attributes* out_stats) {
+
+	g_syscall_fs_fstat data;
+	data.fd = fd;
+	g_syscall(G_SYSCALL_FS_FSTAT, (uint32_t) &data);
+
+	if (data.result == G_FS_STAT_SUCCESSFUL) {
+		*out_stats = data.stats;
+	}
+	return data.result;
+}
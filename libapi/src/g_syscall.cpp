@@ -20,12 +20,60 @@
 
 #include "ghost/user.h"
 
+/**
+ * Whether SYSENTER is used, -1 until the processor was asked.
+ */
+static int __g_syscall_use_sysenter = -1;
+
 /**
  *
  */
 void g_syscall(uint32_t call, uint32_t data) {
+	if(__g_syscall_use_sysenter == -1) {
+		__g_syscall_use_sysenter = g_syscall_sysenter_available() ? 1 : 0;
+	}
+
+	if(__g_syscall_use_sysenter) {
+		g_syscall_sysenter(call, data);
+	} else {
+		g_syscall_int(call, data);
+	}
+}
+
+/**
+ *
+ */
+void g_syscall_int(uint32_t call, uint32_t data) {
 	asm volatile ("int $0x80"
 			:
 			: "a"(call), "b"(data)
 			: "cc", "memory");
 }
+
+/**
+ * The kernel returns to the address in EDX with the stack pointer from ECX. The
+ * return address is calculated relative to the current position, as the library
+ * is position independent.
+ */
+void g_syscall_sysenter(uint32_t call, uint32_t data) {
+	asm volatile ("call 1f\n"
+			"1: pop %%edx\n"
+			"add $(2f - 1b), %%edx\n"
+			"mov %%esp, %%ecx\n"
+			"sysenter\n"
+			"2:\n"
+			:
+			: "a"(call), "b"(data)
+			: "ecx", "edx", "cc", "memory");
+}
+
+/**
+ *
+ */
+g_bool g_syscall_sysenter_available() {
+	uint32_t eax, ebx, ecx, edx;
+	asm volatile ("cpuid"
+			: "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx)
+			: "a"(1));
+	return (edx & (1 << 11)) ? true : false;
+}
@@ -0,0 +1,106 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ghost/user.h"
+#include "__internal.h"
+
+/**
+ *
+ */
+g_syscall_ring* g_create_syscall_ring(uint32_t size) {
+	if(size == 0 || size > G_SYSCALL_RING_MAXIMUM_SIZE || (size & (size - 1)) != 0) {
+		return 0;
+	}
+
+	g_syscall_ring* ring = (g_syscall_ring*) g_alloc_mem(sizeof(g_syscall_ring) + size * sizeof(g_syscall_ring_entry));
+	if(ring) {
+		ring->size = size;
+		ring->submitted = 0;
+		ring->completed = 0;
+		ring->draining = 0;
+		ring->worker_waiting = 0;
+	}
+	return ring;
+}
+
+/**
+ *
+ */
+g_bool g_push_syscall(g_syscall_ring* ring, uint32_t call, void* data) {
+	if(ring->submitted - ring->completed >= ring->size) {
+		return false;
+	}
+
+	g_syscall_ring_entry* entry = G_SYSCALL_RING_ENTRY(ring, ring->submitted);
+	entry->call = call;
+	entry->data = (uint32_t) data;
+	entry->status = G_SYSCALL_RING_ENTRY_PENDING;
+
+	// Entry must be complete before the kernel can see it
+	__atomic_store_n(&ring->submitted, ring->submitted + 1, __ATOMIC_SEQ_CST);
+
+	// A draining worker only needs a wake if it announced that it goes to sleep
+	if(__atomic_load_n(&ring->worker_waiting, __ATOMIC_SEQ_CST)) {
+		__g_channel_wake(&ring->submitted);
+	}
+	return true;
+}
+
+/**
+ *
+ */
+g_syscall_ring_status g_submit_syscall_ring(g_syscall_ring* ring) {
+	while(ring->completed != ring->submitted) {
+		g_syscall_ring_submit data;
+		data.ring = ring;
+		g_syscall(G_SYSCALL_RING_SUBMIT, (uint32_t) &data);
+		if(data.status != G_SYSCALL_RING_STATUS_SUCCESSFUL) {
+			return data.status;
+		}
+
+		// The kernel stops after a call it can't execute from the ring
+		g_syscall_ring_entry* last = G_SYSCALL_RING_ENTRY(ring, ring->completed - 1);
+		if(last->status == G_SYSCALL_RING_ENTRY_UNSUPPORTED) {
+			g_syscall(last->call, last->data);
+			last->status = G_SYSCALL_RING_ENTRY_DONE;
+		}
+	}
+	return G_SYSCALL_RING_STATUS_SUCCESSFUL;
+}
+
+/**
+ *
+ */
+g_tid g_drain_syscall_ring(g_syscall_ring* ring) {
+	g_syscall_ring_drain data;
+	data.ring = ring;
+	g_syscall(G_SYSCALL_RING_DRAIN, (uint32_t) &data);
+	return data.worker;
+}
+
+/**
+ *
+ */
+void g_stop_draining_syscall_ring(g_syscall_ring* ring) {
+	__atomic_store_n(&ring->draining, 0, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&ring->worker_waiting, __ATOMIC_SEQ_CST)) {
+		__g_channel_wake(&ring->submitted);
+	}
+}
@@ -0,0 +1,65 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "ghost/user.h"
+#include "__internal.h"
+
+/**
+ * The mutex word is 0 when free, 1 when locked and 2 when locked with possible
+ * waiters. Only a release in state 2 needs to enter the kernel.
+ */
+#define G_USER_MUTEX_FREE		0
+#define G_USER_MUTEX_LOCKED		1
+#define G_USER_MUTEX_CONTENDED	2
+
+/**
+ *
+ */
+void g_user_mutex_lock(g_user_mutex* mutex) {
+	uint32_t state = G_USER_MUTEX_FREE;
+	if(__atomic_compare_exchange_n(mutex, &state, G_USER_MUTEX_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		return;
+	}
+
+	if(state != G_USER_MUTEX_CONTENDED) {
+		state = __atomic_exchange_n(mutex, G_USER_MUTEX_CONTENDED, __ATOMIC_ACQUIRE);
+	}
+	while(state != G_USER_MUTEX_FREE) {
+		g_futex_wait(mutex, G_USER_MUTEX_CONTENDED);
+		state = __atomic_exchange_n(mutex, G_USER_MUTEX_CONTENDED, __ATOMIC_ACQUIRE);
+	}
+}
+
+/**
+ *
+ */
+g_bool g_user_mutex_try_lock(g_user_mutex* mutex) {
+	uint32_t state = G_USER_MUTEX_FREE;
+	return __atomic_compare_exchange_n(mutex, &state, G_USER_MUTEX_LOCKED, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+/**
+ *
+ */
+void g_user_mutex_unlock(g_user_mutex* mutex) {
+	if(__atomic_exchange_n(mutex, G_USER_MUTEX_FREE, __ATOMIC_RELEASE) == G_USER_MUTEX_CONTENDED) {
+		g_futex_wake(mutex, 1);
+	}
+}
@@ -55,6 +55,10 @@ typedef uint32_t mode_t;
 
 #define FD_CLOEXEC			0//G_FILE_CONTROL_FLAG_CLOSE_ON_EXEC
 
+// maximum capacity of pipes, same values as on Linux
+#define F_SETPIPE_SZ		1031
+#define F_GETPIPE_SZ		1032
+
 // POSIX
 int open(const char* pathname, int flags, ...);
 
@@ -24,6 +24,7 @@
 #include "ghost/common.h"
 #include "ghost/fs.h"
 #include "sys/types.h"
+#include "sys/uio.h"
 #include "stdint.h"
 
 __BEGIN_C
@@ -45,7 +46,7 @@ typedef struct FILE FILE;
  */
 struct FILE {
 	g_fd file_descriptor;
-	uint8_t lock;
+	g_user_mutex lock;
 
 	uint8_t* buffer;
 	size_t buffer_size;
@@ -56,6 +57,7 @@ struct FILE {
 
 	ssize_t (*impl_read)(void* buf, size_t len, FILE* stream);
 	ssize_t (*impl_write)(const void* buf, size_t len, FILE* stream);
+	ssize_t (*impl_writev)(const struct iovec* iov, int iovcnt, FILE* stream);
 	int (*impl_seek)(FILE*, off_t, int);
 	off_t (*impl_tell)(FILE*);
 	int (*impl_close)(FILE*);
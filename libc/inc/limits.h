@@ -64,6 +64,7 @@
 
 #define NAME_MAX		G_FILENAME_MAX
 #define SYMLINK_MAX		G_FILENAME_MAX
+#define IOV_MAX			G_FS_IOV_MAX
 #define PATH_MAX		G_PATH_MAX
 
 #define NZERO			20
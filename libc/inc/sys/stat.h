@@ -45,9 +45,15 @@ typedef uint32_t mode_t;
 #define S_IRUSR 0400
 #define S_IRWXU 0700
 
-// TODO dummy macros
-#define S_ISREG(mode)	1
-#define S_ISDIR(mode)	0
+// file types
+#define S_IFMT	0170000
+#define S_IFIFO	0010000
+#define S_IFDIR	0040000
+#define S_IFREG	0100000
+
+#define S_ISREG(mode)	(((mode) & S_IFMT) == S_IFREG)
+#define S_ISDIR(mode)	(((mode) & S_IFMT) == S_IFDIR)
+#define S_ISFIFO(mode)	(((mode) & S_IFMT) == S_IFIFO)
 #define S_ISLNK(mode)	0
 
 struct stat {
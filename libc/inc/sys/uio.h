@@ -0,0 +1,50 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __GHOST_LIBC_SYS_UIO__
+#define __GHOST_LIBC_SYS_UIO__
+
+#include "ghost/common.h"
+#include "ghost/fs.h"
+#include "sys/types.h"
+
+__BEGIN_C
+
+/**
+ * A buffer for vectored I/O, has the same layout as {g_fs_iovec}.
+ */
+struct iovec {
+	void* iov_base;
+	size_t iov_len;
+};
+
+/**
+ * POSIX wrapper for <g_readv>
+ */
+ssize_t readv(int fd, const struct iovec* iov, int iovcnt);
+
+/**
+ * POSIX wrapper for <g_writev>
+ */
+ssize_t writev(int fd, const struct iovec* iov, int iovcnt);
+
+__END_C
+
+#endif
@@ -47,6 +47,16 @@ ssize_t read(int fd, void* buf, size_t count);
  */
 ssize_t write(int fd, const void* buf, size_t count);
 
+/**
+ * POSIX wrapper for <g_pread>
+ */
+ssize_t pread(int fd, void* buf, size_t count, off_t offset);
+
+/**
+ * POSIX wrapper for <g_pwrite>
+ */
+ssize_t pwrite(int fd, const void* buf, size_t count, off_t offset);
+
 /**
  * POSIX wrapper for <g_seek>
  */
@@ -35,6 +35,7 @@ DIR* opendir(const char* path) {
 		DIR* dir = (DIR*) malloc(sizeof(DIR));
 		dir->entbuf = (dirent*) malloc(sizeof(dirent));
 		dir->iter = iter;
+		dir->lock = 0;
 		return dir;
 
 	} else if (stat == G_FS_OPEN_DIRECTORY_NOT_FOUND) {
@@ -38,8 +38,14 @@ struct dirent* readdir(DIR* dir) {
 		ent->d_fileno = entry->node_id;
 		dir->entbuf->d_dev = -1; // TODO
 		dir->entbuf->d_namlen = strlen(entry->name);
-		dir->entbuf->d_reclen = -1; // TODO
-		dir->entbuf->d_type = -1; // TODO
+		dir->entbuf->d_reclen = sizeof(struct dirent);
+		if (entry->type == G_FS_NODE_TYPE_FILE) {
+			dir->entbuf->d_type = DT_REG;
+		} else if (entry->type == G_FS_NODE_TYPE_PIPE) {
+			dir->entbuf->d_type = DT_FIFO;
+		} else {
+			dir->entbuf->d_type = DT_DIR;
+		}
 		strcpy(ent->d_name, entry->name);
 		return ent;
 
@@ -58,7 +64,7 @@ struct dirent* readdir(DIR* dir) {
  */
 int readdir_r(DIR* dirp, struct dirent* entry, struct dirent** result) {
 
-	g_atomic_lock(&(dirp->lock));
+	g_user_mutex_lock(&dirp->lock);
 
 	errno = 0;
 
@@ -71,6 +77,6 @@ int readdir_r(DIR* dirp, struct dirent* entry, struct dirent** result) {
 	}
 
 	int err = errno;
-	dirp->lock = 0;
+	g_user_mutex_unlock(&dirp->lock);
 	return err ? err : 0;
 }
@@ -30,8 +30,8 @@
  */
 int __fclose_static(FILE* stream) {
 
-	g_atomic_lock(&stream->lock);
+	g_user_mutex_lock(&stream->lock);
 	int res = __fclose_static_unlocked(stream);
-	stream->lock = 0;
+	g_user_mutex_unlock(&stream->lock);
 	return res;
 }
@@ -47,6 +47,7 @@ int __fdopen_static(int fd, const char* mode, FILE* file) {
 	file->impl_close = __stdio_impl_close;
 	file->impl_read = __stdio_impl_read;
 	file->impl_write = __stdio_impl_write;
+	file->impl_writev = __stdio_impl_writev;
 	file->impl_seek = __stdio_impl_seek;
 	file->impl_tell = __stdio_impl_tell;
 	file->impl_fileno = __stdio_impl_fileno;
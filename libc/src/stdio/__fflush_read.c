@@ -27,8 +27,8 @@
  */
 int __fflush_read(FILE* stream) {
 
-	g_atomic_lock(&stream->lock);
+	g_user_mutex_lock(&stream->lock);
 	int res = __fflush_read_unlocked(stream);
-	stream->lock = 0;
+	g_user_mutex_unlock(&stream->lock);
 	return res;
 }
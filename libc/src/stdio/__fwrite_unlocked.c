@@ -23,6 +23,59 @@
 #include "string.h"
 #include "errno.h"
 
+/**
+ * Writes the buffered bytes followed by the given data with vectored writes,
+ * so that data which doesn't fit into the buffer needs no extra copy or flush.
+ */
+static size_t __fwrite_vectored_unlocked(const void* ptr, size_t total,
+		FILE* stream) {
+
+	struct iovec vectors[2];
+	vectors[0].iov_base = stream->buffer;
+	vectors[0].iov_len = stream->buffered_bytes_write;
+	vectors[1].iov_base = (void*) ptr;
+	vectors[1].iov_len = total;
+
+	int first = (stream->buffered_bytes_write == 0) ? 1 : 0;
+	size_t buffered = stream->buffered_bytes_write;
+	size_t done = 0;
+
+	// stream has no buffered bytes anymore, even if writing fails
+	stream->buffered_bytes_write = 0;
+	stream->flags |= G_FILE_FLAG_BUFFER_DIRECTION_WRITE;
+	stream->flags &= ~G_FILE_FLAG_EOF;
+
+	while (done < buffered + total) {
+		ssize_t written = stream->impl_writev(&vectors[first], 2 - first,
+				stream);
+
+		if (written == 0) {
+			stream->flags |= G_FILE_FLAG_EOF;
+			break;
+
+		} else if (written == -1) {
+			stream->flags |= G_FILE_FLAG_ERROR;
+			break;
+		}
+
+		done += written;
+
+		// skip what was written
+		while (first < 2 && (size_t) written >= vectors[first].iov_len) {
+			written -= vectors[first].iov_len;
+			first++;
+		}
+		if (first < 2) {
+			vectors[first].iov_base = (uint8_t*) vectors[first].iov_base
+					+ written;
+			vectors[first].iov_len -= written;
+		}
+	}
+
+	stream->flags &= ~G_FILE_FLAG_BUFFER_DIRECTION_WRITE;
+	return (done > buffered) ? done - buffered : 0;
+}
+
 /**
  *
  */
@@ -78,7 +131,7 @@ size_t __fwrite_unlocked(const void* ptr, size_t size, size_t nmemb,
 		while (done < total) {
 			// call write implementation
 			ssize_t written = stream->impl_write(&(((uint8_t*) ptr)[done]),
-					total, stream);
+					total - done, stream);
 
 			if (written == 0) {
 				stream->flags |= G_FILE_FLAG_EOF;
@@ -94,6 +147,21 @@ size_t __fwrite_unlocked(const void* ptr, size_t size, size_t nmemb,
 		return done / size;
 	}
 
+	// data that doesn't fit into the buffer is written together with it
+	size_t total = size * nmemb;
+	if (stream->impl_writev != NULL
+			&& stream->buffered_bytes_write + total > stream->buffer_size) {
+
+		// if the last access was a read, flush it
+		if (stream->flags & G_FILE_FLAG_BUFFER_DIRECTION_READ) {
+			if (__fflush_read_unlocked(stream) == EOF) {
+				return EOF;
+			}
+		}
+
+		return __fwrite_vectored_unlocked(ptr, total, stream) / size;
+	}
+
 	// for buffered streams, put char-by-char
 	uint8_t* buffer = (uint8_t*) ptr;
 
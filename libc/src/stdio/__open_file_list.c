@@ -22,7 +22,7 @@
 #include "stdio_internal.h"
 
 FILE* __open_file_list = 0;
-uint8_t open_file_list_lockatom = 0;
+g_user_mutex open_file_list_lock = 0;
 
 /**
  *
@@ -62,12 +62,12 @@ void __open_file_list_remove(FILE* file) {
  *
  */
 void __open_file_list_lock() {
-	g_atomic_lock(&open_file_list_lockatom);
+	g_user_mutex_lock(&open_file_list_lock);
 }
 
 /**
  *
  */
 void __open_file_list_unlock() {
-	open_file_list_lockatom = 0;
+	g_user_mutex_unlock(&open_file_list_lock);
 }
@@ -27,7 +27,7 @@
  */
 void clearerr(FILE* stream) {
 
-	g_atomic_lock(&stream->lock);
+	g_user_mutex_lock(&stream->lock);
 	__clearerr_unlocked(stream);
-	stream->lock = 0;
+	g_user_mutex_unlock(&stream->lock);
 }
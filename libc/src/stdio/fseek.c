@@ -36,9 +36,9 @@ int fseek(FILE* stream, long int offset, int whence) {
  */
 int fseeko(FILE* stream, off_t offset, int whence) {
 
-	g_atomic_lock(&stream->lock);
+	g_user_mutex_lock(&stream->lock);
 	int res = __fseeko_unlocked(stream, offset, whence);
-	stream->lock = 0;
+	g_user_mutex_unlock(&stream->lock);
 	return res;
 }
 
@@ -26,11 +26,11 @@
  */
 void fseterr(FILE* stream) {
 
-	g_atomic_lock(&stream->lock);
+	g_user_mutex_lock(&stream->lock);
 	if (stream->impl_seterr) {
 		stream->impl_seterr(stream);
 	} else {
 		errno = ENOTSUP;
 	}
-	stream->lock = 0;
+	g_user_mutex_unlock(&stream->lock);
 }
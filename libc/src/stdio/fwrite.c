@@ -28,8 +28,8 @@
  */
 size_t fwrite(const void* ptr, size_t size, size_t nmemb, FILE* stream) {
 
-	g_atomic_lock(&stream->lock);
+	g_user_mutex_lock(&stream->lock);
 	size_t len = __fwrite_unlocked(ptr, size, nmemb, stream);
-	stream->lock = 0;
+	g_user_mutex_unlock(&stream->lock);
 	return len;
 }
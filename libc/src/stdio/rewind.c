@@ -26,8 +26,8 @@
  */
 void rewind(FILE* stream) {
 
-	g_atomic_lock(&stream->lock);
+	g_user_mutex_lock(&stream->lock);
 	__fseeko_unlocked(stream, 0, SEEK_SET);
 	__clearerr_unlocked(stream);
-	stream->lock = 0;
+	g_user_mutex_unlock(&stream->lock);
 }
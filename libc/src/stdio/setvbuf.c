@@ -28,9 +28,9 @@
  */
 int setvbuf(FILE* stream, char* buf, int mode, size_t size) {
 
-	g_atomic_lock(&stream->lock);
+	g_user_mutex_lock(&stream->lock);
 	int res = __setvbuf_unlocked(stream, buf, mode, size);
-	stream->lock = 0;
+	g_user_mutex_unlock(&stream->lock);
 	return res;
 }
 
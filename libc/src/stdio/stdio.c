@@ -69,9 +69,9 @@ void __fini_stdio() {
 	FILE* f = __open_file_list;
 	while (f) {
 		FILE* n = f->next;
-		if(f->file_descriptor > STDERR_FILENO && g_atomic_try_lock(&f->lock)) {
+		if(f->file_descriptor > STDERR_FILENO && g_user_mutex_try_lock(&f->lock)) {
 			__fclose_static_unlocked(f);
-			f->lock = 0;
+			g_user_mutex_unlock(&f->lock);
 		}
 		f = n;
 	}
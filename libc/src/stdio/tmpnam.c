@@ -24,7 +24,7 @@
 #include "inttypes.h"
 #include "stdlib.h"
 
-uint8_t tmpnam_lock = 0;
+g_user_mutex tmpnam_lock = 0;
 char* tmpnam_static = NULL;
 uint64_t tmpnam_next = 0;
 
@@ -34,7 +34,7 @@ uint64_t tmpnam_next = 0;
 char* tmpnam(char* buf) {
 
 	// lock tmpnam
-	g_atomic_lock(&tmpnam_lock);
+	g_user_mutex_lock(&tmpnam_lock);
 
 	// set buffers
 	if (buf == NULL) {
@@ -44,7 +44,7 @@ char* tmpnam(char* buf) {
 
 			if (tmpnam_static == NULL) {
 				errno = ENOMEM;
-				tmpnam_lock = 0;
+				g_user_mutex_unlock(&tmpnam_lock);
 				return NULL;
 			}
 		}
@@ -60,7 +60,7 @@ char* tmpnam(char* buf) {
 			g_get_pid());
 
 	// unlock tmpnam
-	tmpnam_lock = 0;
+	g_user_mutex_unlock(&tmpnam_lock);
 
 	return buf;
 }
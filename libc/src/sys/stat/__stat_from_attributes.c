@@ -0,0 +1,57 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "stat_internal.h"
+#include "string.h"
+#include "errno.h"
+
+/**
+ *
+ */
+int __stat_from_attributes(g_fs_stat_status status, g_fs_stat_attributes* attributes, struct stat* buf) {
+
+	if (status == G_FS_STAT_NOT_FOUND) {
+		errno = ENOENT;
+		return -1;
+
+	} else if (status == G_FS_STAT_INVALID_FD) {
+		errno = EBADF;
+		return -1;
+
+	} else if (status != G_FS_STAT_SUCCESSFUL) {
+		errno = EIO;
+		return -1;
+	}
+
+	memset(buf, 0, sizeof(struct stat));
+	buf->st_ino = attributes->node_id;
+	buf->st_nlink = 1;
+	buf->st_size = attributes->length;
+
+	// there are no permissions yet, so everything is accessible
+	if (attributes->type == G_FS_NODE_TYPE_FILE) {
+		buf->st_mode = S_IFREG | S_IRWXU | S_IRWXG | S_IRWXO;
+	} else if (attributes->type == G_FS_NODE_TYPE_PIPE) {
+		buf->st_mode = S_IFIFO | S_IRWXU | S_IRWXG | S_IRWXO;
+	} else {
+		buf->st_mode = S_IFDIR | S_IRWXU | S_IRWXG | S_IRWXO;
+	}
+	return 0;
+}
@@ -21,12 +21,14 @@
 #include "sys/stat.h"
 #include "stdint.h"
 #include "ghost.h"
+#include "stat_internal.h"
 
 /**
  *
  */
 int fstat(int fd, struct stat* buf) {
 
-	klog("warning: fstat(%i, %x) not implemented", fd, buf);
-	return 0;
+	g_fs_stat_attributes attributes;
+	g_fs_stat_status status = g_fstat(fd, &attributes);
+	return __stat_from_attributes(status, &attributes, buf);
 }
@@ -21,11 +21,14 @@
 #include "sys/stat.h"
 #include "stdint.h"
 #include "ghost.h"
+#include "stat_internal.h"
 
 /**
  *
  */
 int stat(const char *pathname, struct stat *buf) {
 
-	__G_NOT_IMPLEMENTED(stat)
+	g_fs_stat_attributes attributes;
+	g_fs_stat_status status = g_stat(pathname, &attributes);
+	return __stat_from_attributes(status, &attributes, buf);
 }
@@ -0,0 +1,39 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#ifndef __GHOST_LIBC_STAT_INTERNAL__
+#define __GHOST_LIBC_STAT_INTERNAL__
+
+#include "ghost.h"
+#include "sys/stat.h"
+
+__BEGIN_C
+
+/**
+ * Fills the stat structure from the attributes that the kernel provides and
+ * sets errno for unsuccessful status codes.
+ *
+ * @return 0 if successful, otherwise -1
+ */
+int __stat_from_attributes(g_fs_stat_status status, g_fs_stat_attributes* attributes, struct stat* buf);
+
+__END_C
+
+#endif
@@ -19,13 +19,47 @@
  * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
 
 #include "unistd.h"
-#include "ghost/kernel.h"
+#include "fcntl.h"
+#include "ghost.h"
 #include "errno.h"
+#include <stdarg.h>
 
 /**
  *
  */
 int fcntl(int fildes, int cmd, ...) {
+
+	if (cmd == F_GETPIPE_SZ || cmd == F_SETPIPE_SZ) {
+		g_fs_pipe_capacity_status status;
+		uint32_t capacity;
+
+		if (cmd == F_SETPIPE_SZ) {
+			va_list ap;
+			va_start(ap, cmd);
+			int requested = va_arg(ap, int);
+			va_end(ap);
+
+			if (requested < 0) {
+				errno = EINVAL;
+				return -1;
+			}
+			capacity = g_pipe_set_capacity(fildes, requested, &status);
+		} else {
+			capacity = g_pipe_get_capacity(fildes, &status);
+		}
+
+		if (status == G_FS_PIPE_CAPACITY_SUCCESSFUL) {
+			return capacity;
+		} else if (status == G_FS_PIPE_CAPACITY_INVALID_FD) {
+			errno = EBADF;
+		} else if (status == G_FS_PIPE_CAPACITY_BUSY) {
+			errno = EBUSY;
+		} else {
+			errno = EINVAL;
+		}
+		return -1;
+	}
+
 	klog("warning: fcntl is not implemented");
 	return -1;
 }
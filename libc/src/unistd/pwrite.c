@@ -0,0 +1,51 @@
+/* * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * *
+ *                                                                           *
+ *  Ghost, a micro-kernel based operating system for the x86 architecture    *
+ *  Copyright (C) 2015, Max Schlüssel <lokoxe@gmail.com>                     *
+ *                                                                           *
+ *  This program is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by     *
+ *  the Free Software Foundation, either version 3 of the License, or        *
+ *  (at your option) any later version.                                      *
+ *                                                                           *
+ *  This program is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of           *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the            *
+ *  GNU General Public License for more details.                             *
+ *                                                                           *
+ *  You should have received a copy of the GNU General Public License        *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.    *
+ *                                                                           *
+ * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * */
+
+#include "unistd.h"
+#include "ghost/user.h"
+#include "errno.h"
+
+/**
+ *
+ */
+ssize_t pwrite(int fd, const void* buf, size_t count, off_t offset) {
+
+	if (offset < 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	g_fs_write_status stat;
+	int64_t len = g_pwrite_s(fd, buf, count, offset, &stat);
+
+	if (stat == G_FS_WRITE_SUCCESSFUL) {
+		return len;
+
+	} else if (stat == G_FS_WRITE_INVALID_FD) {
+		errno = EBADF;
+
+	} else {
+		// TODO improve kernel error codes
+		errno = EIO;
+
+	}
+
+	return -1;
+}
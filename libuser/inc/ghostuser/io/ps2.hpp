@@ -20,10 +20,10 @@
 
 #include "ps2_driver_constants.hpp"
 
-// shared area pointer
+// input channels shared with the driver
 extern bool g_ps2_is_registered;
-extern g_ps2_shared_area* g_ps2_area;
-extern g_fd g_ps2_keyboard_pipe;
+extern g_channel* g_ps2_mouse_channel;
+extern g_channel* g_ps2_keyboard_channel;
 
 /**
  *
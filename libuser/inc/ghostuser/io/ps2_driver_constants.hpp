@@ -27,52 +27,20 @@
 #define G_PS2_DRIVER_IDENTIFIER							"ps2driver"
 
 /**
- * Shared memory area that is used for transferring PS/2 input data
- * to a process that handles this data.
+ * Record passed through the mouse channel for each packet.
  */
 typedef struct {
-	struct {
-		/**
-		 * Lock to use when accessing any of the variables in the structure.
-		 */
-		g_atom lock;
+	int16_t move_x;
+	int16_t move_y;
+	uint16_t flags;
+}__attribute__((packed)) g_ps2_mouse_packet;
 
-		/**
-		 * This atom is set to true when the PS2 driver is initialized. Once
-		 * the driver writes bytes to the buffer, it is set to false.
-		 *
-		 * A client shall block on this atom when reading data. Once the atom is
-		 * false, the client shall take the information in this struct. The
-		 * client then shall set this atom to true to lock himself.
-		 */
-		g_atom buffer_empty_lock;
-
-		int16_t move_x;
-		int16_t move_y;
-		uint16_t flags;
-	} mouse;
-
-	struct {
-		/**
-		 * This atom is set to true when the PS2 driver is initialized. Once
-		 * the driver writes bytes to the buffer, it is set to false.
-		 *
-		 * A client shall block on this atom when reading data. Once the atom is
-		 * false, the client shall read bytes from the buffer, check if there
-		 * are still bytes in the buffer and set the remaining variables
-		 * accordingly.
-		 */
-		g_atom buffer_empty_lock;
-
-		/**
-		 * Counter for the number of bytes in the key buffer. See the lock
-		 * above for a detailed description. The "buffer_amount_lock" is used
-		 * for atomic access to the buffer amount counter.
-		 */
-		uint16_t buffer_amount;
-		g_atom buffer_amount_lock;
-	} keyboard;
-}__attribute__((packed)) g_ps2_shared_area;
+/**
+ * Number of records that the input channels can hold. Input is dropped
+ * while a channel is full.
+ */
+#define G_PS2_MOUSE_CHANNEL_CAPACITY					256
+#define G_PS2_KEYBOARD_CHANNEL_CAPACITY					256
 
 /**
  * Request sent to register the sender thread as the
@@ -83,12 +51,13 @@ typedef struct {
 }__attribute__((packed)) g_ps2_register_request;
 
 /**
- * Response sent to a registering thread, containing the
- * shared memory area to use.
+ * Response sent to a registering thread, containing the channels that
+ * the input is passed through. The keyboard channel transports scancode
+ * bytes. Only one thread should consume each channel.
  */
 typedef struct {
-	g_ps2_shared_area* area;
-	g_fd keyboard_pipe;
+	g_channel* mouse;
+	g_channel* keyboard;
 }__attribute__((packed)) g_ps2_register_response;
 
 #endif
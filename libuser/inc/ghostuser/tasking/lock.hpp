@@ -24,30 +24,30 @@
 #include <ghost.h>
 
 /**
- *
+ * Mutex for the threads of a process, see {g_user_mutex_lock}.
  */
 class g_lock {
 protected:
-	uint8_t locked;
+	g_user_mutex locked;
 
 public:
 	g_lock() :
-			locked(false) {
+			locked(0) {
 	}
 
 	virtual ~g_lock() {
 	}
 
 	virtual void lock() {
-		g_atomic_lock(&locked);
+		g_user_mutex_lock(&locked);
 	}
 
 	virtual void unlock() {
-		locked = false;
+		g_user_mutex_unlock(&locked);
 	}
 
 	bool isLocked() {
-		return locked;
+		return locked != 0;
 	}
 
 };
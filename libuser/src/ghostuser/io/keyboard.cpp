@@ -55,26 +55,14 @@ g_key_info g_keyboard::readKey(bool* break_condition) {
 		}
 	}
 
-	// wait until there are bytes in the buffer
-	if (g_atomic_block_to(&g_ps2_area->keyboard.buffer_empty_lock, 10000) == false) {
-
-		// keyboard pipe is non-blocking
-		uint8_t scancode[1];
-		if (g_read(g_ps2_keyboard_pipe, scancode, 1) > 0) {
-
-			// decrease buffer counter
-			g_atomic_lock(&g_ps2_area->keyboard.buffer_amount_lock);
-			g_ps2_area->keyboard.buffer_amount--;
-			if (g_ps2_area->keyboard.buffer_amount == 0) {
-				g_ps2_area->keyboard.buffer_empty_lock = true;
-			}
-			g_ps2_area->keyboard.buffer_amount_lock = false;
+	// wait until there is a scancode in the channel
+	uint8_t scancode;
+	if (g_channel_pop_to(g_ps2_keyboard_channel, &scancode, 10000)) {
 
-			// read and convert data
-			g_key_info info;
-			if (keyForScancode(scancode[0], &info)) {
-				return info;
-			}
+		// convert data
+		g_key_info info;
+		if (keyForScancode(scancode, &info)) {
+			return info;
 		}
 	}
 	return g_key_info();
@@ -35,20 +35,22 @@ g_mouse_info g_mouse::readMouse() {
 		}
 	}
 
-	// wait until incoming data is here (and the driver unsets the atom)
-	g_atomic_block(&g_ps2_area->mouse.buffer_empty_lock);
+	// wait until a packet is here
+	g_ps2_mouse_packet packet;
+	g_channel_pop(g_ps2_mouse_channel, &packet, true);
 
 	g_mouse_info e;
-	e.x = g_ps2_area->mouse.move_x;
-	e.y = g_ps2_area->mouse.move_y;
-	e.button1 = (g_ps2_area->mouse.flags & (1 << 0));
-	e.button2 = (g_ps2_area->mouse.flags & (1 << 1));
-	e.button3 = (g_ps2_area->mouse.flags & (1 << 2));
+	e.x = packet.move_x;
+	e.y = packet.move_y;
 
-	g_ps2_area->mouse.move_x = 0;
-	g_ps2_area->mouse.move_y = 0;
-
-	g_ps2_area->mouse.buffer_empty_lock = true;
+	// sum up the movement of packets that arrived meanwhile
+	while (g_channel_pop(g_ps2_mouse_channel, &packet, false)) {
+		e.x += packet.move_x;
+		e.y += packet.move_y;
+	}
 
+	e.button1 = (packet.flags & (1 << 0));
+	e.button2 = (packet.flags & (1 << 1));
+	e.button3 = (packet.flags & (1 << 2));
 	return e;
 }
@@ -23,9 +23,9 @@
 #include <stdio.h>
 #include <ghostuser/utils/local.hpp>
 
-g_ps2_shared_area* g_ps2_area = 0;
 bool g_ps2_is_registered = false;
-g_fd g_ps2_keyboard_pipe = -1;
+g_channel* g_ps2_mouse_channel = 0;
+g_channel* g_ps2_keyboard_channel = 0;
 
 static uint8_t g_ps2_registration_lock = false;
 
@@ -68,8 +68,8 @@ bool g_ps2::registerSelf() {
 
 	// receive content
 	g_ps2_register_response* response = (g_ps2_register_response*) G_MESSAGE_CONTENT(response_buf());
-	if (response->area == 0) {
-		klog("PS/2 driver registration error: shared memory was NULL");
+	if (response->mouse == 0 || response->keyboard == 0) {
+		klog("PS/2 driver registration error: input channels were NULL");
 		g_ps2_registration_lock = false;
 		return false;
 	}
@@ -77,7 +77,7 @@ bool g_ps2::registerSelf() {
 	// all fine
 	g_ps2_registration_lock = false;
 	g_ps2_is_registered = true;
-	g_ps2_area = response->area;
-	g_ps2_keyboard_pipe = response->keyboard_pipe;
+	g_ps2_mouse_channel = response->mouse;
+	g_ps2_keyboard_channel = response->keyboard;
 	return true;
 }
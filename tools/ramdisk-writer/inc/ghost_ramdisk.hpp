@@ -24,29 +24,71 @@
 #include <fstream>
 #include <stdint.h>
 #include <list>
+#include <string>
+#include <vector>
 
-#define VERSION_MAJOR	1
+#define VERSION_MAJOR	2
 #define	VERSION_MINOR	0
 
+/**
+ * Layout of version 2 images, must match ghost/ramdisk.h of the kernel.
+ */
+#define RAMDISK_V2_MAGIC			0x32445247
+#define RAMDISK_V2_VERSION			2
+#define RAMDISK_V2_HEADER_SIZE		32
+#define RAMDISK_V2_ENTRY_SIZE		20
+
+#define RAMDISK_ENTRY_TYPE_FOLDER	0
+#define RAMDISK_ENTRY_TYPE_FILE		1
+#define RAMDISK_V2_ENTRY_TYPE_COMPRESSED_FILE	2
+
+#define RAMDISK_V2_BLOCK_SIZE		0x4000
+
+/**
+ * An entry that is collected before the image is written, its id is its index.
+ */
+struct ghost_ramdisk_entry
+{
+	uint32_t parentId;
+	bool isFile;
+	std::string name;
+	std::string path;
+	uint32_t contentLength;
+	std::vector<uint32_t> children;
+
+	/**
+	 * Block table and blocks of a compressed file, empty if it is stored as it is.
+	 */
+	std::vector<uint8_t> compressed;
+
+	uint32_t nameOffset;
+	uint32_t data;
+};
+
 /**
  *
  */
 class ghost_ramdisk
 {
 private:
-	int idCounter;
 	std::ofstream out;
 	std::list<std::string> ignores;
+	std::vector<ghost_ramdisk_entry> entries;
 
-	void writeRecursive(const char* basePath, const char* path, const char* name, uint32_t contentLength, uint32_t parentId, bool isFile);
+	bool isIgnored(const char* basePath, const char* path);
+	void collectRecursive(const char* basePath, const char* path, const char* name, uint32_t contentLength, uint32_t parentId, bool isFile);
+	void compressFile(ghost_ramdisk_entry& entry);
+	void writeImage();
+	void writeUint32(uint32_t value);
 
 public:
 	ghost_ramdisk() :
-			idCounter(0), verbose(false)
+			verbose(false), compress(false)
 	{
 	}
 
 	bool verbose;
+	bool compress;
 	void create(const char* sourcePath, const char* targetPath);
 };
 
@@ -48,7 +48,10 @@ int main(int argc, char** argv)
 			std::cout << "  This program generates a Ghost ramdisk from a given source folder." << std::endl;
 			std::cout << "  To do so, use the following command syntax:" << std::endl;
 			std::cout << std::endl;
-			std::cout << "\tpath/to/source path/to/target" << std::endl;
+			std::cout << "\tpath/to/source path/to/target [-v] [-c]" << std::endl;
+			std::cout << std::endl;
+			std::cout << "  -v  list the entries that are written" << std::endl;
+			std::cout << "  -c  compress the file contents in blocks" << std::endl;
 			std::cout << std::endl;
 			return 0;
 		}
@@ -60,12 +63,15 @@ int main(int argc, char** argv)
 	if(argc >= 3)
 	{
 
-		if(argc == 4)
+		for(int i = 3; i < argc; i++)
 		{
-			char* flag = argv[3];
+			char* flag = argv[i];
 			if(strcmp(flag, "-v") == 0)
 			{
 				ramdisk.verbose = true;
+			} else if(strcmp(flag, "-c") == 0)
+			{
+				ramdisk.compress = true;
 			}
 		}
 
@@ -120,7 +126,8 @@ void ghost_ramdisk::create(const char* sourcePath, const char* targetPath)
 		{
 			std::cout << "status: packing folder \"" << sourcePath << "\" to ramdisk file \"" << targetPath << "\":" << std::endl;
 			int64_t pos = out.tellp();
-			writeRecursive(sourcePath, sourcePath, "", 0, 0, false);
+			collectRecursive(sourcePath, sourcePath, "", 0, 0, false);
+			writeImage();
 			int64_t written = out.tellp() - pos;
 			std::cout << "status: ramdisk successfully created, wrote " << written << " bytes" << std::endl;
 		} else
@@ -142,10 +149,8 @@ void ghost_ramdisk::create(const char* sourcePath, const char* targetPath)
 /**
  *
  */
-void ghost_ramdisk::writeRecursive(const char* basePath, const char* path, const char* name, uint32_t contentLength, uint32_t parentId, bool isFile)
+bool ghost_ramdisk::isIgnored(const char* basePath, const char* path)
 {
-
-	// check whether to skip the file
 	std::string basePathStr(basePath);
 	std::string pathStr(path);
 	for(std::string ign : ignores)
@@ -157,8 +162,7 @@ void ghost_ramdisk::writeRecursive(const char* basePath, const char* path, const
 			std::string part = ign.substr(1);
 			if(pathStr.find(part) == pathStr.length() - part.length())
 			{
-				std::cout << "  skipping: " << path << std::endl;
-				return;
+				return true;
 			}
 		}
 
@@ -170,8 +174,7 @@ void ghost_ramdisk::writeRecursive(const char* basePath, const char* path, const
 
 			if(pathStr.find(absolutePartPath) == 0)
 			{
-				std::cout << "  skipping: " << path << std::endl;
-				return;
+				return true;
 			}
 		}
 
@@ -179,15 +182,24 @@ void ghost_ramdisk::writeRecursive(const char* basePath, const char* path, const
 		std::string absolutePath = basePathStr + "/" + ign;
 		if(absolutePath == pathStr)
 		{
-			std::cout << "  skipping: " << path << std::endl;
-			return;
+			return true;
 		}
 	}
+	return false;
+}
 
-	uint32_t bufferSize = 0x10000;
-	char* buffer = new char[bufferSize];
-	uint32_t entryId = idCounter++;
+/**
+ *
+ */
+void ghost_ramdisk::collectRecursive(const char* basePath, const char* path, const char* name, uint32_t contentLength, uint32_t parentId, bool isFile)
+{
+	if(isIgnored(basePath, path))
+	{
+		std::cout << "  skipping: " << path << std::endl;
+		return;
+	}
 
+	uint32_t entryId = entries.size();
 	if(verbose)
 	{
 		std::stringstream msg;
@@ -195,112 +207,387 @@ void ghost_ramdisk::writeRecursive(const char* basePath, const char* path, const
 		std::cout << msg.str() << std::endl;
 	}
 
-	// Root must not be written
+	ghost_ramdisk_entry entry;
+	entry.parentId = parentId;
+	entry.isFile = isFile;
+	entry.name = name;
+	entry.path = path;
+	entry.contentLength = contentLength;
+	entry.nameOffset = 0;
+	entry.data = 0;
+	entries.push_back(entry);
+
+	// Root has no parent
 	if(entryId > 0)
 	{
-		// file or folder
-		buffer[0] = isFile ? 1 : 0;
-		out.write(buffer, 1);
-
-		// id
-		buffer[0] = ((entryId >> 0) & 0xFF);
-		buffer[1] = ((entryId >> 8) & 0xFF);
-		buffer[2] = ((entryId >> 16) & 0xFF);
-		buffer[3] = ((entryId >> 24) & 0xFF);
-		out.write(buffer, 4);
-
-		// parent id
-		buffer[0] = ((parentId >> 0) & 0xFF);
-		buffer[1] = ((parentId >> 8) & 0xFF);
-		buffer[2] = ((parentId >> 16) & 0xFF);
-		buffer[3] = ((parentId >> 24) & 0xFF);
-		out.write(buffer, 4);
-
-		// name length
-		int32_t namelen = strlen(name);
-		buffer[0] = ((namelen >> 0) & 0xFF);
-		buffer[1] = ((namelen >> 8) & 0xFF);
-		buffer[2] = ((namelen >> 16) & 0xFF);
-		buffer[3] = ((namelen >> 24) & 0xFF);
-		out.write(buffer, 4);
-
-		// name
-		memcpy(buffer, name, namelen);
-		out.write(buffer, namelen);
+		entries[parentId].children.push_back(entryId);
 	}
 
 	if(isFile)
 	{
-		// file length
-		buffer[0] = ((contentLength >> 0) & 0xFF);
-		buffer[1] = ((contentLength >> 8) & 0xFF);
-		buffer[2] = ((contentLength >> 16) & 0xFF);
-		buffer[3] = ((contentLength >> 24) & 0xFF);
-		out.write(buffer, 4);
+		return;
+	}
 
-		// file content
-		std::ifstream fileInput;
-		fileInput.open(path, std::ios::in | std::ios::binary);
+	DIR *directory;
+	dirent *dirEntry;
 
-		int32_t length;
-		while(fileInput.good())
+	if((directory = opendir(path)) != NULL)
+	{
+		while((dirEntry = readdir(directory)) != NULL)
 		{
-			fileInput.read(buffer, bufferSize);
-			length = fileInput.gcount();
-			out.write(buffer, length);
+			std::string entryPath = std::string(path) + '/' + dirEntry->d_name;
+
+			struct stat s;
+			int32_t statr = stat(entryPath.c_str(), &s);
+			if(statr == 0)
+			{
+
+				if(S_ISREG(s.st_mode))
+				{
+					collectRecursive(basePath, entryPath.c_str(), dirEntry->d_name, s.st_size, entryId, true);
+
+				} else if(S_ISDIR(s.st_mode))
+				{
+					if(!(strcmp(dirEntry->d_name, ".") == 0 || strcmp(dirEntry->d_name, "..") == 0))
+					{
+						collectRecursive(basePath, entryPath.c_str(), dirEntry->d_name, 0, entryId, false);
+					}
+				}
+			} else
+			{
+				std::cerr << "error: could not read directory: '" << path << "'";
+				break;
+			}
 		}
 
-		fileInput.close();
+		closedir(directory);
 	} else
 	{
-		DIR *directory;
-		dirent *entry;
+		std::cerr << "error: could not open directory: '" << path << "'";
+	}
+}
+
+/**
+ *
+ */
+void ghost_ramdisk::writeUint32(uint32_t value)
+{
+	char buffer[4];
+	buffer[0] = ((value >> 0) & 0xFF);
+	buffer[1] = ((value >> 8) & 0xFF);
+	buffer[2] = ((value >> 16) & 0xFF);
+	buffer[3] = ((value >> 24) & 0xFF);
+	out.write(buffer, 4);
+}
+
+/**
+ * Appends the length extension bytes, see compressBlock.
+ */
+static void writeLengthExtension(std::vector<uint8_t>& out, uint32_t value)
+{
+	while(value >= 255)
+	{
+		out.push_back(255);
+		value -= 255;
+	}
+	out.push_back(value);
+}
 
-		if((directory = opendir(path)) != NULL)
+/**
+ * Appends a sequence of literals followed by a match, or only literals if the match
+ * length is zero.
+ */
+static void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals, uint32_t literalCount, uint32_t distance, uint32_t matchLength)
+{
+	uint8_t literalNibble = std::min(literalCount, (uint32_t) 15);
+	uint8_t matchNibble = matchLength ? std::min(matchLength - 4, (uint32_t) 15) : 0;
+	out.push_back((literalNibble << 4) | matchNibble);
+	if(literalCount >= 15)
+	{
+		writeLengthExtension(out, literalCount - 15);
+	}
+	out.insert(out.end(), literals, literals + literalCount);
+
+	if(matchLength)
+	{
+		out.push_back(distance & 0xFF);
+		out.push_back((distance >> 8) & 0xFF);
+		if(matchLength - 4 >= 15)
 		{
-			while((entry = readdir(directory)) != NULL)
-			{
-				char entryPath[260];
+			writeLengthExtension(out, matchLength - 4 - 15);
+		}
+	}
+}
 
-				std::stringstream str;
-				str << path;
-				str << '/';
-				str << entry->d_name;
+/**
+ * Compresses a block in the format that is described in ghost/ramdisk.h, using a
+ * greedy search over a hash table of the last position of each four byte sequence.
+ */
+static void compressBlock(const uint8_t* in, uint32_t length, std::vector<uint8_t>& out)
+{
+	const uint32_t hashBits = 12;
+	std::vector<int32_t> table(1 << hashBits, -1);
 
-				str >> entryPath;
+	uint32_t pos = 0;
+	uint32_t literalStart = 0;
+	while(pos + 4 <= length)
+	{
+		uint32_t sequence;
+		memcpy(&sequence, &in[pos], 4);
+		uint32_t hash = (sequence * 2654435761u) >> (32 - hashBits);
+		int32_t candidate = table[hash];
+		table[hash] = pos;
 
-				struct stat s;
-				int32_t statr = stat(entryPath, &s);
-				if(statr == 0)
-				{
+		if(candidate < 0 || pos - candidate > 0xFFFF || memcmp(&in[candidate], &in[pos], 4) != 0)
+		{
+			pos++;
+			continue;
+		}
 
-					if(s.st_mode & S_IFREG)
-					{
-						writeRecursive(basePath, entryPath, entry->d_name, s.st_size, entryId, true);
+		uint32_t matchLength = 4;
+		while(pos + matchLength < length && in[candidate + matchLength] == in[pos + matchLength])
+		{
+			matchLength++;
+		}
 
-					} else if(s.st_mode & S_IFDIR)
-					{
-						if(!(strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0))
-						{
-							writeRecursive(basePath, entryPath, entry->d_name, 0, entryId, false);
-						}
-					}
-				} else
-				{
-					std::cerr << "error: could not read directory: '" << path << "'";
-					break;
-				}
+		writeSequence(out, &in[literalStart], pos - literalStart, pos - candidate, matchLength);
+		pos += matchLength;
+		literalStart = pos;
+	}
+
+	writeSequence(out, &in[literalStart], length - literalStart, 0, 0);
+}
+
+/**
+ * Compresses the contents of a file into a block table followed by the blocks.
+ * Files that don't get smaller are stored as they are.
+ */
+void ghost_ramdisk::compressFile(ghost_ramdisk_entry& entry)
+{
+	std::vector<uint8_t> content(entry.contentLength);
+	std::ifstream fileInput;
+	fileInput.open(entry.path, std::ios::in | std::ios::binary);
+	fileInput.read((char*) content.data(), entry.contentLength);
+	if((uint32_t) fileInput.gcount() != entry.contentLength)
+	{
+		std::cerr << "error: file changed while packing: '" << entry.path << "'" << std::endl;
+		return;
+	}
+
+	uint32_t blockCount = (entry.contentLength + RAMDISK_V2_BLOCK_SIZE - 1) / RAMDISK_V2_BLOCK_SIZE;
+	std::vector<uint32_t> blockEnds;
+	std::vector<uint8_t> blocks;
+	for(uint32_t block = 0; block < blockCount; block++)
+	{
+		uint32_t offset = block * RAMDISK_V2_BLOCK_SIZE;
+		uint32_t length = std::min(entry.contentLength - offset, (uint32_t) RAMDISK_V2_BLOCK_SIZE);
+
+		std::vector<uint8_t> compressedBlock;
+		compressBlock(&content[offset], length, compressedBlock);
+
+		// Blocks with the same size as their contents are stored as they are
+		if(compressedBlock.size() >= length)
+		{
+			blocks.insert(blocks.end(), &content[offset], &content[offset] + length);
+		} else
+		{
+			blocks.insert(blocks.end(), compressedBlock.begin(), compressedBlock.end());
+		}
+		blockEnds.push_back(blocks.size());
+	}
+
+	uint32_t tableSize = (blockCount + 1) * 4;
+	if(tableSize + blocks.size() >= entry.contentLength)
+	{
+		return;
+	}
+
+	// Offsets in the table are relative to the image, they are fixed once the layout is known
+	entry.compressed.resize(tableSize);
+	for(uint32_t i = 0; i <= blockCount; i++)
+	{
+		uint32_t relative = tableSize + (i == 0 ? 0 : blockEnds[i - 1]);
+		memcpy(&entry.compressed[i * 4], &relative, 4);
+	}
+	entry.compressed.insert(entry.compressed.end(), blocks.begin(), blocks.end());
+}
+
+/**
+ * Adds the position of the compressed contents to the offsets in its block table.
+ */
+static void relocateBlockTable(ghost_ramdisk_entry& entry)
+{
+	uint32_t blockCount = (entry.contentLength + RAMDISK_V2_BLOCK_SIZE - 1) / RAMDISK_V2_BLOCK_SIZE;
+	for(uint32_t i = 0; i <= blockCount; i++)
+	{
+		uint32_t offset;
+		memcpy(&offset, &entry.compressed[i * 4], 4);
+		offset += entry.data;
+		memcpy(&entry.compressed[i * 4], &offset, 4);
+	}
+}
+
+/**
+ * Writes the header, the entry table, the child table, the string table and then
+ * the file contents, each aligned to four bytes.
+ */
+void ghost_ramdisk::writeImage()
+{
+	// Children are sorted by name so that the kernel can do a binary search
+	uint32_t childCount = 0;
+	uint32_t compressedCount = 0;
+	for(ghost_ramdisk_entry& entry : entries)
+	{
+		if(compress && entry.isFile)
+		{
+			compressFile(entry);
+			if(entry.compressed.size() > 0)
+			{
+				compressedCount++;
 			}
+		}
+
+		std::sort(entry.children.begin(), entry.children.end(), [this](uint32_t a, uint32_t b)
+		{
+			return strcmp(entries[a].name.c_str(), entries[b].name.c_str()) < 0;
+		});
+		childCount += entry.children.size();
+	}
+
+	uint32_t entryTableOffset = RAMDISK_V2_HEADER_SIZE;
+	uint32_t childTableOffset = entryTableOffset + entries.size() * RAMDISK_V2_ENTRY_SIZE;
+	uint32_t stringTableOffset = childTableOffset + childCount * 4;
+
+	uint32_t stringTableSize = 0;
+	for(ghost_ramdisk_entry& entry : entries)
+	{
+		entry.nameOffset = stringTableSize;
+		stringTableSize += entry.name.length() + 1;
+	}
+
+	uint32_t position = (stringTableOffset + stringTableSize + 3) & ~3;
+	uint32_t firstChild = 0;
+	for(ghost_ramdisk_entry& entry : entries)
+	{
+		if(entry.isFile)
+		{
+			entry.data = position;
+			if(entry.compressed.size() > 0)
+			{
+				relocateBlockTable(entry);
+				position = (position + entry.compressed.size() + 3) & ~3;
+			} else
+			{
+				position = (position + entry.contentLength + 3) & ~3;
+			}
+		} else
+		{
+			entry.data = firstChild;
+			firstChild += entry.children.size();
+		}
+	}
 
-			closedir(directory);
+	// Header
+	writeUint32(RAMDISK_V2_MAGIC);
+	writeUint32(RAMDISK_V2_VERSION);
+	writeUint32(entries.size());
+	writeUint32(entryTableOffset);
+	writeUint32(childTableOffset);
+	writeUint32(childCount);
+	writeUint32(stringTableOffset);
+	writeUint32(stringTableSize);
+
+	// Entry table
+	for(ghost_ramdisk_entry& entry : entries)
+	{
+		if(entry.compressed.size() > 0)
+		{
+			writeUint32(RAMDISK_V2_ENTRY_TYPE_COMPRESSED_FILE);
 		} else
 		{
-			std::cerr << "error: could not open directory: '" << path << "'";
+			writeUint32(entry.isFile ? RAMDISK_ENTRY_TYPE_FILE : RAMDISK_ENTRY_TYPE_FOLDER);
+		}
+		writeUint32(entry.parentId);
+		writeUint32(entry.nameOffset);
+		writeUint32(entry.data);
+		writeUint32(entry.isFile ? entry.contentLength : entry.children.size());
+	}
+
+	// Child table
+	for(ghost_ramdisk_entry& entry : entries)
+	{
+		for(uint32_t child : entry.children)
+		{
+			writeUint32(child);
+		}
+	}
+
+	// String table
+	for(ghost_ramdisk_entry& entry : entries)
+	{
+		out.write(entry.name.c_str(), entry.name.length() + 1);
+	}
+
+	// File contents, padded or cut to the size that was recorded
+	uint32_t bufferSize = 0x10000;
+	char* buffer = new char[bufferSize];
+	for(ghost_ramdisk_entry& entry : entries)
+	{
+		if(!entry.isFile)
+		{
+			continue;
+		}
+
+		memset(buffer, 0, bufferSize);
+		while((uint32_t) out.tellp() < entry.data)
+		{
+			out.write(buffer, 1);
 		}
+
+		if(entry.compressed.size() > 0)
+		{
+			out.write((const char*) entry.compressed.data(), entry.compressed.size());
+			continue;
+		}
+
+		std::ifstream fileInput;
+		fileInput.open(entry.path, std::ios::in | std::ios::binary);
+
+		uint32_t remaining = entry.contentLength;
+		while(remaining > 0 && fileInput.good())
+		{
+			fileInput.read(buffer, std::min(remaining, bufferSize));
+			uint32_t length = fileInput.gcount();
+			out.write(buffer, length);
+			remaining -= length;
+		}
+		fileInput.close();
+
+		if(remaining > 0)
+		{
+			std::cerr << "error: file changed while packing: '" << entry.path << "'" << std::endl;
+			memset(buffer, 0, bufferSize);
+			while(remaining > 0)
+			{
+				uint32_t length = std::min(remaining, bufferSize);
+				out.write(buffer, length);
+				remaining -= length;
+			}
+		}
+	}
+
+	// Pad the last file
+	memset(buffer, 0, 4);
+	while((uint32_t) out.tellp() < position)
+	{
+		out.write(buffer, 1);
 	}
 
-	// entry done
 	out.flush();
+	delete[] buffer;
 
-	delete buffer;
+	if(compress)
+	{
+		std::cout << "status: compressed " << compressedCount << " files" << std::endl;
+	}
 }